@@ -0,0 +1,677 @@
+/* -*- C++ -*- */
+#ifndef _MADARA_NO_KARL_
+
+#include <algorithm>
+
+#include "madara/expression/AccessVisitor.h"
+#include "madara/expression/LeafNode.h"
+#include "madara/expression/VariableNode.h"
+#include "madara/expression/VariableDecrementNode.h"
+#include "madara/expression/VariableDivideNode.h"
+#include "madara/expression/VariableIncrementNode.h"
+#include "madara/expression/VariableMultiplyNode.h"
+#include "madara/expression/VariableCompareNode.h"
+#include "madara/expression/CompositeArrayReference.h"
+#include "madara/expression/CompositeConstArray.h"
+#include "madara/expression/CompositeForLoop.h"
+#include "madara/expression/CompositeNegateNode.h"
+#include "madara/expression/CompositePostdecrementNode.h"
+#include "madara/expression/CompositePostincrementNode.h"
+#include "madara/expression/CompositePredecrementNode.h"
+#include "madara/expression/CompositePreincrementNode.h"
+#include "madara/expression/CompositeSquareRootNode.h"
+#include "madara/expression/CompositeNotNode.h"
+#include "madara/expression/CompositeAddNode.h"
+#include "madara/expression/CompositeAssignmentNode.h"
+#include "madara/expression/CompositeAndNode.h"
+#include "madara/expression/CompositeOrNode.h"
+#include "madara/expression/CompositeEqualityNode.h"
+#include "madara/expression/CompositeInequalityNode.h"
+#include "madara/expression/CompositeGreaterThanEqualNode.h"
+#include "madara/expression/CompositeGreaterThanNode.h"
+#include "madara/expression/CompositeLessThanEqualNode.h"
+#include "madara/expression/CompositeLessThanNode.h"
+#include "madara/expression/CompositeSubtractNode.h"
+#include "madara/expression/CompositeDivideNode.h"
+#include "madara/expression/CompositeMultiplyNode.h"
+#include "madara/expression/CompositeModulusNode.h"
+#include "madara/expression/CompositeBothNode.h"
+#include "madara/expression/CompositeReturnRightNode.h"
+#include "madara/expression/CompositeSequentialNode.h"
+#include "madara/expression/CompositeImpliesNode.h"
+#include "madara/expression/SystemCallCos.h"
+#include "madara/expression/SystemCallExpandEnv.h"
+#include "madara/expression/SystemCallFragment.h"
+#include "madara/expression/SystemCallGeneric.h"
+#include "madara/expression/SystemCallGetTime.h"
+#include "madara/expression/SystemCallGetTimeSeconds.h"
+#include "madara/expression/SystemCallIsinf.h"
+#include "madara/expression/SystemCallPow.h"
+#include "madara/expression/SystemCallReadFile.h"
+#include "madara/expression/SystemCallSin.h"
+#include "madara/expression/SystemCallSize.h"
+#include "madara/expression/SystemCallSleep.h"
+#include "madara/expression/SystemCallSqrt.h"
+#include "madara/expression/SystemCallTan.h"
+#include "madara/expression/SystemCallToBuffer.h"
+#include "madara/expression/SystemCallToDouble.h"
+#include "madara/expression/SystemCallToDoubles.h"
+#include "madara/expression/SystemCallToHostDirs.h"
+#include "madara/expression/SystemCallToInteger.h"
+#include "madara/expression/SystemCallToIntegers.h"
+#include "madara/expression/SystemCallToString.h"
+#include "madara/expression/SystemCallType.h"
+
+namespace
+{
+bool intersects(const std::set<std::string>& lhs,
+    const std::set<std::string>& rhs)
+{
+  auto l = lhs.begin();
+  auto r = rhs.begin();
+
+  while (l != lhs.end() && r != rhs.end())
+  {
+    if (*l < *r)
+      ++l;
+    else if (*r < *l)
+      ++r;
+    else
+      return true;
+  }
+
+  return false;
+}
+}
+
+bool madara::expression::VariableAccess::conflicts(
+    const VariableAccess& rhs) const
+{
+  return unbounded || rhs.unbounded || intersects(writes, rhs.writes) ||
+         intersects(writes, rhs.reads) || intersects(reads, rhs.writes);
+}
+
+madara::expression::VariableAccess madara::expression::AccessVisitor::analyze(
+    const ComponentNode* root)
+{
+  access_ = VariableAccess();
+
+  add(root);
+
+  return std::move(access_);
+}
+
+void madara::expression::AccessVisitor::add(const ComponentNode* node)
+{
+  if (node)
+  {
+    node->accept(*this);
+  }
+}
+
+void madara::expression::AccessVisitor::add(
+    const std::string& key, bool write)
+{
+  // expanded names depend on values only known during evaluation
+  if (key.find('{') != std::string::npos)
+  {
+    access_.unbounded = true;
+  }
+  else if (write)
+  {
+    access_.writes.insert(key);
+  }
+  else
+  {
+    access_.reads.insert(key);
+  }
+}
+
+void madara::expression::AccessVisitor::add(const VariableNode* var,
+    const CompositeArrayReference* array, bool read)
+{
+  if (var)
+  {
+    if (read)
+    {
+      add(var->key(), false);
+    }
+
+    add(var->key(), true);
+  }
+  else if (array)
+  {
+    if (read)
+    {
+      add(array->key(), false);
+    }
+
+    add(array->key(), true);
+    add(array->right());
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const LeafNode&) {}
+
+void madara::expression::AccessVisitor::visit(const VariableNode& node)
+{
+  add(node.key(), false);
+}
+
+void madara::expression::AccessVisitor::visit(
+    const VariableDecrementNode& node)
+{
+  add(node.rhs_);
+  add(node.var_, node.array_, true);
+}
+
+void madara::expression::AccessVisitor::visit(const VariableDivideNode& node)
+{
+  add(node.rhs_);
+  add(node.var_, node.array_, true);
+}
+
+void madara::expression::AccessVisitor::visit(
+    const VariableIncrementNode& node)
+{
+  add(node.rhs_);
+  add(node.var_, node.array_, true);
+}
+
+void madara::expression::AccessVisitor::visit(
+    const VariableMultiplyNode& node)
+{
+  add(node.rhs_);
+  add(node.var_, node.array_, true);
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositePostdecrementNode& node)
+{
+  add(node.var_, node.array_, true);
+
+  if (!node.var_ && !node.array_)
+  {
+    add(node.right());
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositePostincrementNode& node)
+{
+  add(node.var_, node.array_, true);
+
+  if (!node.var_ && !node.array_)
+  {
+    add(node.right());
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositePredecrementNode& node)
+{
+  add(node.var_, node.array_, true);
+
+  if (!node.var_ && !node.array_)
+  {
+    add(node.right());
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositePreincrementNode& node)
+{
+  add(node.var_, node.array_, true);
+
+  if (!node.var_ && !node.array_)
+  {
+    add(node.right());
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeAssignmentNode& node)
+{
+  add(node.right());
+  add(node.var_, node.array_, false);
+}
+
+void madara::expression::AccessVisitor::visit(const VariableCompareNode& node)
+{
+  add(node.rhs_);
+
+  if (node.var_)
+  {
+    add(node.var_->key(), false);
+  }
+  else if (node.array_)
+  {
+    add(node.array_);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeArrayReference& node)
+{
+  add(node.key(), false);
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeForLoop& node)
+{
+  add(node.precondition_);
+  add(node.condition_);
+  add(node.postcondition_);
+  add(node.body_);
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeNegateNode& node)
+{
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeSquareRootNode& node)
+{
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeNotNode& node)
+{
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeEqualityNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeInequalityNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeGreaterThanEqualNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeGreaterThanNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeLessThanEqualNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeLessThanNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeSubtractNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeDivideNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeModulusNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeImpliesNode& node)
+{
+  add(node.left());
+  add(node.right());
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeConstArray& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeAddNode& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeAndNode& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeOrNode& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeMultiplyNode& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeBothNode& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeReturnRightNode& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const CompositeSequentialNode& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallCos& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallExpandEnv& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallFragment& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallGeneric& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallGetTime& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(
+    const SystemCallGetTimeSeconds& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallIsinf& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallPow& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallReadFile& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSin& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSize& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSleep& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSqrt& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallTan& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallToBuffer& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallToDouble& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallToDoubles& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallToHostDirs& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallToInteger& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallToIntegers& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallToString& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallType& node)
+{
+  for (const ComponentNode* child : node.nodes())
+  {
+    add(child);
+  }
+}
+
+void madara::expression::AccessVisitor::visit(const ListNode&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const CompositeFunctionNode&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallClearVariable&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallDeleteVariable&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallEval&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallExpandStatement&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallGetClock&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallLogLevel&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallPrint&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(
+    const SystemCallPrintSystemCalls&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallRandDouble&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallRandInt&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSetClock&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallWriteFile&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSetFixed&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSetPrecision&)
+{
+  access_.unbounded = true;
+}
+
+void madara::expression::AccessVisitor::visit(const SystemCallSetScientific&)
+{
+  access_.unbounded = true;
+}
+
+#endif  // _MADARA_NO_KARL_
@@ -0,0 +1,223 @@
+/* -*- C++ -*- */
+#ifndef _MADARA_ACCESS_VISITOR_H_
+#define _MADARA_ACCESS_VISITOR_H_
+
+#ifndef _MADARA_NO_KARL_
+
+/**
+ * @file AccessVisitor.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the AccessVisitor class, which finds the variables
+ * a compiled KaRL expression tree reads and writes
+ **/
+
+#include <set>
+#include <string>
+
+#include "madara/MadaraExport.h"
+#include "madara/expression/Visitor.h"
+#include "madara/expression/ComponentNode.h"
+
+namespace madara
+{
+namespace expression
+{
+/**
+ * @struct VariableAccess
+ * @brief The variables an expression may read and write
+ **/
+struct MADARA_EXPORT VariableAccess
+{
+  /// variables that may be read
+  std::set<std::string> reads;
+
+  /// variables that may be written
+  std::set<std::string> writes;
+
+  /// true if the expression may access variables that cannot be named
+  /// before evaluation or has effects beyond its variables, such as
+  /// printing, calling functions or erasing records
+  bool unbounded = false;
+
+  /**
+   * Checks if evaluating two expressions in either order could give
+   * different results
+   * @param  rhs   the other expression's access
+   * @return true if either writes a variable the other reads or writes,
+   *         or either is unbounded
+   **/
+  bool conflicts(const VariableAccess& rhs) const;
+};
+
+/**
+ * @class AccessVisitor
+ * @brief Collects the variables an expression tree reads and writes
+ *
+ * Every branch is included, whether or not evaluation would take it, so
+ * the result is a superset of what any one evaluation touches.
+ **/
+class MADARA_EXPORT AccessVisitor : public Visitor
+{
+public:
+  /**
+   * Analyzes an expression tree
+   * @param  root   the root of the tree, usually from
+   *                CompiledExpression::get_root. Null for empty logic.
+   * @return the variables the tree may access
+   **/
+  VariableAccess analyze(const ComponentNode* root);
+
+  /**
+   * Records nothing, as constants access no variables
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const LeafNode& node);
+
+  /**
+   * Records a read of the variable
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const VariableNode& node);
+
+  /**
+   * Records a read and write of the variable and analyzes the operand
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const VariableDecrementNode& node);
+  virtual void visit(const VariableDivideNode& node);
+  virtual void visit(const VariableIncrementNode& node);
+  virtual void visit(const VariableMultiplyNode& node);
+  virtual void visit(const CompositePostdecrementNode& node);
+  virtual void visit(const CompositePostincrementNode& node);
+  virtual void visit(const CompositePredecrementNode& node);
+  virtual void visit(const CompositePreincrementNode& node);
+
+  /**
+   * Records a write of the variable and analyzes the value
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const CompositeAssignmentNode& node);
+
+  /**
+   * Records a read of the variable and analyzes the compared value
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const VariableCompareNode& node);
+
+  /**
+   * Records a read of the array and analyzes the index
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const CompositeArrayReference& node);
+
+  /**
+   * Analyzes the loop's initialization, condition, step and body
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const CompositeForLoop& node);
+
+  /**
+   * Analyzes the operands, as these nodes only compute values
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const CompositeConstArray& node);
+  virtual void visit(const CompositeNegateNode& node);
+  virtual void visit(const CompositeSquareRootNode& node);
+  virtual void visit(const CompositeNotNode& node);
+  virtual void visit(const CompositeAddNode& node);
+  virtual void visit(const CompositeAndNode& node);
+  virtual void visit(const CompositeOrNode& node);
+  virtual void visit(const CompositeEqualityNode& node);
+  virtual void visit(const CompositeInequalityNode& node);
+  virtual void visit(const CompositeGreaterThanEqualNode& node);
+  virtual void visit(const CompositeGreaterThanNode& node);
+  virtual void visit(const CompositeLessThanEqualNode& node);
+  virtual void visit(const CompositeLessThanNode& node);
+  virtual void visit(const CompositeSubtractNode& node);
+  virtual void visit(const CompositeDivideNode& node);
+  virtual void visit(const CompositeMultiplyNode& node);
+  virtual void visit(const CompositeModulusNode& node);
+  virtual void visit(const CompositeBothNode& node);
+  virtual void visit(const CompositeReturnRightNode& node);
+  virtual void visit(const CompositeSequentialNode& node);
+  virtual void visit(const CompositeImpliesNode& node);
+  virtual void visit(const SystemCallCos& node);
+  virtual void visit(const SystemCallExpandEnv& node);
+  virtual void visit(const SystemCallFragment& node);
+  virtual void visit(const SystemCallGeneric& node);
+  virtual void visit(const SystemCallGetTime& node);
+  virtual void visit(const SystemCallGetTimeSeconds& node);
+  virtual void visit(const SystemCallIsinf& node);
+  virtual void visit(const SystemCallPow& node);
+  virtual void visit(const SystemCallReadFile& node);
+  virtual void visit(const SystemCallSin& node);
+  virtual void visit(const SystemCallSize& node);
+  virtual void visit(const SystemCallSleep& node);
+  virtual void visit(const SystemCallSqrt& node);
+  virtual void visit(const SystemCallTan& node);
+  virtual void visit(const SystemCallToBuffer& node);
+  virtual void visit(const SystemCallToDouble& node);
+  virtual void visit(const SystemCallToDoubles& node);
+  virtual void visit(const SystemCallToHostDirs& node);
+  virtual void visit(const SystemCallToInteger& node);
+  virtual void visit(const SystemCallToIntegers& node);
+  virtual void visit(const SystemCallToString& node);
+  virtual void visit(const SystemCallType& node);
+
+  /**
+   * The remaining nodes call functions, change state outside of
+   * variables or use the context directly, and make the access unbounded
+   * @param     node  the node to analyze
+   **/
+  virtual void visit(const ListNode& node);
+  virtual void visit(const CompositeFunctionNode& node);
+  virtual void visit(const SystemCallClearVariable& node);
+  virtual void visit(const SystemCallDeleteVariable& node);
+  virtual void visit(const SystemCallEval& node);
+  virtual void visit(const SystemCallExpandStatement& node);
+  virtual void visit(const SystemCallGetClock& node);
+  virtual void visit(const SystemCallLogLevel& node);
+  virtual void visit(const SystemCallPrint& node);
+  virtual void visit(const SystemCallPrintSystemCalls& node);
+  virtual void visit(const SystemCallRandDouble& node);
+  virtual void visit(const SystemCallRandInt& node);
+  virtual void visit(const SystemCallSetClock& node);
+  virtual void visit(const SystemCallWriteFile& node);
+  virtual void visit(const SystemCallSetFixed& node);
+  virtual void visit(const SystemCallSetPrecision& node);
+  virtual void visit(const SystemCallSetScientific& node);
+
+private:
+  /**
+   * Analyzes a node, if there is one
+   * @param  node   the node, or null
+   **/
+  void add(const ComponentNode* node);
+
+  /**
+   * Records access to a variable
+   * @param  key    the name of the variable, which makes the access
+   *                unbounded if it needs expansion
+   * @param  write  true if the variable may be written
+   **/
+  void add(const std::string& key, bool write);
+
+  /**
+   * Records access to the target of a modifying node
+   * @param  var    the variable, or null if not a variable
+   * @param  array  the array reference, or null if not an array reference
+   * @param  read   true if the old value is read
+   **/
+  void add(const VariableNode* var, const CompositeArrayReference* array,
+      bool read);
+
+  /// the access found so far
+  VariableAccess access_;
+};
+}
+}
+
+#endif  // _MADARA_NO_KARL_
+
+#endif  // _MADARA_ACCESS_VISITOR_H_
@@ -189,7 +189,7 @@ madara::expression::CompositeArrayReference::dec(
     // notice that we assume the context is locked
     // check if we have the appropriate write quality
     if (!settings.always_overwrite && record->write_quality < record->quality)
-      return context_.retrieve_index(expand_key(), index, settings);
+      return record->retrieve_index(index);
 
     // cheaper to read than write, so check to see if
     // we actually need to update quality and status
@@ -231,7 +231,7 @@ madara::expression::CompositeArrayReference::inc(
     // notice that we assume the context is locked
     // check if we have the appropriate write quality
     if (!settings.always_overwrite && record->write_quality < record->quality)
-      return context_.retrieve_index(expand_key(), index, settings);
+      return record->retrieve_index(index);
 
     // cheaper to read than write, so check to see if
     // we actually need to update quality and status
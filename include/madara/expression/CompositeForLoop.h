@@ -23,6 +23,8 @@ class Visitor;
 class CompositeForLoop : public ComponentNode
 {
 public:
+  friend class AccessVisitor;
+
   /**
    * Constructor
    * @param   precondition  executed before loop
@@ -25,6 +25,9 @@ class Visitor;
 class CompositePostincrementNode : public CompositeUnaryNode
 {
 public:
+  friend class CppGenerator;
+  friend class AccessVisitor;
+
   /**
    * Constructor
    * @param   logger the logger to use for printing
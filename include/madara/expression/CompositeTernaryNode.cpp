@@ -42,6 +42,12 @@ void madara::expression::CompositeTernaryNode::accept(
   (void)visitor;
 }
 
+const madara::expression::ComponentNodes&
+madara::expression::CompositeTernaryNode::nodes(void) const
+{
+  return nodes_;
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _TERNARY_NODE_CPP_ */
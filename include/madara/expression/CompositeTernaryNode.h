@@ -70,6 +70,12 @@ public:
    **/
   virtual void accept(Visitor& visitor) const;
 
+  /**
+   * Returns the contained expressions
+   * @return    the expressions, in evaluation order
+   **/
+  const ComponentNodes& nodes(void) const;
+
 protected:
   ComponentNodes nodes_;
 };
@@ -0,0 +1,943 @@
+/* -*- C++ -*- */
+#ifndef _MADARA_NO_KARL_
+
+#include <cmath>
+#include <limits>
+
+#include "madara/expression/CppGenerator.h"
+#include "madara/expression/LeafNode.h"
+#include "madara/expression/VariableNode.h"
+#include "madara/expression/VariableDecrementNode.h"
+#include "madara/expression/VariableDivideNode.h"
+#include "madara/expression/VariableIncrementNode.h"
+#include "madara/expression/VariableMultiplyNode.h"
+#include "madara/expression/VariableCompareNode.h"
+#include "madara/expression/CompositeNegateNode.h"
+#include "madara/expression/CompositePostdecrementNode.h"
+#include "madara/expression/CompositePostincrementNode.h"
+#include "madara/expression/CompositePredecrementNode.h"
+#include "madara/expression/CompositePreincrementNode.h"
+#include "madara/expression/CompositeSquareRootNode.h"
+#include "madara/expression/CompositeNotNode.h"
+#include "madara/expression/CompositeAddNode.h"
+#include "madara/expression/CompositeAssignmentNode.h"
+#include "madara/expression/CompositeAndNode.h"
+#include "madara/expression/CompositeOrNode.h"
+#include "madara/expression/CompositeEqualityNode.h"
+#include "madara/expression/CompositeInequalityNode.h"
+#include "madara/expression/CompositeGreaterThanEqualNode.h"
+#include "madara/expression/CompositeGreaterThanNode.h"
+#include "madara/expression/CompositeLessThanEqualNode.h"
+#include "madara/expression/CompositeLessThanNode.h"
+#include "madara/expression/CompositeSubtractNode.h"
+#include "madara/expression/CompositeDivideNode.h"
+#include "madara/expression/CompositeMultiplyNode.h"
+#include "madara/expression/CompositeModulusNode.h"
+#include "madara/expression/CompositeBothNode.h"
+#include "madara/expression/CompositeReturnRightNode.h"
+#include "madara/expression/CompositeSequentialNode.h"
+#include "madara/expression/CompositeImpliesNode.h"
+#include "madara/expression/SystemCallGeneric.h"
+#include "madara/exceptions/KarlException.h"
+
+typedef madara::knowledge::KnowledgeRecord KnowledgeRecord;
+
+std::string madara::expression::CppGenerator::generate(
+    const ComponentNode* root, const std::string& name,
+    const std::string& source)
+{
+  body_.str("");
+  keys_.clear();
+  key_indices_.clear();
+  temps_ = 0;
+  indent_ = 2;
+
+  std::string result = root ? eval(root) : declare();
+
+  std::stringstream function;
+
+  if (source.size() != 0)
+  {
+    function << "/**\n * Generated from:\n *\n";
+
+    std::stringstream lines(source);
+    std::string text;
+
+    while (std::getline(lines, text))
+    {
+      // keep the logic from closing the comment
+      for (size_t pos = text.find("*/"); pos != std::string::npos;
+           pos = text.find("*/", pos))
+      {
+        text.replace(pos, 2, "* /");
+      }
+
+      function << " *" << (text.size() != 0 ? "   " : "") << text << "\n";
+    }
+
+    function << " **/\n";
+  }
+
+  function << "madara::knowledge::KnowledgeRecord " << name << "(\n";
+  function << "    madara::knowledge::FunctionArguments&, "
+              "madara::knowledge::Variables& vars)\n";
+  function << "{\n";
+  function << "  typedef madara::knowledge::KnowledgeRecord KnowledgeRecord;\n";
+
+  if (keys_.size() != 0)
+  {
+    function << "  typedef madara::knowledge::GeneratedLogic "
+                "GeneratedLogic;\n\n";
+    function << "  static GeneratedLogic logic({";
+
+    for (size_t i = 0; i < keys_.size(); ++i)
+    {
+      function << (i == 0 ? "" : ", ") << quote(keys_[i]);
+    }
+
+    function << "});\n\n";
+  }
+  else
+  {
+    function << "\n";
+  }
+
+  function << "  madara::knowledge::ThreadSafeContext& context = "
+              "*vars.get_context();\n";
+  function << "  madara::knowledge::ContextGuard guard(context);\n";
+
+  if (keys_.size() != 0)
+  {
+    function << "  const madara::knowledge::VariableReference* refs = "
+                "logic.bind(context);\n";
+  }
+
+  function << "  const madara::knowledge::KnowledgeUpdateSettings settings;\n";
+  function << "  (void)settings;\n\n";
+  function << body_.str();
+  function << "\n  return " << result << ";\n";
+  function << "}\n";
+
+  return function.str();
+}
+
+std::string madara::expression::CppGenerator::literal(
+    const knowledge::KnowledgeRecord& record)
+{
+  std::stringstream buffer;
+  buffer.precision(std::numeric_limits<double>::max_digits10);
+
+  auto integer = [&buffer](KnowledgeRecord::Integer value) {
+    if (value == std::numeric_limits<KnowledgeRecord::Integer>::min())
+    {
+      buffer << "std::numeric_limits<KnowledgeRecord::Integer>::min()";
+    }
+    else
+    {
+      buffer << value << "LL";
+    }
+  };
+
+  auto real = [&buffer](double value) {
+    if (std::isnan(value))
+    {
+      buffer << "std::numeric_limits<double>::quiet_NaN()";
+    }
+    else if (std::isinf(value))
+    {
+      buffer << (value < 0 ? "-" : "")
+             << "std::numeric_limits<double>::infinity()";
+    }
+    else
+    {
+      std::stringstream number;
+      number.precision(std::numeric_limits<double>::max_digits10);
+      number << value;
+
+      std::string text = number.str();
+
+      // keep the literal a double
+      if (text.find_first_of(".e") == std::string::npos)
+      {
+        text += ".0";
+      }
+
+      buffer << text;
+    }
+  };
+
+  if (!record.exists())
+  {
+    buffer << "KnowledgeRecord()";
+  }
+  else if (record.type() == KnowledgeRecord::INTEGER)
+  {
+    buffer << "KnowledgeRecord(KnowledgeRecord::Integer(";
+    integer(record.to_integer());
+    buffer << "))";
+  }
+  else if (record.type() == KnowledgeRecord::DOUBLE)
+  {
+    buffer << "KnowledgeRecord(";
+    real(record.to_double());
+    buffer << ")";
+  }
+  else if (record.type() == KnowledgeRecord::STRING)
+  {
+    buffer << "KnowledgeRecord(std::string(" << quote(record.to_string())
+           << ", " << record.to_string().size() << "))";
+  }
+  else if (record.type() == KnowledgeRecord::INTEGER_ARRAY)
+  {
+    buffer << "KnowledgeRecord(std::vector<KnowledgeRecord::Integer>{";
+
+    std::vector<KnowledgeRecord::Integer> values(record.to_integers());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      buffer << (i == 0 ? "" : ", ");
+      integer(values[i]);
+    }
+
+    buffer << "})";
+  }
+  else if (record.type() == KnowledgeRecord::DOUBLE_ARRAY)
+  {
+    buffer << "KnowledgeRecord(std::vector<double>{";
+
+    std::vector<double> values(record.to_doubles());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      buffer << (i == 0 ? "" : ", ");
+      real(values[i]);
+    }
+
+    buffer << "})";
+  }
+  else
+  {
+    unsupported("constants of type " + std::to_string(record.type()));
+  }
+
+  return buffer.str();
+}
+
+std::string madara::expression::CppGenerator::quote(const std::string& value)
+{
+  static const char digits[] = "01234567";
+
+  std::string result("\"");
+
+  for (char c : value)
+  {
+    unsigned char u = static_cast<unsigned char>(c);
+
+    if (c == '"' || c == '\\')
+    {
+      result += '\\';
+      result += c;
+    }
+    else if (c == '\n')
+    {
+      result += "\\n";
+    }
+    else if (c == '\t')
+    {
+      result += "\\t";
+    }
+    else if (u < 0x20 || u >= 0x7f || c == '?')
+    {
+      // three octal digits never merge with the characters that follow,
+      // and escaping ? avoids trigraphs
+      result += '\\';
+      result += digits[(u >> 6) & 7];
+      result += digits[(u >> 3) & 7];
+      result += digits[u & 7];
+    }
+    else
+    {
+      result += c;
+    }
+  }
+
+  result += '"';
+
+  return result;
+}
+
+std::string madara::expression::CppGenerator::eval(const ComponentNode* node)
+{
+  node->accept(*this);
+
+  return result_;
+}
+
+std::string madara::expression::CppGenerator::declare(const std::string& init)
+{
+  std::string name = "t" + std::to_string(temps_++);
+
+  // an empty record is default constructed, as "t(KnowledgeRecord())"
+  // would declare a function
+  if (init.size() == 0 || init == "KnowledgeRecord()")
+  {
+    line("KnowledgeRecord " + name + ";");
+  }
+  else
+  {
+    line("KnowledgeRecord " + name + "(" + init + ");");
+  }
+
+  return name;
+}
+
+std::string madara::expression::CppGenerator::ref(const std::string& key)
+{
+  if (key.find('{') != std::string::npos)
+  {
+    unsupported("variables with expanded names (" + key + ")");
+  }
+
+  auto found = key_indices_.find(key);
+
+  if (found == key_indices_.end())
+  {
+    found = key_indices_.emplace(key, keys_.size()).first;
+    keys_.push_back(key);
+  }
+
+  return "refs[" + std::to_string(found->second) + "]";
+}
+
+void madara::expression::CppGenerator::line(const std::string& text)
+{
+  body_ << std::string(indent_, ' ') << text << "\n";
+}
+
+void madara::expression::CppGenerator::binary(
+    const ComponentNode* left, const ComponentNode* right, const char* op)
+{
+  std::string lhs = eval(left);
+  std::string rhs = eval(right);
+
+  result_ = declare(lhs + " " + op + " " + rhs);
+}
+
+void madara::expression::CppGenerator::modify(const VariableNode* var,
+    const CompositeArrayReference* array, const ComponentNode* rhs,
+    const knowledge::KnowledgeRecord& value, const char* op)
+{
+  std::string operand = rhs ? eval(rhs) : declare(literal(value));
+
+  if (var)
+  {
+    std::string variable = ref(var->key());
+
+    result_ = declare("GeneratedLogic::get(" + variable + ", settings) " + op +
+                      " " + operand);
+    line("GeneratedLogic::set(context, " + variable + ", " + result_ +
+         ", settings);");
+  }
+  else if (array)
+  {
+    unsupported("array indexing");
+  }
+  else
+  {
+    result_ = operand;
+  }
+}
+
+void madara::expression::CppGenerator::step(const VariableNode* var,
+    const CompositeArrayReference* array, const ComponentNode* right,
+    const char* op, bool post)
+{
+  if (var)
+  {
+    std::string variable = ref(var->key());
+    std::string change = std::string("GeneratedLogic::") + op +
+                         "(context, " + variable + ", settings)";
+
+    if (post)
+    {
+      result_ = declare("GeneratedLogic::get(" + variable + ", settings)");
+      line(change + ";");
+    }
+    else
+    {
+      result_ = declare(change);
+    }
+  }
+  else if (array)
+  {
+    unsupported("array indexing");
+  }
+  else
+  {
+    // the interpreter steps temporaries the same way before and after
+    std::string operand = eval(right);
+    result_ = declare((op[0] == 'i' ? "++" : "--") + operand);
+  }
+}
+
+void madara::expression::CppGenerator::unsupported(const std::string& what)
+{
+  throw exceptions::KarlException(
+      "madara::expression::CppGenerator: " + what +
+      " cannot be generated as C++");
+}
+
+void madara::expression::CppGenerator::visit(const LeafNode& node)
+{
+  result_ = declare(literal(node.item()));
+}
+
+void madara::expression::CppGenerator::visit(const VariableNode& node)
+{
+  result_ = declare("GeneratedLogic::get(" + ref(node.key()) + ", settings)");
+}
+
+void madara::expression::CppGenerator::visit(const VariableDecrementNode& node)
+{
+  modify(node.var_, node.array_, node.rhs_, node.value_, "-");
+}
+
+void madara::expression::CppGenerator::visit(const VariableDivideNode& node)
+{
+  modify(node.var_, node.array_, node.rhs_, node.value_, "/");
+}
+
+void madara::expression::CppGenerator::visit(const VariableIncrementNode& node)
+{
+  modify(node.var_, node.array_, node.rhs_, node.value_, "+");
+}
+
+void madara::expression::CppGenerator::visit(const VariableMultiplyNode& node)
+{
+  modify(node.var_, node.array_, node.rhs_, node.value_, "*");
+}
+
+void madara::expression::CppGenerator::visit(const VariableCompareNode& node)
+{
+  std::string lhs;
+
+  if (node.var_)
+  {
+    lhs = declare("GeneratedLogic::get(" + ref(node.var_->key()) +
+                  ", settings)");
+  }
+  else if (node.array_)
+  {
+    unsupported("array indexing");
+  }
+  else
+  {
+    lhs = declare();
+  }
+
+  std::string rhs = node.rhs_ ? eval(node.rhs_) : declare(literal(node.value_));
+
+  const char* op;
+
+  switch (node.compare_type_)
+  {
+    case VariableCompareNode::LESS_THAN:
+      op = " < ";
+      break;
+    case VariableCompareNode::LESS_THAN_EQUAL:
+      op = " <= ";
+      break;
+    case VariableCompareNode::EQUAL:
+      op = " == ";
+      break;
+    case VariableCompareNode::GREATER_THAN_EQUAL:
+      op = " >= ";
+      break;
+    default:
+      op = " > ";
+      break;
+  }
+
+  result_ = declare("KnowledgeRecord::Integer(" + lhs + op + rhs + ")");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeNegateNode& node)
+{
+  std::string operand = eval(node.right());
+  result_ = declare("-" + operand);
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositePostdecrementNode& node)
+{
+  step(node.var_, node.array_, node.right(), "dec", true);
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositePostincrementNode& node)
+{
+  step(node.var_, node.array_, node.right(), "inc", true);
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositePredecrementNode& node)
+{
+  step(node.var_, node.array_, node.right(), "dec", false);
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositePreincrementNode& node)
+{
+  step(node.var_, node.array_, node.right(), "inc", false);
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeSquareRootNode& node)
+{
+  std::string operand = eval(node.right());
+  result_ = declare("std::sqrt(" + operand + ".to_double())");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeNotNode& node)
+{
+  std::string operand = eval(node.right());
+  result_ = declare("!" + operand);
+}
+
+void madara::expression::CppGenerator::visit(const CompositeAddNode& node)
+{
+  std::string result;
+
+  for (const ComponentNode* child : node.nodes())
+  {
+    std::string value = eval(child);
+
+    if (result.size() == 0)
+    {
+      result = declare(value);
+    }
+    else
+    {
+      line(result + " += " + value + ";");
+    }
+  }
+
+  result_ = result.size() != 0 ? result : declare();
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeAssignmentNode& node)
+{
+  std::string value = eval(node.right());
+
+  if (node.var_)
+  {
+    line("GeneratedLogic::set(context, " + ref(node.var_->key()) + ", " +
+         value + ", settings);");
+  }
+  else if (node.array_)
+  {
+    unsupported("array indexing");
+  }
+
+  result_ = value;
+}
+
+void madara::expression::CppGenerator::visit(const CompositeAndNode& node)
+{
+  std::string result = declare("KnowledgeRecord::Integer(0)");
+
+  line("do");
+  line("{");
+  indent_ += 2;
+
+  for (const ComponentNode* child : node.nodes())
+  {
+    line("if (" + eval(child) + ".is_false())");
+    line("  break;");
+  }
+
+  line(result + " = KnowledgeRecord(KnowledgeRecord::Integer(1));");
+
+  indent_ -= 2;
+  line("} while (false);");
+
+  result_ = result;
+}
+
+void madara::expression::CppGenerator::visit(const CompositeOrNode& node)
+{
+  std::string result = declare();
+
+  line("do");
+  line("{");
+  indent_ += 2;
+
+  for (const ComponentNode* child : node.nodes())
+  {
+    line("if (" + eval(child) + ".is_true())");
+    line("{");
+    line("  " + result + " = KnowledgeRecord(KnowledgeRecord::Integer(1));");
+    line("  break;");
+    line("}");
+  }
+
+  indent_ -= 2;
+  line("} while (false);");
+
+  result_ = result;
+}
+
+void madara::expression::CppGenerator::visit(const CompositeEqualityNode& node)
+{
+  binary(node.left(), node.right(), "==");
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeInequalityNode& node)
+{
+  binary(node.left(), node.right(), "!=");
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeGreaterThanEqualNode& node)
+{
+  binary(node.left(), node.right(), ">=");
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeGreaterThanNode& node)
+{
+  binary(node.left(), node.right(), ">");
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeLessThanEqualNode& node)
+{
+  binary(node.left(), node.right(), "<=");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeLessThanNode& node)
+{
+  binary(node.left(), node.right(), "<");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeSubtractNode& node)
+{
+  binary(node.left(), node.right(), "-");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeDivideNode& node)
+{
+  binary(node.left(), node.right(), "/");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeMultiplyNode& node)
+{
+  std::string result;
+
+  for (const ComponentNode* child : node.nodes())
+  {
+    std::string value = eval(child);
+
+    if (result.size() == 0)
+    {
+      result = declare(value);
+    }
+    else
+    {
+      line(result + " *= " + value + ";");
+    }
+  }
+
+  result_ = result.size() != 0 ? result : declare();
+}
+
+void madara::expression::CppGenerator::visit(const CompositeModulusNode& node)
+{
+  binary(node.left(), node.right(), "%");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeBothNode& node)
+{
+  std::string result;
+
+  for (const ComponentNode* child : node.nodes())
+  {
+    std::string value = eval(child);
+
+    if (result.size() == 0)
+    {
+      result = declare(value);
+    }
+    else
+    {
+      line("if (" + value + " > " + result + ")");
+      line("  " + result + " = " + value + ";");
+    }
+  }
+
+  result_ = result.size() != 0 ? result : declare();
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeReturnRightNode& node)
+{
+  std::string result;
+
+  for (const ComponentNode* child : node.nodes())
+  {
+    result = eval(child);
+  }
+
+  result_ = result.size() != 0 ? result : declare();
+}
+
+void madara::expression::CppGenerator::visit(
+    const CompositeSequentialNode& node)
+{
+  std::string result;
+
+  for (const ComponentNode* child : node.nodes())
+  {
+    std::string value = eval(child);
+
+    if (result.size() == 0)
+    {
+      result = declare(value);
+    }
+    else
+    {
+      line("if (" + value + " < " + result + ")");
+      line("  " + result + " = " + value + ";");
+    }
+  }
+
+  result_ = result.size() != 0 ? result : declare();
+}
+
+void madara::expression::CppGenerator::visit(const CompositeImpliesNode& node)
+{
+  std::string result = declare(eval(node.left()));
+
+  line("if (" + result + ".is_true())");
+  line("{");
+  indent_ += 2;
+
+  eval(node.right());
+
+  indent_ -= 2;
+  line("}");
+
+  result_ = result;
+}
+
+void madara::expression::CppGenerator::visit(const CompositeConstArray&)
+{
+  unsupported("constant arrays");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeArrayReference&)
+{
+  unsupported("array indexing");
+}
+
+void madara::expression::CppGenerator::visit(const ListNode&)
+{
+  unsupported("argument lists");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeFunctionNode&)
+{
+  unsupported("function calls");
+}
+
+void madara::expression::CppGenerator::visit(const CompositeForLoop&)
+{
+  unsupported("for loops");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallClearVariable&)
+{
+  unsupported("the #clear_variable system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallCos&)
+{
+  unsupported("the #cos system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallDeleteVariable&)
+{
+  unsupported("the #delete_variable system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallEval&)
+{
+  unsupported("the #eval system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallExpandEnv&)
+{
+  unsupported("the #expand_env system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallExpandStatement&)
+{
+  unsupported("the #expand_statement system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallFragment&)
+{
+  unsupported("the #fragment system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallGeneric& node)
+{
+  unsupported(std::string("the #") + node.name() + " system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallGetClock&)
+{
+  unsupported("the #get_clock system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallGetTime&)
+{
+  unsupported("the #get_time system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallGetTimeSeconds&)
+{
+  unsupported("the #get_time_seconds system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallIsinf&)
+{
+  unsupported("the #isinf system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallLogLevel&)
+{
+  unsupported("the #log_level system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallPow&)
+{
+  unsupported("the #pow system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallPrint&)
+{
+  unsupported("the #print system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallPrintSystemCalls&)
+{
+  unsupported("the #print_system_calls system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallRandDouble&)
+{
+  unsupported("the #rand_double system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallRandInt&)
+{
+  unsupported("the #rand_int system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallReadFile&)
+{
+  unsupported("the #read_file system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSetClock&)
+{
+  unsupported("the #set_clock system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSin&)
+{
+  unsupported("the #sin system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSize&)
+{
+  unsupported("the #size system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSleep&)
+{
+  unsupported("the #sleep system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSqrt&)
+{
+  unsupported("the #sqrt system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallTan&)
+{
+  unsupported("the #tan system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallToBuffer&)
+{
+  unsupported("the #to_buffer system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallToDouble&)
+{
+  unsupported("the #to_double system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallToDoubles&)
+{
+  unsupported("the #to_doubles system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallToHostDirs&)
+{
+  unsupported("the #to_host_dirs system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallToInteger&)
+{
+  unsupported("the #to_integer system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallToIntegers&)
+{
+  unsupported("the #to_integers system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallToString&)
+{
+  unsupported("the #to_string system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallType&)
+{
+  unsupported("the #type system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallWriteFile&)
+{
+  unsupported("the #write_file system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSetFixed&)
+{
+  unsupported("the #set_fixed system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSetPrecision&)
+{
+  unsupported("the #set_precision system call");
+}
+
+void madara::expression::CppGenerator::visit(const SystemCallSetScientific&)
+{
+  unsupported("the #set_scientific system call");
+}
+
+#endif  // _MADARA_NO_KARL_
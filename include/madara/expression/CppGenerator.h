@@ -0,0 +1,405 @@
+/* -*- C++ -*- */
+#ifndef _MADARA_CPP_GENERATOR_H_
+#define _MADARA_CPP_GENERATOR_H_
+
+#ifndef _MADARA_NO_KARL_
+
+/**
+ * @file CppGenerator.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the CppGenerator class, which translates compiled
+ * KaRL expression trees into C++ source
+ **/
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "madara/MadaraExport.h"
+#include "madara/expression/Visitor.h"
+#include "madara/expression/ComponentNode.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+
+namespace madara
+{
+namespace expression
+{
+/**
+ * @class CppGenerator
+ * @brief Generates a C++ function that evaluates an expression tree with
+ *        the same results as the interpreter
+ *
+ * The generated function has the signature expected by
+ * KnowledgeBase::define_function. Variables are resolved once per
+ * context through knowledge::GeneratedLogic, and each node becomes a few
+ * statements on KnowledgeRecord temporaries, evaluated in the order the
+ * interpreter evaluates them.
+ *
+ * Variables with expanded names (var{.i}), array indexing, functions,
+ * for loops and system calls are not supported. Generating a tree that
+ * contains them throws a KarlException naming the construct.
+ **/
+class MADARA_EXPORT CppGenerator : public Visitor
+{
+public:
+  /**
+   * Generates a function from an expression tree
+   * @param  root     the root of the tree, usually from
+   *                  CompiledExpression::get_root. Null for empty logic.
+   * @param  name     the name of the function
+   * @param  source   the KaRL logic the tree was compiled from, which is
+   *                  copied into a comment
+   * @return the function definition
+   * @throw exceptions::KarlException  the tree contains an unsupported node
+   **/
+  std::string generate(const ComponentNode* root, const std::string& name,
+      const std::string& source = "");
+
+  /**
+   * Returns a C++ expression that constructs a record
+   * @param  record   the record to construct. Must be empty, an integer,
+   *                  a double, a string or an array of integers or doubles.
+   * @return the expression
+   * @throw exceptions::KarlException  the record has an unsupported type
+   **/
+  static std::string literal(const knowledge::KnowledgeRecord& record);
+
+  /**
+   * Returns a C++ string literal
+   * @param  value    the characters of the string
+   * @return the quoted and escaped literal
+   **/
+  static std::string quote(const std::string& value);
+
+  /**
+   * Generates a constant
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const LeafNode& node);
+
+  /**
+   * Generates a read of a variable
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const VariableNode& node);
+
+  /**
+   * Generates a variable decrement (-=)
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const VariableDecrementNode& node);
+
+  /**
+   * Generates a variable division (/=)
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const VariableDivideNode& node);
+
+  /**
+   * Generates a variable increment (+=)
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const VariableIncrementNode& node);
+
+  /**
+   * Generates a variable multiplication (*=)
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const VariableMultiplyNode& node);
+
+  /**
+   * Generates a comparison of a variable to a value
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const VariableCompareNode& node);
+
+  /**
+   * Generates a negation
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeNegateNode& node);
+
+  /**
+   * Generates a postdecrement
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositePostdecrementNode& node);
+
+  /**
+   * Generates a postincrement
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositePostincrementNode& node);
+
+  /**
+   * Generates a predecrement
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositePredecrementNode& node);
+
+  /**
+   * Generates a preincrement
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositePreincrementNode& node);
+
+  /**
+   * Generates a square root
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeSquareRootNode& node);
+
+  /**
+   * Generates a logical not
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeNotNode& node);
+
+  /**
+   * Generates an addition
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeAddNode& node);
+
+  /**
+   * Generates an assignment
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeAssignmentNode& node);
+
+  /**
+   * Generates a logical and
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeAndNode& node);
+
+  /**
+   * Generates a logical or
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeOrNode& node);
+
+  /**
+   * Generates an equality comparison
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeEqualityNode& node);
+
+  /**
+   * Generates an inequality comparison
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeInequalityNode& node);
+
+  /**
+   * Generates a greater than or equal comparison
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeGreaterThanEqualNode& node);
+
+  /**
+   * Generates a greater than comparison
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeGreaterThanNode& node);
+
+  /**
+   * Generates a less than or equal comparison
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeLessThanEqualNode& node);
+
+  /**
+   * Generates a less than comparison
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeLessThanNode& node);
+
+  /**
+   * Generates a subtraction
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeSubtractNode& node);
+
+  /**
+   * Generates a division
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeDivideNode& node);
+
+  /**
+   * Generates a multiplication
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeMultiplyNode& node);
+
+  /**
+   * Generates a modulus
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeModulusNode& node);
+
+  /**
+   * Generates a both operator (;), which returns the maximum
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeBothNode& node);
+
+  /**
+   * Generates a return right operator (;>)
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeReturnRightNode& node);
+
+  /**
+   * Generates a sequence (,), which returns the minimum
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeSequentialNode& node);
+
+  /**
+   * Generates an implication (=>)
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeImpliesNode& node);
+
+  /**
+   * The remaining nodes cannot be generated and throw a KarlException
+   * @param     node  the node to generate
+   **/
+  virtual void visit(const CompositeConstArray& node);
+  virtual void visit(const CompositeArrayReference& node);
+  virtual void visit(const ListNode& node);
+  virtual void visit(const CompositeFunctionNode& node);
+  virtual void visit(const CompositeForLoop& node);
+  virtual void visit(const SystemCallClearVariable& node);
+  virtual void visit(const SystemCallCos& node);
+  virtual void visit(const SystemCallDeleteVariable& node);
+  virtual void visit(const SystemCallEval& node);
+  virtual void visit(const SystemCallExpandEnv& node);
+  virtual void visit(const SystemCallExpandStatement& node);
+  virtual void visit(const SystemCallFragment& node);
+  virtual void visit(const SystemCallGeneric& node);
+  virtual void visit(const SystemCallGetClock& node);
+  virtual void visit(const SystemCallGetTime& node);
+  virtual void visit(const SystemCallGetTimeSeconds& node);
+  virtual void visit(const SystemCallIsinf& node);
+  virtual void visit(const SystemCallLogLevel& node);
+  virtual void visit(const SystemCallPow& node);
+  virtual void visit(const SystemCallPrint& node);
+  virtual void visit(const SystemCallPrintSystemCalls& node);
+  virtual void visit(const SystemCallRandDouble& node);
+  virtual void visit(const SystemCallRandInt& node);
+  virtual void visit(const SystemCallReadFile& node);
+  virtual void visit(const SystemCallSetClock& node);
+  virtual void visit(const SystemCallSin& node);
+  virtual void visit(const SystemCallSize& node);
+  virtual void visit(const SystemCallSleep& node);
+  virtual void visit(const SystemCallSqrt& node);
+  virtual void visit(const SystemCallTan& node);
+  virtual void visit(const SystemCallToBuffer& node);
+  virtual void visit(const SystemCallToDouble& node);
+  virtual void visit(const SystemCallToDoubles& node);
+  virtual void visit(const SystemCallToHostDirs& node);
+  virtual void visit(const SystemCallToInteger& node);
+  virtual void visit(const SystemCallToIntegers& node);
+  virtual void visit(const SystemCallToString& node);
+  virtual void visit(const SystemCallType& node);
+  virtual void visit(const SystemCallWriteFile& node);
+  virtual void visit(const SystemCallSetFixed& node);
+  virtual void visit(const SystemCallSetPrecision& node);
+  virtual void visit(const SystemCallSetScientific& node);
+
+private:
+  /**
+   * Generates a node and returns the temporary holding its value
+   * @param  node   the node
+   * @return the name of the temporary
+   **/
+  std::string eval(const ComponentNode* node);
+
+  /**
+   * Declares a new temporary record
+   * @param  init   the initializer, or empty for an empty record
+   * @return the name of the temporary
+   **/
+  std::string declare(const std::string& init = "");
+
+  /**
+   * Returns the expression for a variable's reference
+   * @param  key    the name of the variable
+   * @return the expression
+   * @throw exceptions::KarlException  the name needs expansion
+   **/
+  std::string ref(const std::string& key);
+
+  /**
+   * Writes an indented line to the body
+   * @param  text   the line, without a newline
+   **/
+  void line(const std::string& text);
+
+  /**
+   * Generates the evaluation of a binary operator
+   * @param  left   the left operand
+   * @param  right  the right operand
+   * @param  op     the C++ operator
+   **/
+  void binary(const ComponentNode* left, const ComponentNode* right,
+      const char* op);
+
+  /**
+   * Generates the evaluation of an assignment operator (+=, -=, ...)
+   * @param  var    the variable, or null if not a variable
+   * @param  array  the array reference, or null if not an array reference
+   * @param  rhs    the right hand expression, or null to use value
+   * @param  value  the right hand value if rhs is null
+   * @param  op     the C++ operator applied to the variable and rhs
+   **/
+  void modify(const VariableNode* var, const CompositeArrayReference* array,
+      const ComponentNode* rhs, const knowledge::KnowledgeRecord& value,
+      const char* op);
+
+  /**
+   * Generates an increment or decrement
+   * @param  var    the variable, or null if not a variable
+   * @param  array  the array reference, or null if not an array reference
+   * @param  right  the operand
+   * @param  op     "inc" or "dec"
+   * @param  post   true to return the value before modification
+   **/
+  void step(const VariableNode* var, const CompositeArrayReference* array,
+      const ComponentNode* right, const char* op, bool post);
+
+  /**
+   * Throws a KarlException for an unsupported construct
+   * @param  what   the construct
+   **/
+  [[noreturn]] static void unsupported(const std::string& what);
+
+  /// generated statements
+  std::stringstream body_;
+
+  /// the names of the variables used, by reference index
+  std::vector<std::string> keys_;
+
+  /// reference indices by variable name
+  std::map<std::string, size_t> key_indices_;
+
+  /// the temporary holding the value of the last generated node
+  std::string result_;
+
+  /// number of temporaries declared
+  size_t temps_ = 0;
+
+  /// current indentation, in spaces
+  size_t indent_ = 2;
+};
+}
+}
+
+#endif  // _MADARA_NO_KARL_
+
+#endif  // _MADARA_CPP_GENERATOR_H_
@@ -0,0 +1,138 @@
+#ifndef _MADARA_NO_KARL_
+
+#include "ExpressionCache.h"
+
+namespace madara
+{
+namespace expression
+{
+constexpr size_t ExpressionCache::DEFAULT_CAPACITY;
+
+ExpressionCache::ExpressionCache(size_t capacity)
+{
+  stats_.capacity = capacity;
+}
+
+bool ExpressionCache::find(const std::string& logic, ExpressionTree& tree)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = trees_.find(logic);
+  if (found == trees_.end())
+  {
+    return false;
+  }
+
+  recency_.splice(recency_.begin(), recency_, found->second.position);
+  tree = found->second.tree;
+  ++stats_.hits;
+
+  return true;
+}
+
+void ExpressionCache::insert(
+    const std::string& logic, const ExpressionTree& tree)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  ++stats_.misses;
+
+  if (stats_.capacity == 0)
+  {
+    return;
+  }
+
+  auto inserted = trees_.emplace(logic, Entry());
+  Entry& entry = inserted.first->second;
+  entry.tree = tree;
+
+  if (inserted.second)
+  {
+    recency_.push_front(&inserted.first->first);
+    entry.position = recency_.begin();
+
+    evict();
+  }
+  else
+  {
+    recency_.splice(recency_.begin(), recency_, entry.position);
+  }
+}
+
+bool ExpressionCache::erase(const std::string& logic)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = trees_.find(logic);
+  if (found == trees_.end())
+  {
+    return false;
+  }
+
+  recency_.erase(found->second.position);
+  trees_.erase(found);
+
+  return true;
+}
+
+void ExpressionCache::clear(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  recency_.clear();
+  trees_.clear();
+}
+
+void ExpressionCache::set_capacity(size_t capacity)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  stats_.capacity = capacity;
+  evict();
+}
+
+size_t ExpressionCache::get_capacity(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return stats_.capacity;
+}
+
+size_t ExpressionCache::size(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return trees_.size();
+}
+
+ExpressionCacheStats ExpressionCache::get_stats(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  ExpressionCacheStats result(stats_);
+  result.size = trees_.size();
+
+  return result;
+}
+
+void ExpressionCache::reset_stats(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  stats_.hits = 0;
+  stats_.misses = 0;
+  stats_.evictions = 0;
+}
+
+void ExpressionCache::evict(void)
+{
+  while (trees_.size() > stats_.capacity)
+  {
+    // the recency list points at keys owned by trees_
+    trees_.erase(trees_.find(*recency_.back()));
+    recency_.pop_back();
+    ++stats_.evictions;
+  }
+}
+}
+}
+
+#endif  // _MADARA_NO_KARL_
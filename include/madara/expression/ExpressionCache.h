@@ -0,0 +1,170 @@
+/* -*- C++ -*- */
+#ifndef _MADARA_EXPRESSION_EXPRESSION_CACHE_H_
+#define _MADARA_EXPRESSION_EXPRESSION_CACHE_H_
+
+#ifndef _MADARA_NO_KARL_
+
+/**
+ * @file ExpressionCache.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ExpressionCache class, which bounds the number
+ * of compiled expression trees an Interpreter keeps
+ **/
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "madara/LockType.h"
+#include "madara/MadaraExport.h"
+#include "madara/utility/StdInt.h"
+#include "madara/expression/ExpressionTree.h"
+
+namespace madara
+{
+namespace expression
+{
+/**
+ * @struct ExpressionCacheStats
+ * @brief Counters describing the use of an ExpressionCache
+ **/
+struct ExpressionCacheStats
+{
+  /// compilations answered from the cache
+  uint64_t hits = 0;
+
+  /// compilations that had to build a new expression tree
+  uint64_t misses = 0;
+
+  /// expression trees dropped to stay within the capacity
+  uint64_t evictions = 0;
+
+  /// expression trees currently cached
+  size_t size = 0;
+
+  /// the most expression trees the cache will hold
+  size_t capacity = 0;
+};
+
+/**
+ * @class ExpressionCache
+ * @brief A thread-safe, size-bounded map of KaRL logic to compiled
+ *        expression trees, evicting the least recently used tree first
+ *
+ * Lookups only take the cache's own lock, so previously compiled logic
+ * can be retrieved without the knowledge base lock. Evicting a tree does
+ * not invalidate CompiledExpressions that still refer to it.
+ **/
+class MADARA_EXPORT ExpressionCache
+{
+public:
+  /// the default for the most expression trees to cache
+  static constexpr size_t DEFAULT_CAPACITY = 10000;
+
+  /**
+   * Constructor
+   * @param  capacity   the most expression trees to cache. 0 disables
+   *                    caching.
+   **/
+  ExpressionCache(size_t capacity = DEFAULT_CAPACITY);
+
+  ExpressionCache(const ExpressionCache&) = delete;
+  ExpressionCache& operator=(const ExpressionCache&) = delete;
+
+  /**
+   * Retrieves a cached expression tree and marks it most recently used
+   * @param  logic   the KaRL logic the tree was compiled from
+   * @param  tree    set to the cached tree if found
+   * @return true if the logic was cached
+   **/
+  bool find(const std::string& logic, ExpressionTree& tree);
+
+  /**
+   * Caches a newly compiled expression tree, evicting the least recently
+   * used trees if the cache is full. Counts as a miss.
+   * @param  logic   the KaRL logic the tree was compiled from
+   * @param  tree    the compiled tree
+   **/
+  void insert(const std::string& logic, const ExpressionTree& tree);
+
+  /**
+   * Removes an expression tree from the cache
+   * @param  logic   the KaRL logic the tree was compiled from
+   * @return true if the logic was cached
+   **/
+  bool erase(const std::string& logic);
+
+  /**
+   * Removes all expression trees from the cache
+   **/
+  void clear(void);
+
+  /**
+   * Sets the most expression trees to cache, evicting trees if the
+   * cache is larger
+   * @param  capacity   the most expression trees to cache. 0 disables
+   *                    caching.
+   **/
+  void set_capacity(size_t capacity);
+
+  /**
+   * Returns the most expression trees the cache will hold
+   * @return  the capacity
+   **/
+  size_t get_capacity(void) const;
+
+  /**
+   * Returns the number of cached expression trees
+   * @return  the size of the cache
+   **/
+  size_t size(void) const;
+
+  /**
+   * Returns the hit, miss and eviction counts, size and capacity
+   * @return  the cache statistics
+   **/
+  ExpressionCacheStats get_stats(void) const;
+
+  /**
+   * Resets the hit, miss and eviction counts
+   **/
+  void reset_stats(void);
+
+private:
+  /// recency list, most recently used first, of keys in trees_
+  typedef std::list<const std::string*> Recency;
+
+  /**
+   * A cached tree and its position in the recency list
+   **/
+  struct Entry
+  {
+    ExpressionTree tree;
+    Recency::iterator position;
+  };
+
+  /**
+   * Evicts least recently used trees until the cache fits its capacity.
+   * Requires the lock.
+   **/
+  void evict(void);
+
+  /// Guards all members
+  mutable MADARA_LOCK_TYPE mutex_;
+
+  /// Cached trees by KaRL logic
+  std::unordered_map<std::string, Entry> trees_;
+
+  /// Keys of trees_, most recently used first
+  Recency recency_;
+
+  /// Current statistics
+  ExpressionCacheStats stats_;
+};
+}
+}
+
+#endif  // _MADARA_NO_KARL_
+
+#endif  // _MADARA_EXPRESSION_EXPRESSION_CACHE_H_
@@ -86,6 +86,7 @@
 #include "madara/expression/Interpreter.h"
 
 #include "madara/expression/Visitor.h"
+#include "madara/utility/ArrayMath.h"
 
 typedef madara::knowledge::KnowledgeRecord::Integer Integer;
 
@@ -1878,6 +1879,179 @@ private:
   const char* name_;
   fn_type fn_;
 };
+
+namespace
+{
+typedef madara::knowledge::KnowledgeRecord KnowledgeRecord;
+typedef std::shared_ptr<const std::vector<KnowledgeRecord::Integer>> Integers;
+typedef std::shared_ptr<const std::vector<double>> Doubles;
+
+/**
+ * Throws unless an array system call has the expected arguments
+ **/
+void check_arguments(const std::vector<KnowledgeRecord>& args,
+    size_t expected, const char* usage)
+{
+  if (args.size() != expected)
+  {
+    std::string message = "madara::expression::Interpreter: "
+                          "KARL RUNTIME ERROR: ";
+    message += usage;
+
+    throw exceptions::KarlException(message);
+  }
+}
+
+/**
+ * Returns the integers of an INTEGER or INTEGER_ARRAY argument without
+ * copying arrays, or null for other types
+ **/
+Integers integers_of(const KnowledgeRecord& arg)
+{
+  if (arg.type() == KnowledgeRecord::INTEGER_ARRAY)
+    return arg.share_integers();
+  else if (arg.type() == KnowledgeRecord::INTEGER)
+    return std::make_shared<const std::vector<KnowledgeRecord::Integer>>(
+        1, arg.to_integer());
+
+  return nullptr;
+}
+
+/**
+ * Returns the doubles of an argument, converting other types
+ **/
+Doubles doubles_of(const KnowledgeRecord& arg)
+{
+  if (arg.type() == KnowledgeRecord::DOUBLE_ARRAY)
+    return arg.share_doubles();
+
+  return std::make_shared<const std::vector<double>>(arg.to_doubles());
+}
+
+/**
+ * #sum (array): sums the elements of an array
+ **/
+KnowledgeRecord array_sum(std::vector<KnowledgeRecord> args)
+{
+  check_arguments(args, 1, "#sum (array) expects 1 argument");
+
+  if (Integers ints = integers_of(args[0]))
+    return KnowledgeRecord(utility::array_sum(ints->data(), ints->size()));
+
+  Doubles doubles = doubles_of(args[0]);
+  return KnowledgeRecord(utility::array_sum(doubles->data(), doubles->size()));
+}
+
+/**
+ * #dot (lhs, rhs): the dot product of two arrays, up to the shorter length
+ **/
+KnowledgeRecord array_dot(std::vector<KnowledgeRecord> args)
+{
+  check_arguments(args, 2, "#dot (lhs, rhs) expects 2 arguments");
+
+  Integers lhs_ints = integers_of(args[0]);
+  Integers rhs_ints = integers_of(args[1]);
+
+  if (lhs_ints && rhs_ints)
+    return KnowledgeRecord(utility::array_dot(lhs_ints->data(),
+        rhs_ints->data(), std::min(lhs_ints->size(), rhs_ints->size())));
+
+  Doubles lhs = doubles_of(args[0]);
+  Doubles rhs = doubles_of(args[1]);
+
+  return KnowledgeRecord(utility::array_dot(
+      lhs->data(), rhs->data(), std::min(lhs->size(), rhs->size())));
+}
+
+/**
+ * #min (values, ...) and #max (values, ...): the extreme element of all
+ * arguments, which may be arrays or scalars
+ **/
+template<bool Largest>
+KnowledgeRecord array_extreme(std::vector<KnowledgeRecord> args)
+{
+  KnowledgeRecord result;
+  bool found = false;
+
+  for (auto& arg : args)
+  {
+    KnowledgeRecord candidate;
+
+    if (Integers ints = integers_of(arg))
+    {
+      if (ints->empty())
+        continue;
+
+      candidate.set_value(Largest ?
+                              utility::array_max(ints->data(), ints->size()) :
+                              utility::array_min(ints->data(), ints->size()));
+    }
+    else
+    {
+      Doubles doubles = doubles_of(arg);
+
+      if (doubles->empty())
+        continue;
+
+      candidate.set_value(
+          Largest ? utility::array_max(doubles->data(), doubles->size()) :
+                    utility::array_min(doubles->data(), doubles->size()));
+    }
+
+    if (!found || (Largest ? result < candidate : candidate < result))
+    {
+      result = candidate;
+      found = true;
+    }
+  }
+
+  return result;
+}
+
+/**
+ * #norm (array): the Euclidean norm of an array
+ **/
+KnowledgeRecord array_norm(std::vector<KnowledgeRecord> args)
+{
+  check_arguments(args, 1, "#norm (array) expects 1 argument");
+
+  Doubles doubles = doubles_of(args[0]);
+  return KnowledgeRecord(
+      utility::array_norm(doubles->data(), doubles->size()));
+}
+
+/**
+ * #axpy (a, x, y): the array a * x + y, up to the shorter of x and y
+ **/
+KnowledgeRecord array_axpy(std::vector<KnowledgeRecord> args)
+{
+  check_arguments(args, 3, "#axpy (a, x, y) expects 3 arguments");
+
+  Integers x_ints = integers_of(args[1]);
+  Integers y_ints = integers_of(args[2]);
+
+  if (args[0].type() == KnowledgeRecord::INTEGER && x_ints && y_ints)
+  {
+    std::vector<KnowledgeRecord::Integer> result(
+        std::min(x_ints->size(), y_ints->size()));
+
+    utility::array_axpy(args[0].to_integer(), x_ints->data(),
+        y_ints->data(), result.data(), result.size());
+
+    return KnowledgeRecord(std::move(result));
+  }
+
+  Doubles x = doubles_of(args[1]);
+  Doubles y = doubles_of(args[2]);
+
+  std::vector<double> result(std::min(x->size(), y->size()));
+
+  utility::array_axpy(args[0].to_double(), x->data(), y->data(),
+      result.data(), result.size());
+
+  return KnowledgeRecord(std::move(result));
+}
+}
 }
 }
 
@@ -5394,6 +5568,12 @@ void madara::expression::Interpreter::system_call_insert(
 
     switch (first_char)
     {
+      case 'a':
+        if (name == "#axpy")
+        {
+          call = new GenericSystemCall(context, "#axpy", array_axpy);
+        }
+        break;
       case 'b':
         if (name == "#buffer")
         {
@@ -5423,6 +5603,10 @@ void madara::expression::Interpreter::system_call_insert(
         {
           call = new ToDoubles(context);
         }
+        else if (name == "#dot")
+        {
+          call = new GenericSystemCall(context, "#dot", array_dot);
+        }
         break;
       case 'e':
         if (name == "#eval" || name == "#evaluate")
@@ -5507,6 +5691,20 @@ void madara::expression::Interpreter::system_call_insert(
                 return KnowledgeRecord(std::move(ret));
               });
         }
+        else if (name == "#max")
+        {
+          call = new GenericSystemCall(context, "#max", array_extreme<true>);
+        }
+        else if (name == "#min")
+        {
+          call = new GenericSystemCall(context, "#min", array_extreme<false>);
+        }
+        break;
+      case 'n':
+        if (name == "#norm")
+        {
+          call = new GenericSystemCall(context, "#norm", array_norm);
+        }
         break;
       case 'p':
         if (name == "#pow")
@@ -5581,6 +5779,10 @@ void madara::expression::Interpreter::system_call_insert(
         {
           call = new ToString(context);
         }
+        else if (name == "#sum")
+        {
+          call = new GenericSystemCall(context, "#sum", array_sum);
+        }
         break;
       case 't':
         if (name == "#tan")
@@ -6639,9 +6841,9 @@ madara::expression::ExpressionTree madara::expression::Interpreter::interpret(
     knowledge::ThreadSafeContext& context, const std::string& input)
 {
   // return the cached expression tree if it exists
-  ExpressionTreeMap::const_iterator found = cache_.find(input);
-  if (found != cache_.end())
-    return found->second;
+  ExpressionTree cached(context.get_logger());
+  if (cache_.find(input, cached))
+    return cached;
 
   ::std::list<Symbol*> list;
   // list.clear ();
@@ -6697,7 +6899,7 @@ madara::expression::ExpressionTree madara::expression::Interpreter::interpret(
     delete list.back();
 
     // store this optimized tree into cached memory
-    cache_[input] = tree;
+    cache_.insert(input, tree);
 
     return tree;
   }
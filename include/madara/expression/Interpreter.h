@@ -19,6 +19,7 @@
 
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/expression/ExpressionTree.h"
+#include "madara/expression/ExpressionCache.h"
 #include "madara/knowledge/ThreadSafeContext.h"
 
 namespace madara
@@ -118,6 +119,21 @@ public:
    **/
   inline bool delete_expression(const std::string& expression);
 
+  /**
+   * Retrieves a previously compiled expression without compiling it.
+   * Does not require the context lock.
+   * @param    expression      expression to look up
+   * @param    tree            set to the cached tree if found
+   * @return   true if the expression was in the cache
+   **/
+  inline bool find_cached(const std::string& expression, ExpressionTree& tree);
+
+  /**
+   * Returns the cache of compiled expressions
+   * @return   the cache used by interpret
+   **/
+  inline ExpressionCache& get_cache(void);
+
 private:
   /**
    * extracts precondition, condition, postcondition, and body from input
@@ -252,7 +268,7 @@ private:
   /**
    * Cache of expressions that have been previously compiled
    **/
-  ExpressionTreeMap cache_;
+  ExpressionCache cache_;
 };
 }
 }
@@ -70,7 +70,19 @@ inline bool madara::expression::Interpreter::is_whitespace(char input)
 inline bool madara::expression::Interpreter::delete_expression(
     const std::string& expression)
 {
-  return cache_.erase(expression) == 1;
+  return cache_.erase(expression);
+}
+
+inline bool madara::expression::Interpreter::find_cached(
+    const std::string& expression, ExpressionTree& tree)
+{
+  return cache_.find(expression, tree);
+}
+
+inline madara::expression::ExpressionCache&
+madara::expression::Interpreter::get_cache(void)
+{
+  return cache_;
 }
 
 #endif  // _MADARA_NO_KARL_
@@ -9,7 +9,7 @@
 
 madara::expression::SystemCallEval::SystemCallEval(
     madara::knowledge::ThreadSafeContext& context, const ComponentNodes& nodes)
-  : SystemCallNode(context, nodes)
+  : SystemCallNode(context, nodes), tree_(context.get_logger())
 {
 }
 
@@ -74,10 +74,21 @@ madara::knowledge::KnowledgeRecord madara::expression::SystemCallEval::evaluate(
         "madara::expression::SystemCallEval: "
         "System call type is returning the eval of its first argument\n");
 
-    madara::knowledge::CompiledExpression expression =
-        context_.compile(nodes_[0]->evaluate(settings).to_string());
+    std::string logic = nodes_[0]->evaluate(settings).to_string();
 
-    return expression.expression.evaluate(settings);
+    // call sites usually evaluate the same logic every time, so skip
+    // even the interpreter cache lookup when the argument is unchanged
+    if (tree_.is_null() || logic != logic_)
+    {
+      tree_ = context_.compile(logic).expression;
+      logic_ = std::move(logic);
+    }
+
+    // hold a reference, in case the logic evaluates this call site again
+    // with a different argument
+    ExpressionTree tree(tree_);
+
+    return tree.evaluate(settings);
   }
   else
   {
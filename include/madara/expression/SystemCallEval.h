@@ -16,6 +16,7 @@
 #include <stdexcept>
 #include "madara/utility/StdInt.h"
 #include "madara/expression/SystemCallNode.h"
+#include "madara/expression/ExpressionTree.h"
 
 namespace madara
 {
@@ -68,6 +69,13 @@ public:
    * @param    visitor   visitor instance to use
    **/
   virtual void accept(Visitor& visitor) const;
+
+private:
+  /// the logic most recently evaluated at this call site
+  std::string logic_;
+
+  /// the compiled logic_, reused while the argument does not change
+  ExpressionTree tree_;
 };
 }
 }
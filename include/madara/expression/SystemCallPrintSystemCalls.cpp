@@ -70,6 +70,11 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
   // if calls hasn't been initialized yet, fill the list of system calls
   if (calls_.size() == 0)
   {
+    calls_["#axpy"] =
+        "\n#axpy (a, x, y):\n"
+        "  Returns the array a * x + y, computed element-wise up to the\n"
+        "  shorter of the arrays x and y.\n";
+
     calls_["#clear_variable"] =
         "\n#clear_var (var) or #clear_variable (var):\n"
         "  Clears the variable var in the knowledge base. This is\n"
@@ -89,6 +94,10 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
         "  expressions or variable references (including container\n"
         "  classes such as Integer, Double, Vector, etc.)\n";
 
+    calls_["#dot"] =
+        "\n#dot (lhs, rhs):\n"
+        "  Returns the dot product of two arrays, up to the shorter array.\n";
+
     calls_["#eval"] =
         "\n#eval (expression) or #evaluate (expression):\n"
         "  Evaluates the KaRL expression and returns a result. Works "
@@ -156,6 +165,17 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
         "  5. Trace events\n"
         "  6. Detailed logging\n";
 
+    calls_["#max"] =
+        "\n#max (value, ...):\n"
+        "  Returns the largest element of the arrays or values passed.\n";
+
+    calls_["#min"] =
+        "\n#min (value, ...):\n"
+        "  Returns the smallest element of the arrays or values passed.\n";
+
+    calls_["#norm"] = "\n#norm (array):\n"
+                      "  Returns the Euclidean norm of an array\n";
+
     calls_["#pow"] = "\n#pow (base, power):\n"
                      "  Returns the base taken to a power (exponent)\n";
 
@@ -224,6 +244,9 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
     calls_["#sqrt"] = "\n#sqrt (value):\n"
                       "  Returns the square root of a value\n";
 
+    calls_["#sum"] = "\n#sum (array):\n"
+                     "  Returns the sum of the elements of an array\n";
+
     calls_["#tan"] = "\n#tan (value):\n"
                      "  Returns the tangent of a term (radians)\n";
 
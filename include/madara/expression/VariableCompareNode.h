@@ -29,6 +29,9 @@ class Visitor;
 class VariableCompareNode : public ComponentNode
 {
 public:
+  friend class CppGenerator;
+  friend class AccessVisitor;
+
   /// Ctor.
   VariableCompareNode(ComponentNode* lhs,
       madara::knowledge::KnowledgeRecord value, int type, ComponentNode* rhs,
@@ -28,6 +28,9 @@ class Visitor;
 class VariableDecrementNode : public ComponentNode
 {
 public:
+  friend class CppGenerator;
+  friend class AccessVisitor;
+
   /// Ctor.
   VariableDecrementNode(ComponentNode* lhs,
       madara::knowledge::KnowledgeRecord value, ComponentNode* rhs,
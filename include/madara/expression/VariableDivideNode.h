@@ -28,6 +28,9 @@ class Visitor;
 class VariableDivideNode : public ComponentNode
 {
 public:
+  friend class CppGenerator;
+  friend class AccessVisitor;
+
   /// Ctor.
   VariableDivideNode(ComponentNode* lhs,
       madara::knowledge::KnowledgeRecord value, ComponentNode* rhs,
@@ -29,6 +29,9 @@ class Visitor;
 class VariableIncrementNode : public ComponentNode
 {
 public:
+  friend class CppGenerator;
+  friend class AccessVisitor;
+
   /// Ctor.
   VariableIncrementNode(ComponentNode* lhs,
       madara::knowledge::KnowledgeRecord value, ComponentNode* rhs,
@@ -28,6 +28,9 @@ class Visitor;
 class VariableMultiplyNode : public ComponentNode
 {
 public:
+  friend class CppGenerator;
+  friend class AccessVisitor;
+
   /// Ctor.
   VariableMultiplyNode(ComponentNode* lhs,
       madara::knowledge::KnowledgeRecord value, ComponentNode* rhs,
@@ -5,20 +5,42 @@
 #include "madara/utility/Utility.h"
 #include "VariableExpander.h"
 #include "madara/exceptions/UninitializedException.h"
+#include "madara/knowledge/ContextGuard.h"
 
+#include <functional>
 #include <string>
 #include <sstream>
 
+namespace
+{
+/// appends a record in the same format as operator<< on KnowledgeRecord
+void append_record(
+    std::string& buffer, const madara::knowledge::KnowledgeRecord& record)
+{
+  typedef madara::knowledge::KnowledgeRecord KnowledgeRecord;
+
+  if (record.type() == KnowledgeRecord::INTEGER)
+    buffer += std::to_string(record.to_integer());
+  else if (record.type() &
+           (KnowledgeRecord::INTEGER_ARRAY | KnowledgeRecord::DOUBLE_ARRAY))
+    buffer += record.to_string(", ");
+  else
+    buffer += record.to_string();
+}
+}
+
 madara::expression::VariableNode::VariableNode(
     const std::string& key, madara::knowledge::ThreadSafeContext& context)
   : ComponentNode(context.get_logger()),
     key_(key),
     context_(context),
-    key_expansion_necessary_(false)
+    key_expansion_necessary_(false),
+    ref_cache_generation_(0)
 {
   // this key requires expansion. We do the compilation and error checking here
   // as the key shouldn't change, and this allows us to only have to do this
-  // once
+  // once. Each top-level {...} becomes a nested VariableNode, so evaluation
+  // only has to concatenate literals with the current nested values.
   if (key.find("{") != key.npos)
   {
     madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
@@ -28,20 +50,34 @@ madara::expression::VariableNode::VariableNode(
 
     key_expansion_necessary_ = true;
     int num_opens = 0;
+    size_t start = 0;
+    size_t opener = 0;
 
     for (size_t i = 0; i < key.size(); ++i)
     {
       if (key[i] == '{')
       {
-        markers_.push_back(i);
+        if (num_opens == 0)
+          opener = i;
+
         ++num_opens;
       }
       else if (key[i] == '}')
       {
         if (num_opens != 0)
         {
-          markers_.push_back(i);
           --num_opens;
+
+          if (num_opens == 0)
+          {
+            KeySegment segment;
+            segment.literal = key.substr(start, opener - start);
+            segment.expansion.reset(new VariableNode(
+                key.substr(opener + 1, i - opener - 1), context));
+
+            segments_.push_back(std::move(segment));
+            start = i + 1;
+          }
         }
         else
         {
@@ -67,16 +103,16 @@ madara::expression::VariableNode::VariableNode(
 
       throw exceptions::KarlException(buffer.str());
     }
-    else if (num_opens < 0)
-    {
-      std::stringstream buffer;
-      buffer << "madara::expression::VariableNode: ";
-      buffer << "KARL COMPILE ERROR: more closing braces than openers in ";
-      buffer << key << "\n";
-      madara_logger_ptr_log(logger_, logger::LOG_ERROR, buffer.str().c_str());
 
-      throw exceptions::KarlException(buffer.str());
+    // handle characters trailing the last closer
+    if (start < key.size())
+    {
+      KeySegment segment;
+      segment.literal = key.substr(start);
+      segments_.push_back(std::move(segment));
     }
+
+    ref_cache_.resize(REF_CACHE_SIZE);
   }
   // no variable expansion necessary. Create a hard link to the ref_->
   // this will save us lots of clock cycles each variable access or
@@ -87,122 +123,84 @@ madara::expression::VariableNode::VariableNode(
   }
 }
 
-std::string madara::expression::VariableNode::expand_opener(
-    size_t opener, size_t& closer) const
+void madara::expression::VariableNode::expand_key_into(
+    std::string& buffer) const
+{
+  for (const KeySegment& segment : segments_)
+  {
+    buffer += segment.literal;
+
+    if (segment.expansion)
+    {
+      const VariableNode& nested = *segment.expansion;
+      const knowledge::KnowledgeRecord* record =
+          nested.ref_.is_valid()
+              ? nested.ref_.get_record_unsafe()
+              : nested.expanded_ref(false).get_record_unsafe();
+
+      if (record)
+        append_record(buffer, *record);
+    }
+  }
+}
+
+madara::knowledge::VariableReference
+madara::expression::VariableNode::expanded_ref(bool create) const
 {
-  size_t i = opener + 1;
-  size_t start = markers_[opener] + 1;
+  knowledge::ContextGuard guard(context_);
 
-  std::stringstream builder;
+  key_buffer_.clear();
+  expand_key_into(key_buffer_);
 
   madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-      "madara::expression::VariableNode:expand_opener: "
-      "key=%s, opener_index=%d, start=%d.\n",
-      key_.c_str(), (int)opener);
+      "madara::expression::VariableNode:expanded_ref: "
+      "%s expanded to %s\n",
+      key_.c_str(), key_buffer_.c_str());
 
-  for (; i < markers_.size(); ++i)
+  // cached references dangle if any record was erased since they were taken
+  uint64_t generation = context_.get_erase_generation();
+
+  if (generation != ref_cache_generation_)
   {
-    if (key_[markers_[i]] == '{')
-    {
-      // copy before opener (4)
-      if (start < markers_[i])
-      {
-        builder << key_.substr(start, markers_[i] - start);
-        madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-            "madara::expression::VariableNode:expand_opener: "
-            "%d-%d{: added %d chars.\n",
-            (int)start, (int)markers_[i], (int)(markers_[i] - start));
-      }
+    for (CachedRef& cached : ref_cache_)
+      cached.ref = knowledge::VariableReference();
 
-      size_t sub_opener = i;
-      builder << expand_opener(i, i);
-      madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-          "madara::expression::VariableNode:expand_opener: "
-          "get_record(expand_opener()) "
-          "expand_opener(%d, %d).\n",
-          (int)sub_opener, (int)i);
+    ref_cache_generation_ = generation;
+  }
 
-      // set next start to after [4]{[5]}*[3]
-      start = markers_[i] + 1;
-    }
-    else if (key_[markers_[i]] == '}')
-    {
-      // main action of this function {[2]}
-      closer = i;
+  CachedRef& cached =
+      ref_cache_[std::hash<std::string>()(key_buffer_) % REF_CACHE_SIZE];
 
-      size_t end = markers_[closer];
+  if (cached.ref.is_valid() && cached.key == key_buffer_)
+    return cached.ref;
 
-      builder << *context_.get_record(key_.substr(start, end - start));
-      madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-          "madara::expression::VariableNode:expand_opener(%d,%d): "
-          "{%d-%d}: added %d chars.\n",
-          (int)opener, (int)closer, (int)start, (int)end, (int)(end - start));
-      break;
-    }
-  }
+  // the key is already fully expanded, so skip the context's expansion pass
+  knowledge::KnowledgeReferenceSettings settings(false);
+  knowledge::VariableReference ref;
 
-  std::string result = builder.str();
+  if (create)
+    ref = context_.get_ref(key_buffer_, settings);
+  else
+    ref = static_cast<const knowledge::ThreadSafeContext&>(context_).get_ref(
+        key_buffer_, settings);
 
-  madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-      "madara::expression::VariableNode:expand_opener(%d,%d): "
-      "return %s\n",
-      (int)opener, (int)closer, result.c_str());
+  if (ref.is_valid())
+  {
+    cached.key = key_buffer_;
+    cached.ref = ref;
+  }
 
-  return result;
+  return ref;
 }
 
 std::string madara::expression::VariableNode::expand_key(void) const
 {
   if (key_expansion_necessary_)
   {
-    madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-        "madara::expression::VariableNode:expand_key: "
-        "Variable %s requires variable expansion"
-        " (%d markers).\n",
-        key_.c_str(), (int)markers_.size());
-
-    size_t i = 0;
-    size_t start = 0;
-
-    // add the first token into a string builder
-    std::stringstream builder;
-
-    for (; i < markers_.size(); ++i)
-    {
-      if (key_[markers_[i]] == '{')
-      {
-        // copy characters between expansions [1]{
-        if (start < markers_[i])
-        {
-          builder << key_.substr(start, markers_[i] - start);
-          madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-              "madara::expression::VariableNode:expand_key: "
-              "%d-%d{: added %d chars.\n",
-              (int)start, (int)markers_[i], (int)(markers_[i] - start));
-        }
-
-        size_t opener = i;
-        builder << expand_opener(i, i);
-        madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-            "madara::expression::VariableNode:expand_key: "
-            "adding results of expand_opener(%d, %d).\n",
-            (int)opener, (int)i);
-
-        start = markers_[i] + 1;
-      }
-    }
-
-    // handle characters trailing }[3]
-    if (start < key_.size() && key_.size() - start > 0)
-    {
-      madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
-          "madara::expression::VariableNode:expand_key: "
-          "substr add from index %d, %d chars.\n",
-          (int)start, (int)key_.size() - start);
-      builder << key_.substr(start, key_.size() - start);
-    }
+    knowledge::ContextGuard guard(context_);
 
-    std::string result = builder.str();
+    std::string result;
+    expand_key_into(result);
 
     madara_logger_ptr_log(logger_, logger::LOG_DETAILED,
         "madara::expression::VariableNode:expand_key: "
@@ -227,8 +225,14 @@ madara::knowledge::KnowledgeRecord madara::expression::VariableNode::item()
 {
   if (ref_.is_valid())
     return *ref_.get_record_unsafe();
+
+  knowledge::ContextGuard guard(context_);
+  knowledge::VariableReference ref = expanded_ref(false);
+
+  if (ref.is_valid())
+    return *ref.get_record_unsafe();
   else
-    return context_.get(expand_key());
+    return knowledge::KnowledgeRecord();
 }
 
 /// Prune the tree of unnecessary nodes.
@@ -245,8 +249,14 @@ madara::knowledge::KnowledgeRecord madara::expression::VariableNode::prune(
   // overhead.
   if (ref_.is_valid())
     return *ref_.get_record_unsafe();
+
+  knowledge::ContextGuard guard(context_);
+  knowledge::VariableReference ref = expanded_ref(false);
+
+  if (ref.is_valid())
+    return *ref.get_record_unsafe();
   else
-    return context_.get(expand_key());
+    return knowledge::KnowledgeRecord();
 }
 
 /// Evaluates the node and its children.
@@ -275,18 +285,23 @@ madara::knowledge::KnowledgeRecord madara::expression::VariableNode::evaluate(
   }
   else
   {
-    auto ret = context_.get(expand_key(), settings);
+    knowledge::ContextGuard guard(context_);
+    knowledge::VariableReference ref = expanded_ref(false);
 
-    if (settings.exception_on_unitialized && !ret.exists ())
+    if (settings.exception_on_unitialized &&
+        (!ref.is_valid() || !ref.get_record_unsafe()->exists()))
     {
       std::stringstream buffer;
       buffer << "madara::expression::VariableNode::evaluate: ";
       buffer << "ERROR: settings do not allow reads of unset vars and ";
-      buffer << ref_.get_name() << " is uninitialized";
+      buffer << key_buffer_ << " is uninitialized";
       throw exceptions::UninitializedException (buffer.str ());
     }
 
-    return ret;
+    if (ref.is_valid())
+      return *ref.get_record_unsafe();
+    else
+      return knowledge::KnowledgeRecord();
   }
 }
 
@@ -310,7 +325,10 @@ int madara::expression::VariableNode::set(
 
   if (!ref.is_valid())
   {
-    ref = context_.get_ref(key_, settings);
+    if (key_expansion_necessary_ && settings.expand_variables)
+      ref = expanded_ref(true);
+    else
+      ref = context_.get_ref(key_, settings);
   }
 
   if (ref.is_valid())
@@ -403,7 +421,10 @@ madara::knowledge::KnowledgeRecord madara::expression::VariableNode::dec(
     return *record;
   }
   else
-    return context_.dec(expand_key(), settings);
+  {
+    knowledge::ContextGuard guard(context_);
+    return context_.dec(expanded_ref(true), settings);
+  }
 }
 
 madara::knowledge::KnowledgeRecord madara::expression::VariableNode::inc(
@@ -431,7 +452,10 @@ madara::knowledge::KnowledgeRecord madara::expression::VariableNode::inc(
     return *record;
   }
   else
-    return context_.inc(expand_key(), settings);
+  {
+    knowledge::ContextGuard guard(context_);
+    return context_.inc(expanded_ref(true), settings);
+  }
 }
 
 #endif  // _MADARA_NO_KARL_
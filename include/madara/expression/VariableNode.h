@@ -4,6 +4,7 @@
 
 #ifndef _MADARA_NO_KARL_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -96,11 +97,31 @@ public:
     if (ref_.is_valid())
       return ref_.get_record_unsafe();
     else
-      return context_.get_record(expand_key());
+      return expanded_ref(true).get_record_unsafe();
   }
 
 private:
-  std::string expand_opener(size_t opener, size_t& closer) const;
+  /**
+   * A compiled piece of an expandable key: literal text followed by an
+   * optional nested variable whose value is inserted after the literal
+   **/
+  struct KeySegment
+  {
+    std::string literal;
+    std::unique_ptr<VariableNode> expansion;
+  };
+
+  /// Appends the expanded key to the end of buffer
+  void expand_key_into(std::string& buffer) const;
+
+  /**
+   * Returns a reference to the variable named by the expanded key. Recently
+   * expanded keys are served from a small per-node reference cache.
+   * @param  create    if true, create the variable if it does not exist
+   * @return the reference, which is invalid if the variable does not exist
+   *         and create is false
+   **/
+  madara::knowledge::VariableReference expanded_ref(bool create) const;
 
   /// Key for retrieving value of this variable.
   const std::string key_;
@@ -111,9 +132,27 @@ private:
   /// Expansion necessary
   bool key_expansion_necessary_;
 
-  std::vector<size_t> markers_;
+  /// Key compiled into literals and nested expansions at construction
+  std::vector<KeySegment> segments_;
+
+  /// Expanded key to reference entry for the reference cache
+  struct CachedRef
+  {
+    std::string key;
+    madara::knowledge::VariableReference ref;
+  };
+
+  /// Number of expanded keys remembered per node
+  static const size_t REF_CACHE_SIZE = 16;
+
+  /// Direct-mapped cache of recently expanded keys. Guarded by context lock
+  mutable std::vector<CachedRef> ref_cache_;
+
+  /// Context erase generation the reference cache is valid for
+  mutable uint64_t ref_cache_generation_;
 
-  /// Reference to context for variable retrieval
+  /// Scratch buffer reused for building expanded keys
+  mutable std::string key_buffer_;
 };
 }
 }
@@ -0,0 +1,76 @@
+
+
+#ifndef _MADARA_FILTERS_BATCH_FILTER_H_
+#define _MADARA_FILTERS_BATCH_FILTER_H_
+
+/**
+ * @file BatchFilter.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a filter functor that operates on a whole batch
+ * of records at once
+ **/
+
+#include <string>
+#include <vector>
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+#include "madara/transport/TransportContext.h"
+#include "madara/knowledge/Variables.h"
+
+namespace madara
+{
+namespace filters
+{
+/**
+ * a batch of named records. On the send path this is the transport's own
+ * update map, so filters work on the records in place without copies.
+ **/
+typedef knowledge::KnowledgeMap RecordBatch;
+
+/**
+ * Abstract base class for implementing batch record filters via
+ * a functor interface. Unlike a RecordFilter, which is invoked once per
+ * record with a freshly built argument list, a BatchFilter is invoked
+ * once per message with every record in that message and a single
+ * transport context. When subclassing this class, create a new
+ * instance with the new operator, and the pointer will be managed
+ * by the underlying MADARA infrastructure.
+ *
+ * Within filter, a record may be:
+ *  - modified in place by changing the mapped record
+ *  - dropped by erasing it from the batch or by calling clear_value
+ *    on it (records that do not exist are not sent or applied)
+ *  - added by inserting a new key into the batch
+ *
+ * If a received message updates a key more than once, the batch holds
+ * only the last record for that key.
+ **/
+class BatchFilter
+{
+public:
+  /**
+   * Destructor
+   **/
+  virtual ~BatchFilter() {}
+
+  /**
+   * User-implementable method for performing a filter on network
+   * data. This is a pure abstract function that must be overridden
+   * when implementing a subclass.
+   * @param   records           the batch of records, modifiable in place
+   * @param   transport_context context for querying transport state
+   * @param   vars              context for querying current program state
+   **/
+  virtual void filter(RecordBatch& records,
+      transport::TransportContext& transport_context,
+      knowledge::Variables& vars) = 0;
+};
+
+/// a chain of batch filters
+typedef std::vector<BatchFilter*> BatchFilters;
+}
+}
+
+#endif  // _MADARA_FILTERS_BATCH_FILTER_H_
@@ -0,0 +1,296 @@
+#include "ContentDedupFilter.h"
+
+#include <sstream>
+
+#include "madara/utility/Sha256.h"
+#include "madara/logger/GlobalLogger.h"
+
+namespace madara
+{
+namespace filters
+{
+ContentDedupFilter::ContentDedupFilter(
+    std::shared_ptr<knowledge::ContentStore> store, const std::string& prefix,
+    double peer_timeout)
+  : store_(store),
+    have_key_(prefix + ".have"),
+    refs_key_(prefix + ".refs"),
+    peer_timeout_((uint64_t)(peer_timeout * 1000000000)),
+    cursor_(store ? store->open_cursor() : 0)
+{
+}
+
+ContentDedupFilter::~ContentDedupFilter()
+{
+  if (store_)
+  {
+    store_->close_cursor(cursor_);
+  }
+}
+
+void ContentDedupFilter::filter(knowledge::KnowledgeMap& records,
+    const transport::TransportContext& transport_context,
+    knowledge::Variables&)
+{
+  if (!store_)
+  {
+    return;
+  }
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (transport_context.get_operation() ==
+      transport::TransportContext::SENDING_OPERATION)
+  {
+    filter_send(records, transport_context);
+  }
+  else if (transport_context.get_operation() ==
+           transport::TransportContext::RECEIVING_OPERATION)
+  {
+    filter_receive(records, transport_context);
+  }
+}
+
+std::string ContentDedupFilter::intern(knowledge::KnowledgeRecord& record)
+{
+  if (!record.is_binary_file_type())
+  {
+    return "";
+  }
+
+  knowledge::ContentStore::Payload payload = record.share_binary();
+  const void* original = payload.get();
+
+  std::string digest = store_->intern(payload);
+
+  if (payload.get() != original)
+  {
+    record.set_shared_file(std::move(payload), record.type());
+  }
+
+  return digest;
+}
+
+void ContentDedupFilter::filter_send(knowledge::KnowledgeMap& records,
+    const transport::TransportContext& transport_context)
+{
+  uint64_t now = transport_context.get_current_time();
+
+  std::vector<const Peer*> active;
+  for (auto& peer : peers_)
+  {
+    if (peer.second.last_seen + peer_timeout_ >= now)
+    {
+      active.push_back(&peer.second);
+    }
+  }
+
+  std::string refs;
+  knowledge::KnowledgeRecord refs_record;
+
+  for (auto record = records.begin(); record != records.end();)
+  {
+    std::string digest = intern(record->second);
+
+    bool everyone_has = digest != "" && active.size() > 0;
+
+    for (size_t i = 0; everyone_has && i < active.size(); ++i)
+    {
+      everyone_has = active[i]->digests.count(digest) > 0;
+    }
+
+    if (everyone_has)
+    {
+      // each reference is <hex digest> <type> <clock> <quality> <toi> <key>
+      refs += utility::digest_to_hex(digest);
+      refs += " " + std::to_string(record->second.type());
+      refs += " " + std::to_string(record->second.clock);
+      refs += " " + std::to_string(record->second.quality);
+      refs += " " + std::to_string(record->second.toi());
+      refs += " " + record->first + "\n";
+
+      // the refs record itself carries the newest of its references
+      if (record->second.clock > refs_record.clock)
+        refs_record.clock = record->second.clock;
+      if (record->second.quality > refs_record.quality)
+        refs_record.quality = record->second.quality;
+      if (record->second.toi() > refs_record.toi())
+        refs_record.set_toi(record->second.toi());
+
+      ++references_sent_;
+      bytes_saved_ += record->second.size();
+
+      record = records.erase(record);
+    }
+    else
+    {
+      ++record;
+    }
+  }
+
+  if (refs.size() > 0)
+  {
+    refs_record.set_value(refs);
+    records[refs_key_] = refs_record;
+  }
+
+  // tell peers about content we have gained since the last message
+  std::vector<std::string> added = store_->digests_since(cursor_);
+
+  if (advertise_all_)
+  {
+    added = store_->digests();
+    pending_.clear();
+    advertise_all_ = false;
+  }
+
+  pending_.insert(pending_.end(), added.begin(), added.end());
+
+  if (pending_.size() > 0)
+  {
+    size_t count =
+        pending_.size() < max_advertised_ ? pending_.size() : max_advertised_;
+
+    std::vector<unsigned char> have;
+    have.reserve(count * utility::SHA256_DIGEST_SIZE);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      have.insert(have.end(), pending_.front().begin(), pending_.front().end());
+      pending_.pop_front();
+    }
+
+    knowledge::KnowledgeRecord have_record;
+    have_record.set_file(std::move(have));
+    records[have_key_] = have_record;
+  }
+}
+
+void ContentDedupFilter::filter_receive(knowledge::KnowledgeMap& records,
+    const transport::TransportContext& transport_context)
+{
+  const std::string& originator = transport_context.get_originator();
+
+  // a new peer needs to hear about everything we have
+  if (peers_.find(originator) == peers_.end())
+  {
+    advertise_all_ = true;
+  }
+
+  Peer& peer = peers_[originator];
+  peer.last_seen = transport_context.get_current_time();
+
+  auto have = records.find(have_key_);
+
+  if (have != records.end())
+  {
+    knowledge::ContentStore::Payload digests = have->second.share_binary();
+
+    for (size_t i = 0;
+         digests && i + utility::SHA256_DIGEST_SIZE <= digests->size();
+         i += utility::SHA256_DIGEST_SIZE)
+    {
+      peer.digests.insert(std::string(
+          (const char*)digests->data() + i, utility::SHA256_DIGEST_SIZE));
+    }
+
+    records.erase(have);
+  }
+
+  auto refs = records.find(refs_key_);
+
+  if (refs != records.end())
+  {
+    knowledge::KnowledgeRecord refs_record = refs->second;
+    records.erase(refs);
+
+    std::stringstream lines(refs_record.to_string());
+    std::string line;
+
+    while (std::getline(lines, line))
+    {
+      std::istringstream fields(line);
+      std::string hex, key;
+      uint32_t type = 0;
+      uint64_t clock = 0;
+      uint32_t quality = 0;
+      uint64_t toi = 0;
+
+      if (!(fields >> hex >> type >> clock >> quality >> toi) ||
+          !std::getline(fields >> std::ws, key) || key.empty())
+      {
+        continue;
+      }
+
+      std::string digest = utility::hex_to_digest(hex);
+
+      knowledge::ContentStore::Payload payload;
+
+      if (digest.size() == utility::SHA256_DIGEST_SIZE)
+      {
+        payload = store_->get(digest);
+      }
+
+      if (!payload)
+      {
+        ++unresolved_;
+
+        madara_logger_ptr_log(madara::logger::global_logger.get(),
+            logger::LOG_MAJOR,
+            "ContentDedupFilter::filter: %s references content %s that is"
+            " not in the store. Dropping it.\n",
+            key.c_str(), hex.c_str());
+
+        continue;
+      }
+
+      knowledge::KnowledgeRecord record;
+      record.set_shared_file(std::move(payload), type);
+      record.clock = clock;
+      record.quality = quality;
+      record.set_toi(toi);
+
+      records.emplace(key, std::move(record));
+    }
+  }
+
+  // keep incoming content so later messages can reference it
+  for (auto& record : records)
+  {
+    intern(record.second);
+  }
+}
+
+void ContentDedupFilter::set_max_advertised(size_t max_digests)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  max_advertised_ = max_digests > 0 ? max_digests : 1;
+}
+
+uint64_t ContentDedupFilter::get_references_sent(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return references_sent_;
+}
+
+uint64_t ContentDedupFilter::get_bytes_saved(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return bytes_saved_;
+}
+
+uint64_t ContentDedupFilter::get_unresolved(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return unresolved_;
+}
+
+void ContentDedupFilter::reset_peers(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  peers_.clear();
+  pending_.clear();
+  advertise_all_ = true;
+}
+}
+}
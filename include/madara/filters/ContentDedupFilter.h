@@ -0,0 +1,185 @@
+#ifndef _MADARA_FILTERS_CONTENT_DEDUP_FILTER_H_
+#define _MADARA_FILTERS_CONTENT_DEDUP_FILTER_H_
+
+/**
+ * @file ContentDedupFilter.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a filter that sends content digests instead of file
+ * payloads that peers already have
+ **/
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "madara/knowledge/ContentStore.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+#include "madara/LockType.h"
+#include "madara/transport/TransportContext.h"
+#include "madara/knowledge/Variables.h"
+
+#include "AggregateFilter.h"
+
+namespace madara
+{
+namespace filters
+{
+/**
+ * @class ContentDedupFilter
+ * @brief Replaces file payloads with content digests when every peer
+ *        already has the content
+ *
+ * Add the same instance as both a send and a receive aggregate filter.
+ * Each participant advertises the digests of the content in its
+ * ContentStore in a {prefix}.have record. When sending, a file record
+ * whose content every active peer has advertised is removed and listed
+ * in a {prefix}.refs record instead. Receivers restore the record from
+ * their own store. All other file payloads that are sent or received are
+ * interned in the store, so they can be referenced in later messages and
+ * sessions.
+ *
+ * A peer is active if it has been heard from within the peer timeout.
+ * With no active peers, all payloads are sent in full.
+ **/
+class MADARA_EXPORT ContentDedupFilter : public AggregateFilter
+{
+public:
+  /**
+   * Constructor
+   * @param  store         the store holding content. Usually the store
+   *                       attached to the knowledge base.
+   * @param  prefix        prefix of the records used to exchange digests
+   * @param  peer_timeout  seconds without hearing from a peer before its
+   *                       advertisements are no longer trusted
+   **/
+  ContentDedupFilter(std::shared_ptr<knowledge::ContentStore> store,
+      const std::string& prefix = "madara.content", double peer_timeout = 10);
+
+  /**
+   * Destructor
+   **/
+  virtual ~ContentDedupFilter();
+
+  /**
+   * Replaces payloads with digests when sending, and digests with
+   * payloads when receiving
+   * @param   records           the aggregate records vector
+   * @param   transport_context context for querying transport state
+   * @param   vars              context for querying current program state
+   **/
+  virtual void filter(knowledge::KnowledgeMap& records,
+      const transport::TransportContext& transport_context,
+      knowledge::Variables& vars);
+
+  /**
+   * Sets the most digests advertised in a single message. The rest are
+   * advertised in following messages.
+   * @param  max_digests   the maximum digests per message
+   **/
+  void set_max_advertised(size_t max_digests);
+
+  /**
+   * Returns the number of payloads sent as digests
+   * @return  the number of references sent
+   **/
+  uint64_t get_references_sent(void) const;
+
+  /**
+   * Returns the payload bytes not sent because peers had the content
+   * @return  the bytes saved
+   **/
+  uint64_t get_bytes_saved(void) const;
+
+  /**
+   * Returns the number of received digests that were not in the store.
+   * Those records are dropped.
+   * @return  the number of unresolved references
+   **/
+  uint64_t get_unresolved(void) const;
+
+  /**
+   * Forgets all peers and their advertisements, and re-advertises the
+   * whole store with the next message
+   **/
+  void reset_peers(void);
+
+private:
+  /**
+   * Content that a peer has advertised
+   **/
+  struct Peer
+  {
+    /// time the peer was last heard from, in nanoseconds
+    uint64_t last_seen = 0;
+
+    /// digests the peer has advertised
+    std::unordered_set<std::string> digests;
+  };
+
+  /**
+   * Handles outgoing records. Requires the lock.
+   **/
+  void filter_send(knowledge::KnowledgeMap& records,
+      const transport::TransportContext& transport_context);
+
+  /**
+   * Handles incoming records. Requires the lock.
+   **/
+  void filter_receive(knowledge::KnowledgeMap& records,
+      const transport::TransportContext& transport_context);
+
+  /**
+   * Interns a file record's payload, pointing the record at the store's
+   * copy. Requires the lock.
+   * @return the digest, or an empty string if the payload is not stored
+   **/
+  std::string intern(knowledge::KnowledgeRecord& record);
+
+  /// Guards all members
+  mutable MADARA_LOCK_TYPE mutex_;
+
+  /// The store holding content
+  std::shared_ptr<knowledge::ContentStore> store_;
+
+  /// Key of the advertisement record
+  std::string have_key_;
+
+  /// Key of the reference record
+  std::string refs_key_;
+
+  /// Nanoseconds before a silent peer is no longer trusted
+  uint64_t peer_timeout_;
+
+  /// Peers by originator id
+  std::map<std::string, Peer> peers_;
+
+  /// Digests waiting to be advertised
+  std::deque<std::string> pending_;
+
+  /// Cursor over content newly interned in the store
+  size_t cursor_;
+
+  /// If true, the whole store is advertised with the next message
+  bool advertise_all_ = true;
+
+  /// Maximum digests advertised per message
+  size_t max_advertised_ = 1000;
+
+  /// Payloads sent as digests
+  uint64_t references_sent_ = 0;
+
+  /// Bytes not sent because of references
+  uint64_t bytes_saved_ = 0;
+
+  /// Received references not found in the store
+  uint64_t unresolved_ = 0;
+};
+}
+}
+
+#endif  // _MADARA_FILTERS_CONTENT_DEDUP_FILTER_H_
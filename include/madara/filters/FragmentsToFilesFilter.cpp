@@ -6,6 +6,7 @@
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Crc32c.h"
 #include "madara/utility/ScopedArray.h"
 #include "madara/knowledge/containers/Vector.h"
 #include "madara/logger/GlobalLogger.h"
@@ -74,23 +75,7 @@ void FragmentsToFilesFilter::filter(knowledge::KnowledgeMap& records,
           {
             if (last_file_path != "")
             {
-              if (utility::file_from_fragments(
-                      last_file_path, last_crc, true, false))
-              {
-                madara_logger_ptr_log(madara::logger::global_logger.get(),
-                    logger::LOG_MAJOR,
-                    "FragmentsToFilesFilter::filter: "
-                    "SUCCESS: file %s is recreated\n",
-                    last_file_path.c_str())
-              }
-              else
-              {
-                madara_logger_ptr_log(madara::logger::global_logger.get(),
-                    logger::LOG_MAJOR,
-                    "FragmentsToFilesFilter::filter: "
-                    "FAIL: file %s is incomplete\n",
-                    last_file_path.c_str())
-              }
+              build_if_complete(last_file_path, last_crc, last_size);
             }
 
             // setup the next file
@@ -118,26 +103,67 @@ void FragmentsToFilesFilter::filter(knowledge::KnowledgeMap& records,
             filename += "." + str_crc + ".frag";
             is_fragment = true;
 
-            // create directory that file needs to exist in
-            std::string directory = utility::extract_path(filename);
+            // verify the fragment if the sender included its checksum
+            auto contents = record->second.share_binary();
+            uint32_t checksum =
+                contents ? utility::crc32c(contents->data(), contents->size())
+                         : 0;
+            auto checksum_record =
+                records.find(last_file + ".checksums." + number);
 
-            utility::recursive_mkdir(directory);
+            if (checksum_record != records.end() &&
+                (uint32_t)checksum_record->second.to_integer() != checksum)
+            {
+              madara_logger_ptr_log(madara::logger::global_logger.get(),
+                  logger::LOG_MAJOR,
+                  "FragmentsToFilesFilter::filter: "
+                  "FAIL: fragment %s is corrupt. Not saving it.\n",
+                  record->first.c_str())
+            }
+            else
+            {
+              // create directory that file needs to exist in
+              std::string directory = utility::extract_path(filename);
 
-            record->second.to_file(filename);
+              utility::recursive_mkdir(directory);
 
-            madara_logger_ptr_log(madara::logger::global_logger.get(),
-                logger::LOG_MAJOR,
-                "FragmentsToFilesFilter::filter: "
-                "found fragment %s:\n"
-                "  base_name=%s\n"
-                "  last_file=%s\n"
-                "  last_file_path=%s\n"
-                "  str_crc=%s\n"
-                "  last_size=%" PRId64 "\n"
-                "  saved to %s\n",
-                record->first.c_str(), base_name.c_str(), last_file.c_str(),
-                last_file_path.c_str(), str_crc.c_str(), last_size,
-                filename.c_str())
+              record->second.to_file(filename);
+
+              // record the fragment so requesters can resume the transfer.
+              // Fragments that are received again or rebroadcast are
+              // already in the manifest.
+              int64_t index = (int64_t)strtoll(number.c_str(), 0, 10);
+              FileProgress& progress =
+                  get_progress(last_file_path, last_crc, last_size);
+              auto recorded = progress.recorded.find(index);
+
+              if (recorded == progress.recorded.end() ||
+                  recorded->second != checksum)
+              {
+                utility::append_fragment_manifest(
+                    last_file_path, last_crc, index, checksum);
+                progress.recorded[index] = checksum;
+              }
+
+              if (last_size <= 0 || index * 60000 < last_size)
+              {
+                progress.fragments.insert(index);
+              }
+
+              madara_logger_ptr_log(madara::logger::global_logger.get(),
+                  logger::LOG_MAJOR,
+                  "FragmentsToFilesFilter::filter: "
+                  "found fragment %s:\n"
+                  "  base_name=%s\n"
+                  "  last_file=%s\n"
+                  "  last_file_path=%s\n"
+                  "  str_crc=%s\n"
+                  "  last_size=%" PRId64 "\n"
+                  "  saved to %s\n",
+                  record->first.c_str(), base_name.c_str(), last_file.c_str(),
+                  last_file_path.c_str(), str_crc.c_str(), last_size,
+                  filename.c_str())
+            }
           }  // end if str_crc is not null
           else
           {
@@ -190,24 +216,83 @@ void FragmentsToFilesFilter::filter(knowledge::KnowledgeMap& records,
 
   if (last_file_path != "")
   {
-    if (utility::file_from_fragments(last_file_path, last_crc, true, false))
+    build_if_complete(last_file_path, last_crc, last_size);
+  }
+}  // end filter method
+
+FragmentsToFilesFilter::FileProgress& FragmentsToFilesFilter::get_progress(
+    const std::string& path, uint32_t crc, int64_t size)
+{
+  FileProgress& progress = progress_[path];
+
+  // a new version of the file starts over from its own manifest, as does
+  // a file whose manifest was removed along with its fragments
+  if (!progress.loaded || progress.crc != crc ||
+      (!progress.recorded.empty() &&
+          !utility::file_exists(
+              utility::get_fragment_manifest_name(path, crc))))
+  {
+    progress = FileProgress();
+    progress.crc = crc;
+    progress.loaded = true;
+    progress.recorded = utility::read_fragment_manifest(path, crc);
+
+    for (const auto& entry : progress.recorded)
     {
-      madara_logger_ptr_log(madara::logger::global_logger.get(),
-          logger::LOG_MAJOR,
-          "FragmentsToFilesFilter::filter: "
-          "SUCCESS: file %s is recreated\n",
-          last_file_path.c_str())
+      if (size <= 0 || entry.first * 60000 < size)
+      {
+        progress.fragments.insert(entry.first);
+      }
     }
-    else
+  }
+
+  return progress;
+}
+
+void FragmentsToFilesFilter::build_if_complete(
+    const std::string& path, uint32_t crc, int64_t size)
+{
+  if (size > 0)
+  {
+    FileProgress& progress = get_progress(path, crc, size);
+    size_t num_fragments = (size_t)((size + 59999) / 60000);
+
+    // building reads every fragment and checks the crc of the whole file,
+    // so only do it once, when the last fragment arrives
+    if (progress.built || progress.fragments.size() < num_fragments)
     {
       madara_logger_ptr_log(madara::logger::global_logger.get(),
-          logger::LOG_MAJOR,
-          "FragmentsToFilesFilter::filter: "
-          "FAIL: file %s is incomplete\n",
-          last_file_path.c_str())
+          logger::LOG_MINOR,
+          "FragmentsToFilesFilter::build_if_complete: "
+          "file %s has %d of %d fragments\n",
+          path.c_str(), (int)progress.fragments.size(), (int)num_fragments)
+
+      return;
     }
   }
-}  // end filter method
+
+  if (utility::file_from_fragments(path, crc, true, false))
+  {
+    if (size > 0)
+    {
+      progress_[path].built = true;
+    }
+
+    madara_logger_ptr_log(madara::logger::global_logger.get(),
+        logger::LOG_MAJOR,
+        "FragmentsToFilesFilter::filter: "
+        "SUCCESS: file %s is recreated\n",
+        path.c_str())
+  }
+  else
+  {
+    madara_logger_ptr_log(madara::logger::global_logger.get(),
+        logger::LOG_MAJOR,
+        "FragmentsToFilesFilter::filter: "
+        "FAIL: file %s is incomplete\n",
+        path.c_str())
+  }
+}
 
 }  // end filters namespace
 }  // end madara namespace
@@ -5,6 +5,8 @@
 #define BOOST_NO_CXX11_SCOPED_ENUMS
 #endif
 
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
@@ -23,7 +25,10 @@ namespace filters
  * @class FragmentsToFilesFilter
  * @brief Receives fragments and saves them to files. This filter is
  *        intended to be paired with the FileFragmenter class, e.g.,
- *        with the Madara File Service (mfs)
+ *        with the Madara File Service (mfs). Fragments sent with a
+ *        CRC-32C checksum are verified before they are saved, and saved
+ *        fragments are listed in a manifest so transfers can be resumed.
+ *        Files are built once all of their fragments have been saved.
  */
 class FragmentsToFilesFilter : public AggregateFilter
 {
@@ -108,6 +113,50 @@ public:
 
   /// map of variable prefixes to directories
   std::map<std::string, std::string> map_;
+
+private:
+  /**
+   * Fragments saved so far for a file being built
+   **/
+  struct FileProgress
+  {
+    /// crc of the completed file the fragments belong to
+    uint32_t crc = 0;
+
+    /// true if the fragments have been read from the manifest
+    bool loaded = false;
+
+    /// true if the file has been built from the fragments
+    bool built = false;
+
+    /// indices of the saved fragments
+    std::set<int64_t> fragments;
+
+    /// fragment indices and checksums already listed in the manifest
+    std::map<int64_t, uint32_t> recorded;
+  };
+
+  /**
+   * Returns the progress of a file, reading its manifest the first time
+   * @param  path   the file being built
+   * @param  crc    crc for completed file
+   * @param  size   expected size of the file, or 0 or less if unknown
+   * @return the progress of the file
+   **/
+  FileProgress& get_progress(
+      const std::string& path, uint32_t crc, int64_t size);
+
+  /**
+   * Builds a file from its fragments if all of them have been saved
+   * @param  path   the file being built
+   * @param  crc    crc for completed file
+   * @param  size   expected size of the file. If 0 or less, the file is
+   *                built from whatever fragments exist.
+   **/
+  void build_if_complete(const std::string& path, uint32_t crc, int64_t size);
+
+  /// map of file paths to the fragments saved for them
+  std::map<std::string, FileProgress> progress_;
 };
 }
 }
@@ -377,6 +377,15 @@ public:
 
   void unserialize(const char* type, const char* data, size_t size);
 
+  /**
+   * Unserialize the given type from a shared buffer, and store into this
+   * Any. Types which support it (e.g., Cap'n Proto objects) keep a reference
+   * into the buffer rather than copying it, so the buffer must not change
+   * afterwards. This operation provides the strong exception-guarantee.
+   **/
+  void unserialize(
+      const char* type, const std::shared_ptr<const char>& data, size_t size);
+
   /**
    * Unserialize the given type from the given character array, and store into
    * this Any, using saved type tag to determine type. This operation provides
@@ -403,6 +412,36 @@ public:
     return len;
   }
 
+  /**
+   * Unserialize from a shared buffer, using saved type tag to determine
+   * type. Types which support it (e.g., Cap'n Proto objects) keep a
+   * reference into the buffer rather than copying it, so the buffer must
+   * not change afterwards. This operation provides the strong
+   * exception-guarantee.
+   *
+   * Use with data serialized by tagged_serialize()
+   **/
+  size_t tagged_unserialize(
+      const std::shared_ptr<const char>& data, size_t size)
+  {
+    namespace bio = boost::iostreams;
+
+    bio::array_source input_source(data.get(), size);
+    bio::stream<bio::array_source> input_stream(input_source);
+
+    auto pos = input_stream.tellg();
+    madara_iarchive archive(input_stream);
+    std::string tag;
+    archive >> tag;
+    auto len = input_stream.tellg() - pos;
+
+    // the value follows the tag, within the same shared buffer
+    std::shared_ptr<const char> value(data, data.get() + len);
+    unserialize(tag.c_str(), value, size - len);
+
+    return len;
+  }
+
 #if 0
   /**
    * Unserialize the given type from the given input stream, and store into
@@ -608,6 +647,26 @@ inline void BasicOwningAny<Impl, Base>::unserialize(
   swap(this->data_, any.data_);
 }
 
+template<typename Impl, typename Base>
+inline void BasicOwningAny<Impl, Base>::unserialize(
+    const char* type, const std::shared_ptr<const char>& data, size_t size)
+{
+  Any any(construct(type));
+
+  if (any.handler_->load_shared)
+  {
+    any.handler_->load_shared(data, size, any.data_, type);
+  }
+  else
+  {
+    any.handler_->load(data.get(), size, any.data_, type);
+  }
+
+  using std::swap;
+  swap(this->handler_, any.handler_);
+  swap(this->data_, any.data_);
+}
+
 template<typename Impl, typename Base>
 inline void BasicOwningAny<Impl, Base>::unserialize_json(
     const char* type, std::istream& i)
@@ -113,6 +113,21 @@ protected:
         (char*)memcpy((char*)operator new(size + extra), data, size));
   }
 
+  /**
+   * Shares a buffer that is already word aligned, so readers view it in
+   * place. Unaligned buffers are copied, as Cap'n Proto requires alignment.
+   **/
+  std::shared_ptr<char> share(std::shared_ptr<const char> data, size_t size)
+  {
+    if ((size_t)data.get() % sizeof(capnp::word) != 0)
+    {
+      return mk_copy(data.get(), size, 0);
+    }
+
+    // never written through, only needed to match data_
+    return std::const_pointer_cast<char>(std::move(data));
+  }
+
   std::shared_ptr<char> read_from(std::istream& i, size_t size, size_t extra)
   {
     std::shared_ptr<char> ret((char*)operator new(size + extra));
@@ -136,6 +151,11 @@ protected:
   {
   }
 
+  BaseCapnObject(std::shared_ptr<const char> data, size_t size)
+    : data_(share(std::move(data), size)), size_(size), reader_(mk_reader())
+  {
+  }
+
   BaseCapnObject(
       std::istream& i, size_t size, size_t extra = 0, bool init_reader = true)
     : data_(read_from(i, size, extra)),
@@ -283,6 +303,14 @@ public:
    **/
   CapnObject(const char* d, size_t s) : Base(d, s) {}
 
+  /**
+   * Construct over a shared buffer without copying it, if it is word
+   * aligned. The buffer must not change while this object refers to it.
+   **/
+  CapnObject(std::shared_ptr<const char> d, size_t s) : Base(std::move(d), s)
+  {
+  }
+
   /**
    * Construct with data from given input stream.
    **/
@@ -356,6 +384,18 @@ public:
   {
   }
 
+  /**
+   * Construct given tag and schema, over a shared buffer without copying it,
+   * if it is word aligned. The buffer must not change while this object
+   * refers to it. Warning: the tag is NOT copied, so ensure its lifetime
+   * exceeds that of this object.
+   **/
+  RegCapnObject(const char* tag, capnp::StructSchema schema,
+      std::shared_ptr<const char> d, size_t s)
+    : Base(std::move(d), s), tag_(tag), schema_(schema)
+  {
+  }
+
   /**
    * Construct given tag and schema, and data copied from given input stream.
    * Warning: the tag is NOT copied, so ensure its lifetime exceeds that of
@@ -550,6 +590,29 @@ inline auto get_type_handler_load(type<knowledge::RegCapnObject>,
   };
 }
 
+template<typename T>
+inline auto get_type_handler_load_shared(type<knowledge::CapnObject<T>>,
+    overload_priority<8>) -> knowledge::TypeHandlers::load_shared_fn_type
+{
+  return [](const std::shared_ptr<const char>& in, size_t size, void* ptr,
+             const char*) {
+    using knowledge::CapnObject;
+    CapnObject<T>& val = *static_cast<CapnObject<T>*>(ptr);
+    val = {in, size};
+  };
+}
+
+inline auto get_type_handler_load_shared(type<knowledge::RegCapnObject>,
+    overload_priority<8>) -> knowledge::TypeHandlers::load_shared_fn_type
+{
+  return [](const std::shared_ptr<const char>& in, size_t size, void* ptr,
+             const char*) {
+    using knowledge::RegCapnObject;
+    RegCapnObject& val = *static_cast<RegCapnObject*>(ptr);
+    val = {val.tag(), val.schema(), in, size};
+  };
+}
+
 template<typename T>
 inline auto get_type_handler_save_json(type<knowledge::CapnObject<T>>,
     overload_priority<8>) -> knowledge::TypeHandlers::save_json_fn_type
@@ -1,5 +1,10 @@
 #include <fstream>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
 
 #include "madara/logger/GlobalLogger.h"
 #include "madara/exceptions/MemoryException.h"
@@ -364,6 +369,413 @@ std::pair<std::string, KnowledgeRecord> CheckpointReader::next()
   }
 }
 
+namespace
+{
+/// One checkpoint state moving through the parallel decode pipeline
+struct CheckpointJob
+{
+  std::vector<char> buffer;
+  int size = 0;
+  uint64_t state = 0;
+  uint64_t clock = 0;
+  bool decoded = false;
+  std::exception_ptr error;
+  std::vector<std::pair<std::string, KnowledgeRecord>> records;
+};
+
+typedef std::shared_ptr<CheckpointJob> CheckpointJobPtr;
+
+/// Shared state between the file reader, decoders, and delivery
+struct CheckpointPipeline
+{
+  std::mutex mutex;
+  std::condition_variable changed;
+
+  /// jobs waiting for a decoder
+  std::deque<CheckpointJobPtr> work;
+
+  /// jobs in file order, waiting for delivery
+  std::deque<CheckpointJobPtr> ordered;
+
+  /// buffers returned by delivery, reused by the file reader
+  std::vector<std::vector<char>> free_buffers;
+
+  bool reading_done = false;
+  bool abort = false;
+};
+
+bool has_allowed_prefix(
+    const CheckpointSettings& settings, const std::string& key)
+{
+  if (settings.prefixes.size() == 0)
+  {
+    return true;
+  }
+
+  for (const auto& prefix : settings.prefixes)
+  {
+    if (madara::utility::begins_with(key, prefix))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/// Applies buffer filters and decodes the records of one checkpoint state
+void decode_checkpoint(const CheckpointSettings& settings, CheckpointJob& job)
+{
+  int64_t buffer_remaining = (int64_t)settings.decode(
+      job.buffer.data(), job.size, (int)job.buffer.size());
+
+  if (buffer_remaining <= 0)
+  {
+    throw exceptions::FilterException(
+        "ParallelCheckpointReader::decode_checkpoint: "
+        "decode () returned a negative encoding size. Bad filter/encode.");
+  }
+
+  if (buffer_remaining <
+      (int64_t)transport::MessageHeader::static_encoded_size())
+  {
+    throw exceptions::MemoryException(
+        "ParallelCheckpointReader::decode_checkpoint: "
+        "Not enough room in buffer for message header");
+  }
+
+  transport::MessageHeader header;
+  const char* current = header.read(job.buffer.data(), buffer_remaining);
+
+  uint64_t updates_size = header.size - header.encoded_size();
+
+  if (updates_size > (uint64_t)buffer_remaining)
+  {
+    throw exceptions::MemoryException(
+        "ParallelCheckpointReader::decode_checkpoint: "
+        "Not enough room in buffer for checkpoint");
+  }
+
+  job.clock = header.clock;
+  job.records.reserve(header.updates);
+
+  for (uint32_t update = 0; update < header.updates; ++update)
+  {
+    std::string key;
+    KnowledgeRecord record;
+    record.clock = header.clock;
+    record.set_toi(settings.last_timestamp);
+    current = record.read(current, key, buffer_remaining);
+
+    if (has_allowed_prefix(settings, key))
+    {
+      job.records.emplace_back(std::move(key), std::move(record));
+    }
+  }
+}
+
+/// Reads raw checkpoint states from the file, in order
+void read_checkpoints(const CheckpointSettings& settings,
+    const FileHeader& meta, size_t window, CheckpointPipeline& pipeline,
+    int64_t& total_read)
+{
+  std::ifstream file(
+      settings.filename.c_str(), std::ios::in | std::ios::binary);
+  uint64_t checkpoint_start = FileHeader::encoded_size();
+
+  for (uint64_t state = 0; state < meta.states && state <= settings.last_state;
+       ++state)
+  {
+    uint64_t checkpoint_size;
+
+    file.seekg(checkpoint_start, file.beg);
+
+    if (!file.read((char*)&checkpoint_size, sizeof(checkpoint_size)))
+    {
+      std::stringstream message;
+      message << "ParallelCheckpointReader::read_all: ";
+      message << "file ";
+      message << settings.filename;
+      message << " does not have enough room for a checkpoint";
+      throw exceptions::FileException(message.str());
+    }
+
+    checkpoint_size = utility::endian_swap(checkpoint_size);
+
+    if (settings.buffer_filters.size() > 0)
+    {
+      checkpoint_size += filters::BufferFilterHeader::encoded_size();
+    }
+
+    file.seekg(checkpoint_start, file.beg);
+    checkpoint_start += checkpoint_size;
+
+    // states before the initial state are skipped without reading them
+    if (state < settings.initial_state)
+    {
+      continue;
+    }
+
+    if (checkpoint_size > settings.buffer_size)
+    {
+      std::stringstream message;
+      message << "ParallelCheckpointReader::read_all: ";
+      message << checkpoint_size;
+      message << " byte checkpoint cannot fit in ";
+      message << settings.buffer_size;
+      message << " byte buffer";
+      throw exceptions::MemoryException(message.str());
+    }
+
+    auto job = std::make_shared<CheckpointJob>();
+    job->state = state;
+    job->size = (int)checkpoint_size;
+
+    {
+      std::unique_lock<std::mutex> guard(pipeline.mutex);
+
+      pipeline.changed.wait(guard, [&] {
+        return pipeline.abort || pipeline.ordered.size() < window;
+      });
+
+      if (pipeline.abort)
+      {
+        return;
+      }
+
+      if (pipeline.free_buffers.size() > 0)
+      {
+        job->buffer = std::move(pipeline.free_buffers.back());
+        pipeline.free_buffers.pop_back();
+      }
+    }
+
+    job->buffer.resize(settings.buffer_size);
+
+    if (!file.read(job->buffer.data(), checkpoint_size))
+    {
+      std::stringstream message;
+      message << "ParallelCheckpointReader::read_all: ";
+      message << "file ";
+      message << settings.filename;
+      message << " does not have enough room for ";
+      message << checkpoint_size;
+      message << " bytes noted in header";
+      throw exceptions::FileException(message.str());
+    }
+
+    total_read += (int64_t)checkpoint_size;
+
+    {
+      std::lock_guard<std::mutex> guard(pipeline.mutex);
+      pipeline.work.push_back(job);
+      pipeline.ordered.push_back(std::move(job));
+    }
+    pipeline.changed.notify_all();
+  }
+}
+
+/// Decodes jobs until the reader is done and no work remains
+void decode_checkpoints(
+    const CheckpointSettings& settings, CheckpointPipeline& pipeline)
+{
+  for (;;)
+  {
+    CheckpointJobPtr job;
+
+    {
+      std::unique_lock<std::mutex> guard(pipeline.mutex);
+
+      pipeline.changed.wait(guard, [&] {
+        return pipeline.abort || pipeline.work.size() > 0 ||
+               pipeline.reading_done;
+      });
+
+      if (pipeline.abort || pipeline.work.size() == 0)
+      {
+        return;
+      }
+
+      job = std::move(pipeline.work.front());
+      pipeline.work.pop_front();
+    }
+
+    try
+    {
+      decode_checkpoint(settings, *job);
+    }
+    catch (...)
+    {
+      job->error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(pipeline.mutex);
+      job->decoded = true;
+    }
+    pipeline.changed.notify_all();
+  }
+}
+
+/// Stops and joins pipeline threads when read_all exits, even on exceptions
+struct PipelineThreads
+{
+  CheckpointPipeline& pipeline;
+  std::vector<std::thread> threads;
+
+  ~PipelineThreads()
+  {
+    {
+      std::lock_guard<std::mutex> guard(pipeline.mutex);
+      pipeline.abort = true;
+    }
+    pipeline.changed.notify_all();
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+  }
+};
+}
+
+ParallelCheckpointReader::ParallelCheckpointReader(
+    CheckpointSettings& in_checkpoint_settings, size_t threads, size_t window)
+  : checkpoint_settings_(in_checkpoint_settings),
+    threads_(threads),
+    window_(window)
+{
+  if (threads_ == 0)
+  {
+    threads_ = std::thread::hardware_concurrency();
+
+    if (threads_ == 0)
+    {
+      threads_ = 1;
+    }
+  }
+
+  if (window_ == 0)
+  {
+    window_ = threads_ * 2;
+  }
+}
+
+uint64_t ParallelCheckpointReader::read_all(const Handler& handler)
+{
+  total_read_ = 0;
+
+  // the sequential reader handles opening the file and its FileHeader
+  CheckpointReader header_reader(checkpoint_settings_);
+  header_reader.start();
+
+  const FileHeader* meta = header_reader.get_file_header();
+
+  if (!meta || !header_reader.is_open() || meta->states == 0)
+  {
+    return 0;
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "ParallelCheckpointReader::read_all:"
+      " reading %d states from %s with %d decode threads\n",
+      (int)meta->states, checkpoint_settings_.filename.c_str(),
+      (int)threads_);
+
+  CheckpointPipeline pipeline;
+  std::exception_ptr read_error;
+  uint64_t delivered = 0;
+
+  {
+    PipelineThreads workers{pipeline, {}};
+
+    workers.threads.emplace_back([&] {
+      try
+      {
+        read_checkpoints(
+            checkpoint_settings_, *meta, window_, pipeline, total_read_);
+      }
+      catch (...)
+      {
+        read_error = std::current_exception();
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(pipeline.mutex);
+        pipeline.reading_done = true;
+      }
+      pipeline.changed.notify_all();
+    });
+
+    for (size_t i = 0; i < threads_; ++i)
+    {
+      workers.threads.emplace_back(
+          decode_checkpoints, std::cref(checkpoint_settings_),
+          std::ref(pipeline));
+    }
+
+    for (;;)
+    {
+      CheckpointJobPtr job;
+
+      {
+        std::unique_lock<std::mutex> guard(pipeline.mutex);
+
+        pipeline.changed.wait(guard, [&] {
+          return (pipeline.ordered.size() > 0 &&
+                     pipeline.ordered.front()->decoded) ||
+                 (pipeline.ordered.size() == 0 && pipeline.reading_done);
+        });
+
+        if (pipeline.ordered.size() == 0)
+        {
+          break;
+        }
+
+        job = std::move(pipeline.ordered.front());
+        pipeline.ordered.pop_front();
+      }
+      pipeline.changed.notify_all();
+
+      if (job->error)
+      {
+        std::rethrow_exception(job->error);
+      }
+
+      if (job->state == 0)
+      {
+        checkpoint_settings_.initial_lamport_clock = job->clock;
+      }
+
+      if (job->state == meta->states - 1)
+      {
+        checkpoint_settings_.last_lamport_clock = job->clock;
+      }
+
+      for (auto& cur : job->records)
+      {
+        handler(cur.first, cur.second);
+        ++delivered;
+      }
+
+      std::lock_guard<std::mutex> guard(pipeline.mutex);
+      pipeline.free_buffers.push_back(std::move(job->buffer));
+    }
+  }
+
+  if (read_error)
+  {
+    std::rethrow_exception(read_error);
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "ParallelCheckpointReader::read_all:"
+      " delivered %d records from %d bytes\n",
+      (int)delivered, (int)total_read_);
+
+  return delivered;
+}
+
 void CheckpointPlayer::thread_main(CheckpointPlayer* self)
 {
   uint64_t start_time = utility::get_time();
@@ -434,5 +846,15 @@ bool CheckpointPlayer::play_until(uint64_t target_toi)
     }
   }
 }
+
+uint64_t CheckpointPlayer::play_all(size_t threads)
+{
+  ParallelCheckpointReader reader(settings_, threads);
+
+  return reader.read_all([this](const std::string& key,
+                             KnowledgeRecord& record) {
+    context_->update_record_from_external(key, record, update_settings_);
+  });
+}
 }
 }  // namespace madara::knowledge
@@ -2,6 +2,7 @@
 #define MADARA_KNOWLEDGE_CHECKPOINT_PLAYER_H
 
 #include <fstream>
+#include <functional>
 #include <thread>
 #include <memory>
 
@@ -109,6 +110,67 @@ private:
   uint64_t update;
 };
 
+/**
+ * Reads an entire binary checkpoint as fast as possible, for offline
+ * analysis. File reads happen on one thread, buffer filter decoding and
+ * record decoding happen on a pool of worker threads, and records are
+ * delivered in file order on the thread calling read_all. Buffer filters
+ * in the settings may be called from several worker threads at once.
+ **/
+class ParallelCheckpointReader
+{
+public:
+  /// Callback receiving each record, in file order
+  using Handler = std::function<void(const std::string&, KnowledgeRecord&)>;
+
+  /**
+   * Construct using the given CheckpointSettings. Ensure that the
+   * referenced object outlives this one.
+   *
+   * @param in_checkpoint_settings  the file, filters, states and prefixes
+   * @param threads   number of decode threads. 0 uses one per hardware core
+   * @param window    max checkpoints in flight. 0 uses twice the threads.
+   *                  Memory use is bounded by window * buffer_size
+   **/
+  ParallelCheckpointReader(CheckpointSettings& in_checkpoint_settings,
+      size_t threads = 0, size_t window = 0);
+
+  /**
+   * Reads the whole checkpoint, calling handler for each record in the
+   * same order that CheckpointReader::next would return them. Exceptions
+   * from reading, filtering or the handler are rethrown after all worker
+   * threads have stopped.
+   *
+   * @param handler   the callback for each record
+   * @return          the number of records passed to handler
+   **/
+  uint64_t read_all(const Handler& handler);
+
+  /**
+   * Get total number of checkpoint bytes read from the file by the last
+   * call to read_all.
+   **/
+  int64_t get_total_read() const
+  {
+    return total_read_;
+  }
+
+  /**
+   * Returns CheckpointSettings this reader is using.
+   */
+  const CheckpointSettings& get_checkpoint_settings() const
+  {
+    return checkpoint_settings_;
+  }
+
+private:
+  CheckpointSettings& checkpoint_settings_;
+
+  size_t threads_;
+  size_t window_;
+  int64_t total_read_ = 0;
+};
+
 /**
  * Plays back a checkpoint over time, based on recorded TOI
  **/
@@ -195,6 +257,17 @@ public:
    **/
   bool play_until(uint64_t target_toi);
 
+  /**
+   * Loads every record of the checkpoint into the context as fast as
+   * possible, ignoring TOI. Decoding is spread across worker threads
+   * (@see ParallelCheckpointReader), but records are applied in order.
+   * Do not call while playback is active.
+   *
+   * @param threads  number of decode threads. 0 uses one per hardware core
+   * @return         the number of records applied to the context
+   **/
+  uint64_t play_all(size_t threads = 0);
+
 private:
   static void thread_main(CheckpointPlayer* self);
 
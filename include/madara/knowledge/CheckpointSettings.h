@@ -453,6 +453,15 @@ public:
    **/
   bool playback_simtime = false;
 
+  /**
+   * If greater than zero, save_context copies the records (payloads are
+   * shared, not deep copied), releases the context lock, and encodes the
+   * copy on this many threads. The file is written as several states of
+   * at most buffer_size bytes each, which load_context applies in order.
+   * If zero, the context is saved as a single state under the lock.
+   **/
+  size_t save_threads = 0;
+
   /**
    * Object which will be used to extract variables for checkpoint saving.
    * By default (if left nullptr), use a default implementation which uses
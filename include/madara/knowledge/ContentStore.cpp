@@ -0,0 +1,374 @@
+#include "ContentStore.h"
+
+#include <fstream>
+
+#include "boost/filesystem.hpp"
+
+#include "madara/utility/Sha256.h"
+#include "madara/utility/Utility.h"
+#include "madara/logger/GlobalLogger.h"
+
+namespace madara
+{
+namespace knowledge
+{
+ContentStore::ContentStore(size_t min_size) : min_size_(min_size) {}
+
+void ContentStore::set_min_size(size_t min_size)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  min_size_ = min_size;
+}
+
+size_t ContentStore::get_min_size(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return min_size_;
+}
+
+void ContentStore::set_directory(const std::string& directory)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  directory_ = directory;
+
+  if (directory_ != "")
+  {
+    boost::system::error_code error;
+    boost::filesystem::create_directories(directory_, error);
+
+    // persist anything interned before the directory was set
+    for (auto& entry : payloads_)
+    {
+      std::string path = get_path(entry.first);
+
+      if (!boost::filesystem::exists(path, error))
+      {
+        std::ofstream output(path, std::ios::out | std::ios::binary);
+        output.write(
+            (const char*)entry.second->data(), entry.second->size());
+      }
+    }
+  }
+}
+
+std::string ContentStore::get_directory(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return directory_;
+}
+
+std::string ContentStore::get_path(const std::string& digest) const
+{
+  return directory_ + "/" + utility::digest_to_hex(digest);
+}
+
+std::string ContentStore::intern(Payload& payload)
+{
+  if (!payload || payload->size() < get_min_size())
+  {
+    return "";
+  }
+
+  std::string result = digest(payload);
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = payloads_.find(result);
+
+  if (found != payloads_.end())
+  {
+    if (found->second != payload)
+    {
+      ++duplicates_;
+      bytes_saved_ += payload->size();
+
+      payload = found->second;
+    }
+  }
+  else
+  {
+    payloads_[result] = payload;
+    digests_[payload.get()] = result;
+
+    // only kept for cursors that have yet to read it
+    if (!cursors_.empty())
+    {
+      added_.push_back(result);
+      ++added_end_;
+    }
+
+    bytes_ += payload->size();
+
+    if (directory_ != "")
+    {
+      std::string path = get_path(result);
+      boost::system::error_code error;
+
+      if (!boost::filesystem::exists(path, error))
+      {
+        std::ofstream output(path, std::ios::out | std::ios::binary);
+        output.write((const char*)payload->data(), payload->size());
+
+        if (!output)
+        {
+          madara_logger_ptr_log(logger::global_logger.get(),
+              logger::LOG_ERROR,
+              "ContentStore::intern: unable to write %s\n", path.c_str());
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+std::string ContentStore::digest(const Payload& payload) const
+{
+  if (!payload)
+  {
+    return utility::sha256(nullptr, 0);
+  }
+
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    auto found = digests_.find(payload.get());
+
+    if (found != digests_.end())
+    {
+      return found->second;
+    }
+  }
+
+  return utility::sha256(payload->data(), payload->size());
+}
+
+ContentStore::Payload ContentStore::get(const std::string& digest)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto found = payloads_.find(digest);
+
+  if (found != payloads_.end())
+  {
+    return found->second;
+  }
+
+  if (directory_ == "")
+  {
+    return nullptr;
+  }
+
+  std::ifstream input(
+      get_path(digest), std::ios::in | std::ios::binary | std::ios::ate);
+
+  if (!input)
+  {
+    return nullptr;
+  }
+
+  auto contents =
+      std::make_shared<std::vector<unsigned char>>((size_t)input.tellg());
+  input.seekg(0);
+  input.read((char*)contents->data(), contents->size());
+
+  // never hand out a payload that does not match its address
+  if (!input || utility::sha256(contents->data(), contents->size()) != digest)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+        "ContentStore::get: %s is corrupt. Ignoring.\n",
+        get_path(digest).c_str());
+
+    return nullptr;
+  }
+
+  Payload payload(std::move(contents));
+
+  payloads_[digest] = payload;
+  digests_[payload.get()] = digest;
+  bytes_ += payload->size();
+
+  return payload;
+}
+
+bool ContentStore::has(const std::string& digest) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (payloads_.find(digest) != payloads_.end())
+  {
+    return true;
+  }
+
+  boost::system::error_code error;
+  return directory_ != "" &&
+         boost::filesystem::exists(get_path(digest), error);
+}
+
+std::vector<std::string> ContentStore::digests(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  std::vector<std::string> result;
+  result.reserve(payloads_.size());
+
+  for (auto& entry : payloads_)
+  {
+    result.push_back(entry.first);
+  }
+
+  if (directory_ != "")
+  {
+    boost::system::error_code error;
+    boost::filesystem::directory_iterator i(directory_, error);
+
+    for (; !error && i != boost::filesystem::directory_iterator();
+         i.increment(error))
+    {
+      std::string name = i->path().filename().string();
+
+      if (name.size() != utility::SHA256_DIGEST_SIZE * 2)
+      {
+        continue;
+      }
+
+      std::string digest = utility::hex_to_digest(name);
+
+      if (digest.size() == utility::SHA256_DIGEST_SIZE &&
+          payloads_.find(digest) == payloads_.end())
+      {
+        result.push_back(digest);
+      }
+    }
+  }
+
+  return result;
+}
+
+size_t ContentStore::open_cursor(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  size_t cursor = next_cursor_++;
+  cursors_[cursor] = added_end_;
+
+  return cursor;
+}
+
+void ContentStore::close_cursor(size_t cursor)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  cursors_.erase(cursor);
+  trim_added();
+}
+
+std::vector<std::string> ContentStore::digests_since(size_t cursor)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  std::vector<std::string> result;
+
+  auto found = cursors_.find(cursor);
+
+  if (found != cursors_.end())
+  {
+    // position of the oldest digest still kept
+    uint64_t first = added_end_ - added_.size();
+    size_t offset =
+        found->second > first ? (size_t)(found->second - first) : 0;
+
+    result.assign(added_.begin() + offset, added_.end());
+    found->second = added_end_;
+
+    trim_added();
+  }
+
+  return result;
+}
+
+void ContentStore::trim_added(void)
+{
+  uint64_t oldest = added_end_;
+
+  for (auto& cursor : cursors_)
+  {
+    if (cursor.second < oldest)
+    {
+      oldest = cursor.second;
+    }
+  }
+
+  while (!added_.empty() && added_end_ - added_.size() < oldest)
+  {
+    added_.pop_front();
+  }
+}
+
+size_t ContentStore::size(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return payloads_.size();
+}
+
+uint64_t ContentStore::get_bytes(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return bytes_;
+}
+
+uint64_t ContentStore::get_duplicates(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return duplicates_;
+}
+
+uint64_t ContentStore::get_bytes_saved(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return bytes_saved_;
+}
+
+size_t ContentStore::prune(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  size_t result = 0;
+
+  for (auto i = payloads_.begin(); i != payloads_.end();)
+  {
+    if (i->second.use_count() == 1)
+    {
+      bytes_ -= i->second->size();
+      digests_.erase(i->second.get());
+      i = payloads_.erase(i);
+      ++result;
+    }
+    else
+    {
+      ++i;
+    }
+  }
+
+  return result;
+}
+
+void ContentStore::clear(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  payloads_.clear();
+  digests_.clear();
+  added_.clear();
+  bytes_ = 0;
+
+  for (auto& cursor : cursors_)
+  {
+    cursor.second = added_end_;
+  }
+  duplicates_ = 0;
+  bytes_saved_ = 0;
+}
+}
+}
@@ -0,0 +1,231 @@
+#ifndef _MADARA_KNOWLEDGE_CONTENT_STORE_H_
+#define _MADARA_KNOWLEDGE_CONTENT_STORE_H_
+
+/**
+ * @file ContentStore.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ContentStore class, which deduplicates binary
+ * record payloads by their SHA-256 digest
+ **/
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+#include "madara/LockType.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class ContentStore
+ * @brief Content-addressed store for file and binary payloads
+ *
+ * Payloads are keyed by their SHA-256 digest. Interning a payload returns
+ * the store's single copy of that content, so every record holding the
+ * same bytes shares one buffer. Records copy the buffer before modifying
+ * it, as they do for any shared payload.
+ *
+ * Attach a store to a knowledge base with
+ * KnowledgeBase::set_content_store to intern every file record on
+ * modification, and add a filters::ContentDedupFilter to the transport to
+ * send digests instead of payloads to peers that already have them.
+ *
+ * If a directory is set, payloads are also written there, named by their
+ * hex digest, so content survives restarts and pruning.
+ **/
+class MADARA_EXPORT ContentStore
+{
+public:
+  /// A shared, immutable payload
+  typedef std::shared_ptr<const std::vector<unsigned char>> Payload;
+
+  /**
+   * Constructor
+   * @param  min_size   payloads smaller than this are not interned
+   **/
+  ContentStore(size_t min_size = 1024);
+
+  /**
+   * Sets the smallest payload that will be interned. Hashing and tracking
+   * small payloads costs more than copying them.
+   * @param  min_size   minimum payload size in bytes
+   **/
+  void set_min_size(size_t min_size);
+
+  /**
+   * Returns the smallest payload that will be interned
+   * @return  minimum payload size in bytes
+   **/
+  size_t get_min_size(void) const;
+
+  /**
+   * Sets a directory for persisting payloads. Payloads already in the
+   * directory become available immediately. An empty string disables
+   * persistence.
+   * @param  directory   the directory to store payloads in
+   **/
+  void set_directory(const std::string& directory);
+
+  /**
+   * Returns the persistence directory
+   * @return  the directory, or an empty string if disabled
+   **/
+  std::string get_directory(void) const;
+
+  /**
+   * Adds a payload to the store, or finds the copy already in it
+   * @param  payload   the payload. Replaced with the store's copy if the
+   *                   same content is already stored.
+   * @return the digest of the payload, or an empty string if the payload
+   *         is smaller than the minimum size
+   **/
+  std::string intern(Payload& payload);
+
+  /**
+   * Returns the digest of a payload, hashing it only if it is not the
+   * store's own copy
+   * @param  payload   the payload
+   * @return the SHA-256 digest of the payload
+   **/
+  std::string digest(const Payload& payload) const;
+
+  /**
+   * Returns a stored payload
+   * @param  digest   the SHA-256 digest of the content
+   * @return the payload, or null if the content is not in the store
+   **/
+  Payload get(const std::string& digest);
+
+  /**
+   * Checks if content is in the store
+   * @param  digest   the SHA-256 digest of the content
+   * @return true if the content is in memory or in the directory
+   **/
+  bool has(const std::string& digest) const;
+
+  /**
+   * Returns the digests of all content in the store
+   * @return the digests in memory and in the directory
+   **/
+  std::vector<std::string> digests(void) const;
+
+  /**
+   * Opens a cursor over content interned from now on, so callers can tell
+   * others about new content without listing the whole store. Digests are
+   * kept until every open cursor has read them.
+   * @return  the cursor to pass to digests_since and close_cursor
+   **/
+  size_t open_cursor(void);
+
+  /**
+   * Closes a cursor. Digests that only it had not read are dropped.
+   * @param  cursor   a cursor from open_cursor
+   **/
+  void close_cursor(size_t cursor);
+
+  /**
+   * Returns the digests of content interned since the cursor was opened
+   * or last read
+   * @param  cursor   a cursor from open_cursor
+   * @return the new digests, or none if the cursor is not open
+   **/
+  std::vector<std::string> digests_since(size_t cursor);
+
+  /**
+   * Returns the number of payloads held in memory
+   * @return  the number of payloads
+   **/
+  size_t size(void) const;
+
+  /**
+   * Returns the bytes held in memory
+   * @return  the total size of payloads in memory
+   **/
+  uint64_t get_bytes(void) const;
+
+  /**
+   * Returns the number of interned payloads that matched stored content
+   * @return  the number of duplicates found
+   **/
+  uint64_t get_duplicates(void) const;
+
+  /**
+   * Returns the bytes not allocated because of duplicates
+   * @return  the total size of duplicate payloads
+   **/
+  uint64_t get_bytes_saved(void) const;
+
+  /**
+   * Drops payloads from memory that no record references. Dropped content
+   * remains available if it was persisted to the directory.
+   * @return  the number of payloads dropped
+   **/
+  size_t prune(void);
+
+  /**
+   * Drops all payloads from memory and resets statistics. Open cursors
+   * skip content interned before the clear. The directory, if any, is not
+   * modified.
+   **/
+  void clear(void);
+
+private:
+  /**
+   * Returns the persisted file name for a digest. Requires the lock.
+   **/
+  std::string get_path(const std::string& digest) const;
+
+  /**
+   * Drops digests that every open cursor has read. Requires the lock.
+   **/
+  void trim_added(void);
+
+  /// Guards all members
+  mutable MADARA_LOCK_TYPE mutex_;
+
+  /// Payloads by digest
+  std::unordered_map<std::string, Payload> payloads_;
+
+  /// Digests of the payloads, by the address of the stored copy
+  std::unordered_map<const void*, std::string> digests_;
+
+  /// Digests in the order they were first interned, while a cursor has
+  /// not read them
+  std::deque<std::string> added_;
+
+  /// Number of digests ever added, which is the position after added_
+  uint64_t added_end_ = 0;
+
+  /// Positions of the open cursors
+  std::map<size_t, uint64_t> cursors_;
+
+  /// The next cursor to open
+  size_t next_cursor_ = 0;
+
+  /// Minimum payload size to intern
+  size_t min_size_;
+
+  /// Persistence directory, if any
+  std::string directory_;
+
+  /// Total bytes in payloads_
+  uint64_t bytes_ = 0;
+
+  /// Number of duplicates found by intern
+  uint64_t duplicates_ = 0;
+
+  /// Bytes of duplicates found by intern
+  uint64_t bytes_saved_ = 0;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_CONTENT_STORE_H_
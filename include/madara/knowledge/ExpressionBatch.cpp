@@ -0,0 +1,305 @@
+#ifndef _MADARA_NO_KARL_
+
+#include "ExpressionBatch.h"
+
+#include <algorithm>
+
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/logger/GlobalLogger.h"
+
+namespace madara
+{
+namespace knowledge
+{
+namespace
+{
+/// the lower 32 bits of next_, which hold a position in the group
+const uint64_t POSITION_MASK = 0xffffffff;
+}
+
+ExpressionBatch::ExpressionBatch(KnowledgeBase& kb, size_t threads) : kb_(kb)
+{
+  if (threads == 0)
+  {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  // the thread calling evaluate is one of the threads
+  for (size_t i = 1; i < threads; ++i)
+  {
+    workers_.emplace_back(&ExpressionBatch::run, this);
+  }
+}
+
+ExpressionBatch::~ExpressionBatch()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    keep_running_ = false;
+  }
+
+  ready_.notify_all();
+
+  for (std::thread& worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+size_t ExpressionBatch::add(const std::string& logic)
+{
+  return add(kb_.compile(logic));
+}
+
+size_t ExpressionBatch::add(const CompiledExpression& logic)
+{
+  Entry entry;
+  entry.logic = logic;
+  entry.access = expression::AccessVisitor().analyze(entry.logic.get_root());
+
+  entries_.push_back(std::move(entry));
+  partitioned_ = false;
+
+  return entries_.size() - 1;
+}
+
+void ExpressionBatch::clear(void)
+{
+  entries_.clear();
+  groups_.clear();
+  partitioned_ = true;
+}
+
+size_t ExpressionBatch::size(void) const
+{
+  return entries_.size();
+}
+
+std::vector<std::vector<size_t>> ExpressionBatch::get_groups(void)
+{
+  partition();
+
+  return groups_;
+}
+
+void ExpressionBatch::partition(void)
+{
+  if (partitioned_)
+  {
+    return;
+  }
+
+  groups_.clear();
+
+  std::vector<size_t> levels(entries_.size(), 0);
+
+  for (size_t i = 0; i < entries_.size(); ++i)
+  {
+    // follow the last earlier expression this one conflicts with
+    for (size_t j = 0; j < i; ++j)
+    {
+      if (levels[j] >= levels[i] &&
+          entries_[i].access.conflicts(entries_[j].access))
+      {
+        levels[i] = levels[j] + 1;
+      }
+    }
+
+    if (levels[i] >= groups_.size())
+    {
+      groups_.resize(levels[i] + 1);
+    }
+
+    groups_[levels[i]].push_back(i);
+  }
+
+  partitioned_ = true;
+}
+
+std::vector<KnowledgeRecord> ExpressionBatch::evaluate(
+    const EvalSettings& settings)
+{
+  partition();
+
+  ThreadSafeContext& context = kb_.get_context();
+
+  madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+      "ExpressionBatch::evaluate:"
+      " evaluating %d expressions in %d groups.\n",
+      (int)entries_.size(), (int)groups_.size());
+
+  // print the pre statement at highest log level (cannot be masked)
+  if (settings.pre_print_statement != "")
+    context.print(settings.pre_print_statement, logger::LOG_ALWAYS);
+
+  results_.assign(entries_.size(), KnowledgeRecord());
+  errors_.assign(entries_.size(), nullptr);
+  settings_ = &settings;
+
+  {
+    ContextGuard guard(context);
+
+    for (const std::vector<size_t>& group : groups_)
+    {
+      evaluate_group(group);
+
+      // stop where sequential evaluation would have stopped
+      for (size_t index : group)
+      {
+        if (errors_[index])
+        {
+          std::rethrow_exception(errors_[index]);
+        }
+      }
+    }
+  }
+
+  kb_.send_modifieds("ExpressionBatch:evaluate", settings);
+
+  // print the post statement at highest log level (cannot be masked)
+  if (settings.post_print_statement != "")
+    context.print(settings.post_print_statement, logger::LOG_ALWAYS);
+
+  return std::move(results_);
+}
+
+void ExpressionBatch::evaluate_group(const std::vector<size_t>& group)
+{
+  // a lone expression gains nothing from the workers, and expressions
+  // with unbounded access are always alone
+  if (group.size() == 1 || workers_.empty())
+  {
+    for (size_t index : group)
+    {
+      evaluate_one(index, nullptr);
+    }
+
+    return;
+  }
+
+  ThreadSafeContext& context = kb_.get_context();
+
+  if (marks_.size() < group.size())
+  {
+    marks_.resize(group.size());
+  }
+
+  context.deferring_marks_ = true;
+
+  uint64_t round;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    round = ++round_;
+    group_ = &group;
+    finished_ = 0;
+    next_ = round << 32;
+  }
+
+  ready_.notify_all();
+
+  claim(group, group.size(), round);
+
+  {
+    std::unique_lock<std::mutex> guard(mutex_);
+
+    done_.wait(guard, [this, &group]() { return finished_ == group.size(); });
+
+    // workers that wake up late must not touch the group again
+    group_ = nullptr;
+  }
+
+  context.deferring_marks_ = false;
+
+  // apply the marks in the order sequential evaluation would have
+  for (size_t i = 0; i < group.size(); ++i)
+  {
+    for (ThreadSafeContext::DeferredMark& mark : marks_[i])
+    {
+      context.mark_and_signal(std::move(mark.ref), mark.settings);
+    }
+
+    marks_[i].clear();
+  }
+}
+
+void ExpressionBatch::claim(
+    const std::vector<size_t>& group, size_t size, uint64_t round)
+{
+  uint64_t next = next_.load();
+
+  // the group is only read after a claim succeeds, which proves the round
+  // has not ended and the group still exists
+  while ((next >> 32) == (round & POSITION_MASK) &&
+         (next & POSITION_MASK) < size)
+  {
+    if (next_.compare_exchange_weak(next, next + 1))
+    {
+      size_t position = (size_t)(next & POSITION_MASK);
+
+      evaluate_one(group[position], &marks_[position]);
+
+      if (++finished_ == size)
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        done_.notify_all();
+      }
+
+      next = next_.load();
+    }
+  }
+}
+
+void ExpressionBatch::evaluate_one(
+    size_t index, ThreadSafeContext::DeferredMarks* marks)
+{
+  ThreadSafeContext::defer_marks(marks);
+
+  try
+  {
+    expression::ComponentNode* root = entries_[index].logic.get_root();
+
+    if (root)
+    {
+      results_[index] = root->evaluate(*settings_);
+    }
+  }
+  catch (...)
+  {
+    errors_[index] = std::current_exception();
+  }
+
+  ThreadSafeContext::defer_marks(nullptr);
+}
+
+void ExpressionBatch::run(void)
+{
+  std::unique_lock<std::mutex> guard(mutex_);
+  uint64_t seen = 0;
+
+  while (true)
+  {
+    ready_.wait(guard, [this, &seen]() {
+      return !keep_running_ || (round_ != seen && group_ != nullptr);
+    });
+
+    if (!keep_running_)
+    {
+      break;
+    }
+
+    seen = round_;
+    const std::vector<size_t>& group = *group_;
+    size_t size = group.size();
+
+    // evaluate without mutex_, so other workers can claim expressions
+    guard.unlock();
+    claim(group, size, seen);
+    guard.lock();
+  }
+}
+}
+}
+
+#endif  // _MADARA_NO_KARL_
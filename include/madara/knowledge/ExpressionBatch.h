@@ -0,0 +1,221 @@
+#ifndef _MADARA_KNOWLEDGE_EXPRESSION_BATCH_H_
+#define _MADARA_KNOWLEDGE_EXPRESSION_BATCH_H_
+
+#ifndef _MADARA_NO_KARL_
+
+/**
+ * @file ExpressionBatch.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ExpressionBatch class, which evaluates
+ * independent compiled expressions concurrently
+ **/
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/CompiledExpression.h"
+#include "madara/knowledge/EvalSettings.h"
+#include "madara/expression/AccessVisitor.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class ExpressionBatch
+ * @brief Evaluates a list of compiled expressions on a pool of worker
+ *        threads, with the same results as evaluating them in order
+ *
+ * When an expression is added, the batch finds the variables it reads and
+ * writes. Two expressions conflict if one writes a variable the other
+ * reads or writes. Each expression is placed in the group after the last
+ * group holding an earlier expression it conflicts with, so expressions
+ * in a group are independent and every conflicting pair is evaluated in
+ * the order it was added.
+ *
+ * Expressions whose variables cannot be determined before evaluation,
+ * such as those with expanded names (var{.i}), function calls or system
+ * calls with side effects like #print, conflict with every other
+ * expression and are evaluated alone.
+ *
+ * The context is locked for the whole evaluation. Workers evaluate the
+ * expressions of a group concurrently, and the modifications they make
+ * are marked (queued for sending, checkpointing, snapshots and rules)
+ * in the order the expressions were added once the group is done.
+ *
+ * Adding and evaluating expressions is not thread safe. Use a batch from
+ * one thread at a time.
+ **/
+class MADARA_EXPORT ExpressionBatch
+{
+public:
+  /**
+   * Constructor. Starts the workers.
+   * @param  kb        the knowledge base expressions are evaluated in
+   * @param  threads   threads that evaluate a group, including the one
+   *                   calling evaluate. 0 uses one per hardware thread.
+   **/
+  ExpressionBatch(KnowledgeBase& kb, size_t threads = 0);
+
+  // workers hold a pointer back to this object, so it cannot be
+  // safely copied or moved
+  ExpressionBatch(const ExpressionBatch&) = delete;
+  ExpressionBatch(ExpressionBatch&&) = delete;
+  ExpressionBatch& operator=(const ExpressionBatch&) = delete;
+  ExpressionBatch& operator=(ExpressionBatch&&) = delete;
+
+  /**
+   * Destructor. Stops the workers.
+   **/
+  ~ExpressionBatch();
+
+  /**
+   * Adds an expression to the end of the batch
+   * @param  logic   KaRL logic to evaluate
+   * @return the index of the expression's result
+   * @throw exceptions::KarlException  the logic does not compile
+   **/
+  size_t add(const std::string& logic);
+
+  /**
+   * Adds an expression to the end of the batch
+   * @param  logic   compiled logic to evaluate
+   * @return the index of the expression's result
+   **/
+  size_t add(const CompiledExpression& logic);
+
+  /**
+   * Removes every expression
+   **/
+  void clear(void);
+
+  /**
+   * Returns the number of expressions
+   * @return the number of expressions added
+   **/
+  size_t size(void) const;
+
+  /**
+   * Returns the groups expressions are evaluated in
+   * @return indices of expressions, by group in evaluation order
+   **/
+  std::vector<std::vector<size_t>> get_groups(void);
+
+  /**
+   * Evaluates every expression
+   * @param  settings   settings to evaluate the expressions with
+   * @return the result of each expression, in the order they were added
+   * @throw  the exception thrown by the first failing expression, after
+   *         the rest of its group has been evaluated. Later groups are
+   *         not evaluated.
+   **/
+  std::vector<KnowledgeRecord> evaluate(
+      const EvalSettings& settings = EvalSettings::DEFAULT);
+
+private:
+  /// an expression and what it accesses
+  struct Entry
+  {
+    CompiledExpression logic;
+    expression::VariableAccess access;
+  };
+
+  /**
+   * Places expressions in groups if any were added since the last time
+   **/
+  void partition(void);
+
+  /**
+   * Evaluates the expressions of one group concurrently and applies
+   * their marks
+   * @param  group      indices of the expressions
+   **/
+  void evaluate_group(const std::vector<size_t>& group);
+
+  /**
+   * Evaluates unclaimed expressions of a group until none remain
+   * @param  group   indices of the group's expressions
+   * @param  size    the size of the group, read while it was current
+   * @param  round   the round the group is evaluated in
+   **/
+  void claim(const std::vector<size_t>& group, size_t size, uint64_t round);
+
+  /**
+   * Evaluates one expression, storing its result or exception
+   * @param  index   the index of the expression
+   * @param  marks   where to leave the expression's marks, or nullptr to
+   *                 apply them immediately
+   **/
+  void evaluate_one(size_t index, ThreadSafeContext::DeferredMarks* marks);
+
+  /**
+   * Waits for groups and helps evaluate them until the batch is destroyed
+   **/
+  void run(void);
+
+  /// the knowledge base expressions are evaluated in
+  KnowledgeBase kb_;
+
+  /// expressions in the order they were added
+  std::vector<Entry> entries_;
+
+  /// expression indices by group, valid if partitioned_
+  std::vector<std::vector<size_t>> groups_;
+
+  /// true if groups_ includes every expression
+  bool partitioned_ = true;
+
+  /// results of the current evaluation
+  std::vector<KnowledgeRecord> results_;
+
+  /// exceptions of the current evaluation
+  std::vector<std::exception_ptr> errors_;
+
+  /// marks made by each expression of the current group
+  std::vector<ThreadSafeContext::DeferredMarks> marks_;
+
+  /// settings of the current evaluation
+  const EvalSettings* settings_ = nullptr;
+
+  /// guards group_, round_ and keep_running_
+  std::mutex mutex_;
+
+  /// signals workers when a group is ready
+  std::condition_variable ready_;
+
+  /// signals evaluate when the last expression of a group is done
+  std::condition_variable done_;
+
+  /// the group being evaluated
+  const std::vector<size_t>* group_ = nullptr;
+
+  /// increases with every group, so late workers skip groups that ended
+  uint64_t round_ = 0;
+
+  /// the round in the upper 32 bits and the next unclaimed position in
+  /// the group in the lower 32 bits
+  std::atomic<uint64_t> next_ = {0};
+
+  /// expressions of the current group that are done
+  std::atomic<size_t> finished_ = {0};
+
+  /// false once the workers should exit
+  bool keep_running_ = true;
+
+  /// threads that help evaluate groups
+  std::vector<std::thread> workers_;
+};
+}
+}
+
+#endif  // _MADARA_NO_KARL_
+
+#endif  // _MADARA_KNOWLEDGE_EXPRESSION_BATCH_H_
@@ -8,6 +8,7 @@
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Crc32c.h"
 #include "madara/utility/ScopedArray.h"
 #include "madara/knowledge/containers/FlexMap.h"
 #include "madara/logger/GlobalLogger.h"
@@ -20,6 +21,11 @@ namespace knowledge
  * @class FileRequester
  * @brief A helper class that can reconstruct files or request files
  * be transferred in fragments from a Madara File Service (MFS)
+ *
+ * Saved fragments are checked against the manifest kept by
+ * FragmentsToFilesFilter, so an interrupted transfer resumes by requesting
+ * only fragments that are missing or fail their CRC-32C checksum. Each
+ * fragment is read and verified at most once per requester.
  */
 class FileRequester
 {
@@ -117,19 +123,11 @@ public:
   {
     double result = 0;
 
-    size_t expected_size = get_size();
-    size_t num_fragments = expected_size / 60000;
-
-    if (expected_size % 60000 > 0)
-    {
-      ++num_fragments;
-    }
+    update_verified();
 
-    if (num_fragments > 0)
+    if (verified_size_ > 0)
     {
-      result = (double)utility::get_file_progress(
-                   filename_, get_crc(), get_size(), max_fragments) /
-               (double)get_size();
+      result = (double)verified_bytes_ / (double)verified_size_;
 
       result *= 100;
     }
@@ -139,12 +137,29 @@ public:
 
   /**
    * Builds fragment request to send
-   * @return the list of missing fragments for the file
+   * @return the list of missing or corrupt fragments for the file
    **/
   inline std::vector<int64_t> build_fragment_request(void)
   {
-    return utility::get_file_missing_fragments(
-        filename_, get_crc(), get_size(), max_fragments);
+    std::vector<int64_t> result;
+
+    update_verified();
+
+    for (size_t i = 0; i < verified_.size(); ++i)
+    {
+      // do we already have enough fragments?
+      if (max_fragments >= 0 && result.size() >= (size_t)max_fragments)
+      {
+        break;
+      }
+
+      if (!verified_[i])
+      {
+        result.push_back((int64_t)i);
+      }
+    }
+
+    return result;
   }
 
   /**
@@ -209,6 +224,11 @@ public:
         remove(frag_file.c_str());
       }
     }
+
+    remove(utility::get_fragment_manifest_name(filename_, get_crc()).c_str());
+
+    verified_.clear();
+    verified_bytes_ = 0;
   }
 
   /**
@@ -223,6 +243,88 @@ public:
   int max_fragments;
 
 private:
+  /**
+   * Verifies fragments saved since the last call against the manifest.
+   * Corrupt fragments are removed so they can be requested again.
+   **/
+  inline void update_verified(void)
+  {
+    const size_t fragment_size = 60000;
+
+    uint32_t crc = get_crc();
+    size_t size = get_size();
+    size_t num_fragments = (size + fragment_size - 1) / fragment_size;
+
+    // a different file (or version of it) starts over
+    if (crc != verified_crc_ || size != verified_size_ ||
+        verified_.size() != num_fragments)
+    {
+      verified_.assign(num_fragments, false);
+      verified_bytes_ = 0;
+      verified_crc_ = crc;
+      verified_size_ = size;
+    }
+
+    if (verified_bytes_ == size)
+    {
+      return;
+    }
+
+    std::map<int64_t, uint32_t> manifest =
+        utility::read_fragment_manifest(filename_, crc);
+    std::string frag_suffix =
+        "." + std::to_string((unsigned long)crc) + ".frag";
+    std::vector<char> buffer;
+
+    for (size_t i = 0; i < num_fragments; ++i)
+    {
+      if (verified_[i])
+      {
+        continue;
+      }
+
+      std::string frag_file = filename_ + "." + std::to_string(i) + frag_suffix;
+      size_t expected =
+          i + 1 < num_fragments ? fragment_size : size - i * fragment_size;
+
+      if (!utility::file_exists(frag_file) ||
+          utility::file_size(frag_file) != expected)
+      {
+        continue;
+      }
+
+      auto entry = manifest.find((int64_t)i);
+
+      if (entry != manifest.end())
+      {
+        std::ifstream input(frag_file, std::ios::in | std::ios::binary);
+        buffer.resize(expected);
+        input.read(buffer.data(), expected);
+
+        if ((size_t)input.gcount() != expected ||
+            utility::crc32c(buffer.data(), expected) != entry->second)
+        {
+          madara_logger_ptr_log(logger::global_logger.get(),
+              logger::LOG_MAJOR,
+              "FileRequester::update_verified: removing corrupt %s\n",
+              frag_file.c_str());
+
+          remove(frag_file.c_str());
+          continue;
+        }
+      }
+      else if (!manifest.empty())
+      {
+        // saved but not yet recorded in the manifest. Without a manifest
+        // at all, the fragments predate manifests and only sizes are known.
+        continue;
+      }
+
+      verified_[i] = true;
+      verified_bytes_ += expected;
+    }
+  }
+
   /**
    * The key that is being synced to
    **/
@@ -239,6 +341,18 @@ private:
 
   /// saves the kb for general usage
   knowledge::KnowledgeBase kb_;
+
+  /// fragments that have been saved and verified
+  std::vector<bool> verified_;
+
+  /// bytes in verified fragments
+  size_t verified_bytes_ = 0;
+
+  /// crc of the file the verified fragments belong to
+  uint32_t verified_crc_ = 0;
+
+  /// size of the file the verified fragments belong to
+  size_t verified_size_ = 0;
 };
 }
 }
@@ -7,10 +7,16 @@
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Crc32c.h"
 #include "madara/utility/ScopedArray.h"
 #include "madara/knowledge/containers/FlexMap.h"
 #include "madara/logger/GlobalLogger.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace madara
 {
 namespace knowledge
@@ -19,6 +25,10 @@ namespace knowledge
  * @class FileStreamer
  * @brief Splits files into fragments that can be saved to and loaded from
  * a knowledge base
+ *
+ * Each fragment is saved to {key}.contents.{index} along with its CRC-32C
+ * checksum in {key}.checksums.{index}, so receivers can verify fragments
+ * individually and request only those that are missing or corrupt.
  */
 class FileStreamer
 {
@@ -28,6 +38,18 @@ public:
    **/
   FileStreamer() {}
 
+  /**
+   * Destructor
+   **/
+  ~FileStreamer()
+  {
+    close();
+  }
+
+  /// the streamer owns its open file, so copies are not allowed
+  FileStreamer(const FileStreamer&) = delete;
+  FileStreamer& operator=(const FileStreamer&) = delete;
+
   /**
    * Constructor
    * @param key        the location in the knowledge base to save to
@@ -54,7 +76,9 @@ public:
     file_space["size"].to_container(file_size);
     file_space["crc"].to_container(file_crc);
     file_space["contents"].to_container(file_fragments);
+    file_space["checksums"].to_container(file_checksums);
     file_fragments.clear();
+    file_checksums.clear();
 
     file_crc.set_name(file_space["crc"].get_name(), kb);
     file_size.set_name(file_space["size"].get_name(), kb);
@@ -64,35 +88,46 @@ public:
     file_crc = (KnowledgeRecord::Integer)utility::file_crc(filename);
     file_size = (KnowledgeRecord::Integer)utility::file_size(filename);
 
+    close();
+
+#ifndef _WIN32
+    fd_ = ::open(filename.c_str(), O_RDONLY);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    // fragments are usually sent in order, so ask for aggressive read-ahead
+    if (fd_ >= 0)
+      posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#else
     stream_.open(filename, std::ios::in | std::ios::binary);
+#endif
   }
 
   /**
-   * Loads a fragment into the knowledge base
+   * Loads a fragment and its checksum into the knowledge base
+   * @param  index      the fragment to load
+   * @param  frag_size  the size of each fragment
+   * @return the number of bytes in the fragment
    **/
   inline size_t load(size_t index, size_t frag_size = 60000)
   {
     size_t bytes_read = 0;
+    std::vector<unsigned char> frag(frag_size);
 
-    if (stream_)
-    {
-      // seek to the index position in the file
-      stream_.seekg((std::streampos)index * frag_size, std::ios::beg);
-
-      // read the fragment into a local buffer
-      std::vector<unsigned char> frag(frag_size);
-      // char * frag = new char [frag_size];
-      stream_.read((char*)frag.data(), frag_size);
-      bytes_read = stream_.gcount();
-      frag.resize(bytes_read);
-
-      KnowledgeRecord record;
-      record.emplace_file(std::move(frag));
-
-      // set the file fragment into the KB
-      file_fragments.set(std::to_string((unsigned long long)index), record);
-      // file_fragments.emplace_file ()
-    }
+    if (!read(index, frag_size, frag.data(), bytes_read))
+      return 0;
+
+    frag.resize(bytes_read);
+
+    std::string name = std::to_string((unsigned long long)index);
+    uint32_t checksum = utility::crc32c(frag.data(), bytes_read);
+    file_checksums.set(name, (KnowledgeRecord::Integer)checksum);
+
+    KnowledgeRecord record;
+    record.emplace_file(std::move(frag));
+
+    // set the file fragment into the KB
+    file_fragments.set(name, record);
 
     return bytes_read;
   }
@@ -130,6 +165,7 @@ public:
   inline void clear_fragments(void)
   {
     file_fragments.clear();
+    file_checksums.clear();
   }
 
   /**
@@ -150,15 +186,90 @@ public:
   /// the crc of the file
   containers::Integer file_crc;
 
-  /// the crc of the file
+  /// the file fragments
   containers::Map file_fragments;
 
+  /// the CRC-32C checksums of the file fragments
+  containers::Map file_checksums;
+
 private:
+  /**
+   * Reads a fragment from the file
+   * @param  index       the fragment to read
+   * @param  frag_size   the size of each fragment
+   * @param  buffer      buffer of at least frag_size bytes to read into
+   * @param  bytes_read  set to the number of bytes read
+   * @return true if the file could be read
+   **/
+  inline bool read(size_t index, size_t frag_size, unsigned char* buffer,
+      size_t& bytes_read)
+  {
+    bytes_read = 0;
+
+#ifndef _WIN32
+    if (fd_ < 0)
+      return false;
+
+    off_t offset = (off_t)index * frag_size;
+
+    // pread doesn't move a shared file position, so there is no seek
+    while (bytes_read < frag_size)
+    {
+      ssize_t result = ::pread(fd_, buffer + bytes_read,
+          frag_size - bytes_read, offset + bytes_read);
+
+      if (result <= 0)
+        break;
+
+      bytes_read += (size_t)result;
+    }
+
+#ifdef POSIX_FADV_WILLNEED
+    // start reading the next fragment while this one is being sent
+    posix_fadvise(fd_, offset + frag_size, frag_size, POSIX_FADV_WILLNEED);
+#endif
+
+    return true;
+#else
+    if (!stream_)
+      return false;
+
+    stream_.clear();
+    stream_.seekg((std::streampos)index * frag_size, std::ios::beg);
+    stream_.read((char*)buffer, frag_size);
+    bytes_read = stream_.gcount();
+
+    return true;
+#endif
+  }
+
+  /**
+   * Closes the file
+   **/
+  inline void close(void)
+  {
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+      ::close(fd_);
+      fd_ = -1;
+    }
+#else
+    if (stream_.is_open())
+      stream_.close();
+#endif
+  }
+
   /// the name of the file
   std::string filename_;
 
+#ifndef _WIN32
+  /// the file descriptor to read from
+  int fd_ = -1;
+#else
   /// the stream to read from
   std::ifstream stream_;
+#endif
 };
 }
 }
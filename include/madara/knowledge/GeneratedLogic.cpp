@@ -0,0 +1,43 @@
+#include "GeneratedLogic.h"
+
+namespace madara
+{
+namespace knowledge
+{
+GeneratedLogic::GeneratedLogic(std::vector<std::string> keys)
+  : keys_(std::move(keys))
+{
+}
+
+const VariableReference* GeneratedLogic::bind(ThreadSafeContext& context)
+{
+  Binding* binding;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    binding = &bindings_[&context];
+  }
+
+  // generations are unique across contexts, so a stale binding left by a
+  // destroyed context at the same address is never mistaken for current
+  uint64_t generation = context.get_erase_generation();
+
+  if (binding->generation != generation)
+  {
+    binding->refs.clear();
+    binding->refs.reserve(keys_.size());
+
+    // keys were expanded when the logic was generated
+    KnowledgeReferenceSettings settings(false);
+
+    for (const std::string& key : keys_)
+    {
+      binding->refs.push_back(context.get_ref(key, settings));
+    }
+
+    binding->generation = generation;
+  }
+
+  return binding->refs.data();
+}
+}
+}
@@ -0,0 +1,148 @@
+#ifndef _MADARA_KNOWLEDGE_GENERATED_LOGIC_H_
+#define _MADARA_KNOWLEDGE_GENERATED_LOGIC_H_
+
+/**
+ * @file GeneratedLogic.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the GeneratedLogic class, the runtime support for
+ * C++ functions generated from KaRL logic by the karl2cpp tool
+ **/
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/FunctionArguments.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/knowledge/KnowledgeUpdateSettings.h"
+#include "madara/knowledge/VariableReference.h"
+
+namespace madara
+{
+namespace knowledge
+{
+class Variables;
+
+/**
+ * @struct GeneratedFunction
+ * @brief A function generated by karl2cpp and the logic it came from
+ **/
+struct GeneratedFunction
+{
+  /// the name the function is defined under
+  const char* name;
+
+  /// the KaRL logic the function was generated from
+  const char* source;
+
+  /// the generated function, suitable for KnowledgeBase::define_function
+  KnowledgeRecord (*function)(FunctionArguments&, Variables&);
+
+  /// true if the logic could not be translated and is interpreted instead
+  bool interpreted;
+};
+
+/**
+ * @class GeneratedLogic
+ * @brief The variables used by one piece of generated logic, resolved to
+ *        VariableReferences once per context
+ *
+ * Generated functions keep a static instance listing the variables they
+ * use and call bind at the start of every evaluation. References are
+ * resolved the first time a context is seen and again only after records
+ * are erased from it, so evaluation does no name lookups.
+ *
+ * The static accessors read and modify records exactly as the
+ * interpreter's variable nodes do, so generated logic produces the same
+ * values, qualities and modification lists as interpreted logic.
+ **/
+class MADARA_EXPORT GeneratedLogic
+{
+public:
+  /**
+   * Constructor
+   * @param  keys   the names of the variables the logic uses
+   **/
+  GeneratedLogic(std::vector<std::string> keys);
+
+  /**
+   * Resolves the variables in a context. Requires the context lock, which
+   * must be held for as long as the references are used.
+   * @param  context   the context the logic is evaluated in
+   * @return references in the order of the keys given to the constructor
+   **/
+  const VariableReference* bind(ThreadSafeContext& context);
+
+  /**
+   * Reads a variable
+   * @param  ref       the variable
+   * @param  settings  settings for the evaluation
+   * @return a copy of the variable's record
+   * @throw exceptions::UninitializedException  the variable is unset and
+   *        settings do not allow reads of unset variables
+   **/
+  static KnowledgeRecord get(
+      const VariableReference& ref, const KnowledgeUpdateSettings& settings);
+
+  /**
+   * Assigns a variable, unless a higher quality writer owns it
+   * @param  context   the context the variable belongs to
+   * @param  ref       the variable
+   * @param  value     the new value
+   * @param  settings  settings for the evaluation
+   **/
+  static void set(ThreadSafeContext& context, const VariableReference& ref,
+      const KnowledgeRecord& value, const KnowledgeUpdateSettings& settings);
+
+  /**
+   * Increments a variable, unless a higher quality writer owns it
+   * @param  context   the context the variable belongs to
+   * @param  ref       the variable
+   * @param  settings  settings for the evaluation
+   * @return the variable's value afterwards
+   **/
+  static KnowledgeRecord inc(ThreadSafeContext& context,
+      const VariableReference& ref, const KnowledgeUpdateSettings& settings);
+
+  /**
+   * Decrements a variable, unless a higher quality writer owns it
+   * @param  context   the context the variable belongs to
+   * @param  ref       the variable
+   * @param  settings  settings for the evaluation
+   * @return the variable's value afterwards
+   **/
+  static KnowledgeRecord dec(ThreadSafeContext& context,
+      const VariableReference& ref, const KnowledgeUpdateSettings& settings);
+
+private:
+  /// references into one context
+  struct Binding
+  {
+    /// the context's erase generation when the references were resolved
+    uint64_t generation = 0;
+
+    /// references in the order of keys_
+    std::vector<VariableReference> refs;
+  };
+
+  /// the names of the variables the logic uses
+  std::vector<std::string> keys_;
+
+  /// guards the bindings_ map, but not the bindings themselves, which are
+  /// guarded by their contexts' locks
+  std::mutex mutex_;
+
+  /// references by context. Map nodes are never moved, so a binding stays
+  /// valid while other contexts are added.
+  std::map<const ThreadSafeContext*, Binding> bindings_;
+};
+}
+}
+
+#include "GeneratedLogic.inl"
+
+#endif  // _MADARA_KNOWLEDGE_GENERATED_LOGIC_H_
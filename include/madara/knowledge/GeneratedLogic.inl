@@ -0,0 +1,91 @@
+#ifndef _MADARA_KNOWLEDGE_GENERATED_LOGIC_INL_
+#define _MADARA_KNOWLEDGE_GENERATED_LOGIC_INL_
+
+#include <sstream>
+
+#include "madara/exceptions/UninitializedException.h"
+
+/**
+ * @file GeneratedLogic.inl
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the inline record accessors of the
+ * knowledge::GeneratedLogic class
+ **/
+
+namespace madara
+{
+namespace knowledge
+{
+inline KnowledgeRecord GeneratedLogic::get(
+    const VariableReference& ref, const KnowledgeUpdateSettings& settings)
+{
+  const KnowledgeRecord* record = ref.get_record_unsafe();
+
+  if (settings.exception_on_unitialized && !record->exists())
+  {
+    std::stringstream buffer;
+    buffer << "madara::knowledge::GeneratedLogic::get: ";
+    buffer << "ERROR: settings do not allow reads of unset vars and ";
+    buffer << ref.get_name() << " is uninitialized";
+    throw exceptions::UninitializedException(buffer.str());
+  }
+
+  return *record;
+}
+
+inline void GeneratedLogic::set(ThreadSafeContext& context,
+    const VariableReference& ref, const KnowledgeRecord& value,
+    const KnowledgeUpdateSettings& settings)
+{
+  KnowledgeRecord* record = ref.get_record_unsafe();
+
+  if (!settings.always_overwrite && record->write_quality < record->quality)
+  {
+    return;
+  }
+
+  if (record->write_quality != record->quality)
+    record->quality = record->write_quality;
+
+  *record = value;
+  context.mark_and_signal(ref);
+}
+
+inline KnowledgeRecord GeneratedLogic::inc(ThreadSafeContext& context,
+    const VariableReference& ref, const KnowledgeUpdateSettings& settings)
+{
+  KnowledgeRecord* record = ref.get_record_unsafe();
+
+  if (!settings.always_overwrite && record->write_quality < record->quality)
+    return *record;
+
+  if (record->write_quality != record->quality)
+    record->quality = record->write_quality;
+
+  ++(*record);
+  context.mark_and_signal(ref);
+
+  return *record;
+}
+
+inline KnowledgeRecord GeneratedLogic::dec(ThreadSafeContext& context,
+    const VariableReference& ref, const KnowledgeUpdateSettings& settings)
+{
+  KnowledgeRecord* record = ref.get_record_unsafe();
+
+  if (!settings.always_overwrite && record->write_quality < record->quality)
+    return *record;
+
+  if (record->write_quality != record->quality)
+    record->quality = record->write_quality;
+
+  --(*record);
+  context.mark_and_signal(ref);
+
+  return *record;
+}
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_GENERATED_LOGIC_INL_
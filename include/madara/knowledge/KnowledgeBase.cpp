@@ -124,5 +124,13 @@ KnowledgeRecord KnowledgeBase::wait(
   return result;
 }
 #endif  // _MADARA_NO_KARL_
+
+KnowledgeBase KnowledgeBase::fork(void)
+{
+  KnowledgeBase result;
+  result.get_context().load_snapshot(snapshot());
+
+  return result;
+}
 }
 }
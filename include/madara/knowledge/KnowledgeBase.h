@@ -901,6 +901,28 @@ public:
    **/
   CompiledExpression compile(const std::string& expression);
 
+  /**
+   * Returns the hit, miss and eviction counts of the cache that compile
+   * and evaluate use to avoid recompiling the same logic
+   *
+   * @return                   the compiled expression cache statistics
+   **/
+  expression::ExpressionCacheStats get_expression_cache_stats(void) const;
+
+  /**
+   * Sets the most compiled expressions to cache. When the cache is full,
+   * the least recently used expression is evicted. CompiledExpressions
+   * held by the caller remain valid after eviction.
+   *
+   * @param capacity           the capacity. 0 disables caching.
+   **/
+  void set_expression_cache_capacity(size_t capacity);
+
+  /**
+   * Removes all compiled expressions from the cache
+   **/
+  void clear_expression_cache(void);
+
   /**
    * Evaluates an expression
    *
@@ -1584,6 +1606,79 @@ public:
     throw_null_context();
   }
 
+  /**
+   * Attach a content store. Once attached, the payload of every file
+   * record is interned in the store when the record is modified, so
+   * records with identical contents share one buffer. Share one store
+   * between knowledge bases to deduplicate across them. May pass nullptr
+   * to stop interning.
+   *
+   * @param store the store to attach
+   * @return the old store, or nullptr if there wasn't any.
+   **/
+  std::shared_ptr<ContentStore> set_content_store(
+      std::shared_ptr<ContentStore> store)
+  {
+    if (impl_)
+    {
+      return impl_->set_content_store(std::move(store));
+    }
+    else if (context_)
+    {
+      return context_->set_content_store(std::move(store));
+    }
+    throw_null_context();
+  }
+
+  /**
+   * Returns the attached content store
+   * @return the store, or nullptr if there isn't one
+   **/
+  std::shared_ptr<ContentStore> get_content_store(void) const
+  {
+    if (impl_)
+    {
+      return impl_->get_content_store();
+    }
+    else if (context_)
+    {
+      return context_->get_content_store();
+    }
+    throw_null_context();
+  }
+
+  /**
+   * Takes an immutable snapshot of every record. Repeated snapshots share
+   * structure, so each costs time proportional to the records modified
+   * since the previous one. @see KnowledgeSnapshot
+   *
+   * @return the snapshot
+   **/
+  KnowledgeSnapshot::Ptr snapshot(void)
+  {
+    if (impl_)
+    {
+      return impl_->snapshot();
+    }
+    else if (context_)
+    {
+      return context_->snapshot();
+    }
+    throw_null_context();
+  }
+
+  /**
+   * Creates a knowledge base holding a copy of this one's records. Taking
+   * the copy costs the same as snapshot(), and records are copied into
+   * the fork only as it accesses them, so forking and changing a few
+   * records is cheap however large this knowledge base is. Changes to
+   * either knowledge base are not seen by the other. The fork has no
+   * transports and does not share functions defined with define_function.
+   *
+   * @return the fork
+   **/
+  KnowledgeBase fork(void);
+
   /**
    * Loads the context from a file
    * @param   filename    name of the file to open
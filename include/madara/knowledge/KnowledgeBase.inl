@@ -1147,6 +1147,22 @@ inline CompiledExpression KnowledgeBase::compile(const std::string& expression)
   return result;
 }
 
+inline expression::ExpressionCacheStats
+KnowledgeBase::get_expression_cache_stats(void) const
+{
+  return get_context().get_expression_cache_stats();
+}
+
+inline void KnowledgeBase::set_expression_cache_capacity(size_t capacity)
+{
+  get_context().set_expression_cache_capacity(capacity);
+}
+
+inline void KnowledgeBase::clear_expression_cache(void)
+{
+  get_context().clear_expression_cache();
+}
+
 // evaluate a knowledge expression and choose to send any modifications
 inline KnowledgeRecord KnowledgeBase::evaluate(
     const std::string& expression, const EvalSettings& settings)
@@ -465,6 +465,15 @@ int KnowledgeBaseImpl::send_modifieds(
         madara_logger_log(map_.get_logger(), logger::LOG_DETAILED,
             "%s: no modifications to send\n", prefix.c_str());
 
+        // records deferred by send priorities still need to go out
+        for (auto& transport : transports)
+        {
+          if (transport->has_deferred_updates())
+          {
+            transport->send_data(modified);
+          }
+        }
+
         return -1;
       }
 
@@ -939,6 +939,39 @@ public:
     return map_.attach_streamer(std::move(streamer));
   }
 
+  /**
+   * Attach a content store. Once attached, the payload of every file
+   * record is interned in the store when the record is modified, so
+   * records with identical contents share one buffer. May pass nullptr
+   * to stop interning.
+   *
+   * @param store the store to attach
+   * @return the old store, or nullptr if there wasn't any.
+   **/
+  std::shared_ptr<ContentStore> set_content_store(
+      std::shared_ptr<ContentStore> store)
+  {
+    return map_.set_content_store(std::move(store));
+  }
+
+  /**
+   * Returns the attached content store
+   * @return the store, or nullptr if there isn't one
+   **/
+  std::shared_ptr<ContentStore> get_content_store(void) const
+  {
+    return map_.get_content_store();
+  }
+
+  /**
+   * Takes an immutable snapshot of every record
+   * @return the snapshot
+   **/
+  KnowledgeSnapshot::Ptr snapshot(void)
+  {
+    return map_.snapshot();
+  }
+
   /**
    * Loads the context from a file
    * @param   filename    name of the file to open
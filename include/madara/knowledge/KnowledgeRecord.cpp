@@ -127,7 +127,7 @@ ssize_t KnowledgeRecord::to_file(const std::string& filename) const
   if (is_string_type(type_))
   {
     return madara::utility::write_file(
-        filename, (void*)str_value_->c_str(), str_value_->size());
+        filename, (void*)string_data(), string_size());
   }
   else if (is_binary_file_type(type_))
   {
@@ -162,8 +162,12 @@ double KnowledgeRecord::to_double(void) const
 
   if (type_ == DOUBLE)
     value = double_value_;
+  else if (type_ == INTEGER)
+    value = (double)int_value_;
   else if (type_ == DOUBLE_ARRAY)
     value = double_array_->size() == 0 ? 0 : double_array_->at(0);
+  else if (type_ == INTEGER_ARRAY)
+    value = int_array_->size() == 0 ? 0 : (double)int_array_->at(0);
   else if (has_history())
     value = ref_newest().to_double();
   else
@@ -171,12 +175,8 @@ double KnowledgeRecord::to_double(void) const
     std::stringstream buffer;
 
     // read the value_ into a stringstream and then convert it to double
-    if (type_ == INTEGER)
-      buffer << int_value_;
-    else if (type_ == INTEGER_ARRAY)
-      buffer << (int_array_->size() == 0 ? 0 : int_array_->at(0));
-    else if (is_string_type(type_))
-      buffer << str_value_->c_str();
+    if (is_string_type(type_))
+      buffer << string_data();
 
     buffer >> value;
   }
@@ -195,6 +195,11 @@ KnowledgeRecord::Integer KnowledgeRecord::to_integer(void) const
 
   if (type_ == INTEGER)
     value = int_value_;
+  else if (type_ == DOUBLE && double_value_ > -9.2e18 &&
+           double_value_ < 9.2e18)
+    // in-range doubles truncate directly. NAN, infinities and huge values
+    // are left to the stream conversion below
+    value = (Integer)double_value_;
   else if (type_ == INTEGER_ARRAY)
     value = int_array_->size() == 0 ? 0 : int_array_->at(0);
   else if (has_history())
@@ -209,7 +214,7 @@ KnowledgeRecord::Integer KnowledgeRecord::to_integer(void) const
     else if (type_ == DOUBLE_ARRAY)
       buffer << (double_array_->size() == 0 ? 0 : double_array_->at(0));
     else if (is_string_type(type_))
-      buffer << str_value_->c_str();
+      buffer << string_data();
 
     buffer >> value;
   }
@@ -256,7 +261,7 @@ std::vector<KnowledgeRecord::Integer> KnowledgeRecord::to_integers(void) const
   }
   else if (is_string_type(type_))
   {
-    const char* ptr_temp = str_value_->c_str();
+    const char* ptr_temp = string_data();
 
     for (unsigned int i = 0; i < size; ++i)
       integers[i] = Integer(ptr_temp[i]);
@@ -309,7 +314,7 @@ std::vector<double> KnowledgeRecord::to_doubles(void) const
   }
   else if (is_string_type(type_))
   {
-    const char* ptr_temp = str_value_->c_str();
+    const char* ptr_temp = string_data();
 
     for (unsigned int i = 0; i < size; ++i)
       doubles[i] = double(ptr_temp[i]);
@@ -340,7 +345,7 @@ std::string KnowledgeRecord::to_string(const std::string& delimiter) const
 
   if (type_ == ANY)
   {
-    return any_value_->to_json();
+    return any_ptr()->to_json();
   }
 
   if (!is_string_type(type_))
@@ -459,7 +464,7 @@ std::string KnowledgeRecord::to_string(const std::string& delimiter) const
     return buffer.str();
   }
   else
-    return std::string(*str_value_);
+    return std::string(string_data(), string_size());
 }
 
 // read the value_ in a string format
@@ -469,9 +474,9 @@ unsigned char* KnowledgeRecord::to_unmanaged_buffer(size_t& size) const
 
   if (is_string_type(type_))
   {
-    size = str_value_->size();
+    size = string_size();
     buffer = new char[size];
-    memcpy(buffer, str_value_->c_str(), size);
+    memcpy(buffer, string_data(), size);
   }
   else if (is_binary_file_type(type_))
   {
@@ -532,7 +537,7 @@ KnowledgeRecord KnowledgeRecord::fragment(unsigned int first, unsigned int last)
 
   if (is_string_type(type_))
   {
-    unsigned int size = (unsigned int)str_value_->size();
+    unsigned int size = (unsigned int)string_size();
 
     // make sure last is accessible in the data type
     last = std::min<unsigned int>(last, size - 1);
@@ -540,7 +545,7 @@ KnowledgeRecord KnowledgeRecord::fragment(unsigned int first, unsigned int last)
     // Create a new buffer, copy over the elements, and add a null delimiter
     char* new_buffer = new char[last - first + 2];
 
-    memcpy(new_buffer, str_value_->c_str() + first, last - first + 1);
+    memcpy(new_buffer, string_data() + first, last - first + 1);
     new_buffer[last - first + 1] = 0;
 
     ret.set_value(new_buffer);
@@ -601,6 +606,15 @@ KnowledgeRecord KnowledgeRecord::fragment(unsigned int first, unsigned int last)
 
 bool KnowledgeRecord::operator<(const knowledge::KnowledgeRecord& rhs) const
 {
+  // scalar fast path: compare inline values without conversions
+  if (MADARA_LIKELY(is_scalar_type(type_) && is_scalar_type(rhs.type_)))
+  {
+    if (type_ == INTEGER && rhs.type_ == INTEGER)
+      return int_value_ < rhs.int_value_;
+
+    return scalar_as_double() < rhs.scalar_as_double();
+  }
+
   if (has_history())
   {
     return (rhs.buf_->empty() ? KnowledgeRecord{} : ref_newest())
@@ -640,7 +654,7 @@ bool KnowledgeRecord::operator<(const knowledge::KnowledgeRecord& rhs) const
     // string to string comparison
     if (is_string_type(rhs.type_))
     {
-      result = strncmp(str_value_->c_str(), rhs.str_value_->c_str(),
+      result = strncmp(string_data(), rhs.string_data(),
                    size() >= rhs.size() ? size() : rhs.size()) < 0;
     }
 
@@ -696,6 +710,15 @@ bool KnowledgeRecord::operator<(const knowledge::KnowledgeRecord& rhs) const
 
 bool KnowledgeRecord::operator<=(const knowledge::KnowledgeRecord& rhs) const
 {
+  // scalar fast path: compare inline values without conversions
+  if (MADARA_LIKELY(is_scalar_type(type_) && is_scalar_type(rhs.type_)))
+  {
+    if (type_ == INTEGER && rhs.type_ == INTEGER)
+      return int_value_ <= rhs.int_value_;
+
+    return scalar_as_double() <= rhs.scalar_as_double();
+  }
+
   if (has_history())
   {
     return (rhs.buf_->empty() ? KnowledgeRecord{} : ref_newest())
@@ -735,7 +758,7 @@ bool KnowledgeRecord::operator<=(const knowledge::KnowledgeRecord& rhs) const
     // string to string comparison
     if (is_string_type(rhs.type_))
     {
-      result = strncmp(str_value_->c_str(), rhs.str_value_->c_str(),
+      result = strncmp(string_data(), rhs.string_data(),
                    size() >= rhs.size() ? size() : rhs.size()) <= 0;
     }
 
@@ -791,6 +814,15 @@ bool KnowledgeRecord::operator<=(const knowledge::KnowledgeRecord& rhs) const
 
 bool KnowledgeRecord::operator==(const knowledge::KnowledgeRecord& rhs) const
 {
+  // scalar fast path: compare inline values without conversions
+  if (MADARA_LIKELY(is_scalar_type(type_) && is_scalar_type(rhs.type_)))
+  {
+    if (type_ == INTEGER && rhs.type_ == INTEGER)
+      return int_value_ == rhs.int_value_;
+
+    return scalar_as_double() == rhs.scalar_as_double();
+  }
+
   if (has_history())
   {
     return (rhs.buf_->empty() ? KnowledgeRecord{} : ref_newest())
@@ -827,8 +859,8 @@ bool KnowledgeRecord::operator==(const knowledge::KnowledgeRecord& rhs) const
     }
     else if (is_string_type(rhs.type_))
     {
-      if (rhs.size() > 0 && rhs.str_value_->at(0) >= '0' &&
-          rhs.str_value_->at(0) <= '9')
+      if (rhs.size() > 0 && rhs.string_data()[0] >= '0' &&
+          rhs.string_data()[0] <= '9')
       {
         result = to_double() == rhs.to_double();
       }
@@ -843,7 +875,7 @@ bool KnowledgeRecord::operator==(const knowledge::KnowledgeRecord& rhs) const
     // string to string comparison
     if (is_string_type(rhs.type_))
     {
-      result = strncmp(str_value_->c_str(), rhs.str_value_->c_str(),
+      result = strncmp(string_data(), rhs.string_data(),
                    size() >= rhs.size() ? size() : rhs.size()) == 0;
     }
 
@@ -864,8 +896,8 @@ bool KnowledgeRecord::operator==(const knowledge::KnowledgeRecord& rhs) const
     // default is string to integer comparison
     else if (is_integer_type(rhs.type_))
     {
-      if (size() > 0 && this->str_value_->at(0) >= '0' &&
-          this->str_value_->at(0) <= '9')
+      if (size() > 0 && this->string_data()[0] >= '0' &&
+          this->string_data()[0] <= '9')
       {
         result = to_double() == rhs.to_double();
       }
@@ -906,6 +938,15 @@ bool KnowledgeRecord::operator==(const knowledge::KnowledgeRecord& rhs) const
 
 bool KnowledgeRecord::operator>(const knowledge::KnowledgeRecord& rhs) const
 {
+  // scalar fast path: compare inline values without conversions
+  if (MADARA_LIKELY(is_scalar_type(type_) && is_scalar_type(rhs.type_)))
+  {
+    if (type_ == INTEGER && rhs.type_ == INTEGER)
+      return int_value_ > rhs.int_value_;
+
+    return scalar_as_double() > rhs.scalar_as_double();
+  }
+
   if (has_history())
   {
     return (rhs.buf_->empty() ? KnowledgeRecord{} : ref_newest())
@@ -945,7 +986,7 @@ bool KnowledgeRecord::operator>(const knowledge::KnowledgeRecord& rhs) const
     // string to string comparison
     if (is_string_type(rhs.type_))
     {
-      result = strncmp(str_value_->c_str(), rhs.str_value_->c_str(),
+      result = strncmp(string_data(), rhs.string_data(),
                    size() >= rhs.size() ? size() : rhs.size()) > 0;
     }
 
@@ -1002,6 +1043,15 @@ bool KnowledgeRecord::operator>(const knowledge::KnowledgeRecord& rhs) const
 
 bool KnowledgeRecord::operator>=(const knowledge::KnowledgeRecord& rhs) const
 {
+  // scalar fast path: compare inline values without conversions
+  if (MADARA_LIKELY(is_scalar_type(type_) && is_scalar_type(rhs.type_)))
+  {
+    if (type_ == INTEGER && rhs.type_ == INTEGER)
+      return int_value_ >= rhs.int_value_;
+
+    return scalar_as_double() >= rhs.scalar_as_double();
+  }
+
   if (has_history())
   {
     return (rhs.buf_->empty() ? KnowledgeRecord{} : ref_newest())
@@ -1041,7 +1091,7 @@ bool KnowledgeRecord::operator>=(const knowledge::KnowledgeRecord& rhs) const
     // string to string comparison
     if (is_string_type(rhs.type_))
     {
-      result = strncmp(str_value_->c_str(), rhs.str_value_->c_str(),
+      result = strncmp(string_data(), rhs.string_data(),
                    size() >= rhs.size() ? size() : rhs.size()) >= 0;
     }
 
@@ -1230,7 +1280,21 @@ void KnowledgeRecord::resize(size_t new_size)
   }
   else if (is_string_type(type_))
   {
-    str_value_->resize(new_size);
+    if (short_str_used_ || new_size <= SHORT_STRING_MAX)
+    {
+      // rebuild the string so it moves between inline and shared storage
+      std::string tmp(string_data(), string_size());
+      tmp.resize(new_size);
+
+      uint32_t type = type_;
+      clear_union();
+      construct_string(std::move(tmp));
+      type_ = type;
+    }
+    else
+    {
+      str_value_->resize(new_size);
+    }
   }
   else if (is_binary_file_type(type_))
   {
@@ -1326,7 +1390,7 @@ bool KnowledgeRecord::is_true(void) const
   }
   else if (is_string_type(type_))
   {
-    return str_value_->size() >= 1;
+    return string_size() >= 1;
   }
   else if (is_binary_file_type(type_))
   {
@@ -1334,7 +1398,8 @@ bool KnowledgeRecord::is_true(void) const
   }
   else if (is_any_type(type_))
   {
-    return !any_value_->empty();
+    return any_serialized_used_ ? !any_serialized_->empty()
+                                : !any_value_->empty();
   }
   else if (has_history())
   {
@@ -1345,6 +1410,107 @@ bool KnowledgeRecord::is_true(void) const
     return false;
   }
 }
+
+bool KnowledgeRecord::array_apply(
+    const KnowledgeRecord& rhs, utility::ArrayOp op)
+{
+  if (rhs.has_history())
+  {
+    return !rhs.buf_->empty() && array_apply(rhs.ref_newest(), op);
+  }
+
+  const uint32_t numbers = ALL_INTEGERS | ALL_DOUBLES;
+
+  if (((type_ | rhs.type_) & ALL_ARRAYS) == 0 || (type_ & numbers) == 0 ||
+      (rhs.type_ & numbers) == 0)
+  {
+    return false;
+  }
+
+  bool lhs_array = (type_ & ALL_ARRAYS) != 0;
+  bool rhs_array = (rhs.type_ & ALL_ARRAYS) != 0;
+
+  size_t size = lhs_array ? this->size() : rhs.size();
+  if (lhs_array && rhs_array)
+  {
+    size = std::min(size, (size_t)rhs.size());
+  }
+
+  bool integers = (type_ & ALL_INTEGERS) && (rhs.type_ & ALL_INTEGERS);
+
+  // integer division by zero is undefined, so divide as doubles instead
+  if (integers && op == utility::ARRAY_DIVIDE)
+  {
+    integers = rhs_array ? std::find(rhs.int_array_->begin(),
+                               rhs.int_array_->begin() + size,
+                               0) == rhs.int_array_->begin() + size
+                         : rhs.int_value_ != 0;
+  }
+
+  if (integers)
+  {
+    // write over an array nothing else refers to
+    bool in_place = type_ == INTEGER_ARRAY &&
+                    shared_.load(std::memory_order_relaxed) == OWNED &&
+                    int_array_.use_count() == 1 && int_array_->size() == size;
+
+    std::vector<Integer> result(in_place ? 0 : size);
+    Integer* out = in_place ? int_array_->data() : result.data();
+
+    if (lhs_array && rhs_array)
+      utility::array_apply(
+          op, int_array_->data(), rhs.int_array_->data(), out, size);
+    else if (lhs_array)
+      utility::array_apply(op, int_array_->data(), rhs.int_value_, out, size);
+    else
+      utility::array_apply(op, int_value_, rhs.int_array_->data(), out, size);
+
+    if (!in_place)
+      set_value(std::move(result));
+  }
+  else
+  {
+    // integer arrays are converted once, so the kernels see only doubles
+    auto doubles = [size](const KnowledgeRecord& record,
+                       std::vector<double>& storage) -> const double* {
+      if (record.type_ == DOUBLE_ARRAY)
+        return record.double_array_->data();
+      else if (record.type_ == DOUBLE)
+        return &record.double_value_;
+      else if (record.type_ == INTEGER)
+        storage.assign(1, (double)record.int_value_);
+      else
+        storage.assign(
+            record.int_array_->begin(), record.int_array_->begin() + size);
+
+      return storage.data();
+    };
+
+    std::vector<double> lhs_storage, rhs_storage;
+    const double* lhs = doubles(*this, lhs_storage);
+    const double* rhs_values = doubles(rhs, rhs_storage);
+
+    bool in_place = type_ == DOUBLE_ARRAY &&
+                    shared_.load(std::memory_order_relaxed) == OWNED &&
+                    double_array_.use_count() == 1 &&
+                    double_array_->size() == size;
+
+    std::vector<double> result(in_place ? 0 : size);
+    double* out = in_place ? double_array_->data() : result.data();
+
+    if (lhs_array && rhs_array)
+      utility::array_apply(op, lhs, rhs_values, out, size);
+    else if (lhs_array)
+      utility::array_apply(op, lhs, *rhs_values, out, size);
+    else
+      utility::array_apply(op, *lhs, rhs_values, out, size);
+
+    if (!in_place)
+      set_value(std::move(result));
+  }
+
+  return true;
+}
 }
 }
 
@@ -10,20 +10,38 @@
  * This file contains the KnowledgeRecord class, helper typdefs and functions
  **/
 
+#include <atomic>
 #include <string>
+#include <cstring>
 #include <vector>
 #include <map>
 #include <memory>
+#include <functional>
 #include <type_traits>
 #include "madara/MadaraExport.h"
 #include "madara/utility/StdInt.h"
 #include "madara/utility/Refcounter.h"
 #include "madara/logger/GlobalLogger.h"
 #include "madara/utility/IntTypes.h"
+#include "madara/utility/ArrayMath.h"
 #include "madara/utility/SupportTest.h"
 #include "madara/utility/CircularBuffer.h"
 #include "madara/exceptions/IndexException.h"
 #include "madara/knowledge/Any.h"
+#include "madara/knowledge/SerializedAny.h"
+
+/**
+ * Branch prediction hints for hot paths (e.g., scalar arithmetic)
+ **/
+#ifndef MADARA_LIKELY
+#if defined(__GNUC__) || defined(__clang__)
+#define MADARA_LIKELY(expr) __builtin_expect(!!(expr), 1)
+#define MADARA_UNLIKELY(expr) __builtin_expect(!!(expr), 0)
+#else
+#define MADARA_LIKELY(expr) (expr)
+#define MADARA_UNLIKELY(expr) (expr)
+#endif
+#endif
 
 namespace madara
 {
@@ -164,6 +182,27 @@ public:
     }
   }
 
+private:
+  /**
+   * modification version stamped by the owning ThreadSafeContext. This
+   * belongs to the record's slot in a context, so it is not copied
+   * between records.
+   **/
+  uint64_t version_ = 0;
+
+public:
+  /**
+   * Returns the modification version of this record. The owning context
+   * stamps a new, higher version each time the record is modified, so
+   * comparing versions is a cheap test for changes. Zero if the record has
+   * never been modified through a context.
+   * @return  the modification version
+   **/
+  uint64_t version() const
+  {
+    return version_;
+  }
+
   /**
    * priority of the update
    **/
@@ -188,7 +227,15 @@ private:
     std::shared_ptr<std::string> str_value_;
     std::shared_ptr<std::vector<unsigned char>> file_value_;
     std::shared_ptr<ConstAny> any_value_;
+    std::shared_ptr<SerializedAny> any_serialized_;
     std::shared_ptr<CircBuf> buf_;
+
+    /**
+     * Inline storage for short strings (see SHORT_STRING_MAX). The
+     * characters are null terminated and the last byte holds the
+     * remaining capacity, so a full buffer ends in its own terminator.
+     **/
+    char short_str_[sizeof(std::shared_ptr<std::string>)];
   };
 
   /**
@@ -198,11 +245,35 @@ private:
 
   /**
    * is this knowledge record's shared_ptr, if any, exposed to
-   * outside holders?
+   * outside holders? Readers holding only a const record, such as
+   * ExpressionBatch workers, may share it concurrently, so it is atomic.
+   * Relaxed ordering suffices: the flag guards no other data, and writers
+   * that read it hold the context lock.
+   **/
+  mutable std::atomic<bool> shared_{OWNED};
+
+  /**
+   * is this knowledge record's string stored inline in short_str_
+   * rather than in str_value_?
+   **/
+  bool short_str_used_ = false;
+
+  /**
+   * is this knowledge record's Any held as received bytes in
+   * any_serialized_ rather than decoded in any_value_?
    **/
-  mutable bool shared_ = OWNED;
+  bool any_serialized_used_ = false;
 
 public:
+  /**
+   * Strings up to this length (excluding the null terminator) are stored
+   * inline in the record and never allocate or share a std::string
+   **/
+  enum
+  {
+    SHORT_STRING_MAX = sizeof(std::shared_ptr<std::string>) - 1
+  };
+
   /* default constructor */
   KnowledgeRecord() noexcept : KnowledgeRecord(*logger::global_logger.get()) {}
 
@@ -361,8 +432,7 @@ public:
   template<typename... Args>
   void emplace_string(Args&&... args)
   {
-    emplace_val<std::string, STRING, &KnowledgeRecord::str_value_>(
-        std::forward<Args>(args)...);
+    emplace_string_val(std::string(std::forward<Args>(args)...));
   }
 
   /**
@@ -474,9 +544,8 @@ public:
    **/
   template<typename... Args>
   KnowledgeRecord(tags::string_t, Args&&... args)
-    : str_value_(std::make_shared<std::string>(std::forward<Args>(args)...)),
-      type_(STRING)
   {
+    emplace_string(std::forward<Args>(args)...);
   }
 
   /**
@@ -918,6 +987,16 @@ public:
    **/
   void set_file(std::unique_ptr<std::vector<unsigned char>> new_value);
 
+  /**
+   * sets the value to a file payload shared with other holders, such as
+   * a ContentStore. The payload is copied only if this record changes it.
+   * @param    new_value   new value of the Knowledge Record
+   * @param    type        the file type, e.g., IMAGE_JPEG
+   **/
+  void set_shared_file(
+      std::shared_ptr<const std::vector<unsigned char>> new_value,
+      uint32_t type = UNKNOWN_FILE_TYPE);
+
   /**
    * Set to Any from any compatible type. The argument will be moved into
    * this Any if it supports it, and the argument is an rvalue reference.
@@ -939,7 +1018,7 @@ public:
   {
     if (type_ == ANY)
     {
-      return *any_value_;
+      return *any_ptr();
     }
     else
     {
@@ -960,6 +1039,20 @@ public:
     return get_any_ref();
   }
 
+  /**
+   * Checks if the stored Any has been decoded. Any values read from a
+   * buffer (e.g., received or loaded from a checkpoint) are kept as bytes
+   * until first accessed, and are written out as the same bytes until
+   * the record is modified.
+   *
+   * @return false if this record holds an Any that has not been decoded
+   **/
+  bool is_any_decoded() const
+  {
+    return type_ != ANY || !any_serialized_used_ ||
+           any_serialized_->decoded();
+  }
+
   /**
    * Access an Any value's stored value by reference.
    * If this knowledge record doesn't hold an Any type, throw BadAnyAccess.
@@ -1063,7 +1156,7 @@ public:
   {
     if (type_ == ANY)
     {
-      return *any_value_;
+      return *any_ptr();
     }
     else if (type_ == INTEGER)
     {
@@ -1083,7 +1176,7 @@ public:
     }
     else if (is_string_type())
     {
-      return Any(*str_value_);
+      return Any(std::string(string_data(), string_size()));
     }
     else if (is_binary_file_type())
     {
@@ -1403,22 +1496,26 @@ public:
   KnowledgeRecord& operator=(KnowledgeRecord&& rhs) noexcept;
 
   /**
-   * In-place addition operator
+   * In-place addition operator. Integer and double arrays are combined
+   * element-wise with arrays (up to the shorter length) and scalars.
    **/
   KnowledgeRecord& operator+=(const KnowledgeRecord& rhs);
 
   /**
-   * In-place subtraction operator
+   * In-place subtraction operator. Integer and double arrays are combined
+   * element-wise with arrays (up to the shorter length) and scalars.
    **/
   KnowledgeRecord& operator-=(const KnowledgeRecord& rhs);
 
   /**
-   * In-place multiplication operator
+   * In-place multiplication operator. Integer and double arrays are combined
+   * element-wise with arrays (up to the shorter length) and scalars.
    **/
   KnowledgeRecord& operator*=(const KnowledgeRecord& rhs);
 
   /**
-   * In-place division operator
+   * In-place division operator. Integer and double arrays are combined
+   * element-wise with arrays (up to the shorter length) and scalars.
    **/
   KnowledgeRecord& operator/=(const KnowledgeRecord& rhs);
 
@@ -2059,6 +2156,225 @@ public:
   void overwrite(KnowledgeRecord&& new_value);
 
 private:
+  /**
+   * Checks if a type is an inline scalar (INTEGER or DOUBLE), i.e., one
+   * that is stored directly in the union without a shared_ptr
+   * @param  type    the type to check
+   * @return true if the type is INTEGER or DOUBLE
+   **/
+  static bool is_scalar_type(uint32_t type) noexcept
+  {
+    return type == INTEGER || type == DOUBLE;
+  }
+
+  /**
+   * Fast path for arithmetic between two scalar records. Operates directly
+   * on the inline union values without touching history, shared_ptrs or
+   * string conversions. Integer op integer stays an integer, anything
+   * involving a double becomes a double.
+   * @param  rhs     the right hand side of the operation
+   * @return true if both sides were scalars and the operation was applied
+   **/
+  template<typename IntOp, typename DoubleOp>
+  bool scalar_apply(const KnowledgeRecord& rhs) noexcept
+  {
+    if (type_ == INTEGER)
+    {
+      if (rhs.type_ == INTEGER)
+      {
+        int_value_ = IntOp()(int_value_, rhs.int_value_);
+        return true;
+      }
+      else if (rhs.type_ == DOUBLE)
+      {
+        double_value_ = DoubleOp()((double)int_value_, rhs.double_value_);
+        type_ = DOUBLE;
+        return true;
+      }
+    }
+    else if (type_ == DOUBLE)
+    {
+      if (rhs.type_ == DOUBLE)
+      {
+        double_value_ = DoubleOp()(double_value_, rhs.double_value_);
+        return true;
+      }
+      else if (rhs.type_ == INTEGER)
+      {
+        double_value_ = DoubleOp()(double_value_, (double)rhs.int_value_);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Element-wise arithmetic when either side is an INTEGER_ARRAY or
+   * DOUBLE_ARRAY and the other is a numeric array or scalar, which is
+   * broadcast to every element. Two arrays are combined up to the length
+   * of the shorter one. Integers stay integers unless an integer divisor
+   * is zero; anything involving a double becomes a DOUBLE_ARRAY.
+   * @param  rhs     the right hand side of the operation
+   * @param  op      the operation
+   * @return true if either side was an array and the operation was applied
+   **/
+  bool array_apply(const KnowledgeRecord& rhs, utility::ArrayOp op);
+
+  /**
+   * Returns a pointer to the null-terminated characters of a string
+   * record, whether stored inline or shared. Only valid for string types.
+   **/
+  const char* string_data(void) const noexcept
+  {
+    return short_str_used_ ? short_str_ : str_value_->c_str();
+  }
+
+  /**
+   * Returns the length of a string record, excluding the null terminator.
+   * Only valid for string types.
+   **/
+  size_t string_size(void) const noexcept
+  {
+    return short_str_used_
+               ? SHORT_STRING_MAX - (unsigned char)short_str_[SHORT_STRING_MAX]
+               : str_value_->size();
+  }
+
+  /**
+   * Stores a string into the (already cleared) union, inline if it fits
+   * within SHORT_STRING_MAX and as a shared std::string otherwise. Does
+   * not change type_.
+   **/
+  void construct_string(std::string&& value)
+  {
+    size_t size = value.size();
+
+    if (size <= SHORT_STRING_MAX)
+    {
+      memcpy(short_str_, value.data(), size);
+      short_str_[size] = 0;
+      short_str_[SHORT_STRING_MAX] = (char)(SHORT_STRING_MAX - size);
+      short_str_used_ = true;
+    }
+    else
+    {
+      new (&str_value_)
+          std::shared_ptr<std::string>(std::make_shared<std::string>(
+              std::move(value)));
+      short_str_used_ = false;
+    }
+  }
+
+  /**
+   * Replaces the value of this record with a string (inline if short)
+   **/
+  void emplace_string_val(std::string&& value)
+  {
+    if (has_history())
+    {
+      KnowledgeRecord tmp;
+      tmp.copy_metadata(*this);
+      tmp.emplace_string_val(std::move(value));
+      emplace_hist(std::move(tmp));
+      return;
+    }
+    clear_union();
+    type_ = STRING;
+    construct_string(std::move(value));
+  }
+
+  /**
+   * Copies the string storage of rhs into the (already cleared) union
+   **/
+  void copy_string(const KnowledgeRecord& rhs) noexcept
+  {
+    if (rhs.short_str_used_)
+      memcpy(short_str_, rhs.short_str_, sizeof(short_str_));
+    else
+      new (&str_value_) std::shared_ptr<std::string>(rhs.str_value_);
+    short_str_used_ = rhs.short_str_used_;
+  }
+
+  /**
+   * Moves the string storage of rhs into the (already cleared) union
+   **/
+  void move_string(KnowledgeRecord& rhs) noexcept
+  {
+    if (rhs.short_str_used_)
+      memcpy(short_str_, rhs.short_str_, sizeof(short_str_));
+    else
+      new (&str_value_)
+          std::shared_ptr<std::string>(std::move(rhs.str_value_));
+    short_str_used_ = rhs.short_str_used_;
+    rhs.short_str_used_ = false;
+  }
+
+  /**
+   * Returns the stored Any, decoding it first if the record holds received
+   * bytes. Only valid for Any types.
+   **/
+  const std::shared_ptr<ConstAny>& any_ptr(void) const
+  {
+    return any_serialized_used_ ? any_serialized_->value() : any_value_;
+  }
+
+  /**
+   * Stores received Any bytes without decoding them. They are decoded on
+   * first access and written out unchanged until the record is modified.
+   **/
+  void emplace_serialized_any(const char* data, size_t size)
+  {
+    if (has_history())
+    {
+      KnowledgeRecord tmp;
+      tmp.copy_metadata(*this);
+      tmp.emplace_serialized_any(data, size);
+      emplace_hist(std::move(tmp));
+      return;
+    }
+    clear_union();
+    type_ = ANY;
+    new (&any_serialized_) std::shared_ptr<SerializedAny>(
+        std::make_shared<SerializedAny>(data, size));
+    any_serialized_used_ = true;
+  }
+
+  /**
+   * Copies the Any storage of rhs into the (already cleared) union
+   **/
+  void copy_any(const KnowledgeRecord& rhs) noexcept
+  {
+    if (rhs.any_serialized_used_)
+      new (&any_serialized_)
+          std::shared_ptr<SerializedAny>(rhs.any_serialized_);
+    else
+      new (&any_value_) std::shared_ptr<ConstAny>(rhs.any_value_);
+    any_serialized_used_ = rhs.any_serialized_used_;
+  }
+
+  /**
+   * Moves the Any storage of rhs into the (already cleared) union
+   **/
+  void move_any(KnowledgeRecord& rhs) noexcept
+  {
+    if (rhs.any_serialized_used_)
+      new (&any_serialized_)
+          std::shared_ptr<SerializedAny>(std::move(rhs.any_serialized_));
+    else
+      new (&any_value_) std::shared_ptr<ConstAny>(std::move(rhs.any_value_));
+    any_serialized_used_ = rhs.any_serialized_used_;
+    rhs.any_serialized_used_ = false;
+  }
+
+  /**
+   * Reads a scalar record as a double without conversions through
+   * streams. Only valid if is_scalar_type(type_).
+   **/
+  double scalar_as_double(void) const noexcept
+  {
+    return type_ == INTEGER ? (double)int_value_ : double_value_;
+  }
+
   template<typename... Args>
   KnowledgeRecord& emplace_hist(Args&&... args)
   {
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <sstream>
 #include <math.h>
+#include <stdexcept>
 
 #include "madara/utility/Utility.h"
 #include "madara/exceptions/MemoryException.h"
@@ -174,22 +175,22 @@ inline KnowledgeRecord::KnowledgeRecord(const knowledge::KnowledgeRecord& rhs)
   if (rhs.type_ == EMPTY)
     return;
 
-  if (rhs.type_ == INTEGER)
+  if (MADARA_LIKELY(rhs.type_ == INTEGER))
     int_value_ = rhs.int_value_;
-  else if (rhs.type_ == INTEGER_ARRAY)
-    new (&int_array_) std::shared_ptr<std::vector<Integer>>(rhs.int_array_);
   else if (rhs.type_ == DOUBLE)
     double_value_ = rhs.double_value_;
+  else if (rhs.type_ == INTEGER_ARRAY)
+    new (&int_array_) std::shared_ptr<std::vector<Integer>>(rhs.int_array_);
   else if (rhs.type_ == DOUBLE_ARRAY)
     new (&double_array_)
         std::shared_ptr<std::vector<double>>(rhs.double_array_);
   else if (is_string_type(rhs.type_))
-    new (&str_value_) std::shared_ptr<std::string>(rhs.str_value_);
+    copy_string(rhs);
   else if (is_binary_file_type(rhs.type_))
     new (&file_value_)
         std::shared_ptr<std::vector<unsigned char>>(rhs.file_value_);
   else if (rhs.type_ == ANY)
-    new (&any_value_) std::shared_ptr<ConstAny>(rhs.any_value_);
+    copy_any(rhs);
   else if (rhs.type_ == BUFFER)
     new (&buf_) std::shared_ptr<CircBuf>(rhs.buf_);
 }
@@ -202,28 +203,28 @@ inline KnowledgeRecord::KnowledgeRecord(
     quality(rhs.quality),
     write_quality(rhs.write_quality),
     type_(rhs.type_),
-    shared_(rhs.shared_)
+    shared_(rhs.shared_.load(std::memory_order_relaxed))
 {
   if (rhs.type_ == EMPTY)
     return;
 
-  if (rhs.type_ == INTEGER)
+  if (MADARA_LIKELY(rhs.type_ == INTEGER))
     int_value_ = rhs.int_value_;
+  else if (rhs.type_ == DOUBLE)
+    double_value_ = rhs.double_value_;
   else if (rhs.type_ == INTEGER_ARRAY)
     new (&int_array_)
         std::shared_ptr<std::vector<Integer>>(std::move(rhs.int_array_));
-  else if (rhs.type_ == DOUBLE)
-    double_value_ = rhs.double_value_;
   else if (rhs.type_ == DOUBLE_ARRAY)
     new (&double_array_)
         std::shared_ptr<std::vector<double>>(std::move(rhs.double_array_));
   else if (is_string_type(rhs.type_))
-    new (&str_value_) std::shared_ptr<std::string>(std::move(rhs.str_value_));
+    move_string(rhs);
   else if (is_binary_file_type(rhs.type_))
     new (&file_value_)
         std::shared_ptr<std::vector<unsigned char>>(std::move(rhs.file_value_));
   else if (rhs.type_ == ANY)
-    new (&any_value_) std::shared_ptr<ConstAny>(std::move(rhs.any_value_));
+    move_any(rhs);
   else if (rhs.type_ == BUFFER)
     new (&buf_) std::shared_ptr<CircBuf>(std::move(rhs.buf_));
 
@@ -314,6 +315,18 @@ inline void KnowledgeRecord::overwrite(const KnowledgeRecord& rhs)
   if (this == &rhs)
     return;
 
+  // scalars are stored inline, so no dynamic memory needs to be touched
+  if (MADARA_LIKELY(is_scalar_type(rhs.type_) && !(type_ & ALL_CLEARABLES) &&
+                    type_ != BUFFER))
+  {
+    type_ = rhs.type_;
+    if (rhs.type_ == INTEGER)
+      int_value_ = rhs.int_value_;
+    else
+      double_value_ = rhs.double_value_;
+    return;
+  }
+
   // clear any dynamic memory being used on the left hand side
   clear_value();
 
@@ -322,7 +335,8 @@ inline void KnowledgeRecord::overwrite(const KnowledgeRecord& rhs)
 
   // set the instance properties accordingly
   type_ = rhs.type_;
-  shared_ = is_ref_counted() ? SHARED : OWNED;
+  shared_.store(
+      is_ref_counted() ? SHARED : OWNED, std::memory_order_relaxed);
 
   if (rhs.type_ == INTEGER)
     int_value_ = rhs.int_value_;
@@ -334,12 +348,12 @@ inline void KnowledgeRecord::overwrite(const KnowledgeRecord& rhs)
     new (&double_array_)
         std::shared_ptr<std::vector<double>>(rhs.double_array_);
   else if (is_string_type(rhs.type_))
-    new (&str_value_) std::shared_ptr<std::string>(rhs.str_value_);
+    copy_string(rhs);
   else if (is_binary_file_type(rhs.type_))
     new (&file_value_)
         std::shared_ptr<std::vector<unsigned char>>(rhs.file_value_);
   else if (rhs.type_ == ANY)
-    new (&any_value_) std::shared_ptr<ConstAny>(rhs.any_value_);
+    copy_any(rhs);
   else if (rhs.type_ == BUFFER)
     new (&buf_) std::shared_ptr<CircBuf>(rhs.buf_);
 }
@@ -357,7 +371,8 @@ inline void KnowledgeRecord::overwrite(KnowledgeRecord&& rhs)
 
   // set the instance properties accordingly
   type_ = rhs.type_;
-  shared_ = rhs.shared_;
+  shared_.store(
+      rhs.shared_.load(std::memory_order_relaxed), std::memory_order_relaxed);
 
   if (rhs.type_ == INTEGER)
     int_value_ = rhs.int_value_;
@@ -370,12 +385,12 @@ inline void KnowledgeRecord::overwrite(KnowledgeRecord&& rhs)
     new (&double_array_)
         std::shared_ptr<std::vector<double>>(std::move(rhs.double_array_));
   else if (is_string_type(rhs.type_))
-    new (&str_value_) std::shared_ptr<std::string>(std::move(rhs.str_value_));
+    move_string(rhs);
   else if (is_binary_file_type(rhs.type_))
     new (&file_value_)
         std::shared_ptr<std::vector<unsigned char>>(std::move(rhs.file_value_));
   else if (rhs.type_ == ANY)
-    new (&any_value_) std::shared_ptr<ConstAny>(std::move(rhs.any_value_));
+    move_any(rhs);
   else if (rhs.type_ == BUFFER)
     new (&buf_) std::shared_ptr<CircBuf>(std::move(rhs.buf_));
 
@@ -447,6 +462,13 @@ inline KnowledgeRecord KnowledgeRecord::operator-(void) const
 inline KnowledgeRecord& KnowledgeRecord::operator+=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (MADARA_LIKELY(
+          (scalar_apply<std::plus<Integer>, std::plus<double>>(rhs))))
+    return *this;
+
+  if (array_apply(rhs, utility::ARRAY_ADD))
+    return *this;
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -471,6 +493,17 @@ inline KnowledgeRecord& KnowledgeRecord::operator+=(
  **/
 inline KnowledgeRecord& KnowledgeRecord::operator--(void)
 {
+  if (MADARA_LIKELY(type_ == INTEGER))
+  {
+    --int_value_;
+    return *this;
+  }
+  else if (type_ == DOUBLE)
+  {
+    --double_value_;
+    return *this;
+  }
+
   if (is_integer_type(type_))
     set_value(to_integer() - 1);
 
@@ -492,6 +525,17 @@ inline KnowledgeRecord& KnowledgeRecord::operator--(void)
  **/
 inline KnowledgeRecord& KnowledgeRecord::operator++(void)
 {
+  if (MADARA_LIKELY(type_ == INTEGER))
+  {
+    ++int_value_;
+    return *this;
+  }
+  else if (type_ == DOUBLE)
+  {
+    ++double_value_;
+    return *this;
+  }
+
   if (is_integer_type(type_))
     set_value(to_integer() + 1);
 
@@ -514,6 +558,13 @@ inline KnowledgeRecord& KnowledgeRecord::operator++(void)
 inline KnowledgeRecord& KnowledgeRecord::operator-=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (MADARA_LIKELY(
+          (scalar_apply<std::minus<Integer>, std::minus<double>>(rhs))))
+    return *this;
+
+  if (array_apply(rhs, utility::ARRAY_SUBTRACT))
+    return *this;
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -536,6 +587,13 @@ inline KnowledgeRecord& KnowledgeRecord::operator-=(
 inline KnowledgeRecord& KnowledgeRecord::operator*=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (MADARA_LIKELY((scalar_apply<std::multiplies<Integer>,
+          std::multiplies<double>>(rhs))))
+    return *this;
+
+  if (array_apply(rhs, utility::ARRAY_MULTIPLY))
+    return *this;
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -558,6 +616,18 @@ inline KnowledgeRecord& KnowledgeRecord::operator*=(
 inline KnowledgeRecord& KnowledgeRecord::operator/=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  // a zero denominator always results in NAN, so only nonzero scalar
+  // denominators can take the fast path
+  if (MADARA_LIKELY(is_scalar_type(type_) && is_scalar_type(rhs.type_) &&
+                    rhs.scalar_as_double() != 0))
+  {
+    scalar_apply<std::divides<Integer>, std::divides<double>>(rhs);
+    return *this;
+  }
+
+  if (array_apply(rhs, utility::ARRAY_DIVIDE))
+    return *this;
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -600,6 +670,13 @@ inline KnowledgeRecord& KnowledgeRecord::operator/=(
 inline KnowledgeRecord& KnowledgeRecord::operator%=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (MADARA_LIKELY(type_ == INTEGER && rhs.type_ == INTEGER &&
+                    rhs.int_value_ != 0))
+  {
+    int_value_ %= rhs.int_value_;
+    return *this;
+  }
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -626,8 +703,9 @@ inline KnowledgeRecord KnowledgeRecord::operator*(
 {
   // copy this value to a local copy
   knowledge::KnowledgeRecord ret_value(*this);
+  ret_value *= rhs;
 
-  return ret_value *= rhs;
+  return ret_value;
 }
 
 /**
@@ -638,8 +716,9 @@ inline KnowledgeRecord KnowledgeRecord::operator/(
 {
   // copy this value to a local copy
   knowledge::KnowledgeRecord ret_value(*this);
+  ret_value /= rhs;
 
-  return ret_value /= rhs;
+  return ret_value;
 }
 
 /**
@@ -650,8 +729,9 @@ inline KnowledgeRecord KnowledgeRecord::operator%(
 {
   // copy this value to a local copy
   knowledge::KnowledgeRecord ret_value(*this);
+  ret_value %= rhs;
 
-  return ret_value %= rhs;
+  return ret_value;
 }
 
 /**
@@ -662,8 +742,9 @@ inline KnowledgeRecord KnowledgeRecord::operator+(
 {
   // copy this value to a local copy
   knowledge::KnowledgeRecord ret_value(*this);
+  ret_value += rhs;
 
-  return ret_value += rhs;
+  return ret_value;
 }
 
 inline bool KnowledgeRecord::is_false(void) const
@@ -696,13 +777,14 @@ inline KnowledgeRecord KnowledgeRecord::operator-(
 {
   // copy this value to a local copy
   knowledge::KnowledgeRecord ret_value(*this);
+  ret_value -= rhs;
 
-  return ret_value -= rhs;
+  return ret_value;
 }
 
 inline void KnowledgeRecord::unshare(void)
 {
-  if (shared_ != SHARED)
+  if (shared_.load(std::memory_order_relaxed) != SHARED)
   {
     return;
   }
@@ -711,7 +793,13 @@ inline void KnowledgeRecord::unshare(void)
   {
     if (is_string_type(type_))
     {
-      emplace_string(*str_value_);
+      // inline strings are never shared
+      if (!short_str_used_)
+      {
+        uint32_t type = type_;
+        emplace_string(*str_value_);
+        type_ = type;
+      }
     }
     else if (is_binary_file_type(type_))
     {
@@ -727,14 +815,18 @@ inline void KnowledgeRecord::unshare(void)
     }
     else if (type_ == ANY)
     {
-      emplace_any(*any_value_);
+      // received bytes are immutable and are never handed out
+      if (!any_serialized_used_)
+      {
+        emplace_any(*any_value_);
+      }
     }
     else if (type_ == BUFFER)
     {
       overwrite_circular_buffer(*buf_);
     }
   }
-  shared_ = OWNED;
+  shared_.store(OWNED, std::memory_order_relaxed);
 }
 
 inline KnowledgeRecord* KnowledgeRecord::clone(void) const
@@ -788,7 +880,7 @@ inline uint32_t KnowledgeRecord::size(void) const
   }
   else if (is_string_type(type_))
   {
-    return (uint32_t)str_value_->size() + 1;
+    return (uint32_t)string_size() + 1;
   }
   else if (is_binary_file_type(type_))
   {
@@ -804,9 +896,11 @@ inline uint32_t KnowledgeRecord::size(void) const
   }
   else if (type_ == ANY)
   {
-    if (any_value_->supports_size())
+    const std::shared_ptr<ConstAny>& any = any_ptr();
+
+    if (any->supports_size())
     {
-      return any_value_->size();
+      return any->size();
     }
   }
   else if (type_ == BUFFER)
@@ -863,7 +957,7 @@ inline int64_t KnowledgeRecord::get_encoded_size(void) const
   }
   else if (is_string_type(type_))
   {
-    buffer_size += str_value_->size() + 1;
+    buffer_size += string_size() + 1;
   }
   else if (is_binary_file_type(type_))
   {
@@ -871,8 +965,15 @@ inline int64_t KnowledgeRecord::get_encoded_size(void) const
   }
   else if (type_ == ANY)
   {
-    // TODO calculate real size
-    buffer_size += 1024;
+    if (any_serialized_used_)
+    {
+      buffer_size += any_serialized_->size();
+    }
+    else
+    {
+      // TODO calculate real size
+      buffer_size += 1024;
+    }
   }
   else if (type_ == BUFFER && !buf_->empty())
   {
@@ -1027,14 +1128,24 @@ inline void KnowledgeRecord::clear_union(void) noexcept
     else if (type_ == DOUBLE_ARRAY)
       destruct(double_array_);
     else if (is_string_type(type_))
-      destruct(str_value_);
+    {
+      if (!short_str_used_)
+        destruct(str_value_);
+      short_str_used_ = false;
+    }
     else if (is_binary_file_type(type_))
       destruct(file_value_);
     else if (type_ == ANY)
-      destruct(any_value_);
+    {
+      if (any_serialized_used_)
+        destruct(any_serialized_);
+      else
+        destruct(any_value_);
+      any_serialized_used_ = false;
+    }
     else if (type_ == BUFFER)
       destruct(buf_);
-    shared_ = OWNED;
+    shared_.store(OWNED, std::memory_order_relaxed);
   }
 }
 
@@ -1169,9 +1280,9 @@ inline const char* KnowledgeRecord::read(
     {
       // madara_logger_ptr_log (logger_, logger::LOG_TRACE,
       //"KnowledgeRecord::read: reading Any type of size %d\n", size);
-      Any any;
-      any.tagged_unserialize(buffer, size);
-      emplace_any(std::move(any));
+
+      // decoded on first access, so unread keys are never decoded
+      emplace_serialized_any(buffer, size);
     }
 
     else
@@ -1399,6 +1510,25 @@ inline void KnowledgeRecord::set_file(
       &KnowledgeRecord::file_value_>(std::move(new_value));
 }
 
+inline void KnowledgeRecord::set_shared_file(
+    std::shared_ptr<const std::vector<unsigned char>> new_value,
+    uint32_t type)
+{
+  if (has_history())
+  {
+    KnowledgeRecord tmp;
+    tmp.copy_metadata(*this);
+    tmp.set_shared_file(std::move(new_value), type);
+    emplace_hist(std::move(tmp));
+    return;
+  }
+
+  emplace_shared_vec<unsigned char, UNKNOWN_FILE_TYPE,
+      &KnowledgeRecord::file_value_>(std::move(new_value));
+  type_ = is_binary_file_type(type) ? type : UNKNOWN_FILE_TYPE;
+  shared_.store(SHARED, std::memory_order_relaxed);
+}
+
 // set the value_ to an integer
 template<typename T, enable_if_<is_int_numeric<T>(), int>>
 inline void KnowledgeRecord::set_value(T new_value)
@@ -1577,7 +1707,14 @@ inline std::shared_ptr<const std::string> KnowledgeRecord::share_string() const
 {
   if (is_string_type(type_))
   {
-    shared_ = SHARED;
+    // inline strings have no shared representation, so hand out a copy
+    if (short_str_used_)
+    {
+      return std::make_shared<const std::string>(
+          string_data(), string_size());
+    }
+
+    shared_.store(SHARED, std::memory_order_relaxed);
     return str_value_;
   }
   else if (has_history() && !buf_->empty())
@@ -1592,7 +1729,7 @@ KnowledgeRecord::share_integers() const
 {
   if (type_ == INTEGER_ARRAY)
   {
-    shared_ = SHARED;
+    shared_.store(SHARED, std::memory_order_relaxed);
     return int_array_;
   }
   else if (has_history() && !buf_->empty())
@@ -1607,7 +1744,7 @@ KnowledgeRecord::share_doubles() const
 {
   if (type_ == DOUBLE_ARRAY)
   {
-    shared_ = SHARED;
+    shared_.store(SHARED, std::memory_order_relaxed);
     return double_array_;
   }
   else if (has_history() && !buf_->empty())
@@ -1622,7 +1759,7 @@ KnowledgeRecord::share_binary() const
 {
   if (is_binary_file_type(type_))
   {
-    shared_ = SHARED;
+    shared_.store(SHARED, std::memory_order_relaxed);
     return file_value_;
   }
   else if (has_history() && !buf_->empty())
@@ -1636,8 +1773,8 @@ inline std::shared_ptr<const ConstAny> KnowledgeRecord::share_any() const
 {
   if (is_any_type(type_))
   {
-    shared_ = SHARED;
-    return any_value_;
+    shared_.store(SHARED, std::memory_order_relaxed);
+    return any_ptr();
   }
   else if (has_history() && !buf_->empty())
   {
@@ -1666,7 +1803,7 @@ KnowledgeRecord::share_circular_buffer() const
   {
     return nullptr;
   }
-  shared_ = SHARED;
+  shared_.store(SHARED, std::memory_order_relaxed);
   return buf_;
 }
 
@@ -1689,7 +1826,10 @@ inline char* KnowledgeRecord::write(
   uint32_t uint32_temp;
   Integer integer_temp;
   double double_temp;
-  uint32_t size = this->size();
+
+  // an Any's size is its encoded length, set below, and checking its
+  // element count would decode received bytes
+  uint32_t size = is_any_type(type_) ? 0 : this->size();
 
   int64_t encoded_size = get_encoded_size();
 
@@ -1739,7 +1879,7 @@ inline char* KnowledgeRecord::write(
       // strings do not have to be converted
       if (buffer_remaining >= int64_t(size))
       {
-        memcpy(buffer, &(*str_value_)[0], size);
+        memcpy(buffer, string_data(), size);
       }
     }
     else if (type_ == INTEGER)
@@ -1822,8 +1962,24 @@ inline char* KnowledgeRecord::write(
 
       try
       {
-        size_intermediate =
-            (uint32_t)any_value_->tagged_serialize(buffer, buffer_remaining);
+        if (any_serialized_used_)
+        {
+          // unmodified since it was read, so the bytes are still valid
+          size_t bytes = any_serialized_->size();
+
+          if (buffer_remaining < (int64_t)bytes)
+          {
+            throw std::length_error("Any bytes do not fit");
+          }
+
+          memcpy(buffer, any_serialized_->data(), bytes);
+          size_intermediate = (uint32_t)bytes;
+        }
+        else
+        {
+          size_intermediate =
+              (uint32_t)any_value_->tagged_serialize(buffer, buffer_remaining);
+        }
         size = size_intermediate;
 
         // madara_logger_ptr_log (logger_, logger::LOG_TRACE,
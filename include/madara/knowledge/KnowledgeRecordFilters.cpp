@@ -29,6 +29,7 @@ madara::knowledge::KnowledgeRecordFilters::KnowledgeRecordFilters(
     const knowledge::KnowledgeRecordFilters& filters)
   : filters_(filters.filters_),
     aggregate_filters_(filters.aggregate_filters_),
+    batch_filters_(filters.batch_filters_),
     context_(filters.context_)
 {
 }
@@ -42,6 +43,7 @@ void madara::knowledge::KnowledgeRecordFilters::operator=(
   {
     filters_ = rhs.filters_;
     aggregate_filters_ = rhs.aggregate_filters_;
+    batch_filters_ = rhs.batch_filters_;
     context_ = rhs.context_;
   }
 }
@@ -114,6 +116,20 @@ void madara::knowledge::KnowledgeRecordFilters::add(
   }
 }
 
+void madara::knowledge::KnowledgeRecordFilters::add(
+    filters::BatchFilter* functor)
+{
+  if (functor != 0)
+  {
+    madara_logger_cond_log(context_, context_->get_logger(),
+        logger::global_logger.get(), logger::LOG_MAJOR,
+        "KnowledgeRecordFilters::add: "
+        "Adding batch functor filter\n");
+
+    batch_filters_.push_back(functor);
+  }
+}
+
 void madara::knowledge::KnowledgeRecordFilters::add(
     uint32_t types, filters::RecordFilter* functor)
 {
@@ -250,6 +266,11 @@ void madara::knowledge::KnowledgeRecordFilters::clear_buffer_filters(void)
   buffer_filters_.clear();
 }
 
+void madara::knowledge::KnowledgeRecordFilters::clear_batch_filters(void)
+{
+  batch_filters_.clear();
+}
+
 void madara::knowledge::KnowledgeRecordFilters::print_num_filters(void) const
 {
   if (context_)
@@ -273,6 +294,10 @@ void madara::knowledge::KnowledgeRecordFilters::print_num_filters(void) const
     madara_logger_cond_log(context_, context_->get_logger(),
         logger::global_logger.get(), logger::LOG_ALWAYS,
         "%d chained buffer filters\n", buffer_filters_.size());
+
+    madara_logger_cond_log(context_, context_->get_logger(),
+        logger::global_logger.get(), logger::LOG_ALWAYS,
+        "%d chained batch filters\n", batch_filters_.size());
   }
 }
 
@@ -697,6 +722,31 @@ void madara::knowledge::KnowledgeRecordFilters::filter(KnowledgeMap& records,
   }
 }
 
+void madara::knowledge::KnowledgeRecordFilters::filter_batch(
+    filters::RecordBatch& records,
+    transport::TransportContext& transport_context) const
+{
+  if (batch_filters_.size() > 0)
+  {
+    madara_logger_cond_log(context_, context_->get_logger(),
+        logger::global_logger.get(), logger::LOG_MAJOR,
+        "KnowledgeRecordFilters::filter_batch: "
+        "Calling %d batch filters on %d records\n",
+        (int)batch_filters_.size(), (int)records.size());
+
+    // one Variables facade is shared by the whole chain and batch
+    std::unique_ptr<Variables> heap_variables(new Variables());
+
+    heap_variables->context_ = context_;
+
+    for (filters::BatchFilters::const_iterator i = batch_filters_.begin();
+         i != batch_filters_.end(); ++i)
+    {
+      (*i)->filter(records, transport_context, *heap_variables);
+    }
+  }
+}
+
 void madara::knowledge::KnowledgeRecordFilters::filter_decode(
     char* source, int size, int max_size) const
 {
@@ -738,3 +788,9 @@ size_t madara::knowledge::KnowledgeRecordFilters::get_number_of_buffer_filters(
 {
   return buffer_filters_.size();
 }
+
+size_t madara::knowledge::KnowledgeRecordFilters::get_number_of_batch_filters(
+    void) const
+{
+  return batch_filters_.size();
+}
@@ -25,6 +25,7 @@
 #include "madara/filters/RecordFilter.h"
 #include "madara/filters/AggregateFilter.h"
 #include "madara/filters/BufferFilter.h"
+#include "madara/filters/BatchFilter.h"
 
 #ifdef _MADARA_JAVA_
 #include <jni.h>
@@ -108,6 +109,13 @@ public:
    **/
   void add(uint32_t types, filters::RecordFilter* filter);
 
+  /**
+   * Adds a batch filter functor, which is called once per message with
+   * all records that survived the individual record filters
+   * @param filter     the functor that will filter the batch
+   **/
+  void add(filters::BatchFilter* filter);
+
 #ifdef _MADARA_JAVA_
 
   /**
@@ -167,6 +175,11 @@ public:
    **/
   void clear_buffer_filters(void);
 
+  /**
+   * Clears the batch filters
+   **/
+  void clear_batch_filters(void);
+
   /**
    * Filters an input according to its filter chain.
    *
@@ -205,6 +218,15 @@ public:
   void filter(KnowledgeMap& records,
       const transport::TransportContext& transport_context) const;
 
+  /**
+   * Calls the batch filter chain on the provided records. Records may
+   * be modified, dropped, or added by each filter in the chain.
+   * @param  records             the batch of records
+   * @param  transport_context   the context of the transport
+   **/
+  void filter_batch(filters::RecordBatch& records,
+      transport::TransportContext& transport_context) const;
+
   /**
    * Calls encode on the the buffer filter chain
    * @param   source           the source and destination buffer
@@ -246,6 +268,12 @@ public:
    **/
   size_t get_number_of_buffer_filters(void) const;
 
+  /**
+   * Returns the number of batch filters
+   * @return  the number of batch filters
+   **/
+  size_t get_number_of_batch_filters(void) const;
+
 protected:
   /**
    * Container for mapping types to filter chains
@@ -262,6 +290,11 @@ protected:
    **/
   filters::BufferFilters buffer_filters_;
 
+  /**
+   * List of batch filters
+   **/
+  filters::BatchFilters batch_filters_;
+
   /**
    * Context used by this filter
    **/
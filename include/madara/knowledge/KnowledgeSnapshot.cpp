@@ -0,0 +1,100 @@
+#include "KnowledgeSnapshot.h"
+
+namespace madara
+{
+namespace knowledge
+{
+KnowledgeSnapshot::Ptr KnowledgeSnapshot::create(KnowledgeMap records)
+{
+  std::shared_ptr<KnowledgeSnapshot> result(new KnowledgeSnapshot());
+  result->records_ = std::move(records);
+
+  return result;
+}
+
+KnowledgeSnapshot::Ptr KnowledgeSnapshot::layer(
+    const Ptr& base, KnowledgeMap changes)
+{
+  Ptr below = base;
+
+  // fold in lower layers that are not much larger than the changes
+  while (below && changes.size() * 2 >= below->records_.size())
+  {
+    // insert keeps existing keys, so the newer changes win
+    changes.insert(below->records_.begin(), below->records_.end());
+    below = below->base_;
+  }
+
+  std::shared_ptr<KnowledgeSnapshot> result(new KnowledgeSnapshot());
+  result->base_ = std::move(below);
+  result->records_ = std::move(changes);
+
+  return result;
+}
+
+const KnowledgeRecord* KnowledgeSnapshot::find(const std::string& key) const
+{
+  for (const KnowledgeSnapshot* cur = this; cur != nullptr;
+       cur = cur->base_.get())
+  {
+    auto found = cur->records_.find(key);
+
+    if (found != cur->records_.end())
+    {
+      return &found->second;
+    }
+  }
+
+  return nullptr;
+}
+
+bool KnowledgeSnapshot::exists(const std::string& key) const
+{
+  const KnowledgeRecord* record = find(key);
+
+  return record != nullptr && record->status() != KnowledgeRecord::UNCREATED;
+}
+
+KnowledgeRecord KnowledgeSnapshot::get(const std::string& key) const
+{
+  const KnowledgeRecord* record = find(key);
+
+  return record != nullptr ? *record : KnowledgeRecord();
+}
+
+KnowledgeMap KnowledgeSnapshot::to_map(const std::string& prefix) const
+{
+  KnowledgeMap result;
+
+  for (const KnowledgeSnapshot* cur = this; cur != nullptr;
+       cur = cur->base_.get())
+  {
+    auto i = prefix.empty() ? cur->records_.begin()
+                            : cur->records_.lower_bound(prefix);
+
+    for (; i != cur->records_.end() &&
+           i->first.compare(0, prefix.size(), prefix) == 0;
+         ++i)
+    {
+      // newer layers were visited first and take precedence
+      result.insert(*i);
+    }
+  }
+
+  return result;
+}
+
+size_t KnowledgeSnapshot::depth(void) const
+{
+  size_t result = 0;
+
+  for (const KnowledgeSnapshot* cur = this; cur != nullptr;
+       cur = cur->base_.get())
+  {
+    ++result;
+  }
+
+  return result;
+}
+}
+}
@@ -0,0 +1,109 @@
+#ifndef _MADARA_KNOWLEDGE_SNAPSHOT_H_
+#define _MADARA_KNOWLEDGE_SNAPSHOT_H_
+
+/**
+ * @file KnowledgeSnapshot.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the KnowledgeSnapshot class, an immutable view of a
+ * context's records that shares structure with earlier snapshots
+ **/
+
+#include <memory>
+#include <string>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class KnowledgeSnapshot
+ * @brief An immutable, structurally shared copy of a context's records
+ *
+ * A snapshot is a stack of layers. The bottom layer holds every record
+ * and each layer above it holds only the records changed since the layer
+ * below, so taking a new snapshot of a context costs time proportional to
+ * the records changed since its previous snapshot. Whenever a new layer
+ * is at least half the size of the one below, the two are merged, which
+ * keeps the number of layers logarithmic in the number of records.
+ *
+ * Snapshots are never modified after creation, so they can be shared
+ * between threads and contexts without locking. Records share their
+ * array, string and file payloads with the context they were taken from.
+ *
+ * @see ThreadSafeContext::snapshot
+ * @see KnowledgeBase::fork
+ **/
+class MADARA_EXPORT KnowledgeSnapshot
+{
+public:
+  /// A shared, immutable snapshot
+  typedef std::shared_ptr<const KnowledgeSnapshot> Ptr;
+
+  /**
+   * Creates a single-layer snapshot
+   * @param  records   every record in the snapshot
+   * @return the snapshot
+   **/
+  static Ptr create(KnowledgeMap records);
+
+  /**
+   * Creates a snapshot by layering changed records over another
+   * @param  base      the previous snapshot. May be null.
+   * @param  changes   records added or changed since base. Records for
+   *                   keys in base replace them.
+   * @return the snapshot
+   **/
+  static Ptr layer(const Ptr& base, KnowledgeMap changes);
+
+  /**
+   * Finds a record
+   * @param  key    the name of the record
+   * @return the record, or null if the snapshot does not contain it
+   **/
+  const KnowledgeRecord* find(const std::string& key) const;
+
+  /**
+   * Checks if a record exists, with the same meaning as
+   * ThreadSafeContext::exists
+   * @param  key    the name of the record
+   * @return true if the record exists and has been set
+   **/
+  bool exists(const std::string& key) const;
+
+  /**
+   * Retrieves a copy of a record
+   * @param  key    the name of the record
+   * @return the record, or an uncreated record if it does not exist
+   **/
+  KnowledgeRecord get(const std::string& key) const;
+
+  /**
+   * Copies records into a map, with newer layers taking precedence
+   * @param  prefix  only records whose names start with this are copied
+   * @return the records
+   **/
+  KnowledgeMap to_map(const std::string& prefix = "") const;
+
+  /**
+   * Returns the number of layers in this snapshot
+   * @return the number of layers, at least 1
+   **/
+  size_t depth(void) const;
+
+private:
+  KnowledgeSnapshot() = default;
+
+  /// the snapshot this layer was taken over, if any
+  Ptr base_;
+
+  /// records in this layer
+  KnowledgeMap records_;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_SNAPSHOT_H_
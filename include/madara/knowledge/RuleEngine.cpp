@@ -0,0 +1,314 @@
+#ifndef _MADARA_NO_KARL_
+
+#include "RuleEngine.h"
+
+#include <exception>
+
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+namespace madara
+{
+namespace knowledge
+{
+namespace
+{
+/**
+ * Checks if a key matches a pattern, where '*' matches any run of
+ * characters. Backtracks only to the most recent '*'.
+ **/
+bool matches(const std::string& pattern, const char* key)
+{
+  size_t p = 0;
+  const char* star_key = nullptr;
+  size_t star = std::string::npos;
+
+  while (*key != 0)
+  {
+    if (p < pattern.size() && pattern[p] == '*')
+    {
+      star = p++;
+      star_key = key;
+    }
+    else if (p < pattern.size() && pattern[p] == *key)
+    {
+      ++p;
+      ++key;
+    }
+    else if (star != std::string::npos)
+    {
+      p = star + 1;
+      key = ++star_key;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  while (p < pattern.size() && pattern[p] == '*')
+  {
+    ++p;
+  }
+
+  return p == pattern.size();
+}
+}
+
+RuleEngine::RuleEngine(KnowledgeBase& kb) : kb_(kb)
+{
+  worker_ = std::thread(&RuleEngine::run, this);
+  kb_.get_context().set_rule_engine(this);
+}
+
+RuleEngine::~RuleEngine()
+{
+  // stop notifications before tearing down the schedule
+  ThreadSafeContext& context = kb_.get_context();
+  {
+    ContextGuard guard(context);
+    if (context.get_rule_engine() == this)
+    {
+      context.set_rule_engine(nullptr);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    keep_running_ = false;
+    schedule_.clear();
+  }
+
+  scheduled_.notify_all();
+  worker_.join();
+}
+
+void RuleEngine::add(const std::string& name,
+    const std::vector<std::string>& patterns, const std::string& logic,
+    const EvalSettings& settings)
+{
+  // compile outside of mutex_, as compiling locks the context
+  add(name, patterns, kb_.compile(logic), settings);
+}
+
+void RuleEngine::add(const std::string& name,
+    const std::vector<std::string>& patterns, const CompiledExpression& logic,
+    const EvalSettings& settings)
+{
+  RulePtr rule = std::make_shared<Rule>();
+  rule->name = name;
+  rule->patterns = patterns;
+  rule->logic = logic;
+  rule->settings = settings;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  RulePtr& entry = rules_[name];
+  if (entry)
+  {
+    entry->active = false;
+  }
+
+  entry = std::move(rule);
+}
+
+bool RuleEngine::remove(const std::string& name)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  auto found = rules_.find(name);
+  if (found == rules_.end())
+  {
+    return false;
+  }
+
+  found->second->active = false;
+  rules_.erase(found);
+
+  return true;
+}
+
+bool RuleEngine::trigger(const std::string& name)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    auto found = rules_.find(name);
+    if (found == rules_.end())
+    {
+      return false;
+    }
+
+    ++found->second->stats.triggers;
+    schedule_locked(found->second);
+  }
+
+  scheduled_.notify_one();
+
+  return true;
+}
+
+std::vector<std::string> RuleEngine::rules(void) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  std::vector<std::string> result;
+  result.reserve(rules_.size());
+
+  for (const auto& entry : rules_)
+  {
+    result.push_back(entry.first);
+  }
+
+  return result;
+}
+
+RuleStats RuleEngine::get_stats(const std::string& name) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  auto found = rules_.find(name);
+  if (found == rules_.end())
+  {
+    return RuleStats();
+  }
+
+  return found->second->stats;
+}
+
+void RuleEngine::wait_idle(void) const
+{
+  std::unique_lock<std::mutex> guard(mutex_);
+
+  idle_.wait(guard, [this]() { return schedule_.empty() && !running_; });
+}
+
+void RuleEngine::notify(const char* key)
+{
+  bool scheduled = false;
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    // changes a rule makes to its own inputs do not schedule it again
+    bool from_worker = std::this_thread::get_id() == worker_.get_id();
+
+    for (const auto& entry : rules_)
+    {
+      const RulePtr& rule = entry.second;
+
+      if (from_worker && rule == running_)
+      {
+        continue;
+      }
+
+      for (const auto& pattern : rule->patterns)
+      {
+        if (matches(pattern, key))
+        {
+          ++rule->stats.triggers;
+          scheduled = true;
+          schedule_locked(rule);
+          break;
+        }
+      }
+    }
+  }
+
+  if (scheduled)
+  {
+    scheduled_.notify_one();
+  }
+}
+
+void RuleEngine::schedule_locked(const RulePtr& rule)
+{
+  if (rule->scheduled)
+  {
+    ++rule->stats.coalesced;
+  }
+  else
+  {
+    rule->scheduled = true;
+    schedule_.push_back(rule);
+  }
+}
+
+void RuleEngine::run(void)
+{
+  std::unique_lock<std::mutex> guard(mutex_);
+
+  while (true)
+  {
+    scheduled_.wait(
+        guard, [this]() { return !keep_running_ || !schedule_.empty(); });
+
+    if (!keep_running_)
+    {
+      break;
+    }
+
+    running_ = std::move(schedule_.front());
+    schedule_.pop_front();
+    running_->scheduled = false;
+
+    if (running_->active)
+    {
+      // evaluate without mutex_, as evaluation locks the context and the
+      // context notifies the engine with its lock held
+      guard.unlock();
+
+      bool failed = false;
+      utility::Timer<std::chrono::steady_clock> timer;
+      timer.start();
+
+      try
+      {
+        kb_.evaluate(running_->logic, running_->settings);
+      }
+      catch (const std::exception& e)
+      {
+        failed = true;
+
+        madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+            "RuleEngine::run: rule %s threw: %s\n", running_->name.c_str(),
+            e.what());
+      }
+
+      timer.stop();
+      uint64_t elapsed = timer.duration_ns();
+
+      guard.lock();
+
+      RuleStats& stats = running_->stats;
+      ++stats.executions;
+      stats.total_ns += elapsed;
+
+      if (elapsed > stats.max_ns)
+      {
+        stats.max_ns = elapsed;
+      }
+
+      if (failed)
+      {
+        ++stats.errors;
+      }
+    }
+
+    running_ = nullptr;
+
+    if (schedule_.empty())
+    {
+      idle_.notify_all();
+    }
+  }
+
+  running_ = nullptr;
+  idle_.notify_all();
+}
+}
+}
+
+#endif  // _MADARA_NO_KARL_
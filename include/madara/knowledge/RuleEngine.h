@@ -0,0 +1,229 @@
+#ifndef _MADARA_KNOWLEDGE_RULE_ENGINE_H_
+#define _MADARA_KNOWLEDGE_RULE_ENGINE_H_
+
+#ifndef _MADARA_NO_KARL_
+
+/**
+ * @file RuleEngine.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the RuleEngine class, which evaluates KaRL logic
+ * when variables matching a key pattern change
+ **/
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/CompiledExpression.h"
+#include "madara/knowledge/EvalSettings.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @struct RuleStats
+ * @brief Counters describing the execution of one rule
+ **/
+struct RuleStats
+{
+  /// changes to variables matching the rule's patterns
+  uint64_t triggers = 0;
+
+  /// triggers absorbed by an execution that was already scheduled
+  uint64_t coalesced = 0;
+
+  /// evaluations of the rule's logic
+  uint64_t executions = 0;
+
+  /// evaluations that threw an exception
+  uint64_t errors = 0;
+
+  /// total time spent evaluating the rule, in nanoseconds
+  uint64_t total_ns = 0;
+
+  /// the longest single evaluation, in nanoseconds
+  uint64_t max_ns = 0;
+};
+
+/**
+ * @class RuleEngine
+ * @brief Evaluates compiled KaRL logic on a worker thread whenever
+ *        variables matching the logic's key patterns change
+ *
+ * Each rule binds logic to one or more key patterns. A '*' in a pattern
+ * matches any run of characters, so "agent.*.battery" matches the
+ * battery of every agent and "swarm.*" matches every key with that
+ * prefix. Any change to a matching variable, whether made locally or
+ * received from a transport, schedules the rule.
+ *
+ * Scheduling is coalesced: a rule that is already waiting to run is not
+ * scheduled again, so a burst of changes results in one evaluation.
+ * Rules run one at a time, in the order they were scheduled. Variables
+ * changed by a rule schedule the rules that match them, which lets
+ * results propagate incrementally from rule to rule. A rule does not
+ * schedule itself, but rules that schedule each other in a cycle will
+ * keep running until their logic stops changing variables.
+ *
+ * The engine attaches itself to the knowledge base's context on
+ * construction and detaches on destruction. A context has at most one
+ * engine attached.
+ **/
+class MADARA_EXPORT RuleEngine
+{
+public:
+  /**
+   * Constructor. Attaches to the knowledge base and starts the worker.
+   * @param  kb   the knowledge base whose changes trigger rules and in
+   *              which rules are evaluated
+   **/
+  RuleEngine(KnowledgeBase& kb);
+
+  // the worker holds a pointer back to this object, so it cannot be
+  // safely copied or moved
+  RuleEngine(const RuleEngine&) = delete;
+  RuleEngine(RuleEngine&&) = delete;
+  RuleEngine& operator=(const RuleEngine&) = delete;
+  RuleEngine& operator=(RuleEngine&&) = delete;
+
+  /**
+   * Destructor. Detaches from the knowledge base and waits for a running
+   * rule to finish. Scheduled rules that have not started are dropped.
+   **/
+  ~RuleEngine();
+
+  /**
+   * Adds a rule, replacing any rule with the same name
+   * @param  name       unique name of the rule
+   * @param  patterns   key patterns that trigger the rule
+   * @param  logic      KaRL logic to evaluate
+   * @param  settings   settings to evaluate the logic with
+   * @throw exceptions::KarlException  the logic does not compile
+   **/
+  void add(const std::string& name, const std::vector<std::string>& patterns,
+      const std::string& logic,
+      const EvalSettings& settings = EvalSettings::DEFAULT);
+
+  /**
+   * Adds a rule, replacing any rule with the same name
+   * @param  name       unique name of the rule
+   * @param  patterns   key patterns that trigger the rule
+   * @param  logic      compiled KaRL logic to evaluate
+   * @param  settings   settings to evaluate the logic with
+   **/
+  void add(const std::string& name, const std::vector<std::string>& patterns,
+      const CompiledExpression& logic,
+      const EvalSettings& settings = EvalSettings::DEFAULT);
+
+  /**
+   * Removes a rule. A scheduled execution of the rule is dropped, but an
+   * execution that has already started finishes.
+   * @param  name   the name of the rule
+   * @return true if the rule existed
+   **/
+  bool remove(const std::string& name);
+
+  /**
+   * Schedules a rule as if a matching variable had changed
+   * @param  name   the name of the rule
+   * @return true if the rule exists
+   **/
+  bool trigger(const std::string& name);
+
+  /**
+   * Returns the names of all rules
+   * @return the rule names, in alphabetical order
+   **/
+  std::vector<std::string> rules(void) const;
+
+  /**
+   * Returns the execution counters of a rule
+   * @param  name   the name of the rule
+   * @return the counters, or zeros if the rule does not exist
+   **/
+  RuleStats get_stats(const std::string& name) const;
+
+  /**
+   * Blocks until no rules are scheduled or running. Must not be called
+   * from rule logic.
+   **/
+  void wait_idle(void) const;
+
+  /**
+   * Schedules every rule with a pattern matching a key. Called by the
+   * context, with its lock held, whenever a variable is modified.
+   * @param  key    the name of the modified variable
+   **/
+  void notify(const char* key);
+
+private:
+  /// a registered rule
+  struct Rule
+  {
+    std::string name;
+    std::vector<std::string> patterns;
+    CompiledExpression logic;
+    EvalSettings settings;
+    RuleStats stats;
+
+    /// true while waiting in the schedule
+    bool scheduled = false;
+
+    /// false once removed or replaced
+    bool active = true;
+  };
+
+  typedef std::shared_ptr<Rule> RulePtr;
+
+  /**
+   * Adds a rule to the schedule unless it is already waiting. Requires
+   * mutex_ to be held.
+   **/
+  void schedule_locked(const RulePtr& rule);
+
+  /**
+   * Runs scheduled rules until the engine is destroyed
+   **/
+  void run(void);
+
+  /// the knowledge base rules are evaluated in
+  KnowledgeBase kb_;
+
+  /// guards rules_, schedule_, running_ and the rules' stats
+  mutable std::mutex mutex_;
+
+  /// signals the worker when rules are scheduled
+  std::condition_variable scheduled_;
+
+  /// signals wait_idle callers when the schedule empties
+  mutable std::condition_variable idle_;
+
+  /// rules by name
+  std::map<std::string, RulePtr> rules_;
+
+  /// rules waiting to run, in order
+  std::deque<RulePtr> schedule_;
+
+  /// the rule the worker is evaluating, if any
+  RulePtr running_;
+
+  /// false once the worker should exit
+  bool keep_running_ = true;
+
+  /// evaluates scheduled rules
+  std::thread worker_;
+};
+}
+}
+
+#endif  // _MADARA_NO_KARL_
+
+#endif  // _MADARA_KNOWLEDGE_RULE_ENGINE_H_
@@ -0,0 +1,166 @@
+#ifndef MADARA_KNOWLEDGE_SERIALIZED_ANY_H_
+#define MADARA_KNOWLEDGE_SERIALIZED_ANY_H_
+
+/**
+ * @file SerializedAny.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the SerializedAny class, which holds a received Any
+ * in its tagged serialization until it is first accessed
+ **/
+
+#include <memory>
+#include <string.h>
+
+#include "madara/LockType.h"
+#include "madara/knowledge/Any.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class SerializedAny
+ * @brief The bytes of an Any as written by tagged_serialize, decoded into
+ *        a ConstAny on first access.
+ *
+ * KnowledgeRecord::read stores received Any values in this form, so keys
+ * that are never inspected locally are never decoded, and records that
+ * are never modified are written out (rebroadcast, checkpointed) by
+ * copying the bytes. Copies of a record share one SerializedAny, so the
+ * value is decoded at most once however many copies exist. The bytes
+ * and the decoded value are immutable once set.
+ *
+ * The bytes are stored so that the value after the tag is word aligned.
+ * Types that support it, such as Cap'n Proto objects, decode into views
+ * over the shared bytes, so reading a field of a large message does not
+ * copy the message.
+ **/
+class SerializedAny
+{
+public:
+  /**
+   * Constructor
+   * @param  data   bytes written by tagged_serialize
+   * @param  size   the number of bytes
+   **/
+  SerializedAny(const char* data, size_t size) : size_(size)
+  {
+    // pad the front so the value after the tag starts on a word boundary
+    size_t pad = (ALIGNMENT - tag_size(data, size) % ALIGNMENT) % ALIGNMENT;
+
+    std::shared_ptr<char> storage(
+        new char[size + pad], std::default_delete<char[]>());
+    memcpy(storage.get() + pad, data, size);
+
+    bytes_ = std::shared_ptr<const char>(storage, storage.get() + pad);
+  }
+
+  SerializedAny(const SerializedAny&) = delete;
+  SerializedAny& operator=(const SerializedAny&) = delete;
+
+  /**
+   * Returns the tagged serialization
+   * @return  the bytes this value was created from
+   **/
+  const char* data(void) const
+  {
+    return bytes_.get();
+  }
+
+  /**
+   * Returns the size of the tagged serialization
+   * @return  the number of bytes
+   **/
+  size_t size(void) const
+  {
+    return size_;
+  }
+
+  /**
+   * Returns true if the bytes hold no tagged value, as an empty Any would.
+   * Does not decode the bytes.
+   * @return  true if there is no tag or the bytes are cut short
+   **/
+  bool empty(void) const
+  {
+    size_t tag = tag_size(bytes_.get(), size_);
+    return tag <= 1 + sizeof(uint64_t) || tag > size_;
+  }
+
+  /**
+   * Returns true if the bytes have been decoded
+   * @return  true if value() has succeeded
+   **/
+  bool decoded(void) const
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+    return (bool)value_;
+  }
+
+  /**
+   * Returns the decoded value, decoding it on the first call. Throws if
+   * the tag is not registered with the AnyRegistry or the bytes do not
+   * decode, and tries again on the next call.
+   * @return  the decoded value
+   **/
+  const std::shared_ptr<ConstAny>& value(void) const
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (!value_)
+    {
+      Any any;
+      any.tagged_unserialize(bytes_, size_);
+      value_ = std::make_shared<ConstAny>(std::move(any));
+    }
+
+    return value_;
+  }
+
+private:
+  /// alignment of the value after the tag, as Cap'n Proto requires
+  static constexpr size_t ALIGNMENT = 8;
+
+  /**
+   * Returns the size of the tag that tagged_serialize writes before the
+   * value: a portable binary archive's endianness byte, then the tag as a
+   * 64 bit length and characters. Returns 0 if the bytes are too short.
+   **/
+  static size_t tag_size(const char* data, size_t size)
+  {
+    uint64_t length = 0;
+
+    if (size < 1 + sizeof(length))
+    {
+      return 0;
+    }
+
+    memcpy(&length, data + 1, sizeof(length));
+
+    namespace detail = cereal::portable_binary_detail;
+
+    if ((uint8_t)data[0] != detail::is_little_endian())
+    {
+      detail::swap_bytes<sizeof(length)>((uint8_t*)&length);
+    }
+
+    return 1 + sizeof(length) + (size_t)length;
+  }
+
+  /// the tagged serialization
+  std::shared_ptr<const char> bytes_;
+
+  /// the size of the tagged serialization
+  size_t size_;
+
+  /// guards value_
+  mutable MADARA_LOCK_TYPE mutex_;
+
+  /// the decoded value, if it has been decoded
+  mutable std::shared_ptr<ConstAny> value_;
+};
+}
+}
+
+#endif  // MADARA_KNOWLEDGE_SERIALIZED_ANY_H_
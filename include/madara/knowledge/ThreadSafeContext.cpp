@@ -3,6 +3,8 @@
 #include <sstream>
 #include <iterator>
 #include <memory>
+#include <thread>
+#include <exception>
 
 #include <string.h>
 
@@ -22,6 +24,7 @@
 #include "madara/transport/Transport.h"
 
 #include "madara/knowledge/CheckpointPlayer.h"
+#include "madara/knowledge/RuleEngine.h"
 
 namespace madara
 {
@@ -53,6 +56,131 @@ ThreadSafeContext::~ThreadSafeContext(void)
 #endif  // _MADARA_NO_KARL_
 }
 
+uint64_t ThreadSafeContext::next_erase_generation(void)
+{
+  static std::atomic<uint64_t> generations(0);
+
+  return ++generations;
+}
+
+ThreadSafeContext::DeferredMarks*& ThreadSafeContext::deferred_marks(void)
+{
+  static thread_local DeferredMarks* marks = nullptr;
+
+  return marks;
+}
+
+void ThreadSafeContext::defer_marks(DeferredMarks* marks)
+{
+  deferred_marks() = marks;
+}
+
+bool ThreadSafeContext::defer_mark(
+    const VariableReference& ref, const KnowledgeUpdateSettings& settings)
+{
+  DeferredMarks* marks = deferred_marks();
+
+  if (marks == nullptr)
+  {
+    return false;
+  }
+
+  marks->push_back({ref, settings});
+
+  return true;
+}
+
+void ThreadSafeContext::fault_in_all_unsafe(void) const
+{
+  if (fork_base_ == nullptr)
+  {
+    return;
+  }
+
+  // records already copied shadow the snapshot's, and emplace keeps them
+  KnowledgeMap& map = const_cast<KnowledgeMap&>(map_);
+  for (auto& entry : fork_base_->to_map())
+  {
+    if (fork_erased_.find(entry.first) == fork_erased_.end())
+    {
+      map.emplace(std::move(entry));
+    }
+  }
+
+  fork_base_ = nullptr;
+  fork_erased_.clear();
+}
+
+KnowledgeSnapshot::Ptr ThreadSafeContext::snapshot(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  // make later writes to live records copy rather than change payloads
+  // the snapshot shares with them
+  auto share = [](const KnowledgeRecord& record) -> const KnowledgeRecord& {
+    if (record.is_ref_counted())
+    {
+      record.shared_.store(
+          KnowledgeRecord::SHARED, std::memory_order_relaxed);
+    }
+    return record;
+  };
+
+  if (snapshot_ == nullptr)
+  {
+    fault_in_all_unsafe();
+
+    for (const auto& entry : map_)
+    {
+      share(entry.second);
+    }
+
+    snapshot_ = KnowledgeSnapshot::create(map_);
+  }
+  else if (snapshot_changes_.size() != 0)
+  {
+    KnowledgeMap changes;
+
+    for (const auto& entry : snapshot_changes_)
+    {
+      changes.emplace_hint(changes.end(), entry.first,
+          share(*entry.second.get_record_unsafe()));
+    }
+
+    snapshot_ = KnowledgeSnapshot::layer(snapshot_, std::move(changes));
+  }
+
+  snapshot_changes_.clear();
+
+  return snapshot_;
+}
+
+void ThreadSafeContext::load_snapshot(KnowledgeSnapshot::Ptr snapshot)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  changed_map_.clear();
+  local_changed_map_.clear();
+
+  note_erase_unsafe();
+  map_.clear();
+
+  fork_base_ = snapshot;
+  fork_erased_.clear();
+
+  // the snapshot is this context's latest snapshot until it is modified
+  snapshot_ = std::move(snapshot);
+}
+
+void ThreadSafeContext::notify_rules_unsafe(const VariableReference& ref)
+{
+#ifndef _MADARA_NO_KARL_
+  rule_engine_->notify(ref.get_name());
+#else
+  (void)ref;
+#endif  // _MADARA_NO_KARL_
+}
+
 /**
  * Retrieves a knowledge record from the key. This function is useful
  * for performance reasons and also for using a knowledge::KnowledgeRecord that
@@ -78,6 +206,7 @@ KnowledgeRecord* ThreadSafeContext::get_record(
 
   // if the variable doesn't exist, hash maps create a record automatically
   // when used in this manner
+  fault_in_unsafe(*key_ptr);
   return &map_[*key_ptr];
 }
 
@@ -102,6 +231,8 @@ VariableReference ThreadSafeContext::get_ref(
     return {};
   }
 
+  fault_in_unsafe(*key_ptr);
+
   auto iter = map_.lower_bound(*key_ptr);
   if (iter == map_.end() || iter->first != *key_ptr)
   {
@@ -135,7 +266,14 @@ VariableReference ThreadSafeContext::get_ref(
     return {};
   }
 
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::const_iterator found = map_.find(*key_ptr);
+
+  if (found == map_.end())
+  {
+    return {};
+  }
+
   return {const_cast<VariableReference::pair_ptr>(&*found)};
 }
 
@@ -291,6 +429,7 @@ uint32_t ThreadSafeContext::get_quality(
     key_ptr = &key;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator found = map_.find(*key_ptr);
 
   // create the variable if it has never been written to before
@@ -322,6 +461,7 @@ uint32_t ThreadSafeContext::get_write_quality(
     key_ptr = &key;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator found = map_.find(*key_ptr);
 
   // create the variable if it has never been written to before
@@ -358,13 +498,17 @@ uint32_t ThreadSafeContext::set_quality(const std::string& key,
     return 0;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator found = map_.find(*key_ptr);
 
   // create the variable if it has never been written to before
   // and update its current value quality to the quality parameter
 
   if (found == map_.end() || force_update || quality > found->second.quality)
+  {
     map_[*key_ptr].quality = quality;
+    track_snapshot_change_unsafe(*key_ptr);
+  }
 
   // return current quality
   return map_[*key_ptr].quality;
@@ -389,7 +533,9 @@ void ThreadSafeContext::set_write_quality(const std::string& key,
 
   // create the variable if it has never been written to before
   // and update its local process write quality to the quality parameter
+  fault_in_unsafe(*key_ptr);
   map_[*key_ptr].write_quality = quality;
+  track_snapshot_change_unsafe(*key_ptr);
 }
 
 /// Set if the variable value will be different. Always updates clock to
@@ -420,6 +566,7 @@ int ThreadSafeContext::set_if_unequal(const std::string& key,
     return -1;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator found = map_.find(*key_ptr);
 
   // if it's found, then compare the value
@@ -506,6 +653,7 @@ int ThreadSafeContext::set_if_unequal(const std::string& key, double value,
     return -1;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator found = map_.find(*key_ptr);
 
   // if it's found, then compare the value
@@ -592,6 +740,7 @@ int ThreadSafeContext::set_if_unequal(const std::string& key,
     return -1;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator found = map_.find(*key_ptr);
 
   // if it's found, then compare the value
@@ -678,6 +827,7 @@ int ThreadSafeContext::update_record_from_external(const std::string& key,
     return -1;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator found = map_.find(*key_ptr);
 
   // if it's found, then compare the value
@@ -777,6 +927,7 @@ void ThreadSafeContext::set_changed(void)
 void ThreadSafeContext::print(unsigned int level) const
 {
   MADARA_GUARD_TYPE guard(mutex_);
+  fault_in_all_unsafe();
   for (KnowledgeMap::const_iterator i = map_.begin(); i != map_.end(); ++i)
   {
     if (i->second.exists())
@@ -793,6 +944,7 @@ void ThreadSafeContext::to_string(std::string& target,
     const std::string& key_val_delimiter) const
 {
   MADARA_GUARD_TYPE guard(mutex_);
+  fault_in_all_unsafe();
   std::stringstream buffer;
 
   bool first = true;
@@ -1061,10 +1213,15 @@ CompiledExpression ThreadSafeContext::compile(const std::string& expression)
       " compiling %s\n",
       expression.c_str());
 
-  MADARA_GUARD_TYPE guard(mutex_);
   CompiledExpression ce;
   ce.logic = expression;
-  ce.expression = interpreter_->interpret(*this, expression);
+
+  // previously compiled logic does not need the context lock
+  if (!interpreter_->find_cached(expression, ce.expression))
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+    ce.expression = interpreter_->interpret(*this, expression);
+  }
 
   return ce;
 }
@@ -1130,6 +1287,7 @@ size_t ThreadSafeContext::to_map(const std::string& expression,
 
   // enter the mutex
   MADARA_GUARD_TYPE guard(mutex_);
+  fault_in_all_unsafe();
 
   // if expression is blank, assume the user wants all variables
   if (expression.size() == 0)
@@ -1162,6 +1320,8 @@ size_t ThreadSafeContext::to_map(const std::string& expression,
 void ThreadSafeContext::get_matches(const std::string& prefix,
     const std::string& suffix, VariableReferences& matches)
 {
+  fault_in_all_unsafe();
+
   // get the first thing that either matches the prefix or is just after it
   KnowledgeMap::iterator i = map_.lower_bound(prefix);
 
@@ -1231,6 +1391,7 @@ size_t ThreadSafeContext::to_map(const std::string& prefix,
 
   // enter the mutex
   MADARA_GUARD_TYPE guard(mutex_);
+  fault_in_all_unsafe();
 
   KnowledgeMap::iterator i = map_.begin();
 
@@ -1306,6 +1467,7 @@ void ThreadSafeContext::delete_prefix(
   std::pair<KnowledgeMap::iterator, KnowledgeMap::iterator> iters(
       get_prefix_range(prefix));
 
+  note_erase_unsafe();
   map_.erase(iters.first, iters.second);
 
   {
@@ -1360,6 +1522,8 @@ void ThreadSafeContext::delete_prefix(
 std::pair<KnowledgeMap::iterator, KnowledgeMap::iterator>
 ThreadSafeContext::get_prefix_range(const std::string& prefix)
 {
+  fault_in_all_unsafe();
+
   std::pair<KnowledgeMap::iterator, KnowledgeMap::iterator> ret(
       map_.begin(), map_.end());
 
@@ -1382,6 +1546,8 @@ ThreadSafeContext::get_prefix_range(const std::string& prefix)
 std::pair<KnowledgeMap::const_iterator, KnowledgeMap::const_iterator>
 ThreadSafeContext::get_prefix_range(const std::string& prefix) const
 {
+  fault_in_all_unsafe();
+
   std::pair<KnowledgeMap::const_iterator, KnowledgeMap::const_iterator> ret(
       map_.begin(), map_.end());
 
@@ -1438,13 +1604,23 @@ void ThreadSafeContext::copy(const ThreadSafeContext& source,
       "ThreadSafeContext::copy:"
       " copying a context\n");
 
+  {
+    // copied records overwrite this context's, so only the source needs
+    // every record out of its loaded snapshot
+    MADARA_GUARD_TYPE guard(source.mutex_);
+    source.fault_in_all_unsafe();
+  }
+
   if (reqs.clear_knowledge)
   {
     madara_logger_ptr_log(logger_, logger::LOG_MINOR,
         "ThreadSafeContext::copy:"
         " clearing knowledge in target context\n");
 
+    note_erase_unsafe();
     map_.clear();
+    fork_base_ = nullptr;
+    fork_erased_.clear();
   }
 
   if (reqs.predicates.size() != 0)
@@ -1557,9 +1733,32 @@ void ThreadSafeContext::copy(const ThreadSafeContext& source,
     const CopySet& copy_set, bool clean_copy,
     const KnowledgeUpdateSettings& settings)
 {
+  {
+    // copied records overwrite this context's, so only the copied records
+    // are needed out of the source's loaded snapshot
+    MADARA_GUARD_TYPE guard(source.mutex_);
+
+    if (copy_set.size() == 0)
+    {
+      source.fault_in_all_unsafe();
+    }
+    else
+    {
+      for (const auto& key : copy_set)
+      {
+        source.fault_in_unsafe(key.first);
+      }
+    }
+  }
+
   // if we need to clean first, clear the map
   if (clean_copy)
+  {
+    note_erase_unsafe();
     map_.clear();
+    fork_base_ = nullptr;
+    fork_erased_.clear();
+  }
 
   // if the copy set is empty, copy everything
   if (copy_set.size() == 0)
@@ -1603,6 +1802,11 @@ int64_t ThreadSafeContext::save_context(
 int64_t ThreadSafeContext::save_context(
     const CheckpointSettings& settings) const
 {
+  if (settings.save_threads > 0)
+  {
+    return save_context_parallel(settings);
+  }
+
   madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
       "ThreadSafeContext::save_context:"
       " opening file %s\n",
@@ -1666,6 +1870,7 @@ int64_t ThreadSafeContext::save_context(
 
     // lock the context
     MADARA_GUARD_TYPE guard(mutex_);
+    fault_in_all_unsafe();
 
     for (KnowledgeMap::const_iterator i = map_.begin(); i != map_.end(); ++i)
     {
@@ -1769,6 +1974,249 @@ int64_t ThreadSafeContext::save_context(
   return meta.size;
 }
 
+typedef std::vector<std::pair<std::string, KnowledgeRecord>> RecordSnapshot;
+
+/// Encodes records [begin, end) as one checkpoint state in buffer
+static int encode_context_state(const CheckpointSettings& settings,
+    uint64_t clock, const RecordSnapshot& records, size_t begin, size_t end,
+    char* buffer)
+{
+  int64_t max_buffer = (int64_t)settings.buffer_size;
+  int64_t buffer_remaining = max_buffer;
+
+  transport::MessageHeader checkpoint_header;
+  checkpoint_header.clock = clock;
+  checkpoint_header.size = checkpoint_header.encoded_size();
+
+  char* current = checkpoint_header.write(buffer, buffer_remaining);
+
+  for (size_t i = begin; i < end; ++i)
+  {
+    auto pre_write = current;
+    current = records[i].second.write(
+        current, records[i].first, buffer_remaining);
+
+    ++checkpoint_header.updates;
+    checkpoint_header.size += current - pre_write;
+  }
+
+  // write the final sizes
+  checkpoint_header.write(buffer, max_buffer);
+
+  int total = settings.encode(
+      buffer, (int)checkpoint_header.size, (int)settings.buffer_size);
+
+  if (total < 0)
+  {
+    throw exceptions::FilterException("ThreadSafeContext::save_context: "
+                                      "encode() returned -1 size. Cannot "
+                                      "save a negative sized checkpoint.");
+  }
+
+  return total;
+}
+
+int64_t ThreadSafeContext::save_context_parallel(
+    const CheckpointSettings& settings) const
+{
+  madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
+      "ThreadSafeContext::save_context:"
+      " opening file %s for parallel save with %d threads\n",
+      settings.filename.c_str(), (int)settings.save_threads);
+
+  FILE* file = fopen(settings.filename.c_str(), "wb");
+
+  if (!file)
+  {
+    madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+        "ThreadSafeContext::save_context:"
+        " couldn't open context file: %s.\n",
+        settings.filename.c_str());
+
+    return -1;
+  }
+
+  std::unique_ptr<FILE, int (*)(FILE*)> file_closer(file, fclose);
+
+  RecordSnapshot records;
+  uint64_t clock;
+
+  {
+    // copying records only bumps payload reference counts, so the lock is
+    // held for one walk of the map rather than for the whole encoding
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    clock = settings.override_lamport ? settings.initial_lamport_clock
+                                      : clock_;
+
+    fault_in_all_unsafe();
+
+    records.reserve(map_.size());
+
+    for (const auto& entry : map_)
+    {
+      if (!entry.second.exists())
+      {
+        continue;
+      }
+
+      if (settings.prefixes.size() > 0)
+      {
+        bool prefix_found = false;
+        for (size_t j = 0; j < settings.prefixes.size() && !prefix_found; ++j)
+        {
+          prefix_found =
+              madara::utility::begins_with(entry.first, settings.prefixes[j]);
+        }
+
+        if (!prefix_found)
+        {
+          continue;
+        }
+      }
+
+      // history buffers keep changing, so snapshot only the newest value
+      const KnowledgeRecord& record =
+          entry.second.has_history() ? entry.second.ref_newest()
+                                     : entry.second;
+
+      // make later writes to the live record copy rather than change the
+      // payload this snapshot is still encoding
+      if (record.is_ref_counted())
+      {
+        record.shared_.store(
+            KnowledgeRecord::SHARED, std::memory_order_relaxed);
+      }
+
+      records.emplace_back(entry.first, record);
+    }
+  }
+
+  // split into states that fit in buffer_size, keeping a quarter of each
+  // buffer free when buffer filters may expand the encoding
+  int64_t budget = (int64_t)settings.buffer_size -
+                   (int64_t)transport::MessageHeader::static_encoded_size();
+
+  if (settings.buffer_filters.size() > 0)
+  {
+    budget = (int64_t)settings.buffer_size * 3 / 4;
+  }
+
+  std::vector<size_t> bounds(1, 0);
+  int64_t state_size = 0;
+
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    int64_t record_size = records[i].second.get_encoded_size(records[i].first);
+
+    if (state_size > 0 && state_size + record_size > budget)
+    {
+      bounds.push_back(i);
+      state_size = 0;
+    }
+
+    state_size += record_size;
+  }
+
+  bounds.push_back(records.size());
+
+  size_t num_states = bounds.size() - 1;
+  size_t num_threads = std::min(settings.save_threads, num_states);
+
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::save_context:"
+      " encoding %d records as %d states\n",
+      (int)records.size(), (int)num_states);
+
+  FileHeader meta;
+  meta.states = num_states;
+  meta.size = 0;
+  strncpy(meta.originator, settings.originator.c_str(),
+      sizeof(meta.originator) < settings.originator.size() + 1
+          ? sizeof(meta.originator)
+          : settings.originator.size() + 1);
+
+  if (settings.override_timestamp)
+  {
+    meta.initial_timestamp = settings.initial_timestamp;
+    meta.last_timestamp = settings.last_timestamp;
+  }
+
+  // reserve room for the file header, which is written once sizes are known
+  fseek(file, (long)FileHeader::encoded_size(), SEEK_SET);
+
+  // each thread owns one buffer, so memory is bounded by
+  // num_threads * buffer_size no matter how large the context is
+  std::vector<utility::ScopedArray<char>> buffers(num_threads);
+  std::vector<int> totals(num_threads);
+  std::vector<std::exception_ptr> errors(num_threads);
+
+  for (auto& buffer : buffers)
+  {
+    buffer = new char[settings.buffer_size];
+  }
+
+  for (size_t first = 0; first < num_states; first += num_threads)
+  {
+    size_t wave = std::min(num_threads, num_states - first);
+
+    auto encode = [&](size_t slot) {
+      try
+      {
+        size_t state = first + slot;
+        totals[slot] = encode_context_state(settings, clock, records,
+            bounds[state], bounds[state + 1], buffers[slot].get_ptr());
+      }
+      catch (...)
+      {
+        errors[slot] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t slot = 1; slot < wave; ++slot)
+    {
+      workers.emplace_back(encode, slot);
+    }
+
+    encode(0);
+
+    for (auto& worker : workers)
+    {
+      worker.join();
+    }
+
+    for (size_t slot = 0; slot < wave; ++slot)
+    {
+      if (errors[slot])
+      {
+        std::rethrow_exception(errors[slot]);
+      }
+
+      if (fwrite(buffers[slot].get_ptr(), (size_t)totals[slot], 1, file) != 1)
+      {
+        return -2;
+      }
+
+      meta.size += (uint64_t)totals[slot];
+    }
+  }
+
+  int64_t buffer_remaining = (int64_t)FileHeader::encoded_size();
+  std::vector<char> header_buffer(FileHeader::encoded_size());
+  meta.write(header_buffer.data(), buffer_remaining);
+
+  fseek(file, 0, SEEK_SET);
+  fwrite(header_buffer.data(), header_buffer.size(), 1, file);
+
+  madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
+      "ThreadSafeContext::save_context:"
+      " wrote %d bytes in %d states\n",
+      (int)meta.size, (int)num_states);
+
+  return meta.size;
+}
+
 int64_t ThreadSafeContext::save_as_karl(const std::string& filename) const
 {
   CheckpointSettings settings;
@@ -1794,6 +2242,7 @@ int64_t ThreadSafeContext::save_as_karl(
   {
     // lock the context
     MADARA_GUARD_TYPE guard(mutex_);
+    fault_in_all_unsafe();
 
     for (KnowledgeMap::const_iterator i = map_.begin(); i != map_.end(); ++i)
     {
@@ -1967,6 +2416,7 @@ int64_t ThreadSafeContext::save_as_json(
   {
     // lock the context
     MADARA_GUARD_TYPE guard(mutex_);
+    fault_in_all_unsafe();
 
     buffer << "{\n";
 
@@ -11,9 +11,12 @@
 #include "madara/knowledge/FileHeader.h"
 #include "madara/logger/Logger.h"
 
+#include <atomic>
 #include <string>
 #include <map>
 #include <memory>
+#include <set>
+#include <vector>
 #include <fstream>
 #include "madara/utility/IntTypes.h"
 
@@ -26,8 +29,11 @@
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
 #include "madara/knowledge/KnowledgeReferenceSettings.h"
 #include "madara/knowledge/CompiledExpression.h"
+#include "madara/expression/ExpressionCache.h"
 #include "madara/knowledge/CheckpointSettings.h"
 #include "madara/knowledge/BaseStreamer.h"
+#include "madara/knowledge/ContentStore.h"
+#include "madara/knowledge/KnowledgeSnapshot.h"
 #include "madara/transport/MessageHeader.h"
 
 #ifdef _MADARA_JAVA_
@@ -55,6 +61,11 @@ namespace rcw
 class BaseTracker;
 }
 
+namespace containers
+{
+class CommitGroup;
+}
+
 /**
  * Typedef for set of copyable keys. @see copy. We use map instead
  * of set so we are not wasting significant memory/time with copying
@@ -71,6 +82,12 @@ typedef std::vector<std::string> PrefixVector;
 /// forward declare for friendship
 class KnowledgeBaseImpl;
 
+class RuleEngine;
+
+class GeneratedLogic;
+
+class ExpressionBatch;
+
 /**
  * @class ThreadSafeContext
  * @brief This class stores variables and their values for use by any entity
@@ -83,6 +100,9 @@ public:
   friend class expression::CompositeArrayReference;
   friend class expression::VariableNode;
   friend class rcw::BaseTracker;
+  friend class GeneratedLogic;
+  friend class ExpressionBatch;
+  friend class containers::CommitGroup;
 
   /**
    * Constructor.
@@ -1137,6 +1157,28 @@ public:
    **/
   bool delete_expression(const std::string& expression);
 
+#ifndef _MADARA_NO_KARL_
+
+  /**
+   * Returns the hit, miss and eviction counts of the interpreter cache
+   * @return                 the interpreter cache statistics
+   **/
+  expression::ExpressionCacheStats get_expression_cache_stats(void) const;
+
+  /**
+   * Sets the most compiled expressions the interpreter cache holds.
+   * The least recently used expressions are evicted first.
+   * @param   capacity       the capacity. 0 disables caching.
+   **/
+  void set_expression_cache_capacity(size_t capacity);
+
+  /**
+   * Removes all compiled expressions from the interpreter cache
+   **/
+  void clear_expression_cache(void);
+
+#endif  // _MADARA_NO_KARL_
+
   /**
    * Atomically checks to see if a variable already exists
    * @param   key            unique identifier of the variable
@@ -1717,6 +1759,98 @@ public:
     return streamer;
   }
 
+  /**
+   * Attach a content store. Once attached, the payload of every file
+   * record is interned in the store when the record is modified, so
+   * records with identical contents share one buffer. May pass nullptr
+   * to stop interning.
+   *
+   * @param store the store to attach
+   * @return the old store, or nullptr if there wasn't any.
+   **/
+  std::shared_ptr<ContentStore> set_content_store(
+      std::shared_ptr<ContentStore> store)
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    using std::swap;
+    swap(store, content_store_);
+
+    return store;
+  }
+
+  /**
+   * Returns the attached content store
+   * @return the store, or nullptr if there isn't one
+   **/
+  std::shared_ptr<ContentStore> get_content_store(void) const
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+    return content_store_;
+  }
+
+  /**
+   * Attach a rule engine, which is notified of every modified variable
+   * while the lock is held. RuleEngine attaches and detaches itself, so
+   * this is rarely called directly. May pass nullptr to detach.
+   *
+   * @param engine the engine to attach, which the context does not own
+   * @return the old engine, or nullptr if there wasn't any.
+   **/
+  RuleEngine* set_rule_engine(RuleEngine* engine)
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    using std::swap;
+    swap(engine, rule_engine_);
+
+    return engine;
+  }
+
+  /**
+   * Returns the attached rule engine
+   * @return the engine, or nullptr if there isn't one
+   **/
+  RuleEngine* get_rule_engine(void) const
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+    return rule_engine_;
+  }
+
+  /**
+   * Takes an immutable snapshot of every record. The first snapshot copies
+   * the context. Later snapshots share structure with the previous one and
+   * only copy records modified since it was taken, or return it unchanged
+   * if nothing was modified. Erasing records makes the next snapshot a
+   * full copy again.
+   * @return the snapshot
+   **/
+  KnowledgeSnapshot::Ptr snapshot(void);
+
+  /**
+   * Replaces the contents of this context with a snapshot in constant
+   * time. Records are copied out of the snapshot the first time they are
+   * accessed, and all at once by operations over many records, such as
+   * to_map, saving, printing or deleting. Modifications are made to this
+   * context only, never to the snapshot. Modified lists are cleared.
+   * @param  snapshot   the records to start from
+   **/
+  void load_snapshot(KnowledgeSnapshot::Ptr snapshot);
+
+  /**
+   * Returns a value that changes whenever records are erased from the
+   * context (e.g., delete_variable, delete_prefix, or clear). Callers
+   * that cache VariableReferences across evaluations should drop them when
+   * this value changes, as the referenced records may no longer exist.
+   * Values are never reused, even by other contexts, so a context address
+   * and generation pair identifies one set of valid references.
+   * @return  the current erase generation
+   **/
+  uint64_t get_erase_generation(void) const
+  {
+    return erase_generation_.load(std::memory_order_acquire);
+  }
+
   /**
    * NOT THREAD SAFE!
    *
@@ -1730,6 +1864,7 @@ public:
    **/
   KnowledgeMap& get_map_unsafe(void)
   {
+    fault_in_all_unsafe();
     return map_;
   }
 
@@ -1747,6 +1882,7 @@ public:
    **/
   const KnowledgeMap& get_map_unsafe(void) const
   {
+    fault_in_all_unsafe();
     return map_;
   }
 
@@ -1832,11 +1968,20 @@ public:
   {
     MADARA_GUARD_TYPE guard(mutex_);
 
+    fault_in_all_unsafe();
     std::for_each(map_.begin(), map_.end(), func);
   }
 
 protected:
 private:
+  /**
+   * Saves the context from a snapshot, encoding states in parallel
+   * @see CheckpointSettings::save_threads
+   * @param   settings    the settings to save
+   * @return              -1 if file open failed, or the bytes written
+   **/
+  int64_t save_context_parallel(const CheckpointSettings& settings) const;
+
   /**
    * Changes variable to modified at current clock, and queues it to send,
    * even if it is a local that would not ordinarily be sent. Skips all
@@ -1857,13 +2002,107 @@ private:
       const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
 
   /**
-   * method for marking a record modified and signaling changes
+   * method for marking a record modified and signaling changes. Also
+   * stamps the record with a new modification version.
    * @param  ref       a reference to a variable in the knowledge base
    * @param  settings  settings for applying modification and signalling
    **/
   void mark_and_signal(VariableReference ref,
       const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
 
+  /**
+   * Replaces a file record's payload with the content store's copy of the
+   * same contents. Requires a content store and the lock.
+   * @param  record    the record to intern
+   **/
+  void intern_content_unsafe(KnowledgeRecord& record);
+
+  /**
+   * Tells the rule engine that a variable was modified. Requires a rule
+   * engine and the lock.
+   * @param  ref       a reference to the modified variable
+   **/
+  void notify_rules_unsafe(const VariableReference& ref);
+
+  /**
+   * Copies a record out of the loaded snapshot, unless it was already
+   * copied. Requires the lock. Does nothing if no snapshot is loaded.
+   * @param  key       the name of the record
+   **/
+  void fault_in_unsafe(const std::string& key) const;
+
+  /**
+   * Copies every record not yet copied out of the loaded snapshot and
+   * releases it. Requires the lock. Does nothing if no snapshot is loaded.
+   **/
+  void fault_in_all_unsafe(void) const;
+
+  /**
+   * Hides a record of the loaded snapshot, so it is not copied out again
+   * after being deleted. Requires the lock. Does nothing if no snapshot is
+   * loaded.
+   * @param  key       the name of the deleted record
+   **/
+  void erase_from_fork_unsafe(const std::string& key);
+
+  /**
+   * Remembers that a record must be copied into the next snapshot.
+   * Requires the lock. Does nothing until a snapshot has been taken.
+   * @param  ref       a reference to the modified record
+   **/
+  void track_snapshot_change_unsafe(const VariableReference& ref);
+
+  /**
+   * Remembers that a record must be copied into the next snapshot.
+   * Requires the lock. Does nothing until a snapshot has been taken.
+   * @param  key       the name of the modified record
+   **/
+  void track_snapshot_change_unsafe(const std::string& key);
+
+  /**
+   * Returns an erase generation no context has used before
+   * @return  the new generation
+   **/
+  static uint64_t next_erase_generation(void);
+
+  /// a mark_and_signal call made while evaluating part of a batch
+  struct DeferredMark
+  {
+    VariableReference ref;
+    KnowledgeUpdateSettings settings;
+  };
+
+  typedef std::vector<DeferredMark> DeferredMarks;
+
+  /**
+   * Directs the calling thread's marks into a list instead of applying
+   * them. ExpressionBatch workers evaluate while another thread holds the
+   * lock, so they leave their marks for that thread to apply.
+   * @param  marks   the list, or nullptr to apply marks again
+   **/
+  static void defer_marks(DeferredMarks* marks);
+
+  /**
+   * Appends a mark to the calling thread's deferred marks
+   * @param  ref       a reference to the modified variable
+   * @param  settings  settings to apply the mark with
+   * @return false if the calling thread is not deferring marks
+   **/
+  static bool defer_mark(
+      const VariableReference& ref, const KnowledgeUpdateSettings& settings);
+
+  /**
+   * Returns the calling thread's deferred marks
+   * @return the list, or nullptr if marks are not deferred
+   **/
+  static DeferredMarks*& deferred_marks(void);
+
+  /**
+   * Replaces the erase generation and drops the incremental snapshot state.
+   * Requires the lock. Call before erasing records from map_.
+   **/
+  void note_erase_unsafe(void);
+
   template<typename... Args>
   int set_unsafe_impl(const VariableReference& variable,
       const KnowledgeUpdateSettings& settings, Args&&... args);
@@ -1903,6 +2142,33 @@ private:
 
   /// Streaming provider for saving all updates
   std::unique_ptr<BaseStreamer> streamer_ = nullptr;
+
+  /// Replaced each time records are erased from map_
+  std::atomic<uint64_t> erase_generation_ = {next_erase_generation()};
+
+  /// Last modification version stamped onto a record. Guarded by mutex_
+  uint64_t version_ = 0;
+
+  /// Store that file payloads are interned into, if any
+  std::shared_ptr<ContentStore> content_store_ = nullptr;
+
+  /// Engine notified of modified variables, if any. Guarded by mutex_
+  RuleEngine* rule_engine_ = nullptr;
+
+  /// True while ExpressionBatch workers may defer marks. Guarded by mutex_
+  bool deferring_marks_ = false;
+
+  /// Snapshot that records not yet in map_ are read from. Guarded by mutex_
+  mutable KnowledgeSnapshot::Ptr fork_base_ = nullptr;
+
+  /// Records of fork_base_ deleted from this context. Guarded by mutex_
+  mutable std::set<std::string> fork_erased_;
+
+  /// The most recent snapshot of this context. Guarded by mutex_
+  KnowledgeSnapshot::Ptr snapshot_ = nullptr;
+
+  /// Records modified since snapshot_ was taken. Guarded by mutex_
+  VariableReferenceMap snapshot_changes_;
 };
 }
 }
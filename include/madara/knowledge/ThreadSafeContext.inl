@@ -145,10 +145,12 @@ inline KnowledgeRecord* ThreadSafeContext::with(
   if (settings.expand_variables)
   {
     std::string cur_key = expand_statement(key);
+    fault_in_unsafe(cur_key);
     found = map_.find(cur_key);
   }
   else
   {
+    fault_in_unsafe(key);
     found = map_.find(key);
   }
 
@@ -190,10 +192,12 @@ inline const KnowledgeRecord* ThreadSafeContext::with(
   if (settings.expand_variables)
   {
     std::string cur_key = expand_statement(key);
+    fault_in_unsafe(cur_key);
     found = map_.find(cur_key);
   }
   else
   {
+    fault_in_unsafe(key);
     found = map_.find(key);
   }
 
@@ -577,6 +581,23 @@ inline bool ThreadSafeContext::delete_expression(const std::string& expression)
   return interpreter_->delete_expression(expression);
 }
 
+// the interpreter cache has its own lock
+inline expression::ExpressionCacheStats
+ThreadSafeContext::get_expression_cache_stats(void) const
+{
+  return interpreter_->get_cache().get_stats();
+}
+
+inline void ThreadSafeContext::set_expression_cache_capacity(size_t capacity)
+{
+  interpreter_->get_cache().set_capacity(capacity);
+}
+
+inline void ThreadSafeContext::clear_expression_cache(void)
+{
+  interpreter_->get_cache().clear();
+}
+
 #endif  // _MADARA_NO_KARL_
 
 inline bool ThreadSafeContext::clear(
@@ -597,12 +618,15 @@ inline bool ThreadSafeContext::clear(
     key_ptr = &key;
 
   // find the key and update found with result of find
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::iterator record = map_.find(*key_ptr);
   found = record != map_.end();
 
   if (found)
   {
     record->second.clear_value();
+    record->second.version_ = ++version_;
+    track_snapshot_change_unsafe(&*record);
   }
 
   return found;
@@ -619,6 +643,8 @@ inline bool ThreadSafeContext::clear(const VariableReference& variable)
     // local_changed_map_.erase (variable.entry_->first.c_str ());
 
     variable.entry_->second.clear_value();
+    variable.entry_->second.version_ = ++version_;
+    track_snapshot_change_unsafe(variable);
 
     return true;
   }
@@ -651,7 +677,12 @@ inline bool ThreadSafeContext::delete_variable(
   changed_map_.erase(key_ptr->c_str());
   local_changed_map_.erase(key_ptr->c_str());
 
+  // the record may still be in a loaded snapshot, which must then hide it
+  fault_in_unsafe(*key_ptr);
+  erase_from_fork_unsafe(*key_ptr);
+
   // erase the map
+  note_erase_unsafe();
   result = map_.erase(*key_ptr) == 1;
 
   return result;
@@ -668,7 +699,11 @@ inline bool ThreadSafeContext::delete_variable(
   changed_map_.erase(var.entry_->first.c_str());
   local_changed_map_.erase(var.entry_->first.c_str());
 
+  // erased keys must not be read from a loaded snapshot again
+  erase_from_fork_unsafe(var.entry_->first);
+
   // erase the map
+  note_erase_unsafe();
   return map_.erase(var.entry_->first.c_str()) == 1;
 }
 
@@ -679,7 +714,11 @@ inline void ThreadSafeContext::delete_variables(KnowledgeMap::iterator begin,
   {
     changed_map_.erase(cur->first.c_str());
     local_changed_map_.erase(cur->first.c_str());
+
+    // erased keys must not be read from a loaded snapshot again
+    erase_from_fork_unsafe(cur->first);
   }
+  note_erase_unsafe();
   map_.erase(begin, end);
 }
 
@@ -704,6 +743,7 @@ inline bool ThreadSafeContext::exists(
   if (*key_ptr != "")
   {
     // find the key in the knowledge base
+    fault_in_unsafe(*key_ptr);
     KnowledgeMap::const_iterator found = map_.find(*key_ptr);
 
     // if it's found, then return the value
@@ -779,12 +819,14 @@ inline uint64_t ThreadSafeContext::set_clock(const std::string& key,
     return 0;
 
   // create the key if it didn't exist
+  fault_in_unsafe(*key_ptr);
   knowledge::KnowledgeRecord& record = map_[*key_ptr];
 
   // check for value already set
   if (record.clock < clock)
   {
     record.clock = clock;
+    track_snapshot_change_unsafe(*key_ptr);
 
     // try to update the global clock as well
     this->set_clock(clock);
@@ -816,9 +858,13 @@ inline uint64_t ThreadSafeContext::inc_clock(
     return 0;
 
   // create the key if it didn't exist
+  fault_in_unsafe(*key_ptr);
   knowledge::KnowledgeRecord& record = map_[*key_ptr];
 
-  return record.clock += settings.clock_increment;
+  record.clock += settings.clock_increment;
+  track_snapshot_change_unsafe(*key_ptr);
+
+  return record.clock;
 }
 
 /// increment the process lamport clock
@@ -871,6 +917,7 @@ inline uint64_t ThreadSafeContext::get_clock(
     return 0;
 
   // find the key in the knowledge base
+  fault_in_unsafe(*key_ptr);
   KnowledgeMap::const_iterator found = map_.find(*key_ptr);
 
   // if it's found, then compare the value
@@ -921,14 +968,24 @@ inline void ThreadSafeContext::clear(bool erase)
 
   if (erase)
   {
+    note_erase_unsafe();
     map_.clear();
+    fork_base_ = nullptr;
+    fork_erased_.clear();
   }
   else
   {
+    fault_in_all_unsafe();
+
     for (KnowledgeMap::iterator i = map_.begin(); i != map_.end(); ++i)
     {
       i->second.reset_value();
+      i->second.version_ = ++version_;
     }
+
+    // every record changed, so the next snapshot is a full copy
+    snapshot_ = nullptr;
+    snapshot_changes_.clear();
   }
 
   changed_.MADARA_CONDITION_NOTIFY_ONE();
@@ -1013,6 +1070,22 @@ inline void ThreadSafeContext::mark_to_checkpoint_unsafe(
 inline void ThreadSafeContext::mark_and_signal(
     VariableReference ref, const KnowledgeUpdateSettings& settings)
 {
+  // batch workers leave their marks for the evaluating thread
+  if (deferring_marks_ && defer_mark(ref, settings))
+    return;
+
+  // let readers that cache values (e.g., rcw trackers) see the change
+  ref.get_record_unsafe()->version_ = ++version_;
+
+  // copy the record into the next snapshot
+  track_snapshot_change_unsafe(ref);
+
+  // share identical file payloads through the content store
+  if (content_store_ != nullptr)
+  {
+    intern_content_unsafe(*ref.get_record_unsafe());
+  }
+
   // otherwise set the value
   if (ref.get_name()[0] != '.' || settings.treat_locals_as_globals)
   {
@@ -1039,10 +1112,95 @@ inline void ThreadSafeContext::mark_and_signal(
     streamer_->enqueue(ref.get_name(), *rec_ptr);
   }
 
+  // schedule rules bound to this variable
+  if (rule_engine_ != nullptr)
+  {
+    notify_rules_unsafe(ref);
+  }
+
   if (settings.signal_changes)
     changed_.MADARA_CONDITION_NOTIFY_ALL();
 }
 
+inline void ThreadSafeContext::intern_content_unsafe(KnowledgeRecord& record)
+{
+  if (record.has_history() && record.get_history_size() == 0)
+  {
+    return;
+  }
+
+  KnowledgeRecord* newest =
+      record.has_history() ? &record.ref_newest() : &record;
+
+  if (KnowledgeRecord::is_binary_file_type(newest->type_))
+  {
+    ContentStore::Payload payload = newest->share_binary();
+    const void* original = payload.get();
+
+    content_store_->intern(payload);
+
+    if (payload.get() != original)
+    {
+      newest->set_shared_file(std::move(payload), newest->type_);
+    }
+  }
+}
+
+inline void ThreadSafeContext::fault_in_unsafe(const std::string& key) const
+{
+  if (fork_base_ != nullptr && map_.find(key) == map_.end() &&
+      fork_erased_.find(key) == fork_erased_.end())
+  {
+    const KnowledgeRecord* record = fork_base_->find(key);
+
+    if (record != nullptr)
+    {
+      // copying out of the snapshot does not change the contents
+      const_cast<KnowledgeMap&>(map_).emplace(key, *record);
+    }
+  }
+}
+
+inline void ThreadSafeContext::erase_from_fork_unsafe(const std::string& key)
+{
+  if (fork_base_ != nullptr)
+  {
+    fork_erased_.insert(key);
+  }
+}
+
+inline void ThreadSafeContext::note_erase_unsafe(void)
+{
+  erase_generation_.store(next_erase_generation(), std::memory_order_release);
+
+  // snapshots cannot record erasures, so the next one is a full copy
+  snapshot_ = nullptr;
+  snapshot_changes_.clear();
+}
+
+inline void ThreadSafeContext::track_snapshot_change_unsafe(
+    const VariableReference& ref)
+{
+  if (snapshot_ != nullptr)
+  {
+    snapshot_changes_[ref.get_name()] = ref;
+  }
+}
+
+inline void ThreadSafeContext::track_snapshot_change_unsafe(
+    const std::string& key)
+{
+  if (snapshot_ != nullptr)
+  {
+    auto found = map_.find(key);
+
+    if (found != map_.end())
+    {
+      track_snapshot_change_unsafe(&*found);
+    }
+  }
+}
+
 inline void ThreadSafeContext::mark_modified(
     const std::string& key, const KnowledgeUpdateSettings& settings)
 {
@@ -1243,6 +1401,8 @@ inline void ThreadSafeContext::apply_modified(void)
 
   //++this->clock_;
 
+  fault_in_all_unsafe();
+
   for (KnowledgeMap::iterator i = map_.begin(); i != map_.end(); ++i)
     for (auto& entry : map_)
     {
@@ -224,6 +224,10 @@ struct TypeHandlers
   typedef bool (*get_reader_fn_type)(capnp::DynamicStruct::Reader*,
       capnp::StructSchema*, const char**, size_t*, void*);
   get_reader_fn_type get_reader;
+
+  typedef void (*load_shared_fn_type)(
+      const std::shared_ptr<const char>&, size_t, void*, const char*);
+  load_shared_fn_type load_shared;
 };
 
 inline const TypeHandlers& AnyField::parent() const
@@ -408,6 +412,16 @@ constexpr TypeHandlers::get_reader_fn_type get_type_handler_get_reader(
   return nullptr;
 }
 
+/// Creates a function for unserializing the given type from a shared buffer
+/// which the new object may keep a reference into, instead of copying. By
+/// default, there is none, and load is used.
+template<typename T>
+constexpr TypeHandlers::load_shared_fn_type get_type_handler_load_shared(
+    type<T>, overload_priority_weakest)
+{
+  return nullptr;
+}
+
 /// For internal use. Constructs a TypeHandlers containing functions used by Any
 template<typename T>
 inline const TypeHandlers& get_type_handler(type<T> t)
@@ -431,6 +445,7 @@ inline const TypeHandlers& get_type_handler(type<T> t)
       get_type_handler_from_record(t, select_overload()),
       get_type_handler_to_ostream(t, select_overload()),
       get_type_handler_get_reader(t, select_overload()),
+      get_type_handler_load_shared(t, select_overload()),
   };
   return handler;
 }
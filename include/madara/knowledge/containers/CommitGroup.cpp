@@ -0,0 +1,164 @@
+#include "CommitGroup.h"
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/exceptions/ContextException.h"
+#include "madara/logger/GlobalLogger.h"
+
+madara::knowledge::containers::CommitGroup::CommitGroup(
+    KnowledgeBase& knowledge, const KnowledgeUpdateSettings& settings)
+  : context_(&(knowledge.get_context())), settings_(settings)
+{
+}
+
+madara::knowledge::containers::CommitGroup::CommitGroup(
+    Variables& knowledge, const KnowledgeUpdateSettings& settings)
+  : context_(knowledge.get_context()), settings_(settings)
+{
+}
+
+void madara::knowledge::containers::CommitGroup::check_context(
+    const ThreadSafeContext* context, const std::string& name) const
+{
+  if (context == 0 || context != context_)
+  {
+    throw exceptions::ContextException(
+        "CommitGroup::add: " + name +
+        " is not a container of the group's knowledge base.");
+  }
+}
+
+void madara::knowledge::containers::CommitGroup::add(IntegerStaged& container)
+{
+  check_context(container.context_, container.name_);
+  entries_.push_back({INTEGER, &container});
+}
+
+void madara::knowledge::containers::CommitGroup::add(DoubleStaged& container)
+{
+  check_context(container.context_, container.name_);
+  entries_.push_back({DOUBLE, &container});
+}
+
+void madara::knowledge::containers::CommitGroup::add(StringStaged& container)
+{
+  check_context(container.context_, container.name_);
+  entries_.push_back({STRING, &container});
+}
+
+void madara::knowledge::containers::CommitGroup::add(
+    NativeDoubleVectorStaged& container)
+{
+  check_context(container.context_, container.name_);
+  entries_.push_back({NATIVE_DOUBLE_VECTOR, &container});
+}
+
+void madara::knowledge::containers::CommitGroup::add(
+    NativeIntegerVectorStaged& container)
+{
+  check_context(container.context_, container.name_);
+  entries_.push_back({NATIVE_INTEGER_VECTOR, &container});
+}
+
+void madara::knowledge::containers::CommitGroup::clear(void)
+{
+  entries_.clear();
+}
+
+size_t madara::knowledge::containers::CommitGroup::size(void) const
+{
+  return entries_.size();
+}
+
+void madara::knowledge::containers::CommitGroup::read(void)
+{
+  ContextGuard context_guard(*context_);
+
+  for (const Entry& entry : entries_)
+  {
+    switch (entry.type)
+    {
+    case INTEGER:
+      static_cast<IntegerStaged*>(entry.container)->read();
+      break;
+    case DOUBLE:
+      static_cast<DoubleStaged*>(entry.container)->read();
+      break;
+    case STRING:
+      static_cast<StringStaged*>(entry.container)->read();
+      break;
+    case NATIVE_DOUBLE_VECTOR:
+      static_cast<NativeDoubleVectorStaged*>(entry.container)->read();
+      break;
+    case NATIVE_INTEGER_VECTOR:
+      static_cast<NativeIntegerVectorStaged*>(entry.container)->read();
+      break;
+    }
+  }
+}
+
+size_t madara::knowledge::containers::CommitGroup::commit(void)
+{
+  // mark each record but wait until every record is written to signal
+  KnowledgeUpdateSettings settings(settings_);
+  settings.signal_changes = false;
+
+  size_t written = 0;
+
+  ContextGuard context_guard(*context_);
+
+  for (const Entry& entry : entries_)
+  {
+    bool result = false;
+
+    switch (entry.type)
+    {
+    case INTEGER:
+      result =
+          static_cast<IntegerStaged*>(entry.container)->write_unsafe(settings);
+      break;
+    case DOUBLE:
+      result =
+          static_cast<DoubleStaged*>(entry.container)->write_unsafe(settings);
+      break;
+    case STRING:
+      result =
+          static_cast<StringStaged*>(entry.container)->write_unsafe(settings);
+      break;
+    case NATIVE_DOUBLE_VECTOR:
+      result = static_cast<NativeDoubleVectorStaged*>(entry.container)
+                   ->write_unsafe(settings);
+      break;
+    case NATIVE_INTEGER_VECTOR:
+      result = static_cast<NativeIntegerVectorStaged*>(entry.container)
+                   ->write_unsafe(settings);
+      break;
+    }
+
+    if (result)
+    {
+      ++written;
+    }
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MINOR,
+      "CommitGroup::commit: wrote %d of %d containers\n", (int)written,
+      (int)entries_.size());
+
+  if (written > 0 && settings_.signal_changes)
+  {
+    context_->changed_.MADARA_CONDITION_NOTIFY_ALL();
+  }
+
+  return written;
+}
+
+madara::knowledge::KnowledgeUpdateSettings
+madara::knowledge::containers::CommitGroup::get_settings(void) const
+{
+  return settings_;
+}
+
+void madara::knowledge::containers::CommitGroup::set_settings(
+    const KnowledgeUpdateSettings& settings)
+{
+  settings_ = settings;
+}
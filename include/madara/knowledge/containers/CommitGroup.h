@@ -0,0 +1,192 @@
+
+#ifndef _MADARA_KNOWLEDGE_CONTAINERS_COMMITGROUP_H_
+#define _MADARA_KNOWLEDGE_CONTAINERS_COMMITGROUP_H_
+
+#include <vector>
+#include <string>
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/KnowledgeUpdateSettings.h"
+#include "IntegerStaged.h"
+#include "DoubleStaged.h"
+#include "StringStaged.h"
+#include "NativeDoubleVectorStaged.h"
+#include "NativeIntegerVectorStaged.h"
+
+/**
+ * @file CommitGroup.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a C++ object that reads and writes many staged
+ * containers at once
+ **/
+
+namespace madara
+{
+namespace knowledge
+{
+namespace containers
+{
+/**
+ * @class CommitGroup
+ * @brief Writes the values of many staged containers to the knowledge
+ *        base in one batch. Calling write on each staged container locks
+ *        the context and wakes waiting threads once per container. A
+ *        commit locks the context once, marks every changed value and
+ *        then wakes waiting threads once.
+ *
+ * Staged values are still changed locally without locks. The group only
+ * refers to its containers, which must outlive it or be removed with
+ * clear. Like the staged containers, a group should be used from one
+ * thread at a time.
+ */
+class MADARA_EXPORT CommitGroup
+{
+public:
+  /**
+   * Constructor
+   * @param  knowledge  the knowledge base of the containers
+   * @param  settings   settings for applying updates
+   **/
+  CommitGroup(KnowledgeBase& knowledge,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
+  /**
+   * Constructor
+   * @param  knowledge  the variable context of the containers
+   * @param  settings   settings for applying updates
+   **/
+  CommitGroup(Variables& knowledge,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
+  /**
+   * Adds a staged container to the group
+   * @param  container  the container to commit with the group
+   * @throw exceptions::ContextException  the container is not in the
+   *                    group's knowledge base
+   **/
+  void add(IntegerStaged& container);
+
+  /**
+   * Adds a staged container to the group
+   * @param  container  the container to commit with the group
+   * @throw exceptions::ContextException  the container is not in the
+   *                    group's knowledge base
+   **/
+  void add(DoubleStaged& container);
+
+  /**
+   * Adds a staged container to the group
+   * @param  container  the container to commit with the group
+   * @throw exceptions::ContextException  the container is not in the
+   *                    group's knowledge base
+   **/
+  void add(StringStaged& container);
+
+  /**
+   * Adds a staged container to the group
+   * @param  container  the container to commit with the group
+   * @throw exceptions::ContextException  the container is not in the
+   *                    group's knowledge base
+   **/
+  void add(NativeDoubleVectorStaged& container);
+
+  /**
+   * Adds a staged container to the group
+   * @param  container  the container to commit with the group
+   * @throw exceptions::ContextException  the container is not in the
+   *                    group's knowledge base
+   **/
+  void add(NativeIntegerVectorStaged& container);
+
+  /**
+   * Removes every container from the group
+   **/
+  void clear(void);
+
+  /**
+   * Returns the number of containers in the group
+   * @return the number of containers
+   **/
+  size_t size(void) const;
+
+  /**
+   * Reads the values of every container from the knowledge base while
+   * holding the context's lock once
+   **/
+  void read(void);
+
+  /**
+   * Writes the values of every changed container to the knowledge base
+   * while holding the context's lock once, and then signals waiting
+   * threads once. Containers are written in the order they were added.
+   * @return the number of containers written
+   **/
+  size_t commit(void);
+
+  /**
+   * Gets the update settings for the group
+   * @return  the current settings
+   **/
+  KnowledgeUpdateSettings get_settings(void) const;
+
+  /**
+   * Sets the update settings for the group
+   * @param  settings  the new settings to use
+   **/
+  void set_settings(const KnowledgeUpdateSettings& settings);
+
+private:
+  /**
+   * Checks that a container uses the group's context
+   * @param  context   the container's context
+   * @param  name      the container's name
+   * @throw exceptions::ContextException  the contexts differ
+   **/
+  void check_context(
+      const ThreadSafeContext* context, const std::string& name) const;
+
+  /**
+   * Variable context that we are modifying
+   **/
+  ThreadSafeContext* context_;
+
+  /**
+   * Settings for modifications
+   **/
+  KnowledgeUpdateSettings settings_;
+
+  /**
+   * The type of a container, for committing in the order of addition
+   **/
+  enum ContainerType
+  {
+    INTEGER,
+    DOUBLE,
+    STRING,
+    NATIVE_DOUBLE_VECTOR,
+    NATIVE_INTEGER_VECTOR
+  };
+
+  /**
+   * A container in the group
+   **/
+  struct Entry
+  {
+    /// the type of the container
+    ContainerType type;
+
+    /// the container, which is cast to its type before use
+    BaseContainer* container;
+  };
+
+  /**
+   * The containers in the order they were added
+   **/
+  std::vector<Entry> entries_;
+};
+}  // containers
+}  // knowledge
+}  // madara
+
+#endif  // _MADARA_KNOWLEDGE_CONTAINERS_COMMITGROUP_H_
@@ -24,6 +24,9 @@ namespace knowledge
 {
 namespace containers
 {
+// forward declare a friend class
+class CommitGroup;
+
 /**
  * @class IntegerStaged
  * @brief Stages an integer value to and from the knowledge base. This
@@ -38,6 +41,9 @@ namespace containers
 class MADARA_EXPORT IntegerStaged : public BaseContainer
 {
 public:
+  /// Allow CommitGroup to write staged values in batches
+  friend class CommitGroup;
+
   /// trait that describes the value type
   typedef knowledge::KnowledgeRecord::Integer type;
 
@@ -322,6 +328,15 @@ public:
   bool is_false(void) const;
 
 private:
+  /**
+   * Writes the staged value to the knowledge base if it has changed.
+   * Callers must hold the context. A written value is unchanged until
+   * it is modified again.
+   * @param  settings   settings for applying the update
+   * @return true if the value was written
+   **/
+  bool write_unsafe(const KnowledgeUpdateSettings& settings);
+
   /**
    * Polymorphic is true method which can be used to determine if
    * all values in the container are true
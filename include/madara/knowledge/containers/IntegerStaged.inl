@@ -281,4 +281,18 @@ inline void madara::knowledge::containers::IntegerStaged::write(void)
     context_->set(variable_, value_);
 }
 
+inline bool madara::knowledge::containers::IntegerStaged::write_unsafe(
+    const KnowledgeUpdateSettings& settings)
+{
+  if (has_changed_ && variable_.is_valid() &&
+      context_->set_unsafe(variable_, value_, settings) == 0)
+  {
+    // the knowledge base now holds the staged value
+    has_changed_ = false;
+    return true;
+  }
+
+  return false;
+}
+
 #endif  // _MADARA_KNOWLEDGE_CONTAINERS_INTEGERSTAGED_INL_
@@ -24,6 +24,9 @@ namespace knowledge
 {
 namespace containers
 {
+// forward declare a friend class
+class CommitGroup;
+
 /**
  * @class NativeIntegerVectorStaged
  * @brief This class stores a vector of doubles inside of KaRL
@@ -31,6 +34,9 @@ namespace containers
 class MADARA_EXPORT NativeIntegerVectorStaged : public BaseContainer
 {
 public:
+  /// Allow CommitGroup to write staged values in batches
+  friend class CommitGroup;
+
   /// trait that describes the value type
   typedef knowledge::KnowledgeRecord::Integer type;
 
@@ -248,6 +254,15 @@ public:
   void write(void);
 
 private:
+  /**
+   * Writes the staged value to the knowledge base if it has changed.
+   * Callers must hold the context. A written value is unchanged until
+   * it is modified again.
+   * @param  settings   settings for applying the update
+   * @return true if the value was written
+   **/
+  bool write_unsafe(const KnowledgeUpdateSettings& settings);
+
   /**
    * Polymorphic is true method which can be used to determine if
    * all values in the container are true
@@ -315,4 +315,19 @@ inline void madara::knowledge::containers::NativeIntegerVectorStaged::write(
     context_->set(vector_, value_);
 }
 
+inline bool
+madara::knowledge::containers::NativeIntegerVectorStaged::write_unsafe(
+    const KnowledgeUpdateSettings& settings)
+{
+  if (has_changed_ && vector_.is_valid() &&
+      context_->set_unsafe(vector_, value_, settings) == 0)
+  {
+    // the knowledge base now holds the staged value
+    has_changed_ = false;
+    return true;
+  }
+
+  return false;
+}
+
 #endif  // _MADARA_NATIVE_INTEGER_VECTOR_STAGED_INL_
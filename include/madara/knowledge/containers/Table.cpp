@@ -0,0 +1,1033 @@
+#include "Table.h"
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/exceptions/NameException.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/ArrayMath.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+/// appends the indices of values within [low, high] to rows
+template<typename T>
+void select_rows(const std::vector<T>& values, double low, double high,
+    std::vector<size_t>& rows)
+{
+  const T* data = values.data();
+  size_t size = values.size();
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    if (data[i] >= low && data[i] <= high)
+    {
+      rows.push_back(i);
+    }
+  }
+}
+}
+
+madara::knowledge::containers::Table::Table(
+    const KnowledgeUpdateSettings& settings)
+  : BaseContainer("", settings), context_(0)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::constructor: new object\n");
+}
+
+madara::knowledge::containers::Table::Table(const std::string& name,
+    KnowledgeBase& knowledge, const Columns& columns, int rows,
+    const KnowledgeUpdateSettings& settings)
+  : BaseContainer(name, settings), context_(&(knowledge.get_context()))
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::constructor called for %s[%d]\n", name.c_str(), rows);
+
+  ContextGuard context_guard(*context_);
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  init(columns, rows);
+}
+
+madara::knowledge::containers::Table::Table(const std::string& name,
+    Variables& knowledge, const Columns& columns, int rows,
+    const KnowledgeUpdateSettings& settings)
+  : BaseContainer(name, settings), context_(knowledge.get_context())
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::constructor called for %s[%d]\n", name.c_str(), rows);
+
+  ContextGuard context_guard(*context_);
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  init(columns, rows);
+}
+
+madara::knowledge::containers::Table::Table(const Table& rhs)
+  : BaseContainer(rhs),
+    context_(rhs.context_),
+    columns_(rhs.columns_),
+    dirty_ref_(rhs.dirty_ref_)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::copy constructor called on %s\n", rhs.name_.c_str());
+}
+
+madara::knowledge::containers::Table::~Table()
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::destructor called on %s\n", this->name_.c_str());
+}
+
+void madara::knowledge::containers::Table::init(
+    const Columns& columns, int rows)
+{
+  columns_.clear();
+  dirty_.clear();
+  dirty_rows_.clear();
+
+  for (const Column& column : columns)
+  {
+    ColumnRef entry;
+    entry.column = column;
+    entry.ref = context_->get_ref(name_ + "." + column.name, settings_);
+
+    columns_.push_back(entry);
+  }
+
+  dirty_ref_ = context_->get_ref(name_ + ".dirty", settings_);
+
+  if (rows >= 0)
+  {
+    resize_unsafe((size_t)rows);
+  }
+}
+
+void madara::knowledge::containers::Table::modify(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::modify called\n");
+
+  if (context_ && name_ != "")
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::modify: context is valid. Marking %s.\n", this->name_.c_str());
+
+    for (const ColumnRef& entry : columns_)
+    {
+      context_->mark_modified(entry.ref);
+    }
+  }
+}
+
+std::string madara::knowledge::containers::Table::get_debug_info(void)
+{
+  std::stringstream result;
+
+  result << "Table: ";
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    result << this->name_;
+    result << " [" << size_unsafe() << "]";
+    result << " = {";
+
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+      if (i > 0)
+      {
+        result << ", ";
+      }
+
+      result << columns_[i].column.name << ": "
+             << context_->get(columns_[i].ref, settings_).to_string();
+    }
+
+    result << "}";
+  }
+
+  return result.str();
+}
+
+void madara::knowledge::containers::Table::modify_(void)
+{
+  modify();
+}
+
+std::string madara::knowledge::containers::Table::get_debug_info_(void)
+{
+  return get_debug_info();
+}
+
+madara::knowledge::containers::BaseContainer*
+madara::knowledge::containers::Table::clone(void) const
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::clone: cloning %s\n", this->name_.c_str());
+
+  return new Table(*this);
+}
+
+void madara::knowledge::containers::Table::operator=(const Table& rhs)
+{
+  if (this != &rhs)
+  {
+    MADARA_GUARD_TYPE guard(mutex_), guard2(rhs.mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::assignment: %s: copying from %s.\n", this->name_.c_str(),
+        rhs.name_.c_str());
+
+    this->context_ = rhs.context_;
+    this->name_ = rhs.name_;
+    this->settings_ = rhs.settings_;
+    this->columns_ = rhs.columns_;
+    this->dirty_ref_ = rhs.dirty_ref_;
+    this->dirty_.clear();
+    this->dirty_rows_.clear();
+  }
+}
+
+void madara::knowledge::containers::Table::set_name(const std::string& var_name,
+    KnowledgeBase& knowledge, const Columns& columns, int rows)
+{
+  context_ = &(knowledge.get_context());
+
+  ContextGuard context_guard(*context_);
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::set_name: setting name to %s\n", var_name.c_str());
+
+  name_ = var_name;
+
+  init(columns, rows);
+}
+
+void madara::knowledge::containers::Table::set_name(const std::string& var_name,
+    Variables& knowledge, const Columns& columns, int rows)
+{
+  context_ = knowledge.get_context();
+
+  ContextGuard context_guard(*context_);
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::set_name: setting name to %s\n", var_name.c_str());
+
+  name_ = var_name;
+
+  init(columns, rows);
+}
+
+madara::knowledge::containers::Table::Columns
+madara::knowledge::containers::Table::get_columns(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  Columns result;
+
+  for (const ColumnRef& entry : columns_)
+  {
+    result.push_back(entry.column);
+  }
+
+  return result;
+}
+
+size_t madara::knowledge::containers::Table::column(
+    const std::string& name) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  for (size_t i = 0; i < columns_.size(); ++i)
+  {
+    if (columns_[i].column.name == name)
+    {
+      return i;
+    }
+  }
+
+  throw exceptions::NameException(
+      "Table::column: " + name_ + " has no column named " + name + ".");
+}
+
+size_t madara::knowledge::containers::Table::size_unsafe(void) const
+{
+  if (columns_.empty())
+  {
+    return 0;
+  }
+
+  KnowledgeRecord record = context_->get(columns_[0].ref, settings_);
+
+  return record.is_array_type() ? record.size() : 0;
+}
+
+size_t madara::knowledge::containers::Table::size(void) const
+{
+  size_t result = 0;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    result = size_unsafe();
+  }
+
+  return result;
+}
+
+void madara::knowledge::containers::Table::resize_unsafe(size_t rows)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::resize: %s: resizing to %d\n", this->name_.c_str(), (int)rows);
+
+  size_t old_rows = size_unsafe();
+
+  for (const ColumnRef& entry : columns_)
+  {
+    KnowledgeRecord record = context_->get(entry.ref, settings_);
+
+    if (entry.column.type == INTEGER)
+    {
+      if (record.type() != KnowledgeRecord::INTEGER_ARRAY ||
+          record.size() != rows)
+      {
+        std::vector<Integer> values;
+
+        if (record.is_array_type())
+        {
+          values = record.to_integers();
+        }
+
+        values.resize(rows);
+        context_->set(entry.ref, std::move(values), settings_);
+      }
+    }
+    else
+    {
+      if (record.type() != KnowledgeRecord::DOUBLE_ARRAY ||
+          record.size() != rows)
+      {
+        std::vector<double> values;
+
+        if (record.is_array_type())
+        {
+          values = record.to_doubles();
+        }
+
+        values.resize(rows);
+        context_->set(entry.ref, std::move(values), settings_);
+      }
+    }
+  }
+
+  if (rows < dirty_.size())
+  {
+    dirty_.resize(rows);
+    dirty_rows_.erase(std::remove_if(dirty_rows_.begin(), dirty_rows_.end(),
+                          [rows](size_t row) { return row >= rows; }),
+        dirty_rows_.end());
+  }
+
+  for (size_t row = old_rows; row < rows; ++row)
+  {
+    mark_dirty(row);
+  }
+}
+
+void madara::knowledge::containers::Table::resize(size_t rows)
+{
+  if (context_ && name_ != "")
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    resize_unsafe(rows);
+  }
+}
+
+size_t madara::knowledge::containers::Table::push_back(
+    const KnowledgeVector& values)
+{
+  size_t row = 0;
+
+  if (context_ && name_ != "")
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::push_back: %s: valid context, pushing.\n",
+        this->name_.c_str());
+
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    row = size_unsafe();
+    resize_unsafe(row + 1);
+
+    for (size_t i = 0; i < values.size() && i < columns_.size(); ++i)
+    {
+      set_unsafe(row, i, values[i]);
+    }
+  }
+
+  return row;
+}
+
+bool madara::knowledge::containers::Table::exists(void) const
+{
+  bool result(false);
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    result = !columns_.empty();
+
+    for (const ColumnRef& entry : columns_)
+    {
+      result = result && context_->exists(entry.ref);
+    }
+  }
+
+  return result;
+}
+
+madara::knowledge::containers::Table::Integer
+madara::knowledge::containers::Table::to_integer(
+    size_t row, size_t column) const
+{
+  Integer result = 0;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (column < columns_.size())
+    {
+      KnowledgeRecord record = context_->get(columns_[column].ref, settings_);
+
+      if (row < record.size() && record.is_array_type())
+      {
+        result = record.retrieve_index(row).to_integer();
+      }
+    }
+  }
+
+  return result;
+}
+
+double madara::knowledge::containers::Table::to_double(
+    size_t row, size_t column) const
+{
+  double result = 0;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (column < columns_.size())
+    {
+      KnowledgeRecord record = context_->get(columns_[column].ref, settings_);
+
+      if (row < record.size() && record.is_array_type())
+      {
+        result = record.retrieve_index(row).to_double();
+      }
+    }
+  }
+
+  return result;
+}
+
+madara::knowledge::KnowledgeVector
+madara::knowledge::containers::Table::get_row(size_t row) const
+{
+  KnowledgeVector result;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::get_row: %s: retrieving row %d\n", this->name_.c_str(),
+        (int)row);
+
+    if (row < size_unsafe())
+    {
+      result.reserve(columns_.size());
+
+      for (const ColumnRef& entry : columns_)
+      {
+        KnowledgeRecord record = context_->get(entry.ref, settings_);
+
+        if (row < record.size())
+        {
+          result.push_back(record.retrieve_index(row));
+        }
+        else if (entry.column.type == INTEGER)
+        {
+          result.push_back(KnowledgeRecord(Integer(0)));
+        }
+        else
+        {
+          result.push_back(KnowledgeRecord(0.0));
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+madara::knowledge::KnowledgeRecord
+madara::knowledge::containers::Table::to_record(size_t column) const
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "Table::to_record: %s: retrieving column %d\n", this->name_.c_str(),
+      (int)column);
+
+  KnowledgeRecord result;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (column < columns_.size())
+    {
+      result = context_->get(columns_[column].ref, settings_);
+    }
+  }
+
+  return result;
+}
+
+std::vector<madara::knowledge::containers::Table::Integer>
+madara::knowledge::containers::Table::to_integers(size_t column) const
+{
+  std::vector<Integer> result;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (column < columns_.size())
+    {
+      KnowledgeRecord record = context_->get(columns_[column].ref, settings_);
+
+      if (record.is_array_type())
+      {
+        result = record.to_integers();
+      }
+    }
+  }
+
+  return result;
+}
+
+std::vector<double> madara::knowledge::containers::Table::to_doubles(
+    size_t column) const
+{
+  std::vector<double> result;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (column < columns_.size())
+    {
+      KnowledgeRecord record = context_->get(columns_[column].ref, settings_);
+
+      if (record.is_array_type())
+      {
+        result = record.to_doubles();
+      }
+    }
+  }
+
+  return result;
+}
+
+std::shared_ptr<const std::vector<madara::knowledge::containers::Table::Integer>>
+madara::knowledge::containers::Table::share_integers(size_t column) const
+{
+  std::shared_ptr<const std::vector<Integer>> result;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (column < columns_.size())
+    {
+      // sharing from the context makes later writes copy the column
+      result = context_->share_integers(columns_[column].ref, settings_);
+    }
+  }
+
+  return result;
+}
+
+std::shared_ptr<const std::vector<double>>
+madara::knowledge::containers::Table::share_doubles(size_t column) const
+{
+  std::shared_ptr<const std::vector<double>> result;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (column < columns_.size())
+    {
+      // sharing from the context makes later writes copy the column
+      result = context_->share_doubles(columns_[column].ref, settings_);
+    }
+  }
+
+  return result;
+}
+
+void madara::knowledge::containers::Table::mark_dirty(size_t row)
+{
+  if (row >= dirty_.size())
+  {
+    dirty_.resize(row + 1, false);
+  }
+
+  if (!dirty_[row])
+  {
+    dirty_[row] = true;
+    dirty_rows_.push_back(row);
+  }
+}
+
+int madara::knowledge::containers::Table::set_unsafe(
+    size_t row, size_t column, const KnowledgeRecord& value)
+{
+  if (column >= columns_.size() || row >= size_unsafe())
+  {
+    return -1;
+  }
+
+  const ColumnRef& entry = columns_[column];
+  int result;
+
+  if (entry.column.type == INTEGER)
+  {
+    result = context_->set_index(entry.ref, row, value.to_integer(), settings_);
+  }
+  else
+  {
+    result = context_->set_index(entry.ref, row, value.to_double(), settings_);
+  }
+
+  if (result == 0)
+  {
+    mark_dirty(row);
+  }
+
+  return result;
+}
+
+int madara::knowledge::containers::Table::set(
+    size_t row, size_t column, Integer value)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::set: %s: setting [%d][%d] to %" PRId64 "\n",
+        this->name_.c_str(), (int)row, (int)column, value);
+
+    result = set_unsafe(row, column, KnowledgeRecord(value));
+  }
+
+  return result;
+}
+
+int madara::knowledge::containers::Table::set(
+    size_t row, size_t column, double value)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::set: %s: setting [%d][%d] to %f\n", this->name_.c_str(),
+        (int)row, (int)column, value);
+
+    result = set_unsafe(row, column, KnowledgeRecord(value));
+  }
+
+  return result;
+}
+
+int madara::knowledge::containers::Table::set_row(
+    size_t row, const KnowledgeVector& values)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::set_row: %s: setting row %d\n", this->name_.c_str(), (int)row);
+
+    if (values.size() == columns_.size() && row < size_unsafe())
+    {
+      result = 0;
+
+      for (size_t i = 0; i < columns_.size(); ++i)
+      {
+        int column_result = set_unsafe(row, i, values[i]);
+
+        if (result == 0)
+        {
+          result = column_result;
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+int madara::knowledge::containers::Table::set_column_unsafe(
+    size_t column, KnowledgeRecord values)
+{
+  size_t rows = size_unsafe();
+
+  if (column >= columns_.size() || values.size() != rows)
+  {
+    return -1;
+  }
+
+  const ColumnRef& entry = columns_[column];
+
+  // keep the column's type, whatever type the values arrived in
+  if (entry.column.type == INTEGER &&
+      values.type() != KnowledgeRecord::INTEGER_ARRAY)
+  {
+    values = KnowledgeRecord(values.to_integers());
+  }
+  else if (entry.column.type == DOUBLE &&
+           values.type() != KnowledgeRecord::DOUBLE_ARRAY)
+  {
+    values = KnowledgeRecord(values.to_doubles());
+  }
+
+  int result = context_->set(entry.ref, std::move(values), settings_);
+
+  if (result == 0)
+  {
+    for (size_t row = 0; row < rows; ++row)
+    {
+      mark_dirty(row);
+    }
+  }
+
+  return result;
+}
+
+int madara::knowledge::containers::Table::set_column(
+    size_t column, const std::vector<Integer>& values)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::set_column: %s: setting column %d\n", this->name_.c_str(),
+        (int)column);
+
+    result = set_column_unsafe(column, KnowledgeRecord(values));
+  }
+
+  return result;
+}
+
+int madara::knowledge::containers::Table::set_column(
+    size_t column, const std::vector<double>& values)
+{
+  int result = -1;
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::set_column: %s: setting column %d\n", this->name_.c_str(),
+        (int)column);
+
+    result = set_column_unsafe(column, KnowledgeRecord(values));
+  }
+
+  return result;
+}
+
+madara::knowledge::KnowledgeRecord madara::knowledge::containers::Table::sum(
+    size_t column) const
+{
+  // scan the shared column, so the context is not held
+  if (auto integers = share_integers(column))
+  {
+    return KnowledgeRecord(
+        utility::array_sum(integers->data(), integers->size()));
+  }
+  else if (auto doubles = share_doubles(column))
+  {
+    return KnowledgeRecord(utility::array_sum(doubles->data(), doubles->size()));
+  }
+
+  return KnowledgeRecord(Integer(0));
+}
+
+madara::knowledge::KnowledgeRecord madara::knowledge::containers::Table::min(
+    size_t column) const
+{
+  if (auto integers = share_integers(column))
+  {
+    if (!integers->empty())
+    {
+      return KnowledgeRecord(
+          utility::array_min(integers->data(), integers->size()));
+    }
+  }
+  else if (auto doubles = share_doubles(column))
+  {
+    if (!doubles->empty())
+    {
+      return KnowledgeRecord(
+          utility::array_min(doubles->data(), doubles->size()));
+    }
+  }
+
+  return KnowledgeRecord();
+}
+
+madara::knowledge::KnowledgeRecord madara::knowledge::containers::Table::max(
+    size_t column) const
+{
+  if (auto integers = share_integers(column))
+  {
+    if (!integers->empty())
+    {
+      return KnowledgeRecord(
+          utility::array_max(integers->data(), integers->size()));
+    }
+  }
+  else if (auto doubles = share_doubles(column))
+  {
+    if (!doubles->empty())
+    {
+      return KnowledgeRecord(
+          utility::array_max(doubles->data(), doubles->size()));
+    }
+  }
+
+  return KnowledgeRecord();
+}
+
+double madara::knowledge::containers::Table::mean(size_t column) const
+{
+  if (auto integers = share_integers(column))
+  {
+    if (!integers->empty())
+    {
+      return (double)utility::array_sum(integers->data(), integers->size()) /
+             integers->size();
+    }
+  }
+  else if (auto doubles = share_doubles(column))
+  {
+    if (!doubles->empty())
+    {
+      return utility::array_sum(doubles->data(), doubles->size()) /
+             doubles->size();
+    }
+  }
+
+  return 0;
+}
+
+madara::knowledge::KnowledgeRecord madara::knowledge::containers::Table::dot(
+    size_t lhs, size_t rhs) const
+{
+  auto lhs_integers = share_integers(lhs);
+  auto rhs_integers = share_integers(rhs);
+
+  if (lhs_integers && rhs_integers)
+  {
+    return KnowledgeRecord(utility::array_dot(lhs_integers->data(),
+        rhs_integers->data(),
+        std::min(lhs_integers->size(), rhs_integers->size())));
+  }
+
+  auto lhs_doubles = share_doubles(lhs);
+  auto rhs_doubles = share_doubles(rhs);
+
+  if (lhs_doubles && rhs_doubles)
+  {
+    return KnowledgeRecord(utility::array_dot(lhs_doubles->data(),
+        rhs_doubles->data(),
+        std::min(lhs_doubles->size(), rhs_doubles->size())));
+  }
+
+  // mixed columns are multiplied as doubles
+  std::vector<double> lhs_values = to_doubles(lhs);
+  std::vector<double> rhs_values = to_doubles(rhs);
+
+  return KnowledgeRecord(utility::array_dot(lhs_values.data(),
+      rhs_values.data(), std::min(lhs_values.size(), rhs_values.size())));
+}
+
+std::vector<size_t> madara::knowledge::containers::Table::select(
+    size_t column, double low, double high) const
+{
+  std::vector<size_t> result;
+  if (auto integers = share_integers(column))
+  {
+    select_rows(*integers, low, high, result);
+  }
+  else if (auto doubles = share_doubles(column))
+  {
+    select_rows(*doubles, low, high, result);
+  }
+
+  return result;
+}
+
+std::vector<size_t> madara::knowledge::containers::Table::get_dirty_rows(
+    void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  std::vector<size_t> result(dirty_rows_);
+  std::sort(result.begin(), result.end());
+
+  return result;
+}
+
+bool madara::knowledge::containers::Table::is_dirty(size_t row) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  return row < dirty_.size() && dirty_[row];
+}
+
+void madara::knowledge::containers::Table::clear_dirty(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  for (size_t row : dirty_rows_)
+  {
+    dirty_[row] = false;
+  }
+
+  dirty_rows_.clear();
+}
+
+size_t madara::knowledge::containers::Table::publish_dirty(void)
+{
+  size_t result = 0;
+
+  if (context_ && name_ != "")
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    result = dirty_rows_.size();
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "Table::publish_dirty: %s: publishing %d dirty rows\n",
+        this->name_.c_str(), (int)result);
+
+    if (result > 0)
+    {
+      std::vector<Integer> rows(dirty_rows_.begin(), dirty_rows_.end());
+      std::sort(rows.begin(), rows.end());
+
+      context_->set(dirty_ref_, std::move(rows), settings_);
+
+      for (size_t row : dirty_rows_)
+      {
+        dirty_[row] = false;
+      }
+
+      dirty_rows_.clear();
+    }
+  }
+
+  return result;
+}
+
+bool madara::knowledge::containers::Table::is_true(void) const
+{
+  bool result(false);
+
+  if (context_)
+  {
+    ContextGuard context_guard(*context_);
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
+        "Table::is_true: %s: Checking for non-zero value\n",
+        this->name_.c_str());
+
+    result = !columns_.empty();
+
+    for (const ColumnRef& entry : columns_)
+    {
+      result = result && context_->get(entry.ref, settings_).is_true();
+    }
+
+    madara_logger_log(context_->get_logger(), logger::LOG_MAJOR,
+        "Table::is_true: %s: final result is %d\n", this->name_.c_str(),
+        (int)result);
+  }
+
+  return result;
+}
+
+bool madara::knowledge::containers::Table::is_false(void) const
+{
+  return !is_true();
+}
+
+bool madara::knowledge::containers::Table::is_true_(void) const
+{
+  return is_true();
+}
+
+bool madara::knowledge::containers::Table::is_false_(void) const
+{
+  return is_false();
+}
@@ -0,0 +1,521 @@
+
+#ifndef _MADARA_CONTAINERS_TABLE_H_
+#define _MADARA_CONTAINERS_TABLE_H_
+
+#include <memory>
+#include <vector>
+#include <string>
+#include "madara/LockType.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/knowledge/KnowledgeUpdateSettings.h"
+#include "BaseContainer.h"
+
+/**
+ * @file Table.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a C++ object that manages interactions for a
+ * table of rows with typed columns, such as per-agent state
+ **/
+
+namespace madara
+{
+namespace knowledge
+{
+namespace containers
+{
+/**
+ * @class Table
+ * @brief This class stores a table inside of KaRL with one native array
+ *        per column. Column {column} of table {name} is kept in the
+ *        record {name}.{column}, so a column is contiguous in memory and
+ *        reading it takes one lookup instead of one per row.
+ *
+ * Rows written through the table are remembered as dirty. Only the
+ * columns of changed cells are marked for sending, and publish_dirty
+ * writes the dirty row numbers to {name}.dirty so that receivers can
+ * process just the rows that changed.
+ */
+class MADARA_EXPORT Table : public BaseContainer
+{
+public:
+  /// trait that describes the integer value type
+  typedef KnowledgeRecord::Integer Integer;
+
+  /**
+   * The types a column can hold
+   **/
+  enum ColumnType
+  {
+    INTEGER,
+    DOUBLE
+  };
+
+  /**
+   * The definition of a column
+   **/
+  struct Column
+  {
+    /// the name of the column, which is appended to the table name
+    std::string name;
+
+    /// the type of the values in the column
+    ColumnType type;
+  };
+
+  /// a list of column definitions
+  typedef std::vector<Column> Columns;
+
+  /**
+   * Default constructor
+   * @param  settings   settings for evaluating the table
+   **/
+  Table(const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
+  /**
+   * Constructor
+   * @param  name       name of the table in the knowledge base
+   * @param  knowledge  the knowledge base that will contain the table
+   * @param  columns    the columns of the table
+   * @param  rows       number of rows (-1 to keep the existing rows)
+   * @param  settings   settings for evaluating the table
+   **/
+  Table(const std::string& name, KnowledgeBase& knowledge,
+      const Columns& columns, int rows = -1,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
+  /**
+   * Constructor
+   * @param  name       name of the table in the knowledge base
+   * @param  knowledge  the knowledge base that will contain the table
+   * @param  columns    the columns of the table
+   * @param  rows       number of rows (-1 to keep the existing rows)
+   * @param  settings   settings for evaluating the table
+   **/
+  Table(const std::string& name, Variables& knowledge, const Columns& columns,
+      int rows = -1,
+      const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings());
+
+  /**
+   * Copy constructor. The copy refers to the same records but tracks
+   * its own dirty rows.
+   **/
+  Table(const Table& rhs);
+
+  /**
+   * Destructor
+   **/
+  virtual ~Table();
+
+  /**
+   * Mark the table as modified. The table retains the same values
+   * but every column will be resent as if it had been modified.
+   **/
+  void modify(void);
+
+  /**
+   * Assignment operator
+   * @param  rhs    value to copy
+   **/
+  void operator=(const Table& rhs);
+
+  /**
+   * Sets the variable name that this refers to
+   * @param var_name   the name of the table in the knowledge base
+   * @param knowledge  the knowledge base the table is housed in
+   * @param columns    the columns of the table
+   * @param rows       number of rows (-1 to keep the existing rows)
+   **/
+  void set_name(const std::string& var_name, KnowledgeBase& knowledge,
+      const Columns& columns, int rows = -1);
+
+  /**
+   * Sets the variable name that this refers to
+   * @param var_name   the name of the table in the knowledge base
+   * @param knowledge  the knowledge base the table is housed in
+   * @param columns    the columns of the table
+   * @param rows       number of rows (-1 to keep the existing rows)
+   **/
+  void set_name(const std::string& var_name, Variables& knowledge,
+      const Columns& columns, int rows = -1);
+
+  /**
+   * Returns the columns of the table
+   * @return the column definitions
+   **/
+  Columns get_columns(void) const;
+
+  /**
+   * Finds a column by name
+   * @param  name   the name of the column
+   * @return the index of the column
+   * @throw exceptions::NameException  no column has the name
+   **/
+  size_t column(const std::string& name) const;
+
+  /**
+   * Returns the number of rows, which is the size of the first column
+   * @return the number of rows
+   **/
+  size_t size(void) const;
+
+  /**
+   * Resizes every column. New rows are zero and dirty.
+   * @param   rows   the new number of rows
+   **/
+  void resize(size_t rows);
+
+  /**
+   * Appends a row to the table
+   * @param  values   a value for each column, in column order. Missing
+   *                  values are zero.
+   * @return the index of the new row
+   **/
+  size_t push_back(const KnowledgeVector& values);
+
+  /**
+   * Checks to see if the columns have ever been assigned a value
+   * @return true if every column record has been set
+   **/
+  bool exists(void) const;
+
+  /**
+   * Retrieves a cell as an integer
+   * @param  row      the row of the cell
+   * @param  column   the column of the cell
+   * @return the value of the cell, or 0 if it is out of range
+   **/
+  Integer to_integer(size_t row, size_t column) const;
+
+  /**
+   * Retrieves a cell as a double
+   * @param  row      the row of the cell
+   * @param  column   the column of the cell
+   * @return the value of the cell, or 0 if it is out of range
+   **/
+  double to_double(size_t row, size_t column) const;
+
+  /**
+   * Retrieves a row
+   * @param  row   the row to retrieve
+   * @return a value for each column, in column order. Empty if the row
+   *         is out of range.
+   **/
+  KnowledgeVector get_row(size_t row) const;
+
+  /**
+   * Retrieves a copy of a column
+   * @param  column   the column to retrieve
+   * @return the column as a native array record
+   **/
+  KnowledgeRecord to_record(size_t column) const;
+
+  /**
+   * Retrieves a copy of a column as integers
+   * @param  column   the column to retrieve
+   * @return the values of the column
+   **/
+  std::vector<Integer> to_integers(size_t column) const;
+
+  /**
+   * Retrieves a copy of a column as doubles
+   * @param  column   the column to retrieve
+   * @return the values of the column
+   **/
+  std::vector<double> to_doubles(size_t column) const;
+
+  /**
+   * Shares an integer column without copying it. Writes to the table
+   * afterward copy the column instead of changing the shared values.
+   * @param  column   the column to share
+   * @return the values of the column, or nullptr if the column does not
+   *         hold integers
+   **/
+  std::shared_ptr<const std::vector<Integer>> share_integers(
+      size_t column) const;
+
+  /**
+   * Shares a double column without copying it. Writes to the table
+   * afterward copy the column instead of changing the shared values.
+   * @param  column   the column to share
+   * @return the values of the column, or nullptr if the column does not
+   *         hold doubles
+   **/
+  std::shared_ptr<const std::vector<double>> share_doubles(
+      size_t column) const;
+
+  /**
+   * Sets a cell, converting the value to the type of the column
+   * @param  row      the row of the cell
+   * @param  column   the column of the cell
+   * @param  value    the new value
+   * @return 0 if successful, -1 if the cell is out of range, and
+   *         -2 if quality isn't high enough
+   **/
+  int set(size_t row, size_t column, Integer value);
+
+  /**
+   * Sets a cell, converting the value to the type of the column
+   * @param  row      the row of the cell
+   * @param  column   the column of the cell
+   * @param  value    the new value
+   * @return 0 if successful, -1 if the cell is out of range, and
+   *         -2 if quality isn't high enough
+   **/
+  int set(size_t row, size_t column, double value);
+
+  /**
+   * Sets every cell of a row
+   * @param  row      the row to set
+   * @param  values   a value for each column, in column order
+   * @return 0 if successful, -1 if the row is out of range or the
+   *         number of values is not the number of columns
+   **/
+  int set_row(size_t row, const KnowledgeVector& values);
+
+  /**
+   * Sets every cell of a column. Every row becomes dirty.
+   * @param  column   the column to set
+   * @param  values   a value for each row
+   * @return 0 if successful, -1 if the column is out of range or the
+   *         number of values is not the number of rows
+   **/
+  int set_column(size_t column, const std::vector<Integer>& values);
+
+  /**
+   * Sets every cell of a column. Every row becomes dirty.
+   * @param  column   the column to set
+   * @param  values   a value for each row
+   * @return 0 if successful, -1 if the column is out of range or the
+   *         number of values is not the number of rows
+   **/
+  int set_column(size_t column, const std::vector<double>& values);
+
+  /**
+   * Sums a column
+   * @param  column   the column to sum
+   * @return the sum, as an integer for integer columns
+   **/
+  KnowledgeRecord sum(size_t column) const;
+
+  /**
+   * Finds the smallest value of a column
+   * @param  column   the column to search
+   * @return the smallest value, or an empty record if there are no rows
+   **/
+  KnowledgeRecord min(size_t column) const;
+
+  /**
+   * Finds the largest value of a column
+   * @param  column   the column to search
+   * @return the largest value, or an empty record if there are no rows
+   **/
+  KnowledgeRecord max(size_t column) const;
+
+  /**
+   * Averages a column
+   * @param  column   the column to average
+   * @return the mean, or 0 if there are no rows
+   **/
+  double mean(size_t column) const;
+
+  /**
+   * Computes the dot product of two columns
+   * @param  lhs   the first column
+   * @param  rhs   the second column
+   * @return the sum of the products of each row's values, as an integer
+   *         if both columns hold integers
+   **/
+  KnowledgeRecord dot(size_t lhs, size_t rhs) const;
+
+  /**
+   * Finds the rows whose value in a column is within a range
+   * @param  column   the column to search
+   * @param  low      the smallest value to include
+   * @param  high     the largest value to include
+   * @return the matching rows, in increasing order
+   **/
+  std::vector<size_t> select(size_t column, double low, double high) const;
+
+  /**
+   * Returns the rows written through this table since the dirty rows
+   * were last published or cleared
+   * @return the dirty rows, in increasing order
+   **/
+  std::vector<size_t> get_dirty_rows(void) const;
+
+  /**
+   * Checks if a row has been written since the dirty rows were last
+   * published or cleared
+   * @param  row   the row to check
+   * @return true if the row is dirty
+   **/
+  bool is_dirty(size_t row) const;
+
+  /**
+   * Forgets the dirty rows without publishing them
+   **/
+  void clear_dirty(void);
+
+  /**
+   * Writes the dirty rows to {name}.dirty, which is sent along with the
+   * changed columns, and then clears them. Call this before sending
+   * the table's changes.
+   * @return the number of rows that were dirty
+   **/
+  size_t publish_dirty(void);
+
+  /**
+   * Returns the type of the container along with name and any other
+   * useful information. The provided information should be useful
+   * for developers wishing to debug container operations, especially
+   * as it pertains to pending network operations (i.e., when used
+   * in conjunction with modify)
+   *
+   * @return info in format {container}: {name}{ = value, if appropriate}
+   **/
+  std::string get_debug_info(void);
+
+  /**
+   * Clones this container
+   * @return  a deep copy of the container that must be managed
+   *          by the user (i.e., you have to delete the return value)
+   **/
+  virtual BaseContainer* clone(void) const;
+
+  /**
+   * Determines if all values in the table are true
+   * @return true if all values are true
+   **/
+  bool is_true(void) const;
+
+  /**
+   * Determines if the value of the table is false
+   * @return true if at least one value is false
+   **/
+  bool is_false(void) const;
+
+private:
+  /**
+   * A column and the record that holds it
+   **/
+  struct ColumnRef
+  {
+    /// the definition of the column
+    Column column;
+
+    /// the record holding the column's values
+    VariableReference ref;
+  };
+
+  /**
+   * Looks up the column records and sizes the columns. Callers must
+   * hold the context and mutex_.
+   * @param columns    the columns of the table
+   * @param rows       number of rows (-1 to keep the existing rows)
+   **/
+  void init(const Columns& columns, int rows);
+
+  /**
+   * Resizes every column. Callers must hold the context and mutex_.
+   * @param   rows   the new number of rows
+   **/
+  void resize_unsafe(size_t rows);
+
+  /**
+   * Returns the number of rows. Callers must hold the context.
+   * @return the number of rows
+   **/
+  size_t size_unsafe(void) const;
+
+  /**
+   * Remembers a row as dirty. Callers must hold mutex_.
+   * @param  row   the row that changed
+   **/
+  void mark_dirty(size_t row);
+
+  /**
+   * Sets a cell without locking. Callers must hold the context and
+   * mutex_.
+   * @param  row      the row of the cell
+   * @param  column   the column of the cell
+   * @param  value    the new value
+   * @return 0 if successful, -1 if the cell is out of range, and
+   *         -2 if quality isn't high enough
+   **/
+  int set_unsafe(size_t row, size_t column, const KnowledgeRecord& value);
+
+  /**
+   * Sets every cell of a column without locking. Callers must hold the
+   * context and mutex_.
+   * @param  column   the column to set
+   * @param  values   a value for each row, as a native array
+   * @return 0 if successful, -1 if the column is out of range or the
+   *         number of values is not the number of rows
+   **/
+  int set_column_unsafe(size_t column, KnowledgeRecord values);
+
+  /**
+   * Polymorphic is true method which can be used to determine if
+   * all values in the container are true
+   **/
+  virtual bool is_true_(void) const;
+
+  /**
+   * Polymorphic is false method which can be used to determine if
+   * at least one value in the container is false
+   **/
+  virtual bool is_false_(void) const;
+
+  /**
+   * Polymorphic modify method used by collection containers. This
+   * method calls the modify method for this class. We separate the
+   * faster version (modify) from this version (modify_) to allow
+   * users the opportunity to have a fastery version that does not
+   * use polymorphic functions (generally virtual functions are half
+   * as efficient as normal function calls)
+   **/
+  virtual void modify_(void);
+
+  /**
+   * Returns the type of the container along with name and any other
+   * useful information. The provided information should be useful
+   * for developers wishing to debug container operations, especially
+   * as it pertains to pending network operations (i.e., when used
+   * in conjunction with modify)
+   *
+   * @return info in format {container}: {name}{ = value, if appropriate}
+   **/
+  virtual std::string get_debug_info_(void);
+
+  /**
+   * Variable context that we are modifying
+   **/
+  ThreadSafeContext* context_;
+
+  /**
+   * The columns and their records
+   **/
+  std::vector<ColumnRef> columns_;
+
+  /**
+   * Reference to the record that dirty rows are published to
+   **/
+  VariableReference dirty_ref_;
+
+  /**
+   * True for each row that is dirty
+   **/
+  std::vector<bool> dirty_;
+
+  /**
+   * The dirty rows, in the order they were first written
+   **/
+  std::vector<size_t> dirty_rows_;
+};
+}
+}
+}
+
+#endif  // _MADARA_CONTAINERS_TABLE_H_
@@ -72,8 +72,12 @@ private:
   /// Reference to tracked variable
   VariableReference ref_;
 
+  /// Modification version of the record when last pulled. Zero if the
+  /// record hasn't been pulled yet.
+  uint64_t pulled_version_;
+
   /// Constructor from a VariableReference
-  BaseTracker(VariableReference ref) : ref_(ref) {}
+  BaseTracker(VariableReference ref) : ref_(ref), pulled_version_(0) {}
 
   /// Override to implement pulling logic (from ref_)
   virtual void pull() = 0;
@@ -86,6 +90,13 @@ private:
   /// Get pointer to tracked object
   virtual const void* get_tracked() const = 0;
 
+  /// Override for trackers that read, to check that the records they
+  /// pulled have not been modified since. No locking, so be careful!
+  virtual bool validate() const
+  {
+    return true;
+  }
+
   /// Get record @ref_ points to. No locking, so be careful!
   const KnowledgeRecord& get() const
   {
@@ -110,6 +121,34 @@ private:
     return *ref.get_record_unsafe();
   }
 
+  /// Has record @ref_ points to not been modified since it was last
+  /// pulled? No locking, so be careful!
+  bool unchanged_since_pull() const
+  {
+    return unchanged_since_pull(ref_, pulled_version_);
+  }
+
+  /// Has record @ref points to not been modified since @version was taken?
+  /// No locking, so be careful!
+  static bool unchanged_since_pull(
+      const VariableReference& ref, uint64_t version)
+  {
+    return version != 0 && get(ref).version() == version;
+  }
+
+  /// Remember the version of record @ref_ points to after pulling it
+  void mark_pulled()
+  {
+    pulled_version_ = get().version();
+  }
+
+  /// Is the version of record @ref_ points to the one last pulled?
+  /// No locking, so be careful!
+  bool is_pulled_version() const
+  {
+    return get().version() == pulled_version_;
+  }
+
   /// Set record @ref_ points to. No locking, so be careful!
   template<typename T>
   void set(KnowledgeBase& kb, T&& val)
@@ -197,6 +236,23 @@ MADARA_MAKE_SUPPORT_TEST(knowledge_cast, p,
 /// Trait to test if type supports equality testing (values of same type)
 MADARA_MAKE_SUPPORT_TEST(self_eq, p,
     (get_value(*p) == get_value(*p), get_value(*p) != get_value(*p)));
+
+/// Compare a tracked object to a previously pulled value
+template<typename T, typename V>
+auto tracked_equals(const T& t, const V& v) ->
+    typename std::enable_if<supports_self_eq<T>::value, bool>::type
+{
+  return get_value(t) == v;
+}
+
+/// Fallback for types without equality testing; never equal, so such
+/// objects are always pulled
+template<typename T, typename V>
+auto tracked_equals(const T&, const V&) ->
+    typename std::enable_if<!supports_self_eq<T>::value, bool>::type
+{
+  return false;
+}
 }
 }
 }  // end namespace madara::knowledge::rcw
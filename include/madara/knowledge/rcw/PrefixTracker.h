@@ -70,6 +70,9 @@ private:
   /// vector of references to elements of vector in knowledge base
   std::vector<VariableReference> elems_;
 
+  /// versions of elements in knowledge base when last pulled
+  std::vector<uint64_t> versions_;
+
   typedef
       typename std::decay<decltype(get_value(std::declval<T>()[0]))>::type V;
 
@@ -81,7 +84,8 @@ private:
       tracked_(tracked),
       prefix_(prefix),
       kb_(kb),
-      elems_()
+      elems_(),
+      versions_()
   {
     update_elems();
   }
@@ -116,14 +120,26 @@ private:
   virtual void pull()
   {
     const size_t n = get().to_integer();
+    mark_pulled();
+
+    // elements can only be skipped if the tracked vector still matches
+    // what was last pulled
+    const bool resized = tracked_->size() != n || is_all_dirty(*tracked_);
+
     tracked_->resize(n);
     update_elems();
+    versions_.resize(n, 0);
     for (size_t i = 0; i < n; ++i)
     {
       if (can_read)
       {
+        if (!resized && !is_dirty(*tracked_, i) &&
+            unchanged_since_pull(elems_[i], versions_[i]))
+          continue;
+
         V val = knowledge_cast<V>(get(elems_[i]));
         set_value(*tracked_, i, val);
+        versions_[i] = get(elems_[i]).version();
       }
       else
       {
@@ -187,6 +203,22 @@ private:
     return (void*)tracked_;
   }
 
+  virtual bool validate() const
+  {
+    if (!can_read)
+      return true;
+
+    if (!is_pulled_version())
+      return false;
+
+    for (size_t i = 0; i < versions_.size(); ++i)
+    {
+      if (get(elems_[i]).version() != versions_[i])
+        return false;
+    }
+    return true;
+  }
+
   friend class Transaction;
 };
 }
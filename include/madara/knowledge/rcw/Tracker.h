@@ -74,8 +74,13 @@ private:
 
   virtual void pull()
   {
+    // skip the conversion if neither side has changed since the last pull
+    if (unchanged_since_pull() && get_value(*tracked_) == get_value(orig_))
+      return;
+
     orig_ = knowledge_cast<V>(get());
     set_value(*tracked_, orig_);
+    mark_pulled();
   }
 
   virtual void push(KnowledgeBase& kb)
@@ -102,6 +107,11 @@ private:
     return (void*)tracked_;
   }
 
+  virtual bool validate() const
+  {
+    return is_pulled_version();
+  }
+
   friend class Transaction;
 };
 
@@ -116,18 +126,25 @@ private:
   typedef typename std::decay<decltype(get_value(std::declval<T>()))>::type V;
 
   T* tracked_;  /// Pointer to tracked object
+  V orig_;      /// Pulled value, to detect local changes to tracked object
 
   static const bool can_read = true;
   static const bool can_write = false;
 
   Tracker(T* tracked, VariableReference ref)
-    : BaseTracker(ref), tracked_(tracked)
+    : BaseTracker(ref), tracked_(tracked), orig_()
   {
   }
 
   virtual void pull()
   {
-    set_value(*tracked_, knowledge_cast<V>(get()));
+    // skip the conversion if neither side has changed since the last pull
+    if (unchanged_since_pull() && tracked_equals(*tracked_, orig_))
+      return;
+
+    orig_ = knowledge_cast<V>(get());
+    set_value(*tracked_, orig_);
+    mark_pulled();
   }
 
   virtual void push(KnowledgeBase&) {}
@@ -144,6 +161,11 @@ private:
     return (void*)tracked_;
   }
 
+  virtual bool validate() const
+  {
+    return is_pulled_version();
+  }
+
   friend class Transaction;
 };
 
@@ -228,9 +250,14 @@ private:
 
   virtual void pull()
   {
+    // skip the conversion if neither side has changed since the last pull
+    if (unchanged_since_pull() && !is_dirty(*tracked_))
+      return;
+
     V val = knowledge_cast<V>(get());
     set_value(*tracked_, val);
     clear_dirty(*tracked_);
+    mark_pulled();
   }
 
   virtual void push(KnowledgeBase& kb)
@@ -257,6 +284,11 @@ private:
     return (void*)tracked_;
   }
 
+  virtual bool validate() const
+  {
+    return is_pulled_version();
+  }
+
   friend class Transaction;
 };
 
@@ -345,6 +377,17 @@ private:
 
   virtual void pull()
   {
+    // skip the conversion if neither side has changed since the last pull
+    if (unchanged_since_pull() && tracked_->size() == orig_size_)
+    {
+      size_t i = 0;
+      while (i < orig_size_ && !is_dirty(*tracked_, i))
+        ++i;
+
+      if (i == orig_size_)
+        return;
+    }
+
     std::vector<double> val = get().to_doubles();
     orig_size_ = val.size();
     size_t n = orig_size_;
@@ -354,6 +397,7 @@ private:
       set_value(*tracked_, i, (V)val[i]);
       clear_dirty(*tracked_, i);
     }
+    mark_pulled();
   }
 
   virtual void push(KnowledgeBase& kb)
@@ -403,6 +447,11 @@ private:
     return (void*)tracked_;
   }
 
+  virtual bool validate() const
+  {
+    return is_pulled_version();
+  }
+
   friend class Transaction;
 };
 
@@ -434,8 +483,14 @@ private:
   {
     if (can_read)
     {
+      // skip the conversion if neither side has changed since the last pull
+      if (unchanged_since_pull() && !is_dirty(*tracked_) &&
+          !is_size_dirty(*tracked_))
+        return;
+
       V val = knowledge_cast<V>(get());
       set_value(*tracked_, val);
+      mark_pulled();
     }
     else
     {
@@ -487,6 +542,11 @@ private:
     return (void*)tracked_;
   }
 
+  virtual bool validate() const
+  {
+    return !can_read || is_pulled_version();
+  }
+
   friend class Transaction;
 };
 }
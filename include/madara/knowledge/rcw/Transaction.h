@@ -62,6 +62,21 @@ private:
   /// Stores all registered trackers
   mutable trackers_vec trackers_;
 
+  /// If true, RCWThread uses transact() instead of pull() and push()
+  bool optimistic_ = false;
+
+  /// Attempts transact() makes before giving up on a cycle
+  size_t max_attempts_ = 10;
+
+  /// Number of try_push() calls that committed
+  uint64_t commits_ = 0;
+
+  /// Number of try_push() calls that found a conflicting modification
+  uint64_t conflicts_ = 0;
+
+  /// Number of times transact() recomputed after a conflict
+  uint64_t retries_ = 0;
+
   /// Helper type to enable initialization using initializer_list
   /// Fallback implementation for types which do not support initializer_list
   template<class B, class I, class T, class dummy = void>
@@ -117,6 +132,108 @@ public:
     }
   }
 
+  /// Optimistic alternative to push. Checks that no record pulled by
+  /// the last pull() has been modified since, and if so, pushes values of
+  /// registered variables into the knowledge base. Trackers only write
+  /// what changed locally, so the lock is held for the validation and the
+  /// changed records only.
+  /// @return true if values were pushed, false on a conflict, in which
+  ///         case nothing is pushed
+  bool try_push(void)
+  {
+    ContextGuard guard(kb_);
+    for (auto& t : trackers_)
+    {
+      if (!t->validate())
+      {
+        ++conflicts_;
+        return false;
+      }
+    }
+
+    for (auto& t : trackers_)
+    {
+      t->push(kb_);
+    }
+    ++commits_;
+    return true;
+  }
+
+  /// Runs optimistic read-compute-write cycles: pull(), @compute, then
+  /// try_push(), retrying with fresh values while try_push() finds a
+  /// conflict, up to the maximum number of attempts.
+  /// @param compute callable that updates registered variables
+  /// @return true if the cycle was committed, false if it was abandoned
+  template<class F>
+  bool transact(F&& compute)
+  {
+    for (size_t attempt = 1;; ++attempt)
+    {
+      pull();
+      compute();
+
+      if (try_push())
+        return true;
+
+      if (attempt >= max_attempts_)
+        return false;
+
+      ++retries_;
+    }
+  }
+
+  /// Selects optimistic cycles for RCWThreads running this Transaction
+  /// @param optimistic if true, use transact() instead of pull() and push()
+  void set_optimistic(bool optimistic)
+  {
+    optimistic_ = optimistic;
+  }
+
+  /// @return true if optimistic cycles are selected
+  bool is_optimistic(void) const
+  {
+    return optimistic_;
+  }
+
+  /// Sets the number of attempts transact() makes before giving up
+  /// @param attempts the maximum attempts. Values less than 1 mean 1.
+  void set_max_attempts(size_t attempts)
+  {
+    max_attempts_ = attempts > 0 ? attempts : 1;
+  }
+
+  /// @return the number of attempts transact() makes before giving up
+  size_t get_max_attempts(void) const
+  {
+    return max_attempts_;
+  }
+
+  /// @return the number of try_push() calls that committed
+  uint64_t get_commits(void) const
+  {
+    return commits_;
+  }
+
+  /// @return the number of try_push() calls that found a conflict
+  uint64_t get_conflicts(void) const
+  {
+    return conflicts_;
+  }
+
+  /// @return the number of times transact() recomputed after a conflict
+  uint64_t get_retries(void) const
+  {
+    return retries_;
+  }
+
+  /// Resets the commit, conflict, and retry counters
+  void reset_counters(void)
+  {
+    commits_ = 0;
+    conflicts_ = 0;
+    retries_ = 0;
+  }
+
   /// Builder type which will be returned from the build*() methods
   /// No need to construct directly; just use those methods
   template<class T, class K, bool Const, bool RD, bool WR, bool Prefix,
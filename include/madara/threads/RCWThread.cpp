@@ -12,6 +12,12 @@ void RCWThread::init(KnowledgeBase& kb)
 
 void RCWThread::run(void)
 {
+  if (tx_->is_optimistic())
+  {
+    tx_->transact([this]() { compute(*tx_); });
+    return;
+  }
+
   tx_->pull();
   compute(*tx_);
   tx_->push();
@@ -53,7 +53,10 @@ public:
   friend class Threader;
 
   /**
-   * Setup the thread for later read-compute-write loops
+   * Setup the thread for later read-compute-write loops. Call
+   * set_optimistic on the Transaction to run each loop with
+   * Transaction::transact, so threads only lock the context briefly
+   * and retry compute when another writer got there first.
    **/
   virtual void setup(knowledge::rcw::Transaction&) {}
 
@@ -4,69 +4,73 @@
 #include "madara/utility/IntTypes.h"
 
 madara::transport::BandwidthMonitor::BandwidthMonitor(time_t window_in_secs)
-  : utilization_(0), window_(window_in_secs)
+  : window_ms_(1), bucket_ms_(1)
 {
+  set_window(window_in_secs);
 }
 
 madara::transport::BandwidthMonitor::BandwidthMonitor(
     const BandwidthMonitor& rhs)
-  : messages_(rhs.messages_),
-    utilization_(rhs.utilization_),
-    window_(rhs.window_)
+  : window_ms_(1), bucket_ms_(1)
 {
+  copy(rhs);
 }
 
 madara::transport::BandwidthMonitor::~BandwidthMonitor() {}
 
 void madara::transport::BandwidthMonitor::operator=(const BandwidthMonitor& rhs)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
   if (this != &rhs)
   {
-    messages_ = rhs.messages_;
-    utilization_ = rhs.utilization_;
-    window_ = rhs.window_;
+    copy(rhs);
   }
 }
 
-void madara::transport::BandwidthMonitor::set_window(time_t window_in_secs)
+void madara::transport::BandwidthMonitor::copy(const BandwidthMonitor& rhs)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  window_ms_.store(rhs.window_ms_.load());
+  bucket_ms_.store(rhs.bucket_ms_.load());
 
-  window_ = window_in_secs;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i)
+  {
+    buckets_[i].period.store(rhs.buckets_[i].period.load());
+    buckets_[i].bytes.store(rhs.buckets_[i].bytes.load());
+    buckets_[i].messages.store(rhs.buckets_[i].messages.load());
+  }
 }
 
-void madara::transport::BandwidthMonitor::add(uint64_t size)
+void madara::transport::BandwidthMonitor::set_window(time_t window_in_secs)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  set_window_ms(window_in_secs > 0 ? (uint64_t)window_in_secs * 1000 : 1000);
+}
 
-  utilization_ += size;
+void madara::transport::BandwidthMonitor::set_window_ms(uint64_t window_in_ms)
+{
+  if (window_in_ms == 0)
+    window_in_ms = 1;
 
-  time_t cur_time = update_utilization();
+  // bucket periods change with the window, so old totals are meaningless
+  clear();
 
-  BandwidthRecord entry(cur_time, size);
+  window_ms_.store(window_in_ms);
+  bucket_ms_.store((window_in_ms + NUM_BUCKETS - 1) / NUM_BUCKETS);
+}
 
-  messages_.push_back(entry);
+void madara::transport::BandwidthMonitor::add(uint64_t size)
+{
+  record(now_ms(), size);
 }
 
 void madara::transport::BandwidthMonitor::add(time_t timestamp, uint64_t size)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
-
-  utilization_ += size;
-
-  BandwidthRecord entry(timestamp, size);
-
-  update_utilization();
-
-  messages_.push_back(entry);
+  record((uint64_t)timestamp * 1000, size);
 }
 
 bool madara::transport::BandwidthMonitor::is_bandwidth_violated(int64_t limit)
 {
   bool result = false;
 
-  if (limit >= 0 && uint64_t(limit) > get_utilization())
+  if (limit > 0 && get_bytes_per_second() > uint64_t(limit))
     result = true;
 
   return result;
@@ -74,47 +78,45 @@ bool madara::transport::BandwidthMonitor::is_bandwidth_violated(int64_t limit)
 
 uint64_t madara::transport::BandwidthMonitor::get_utilization(void)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
-
-  update_utilization();
+  uint64_t messages;
 
-  return utilization_;
+  return sum(messages);
 }
 
 uint64_t madara::transport::BandwidthMonitor::get_bytes_per_second(void)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  uint64_t messages;
 
-  update_utilization();
-
-  return utilization_ / (uint64_t)window_;
+  return sum(messages) * 1000 / window_ms_.load(std::memory_order_relaxed);
 }
 
 void madara::transport::BandwidthMonitor::clear(void)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
-  messages_.clear();
-  utilization_ = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i)
+  {
+    buckets_[i].period.store(0);
+    buckets_[i].bytes.store(0);
+    buckets_[i].messages.store(0);
+  }
 }
 
 void madara::transport::BandwidthMonitor::print_utilization(void)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
-
-  update_utilization();
+  uint64_t messages;
+  uint64_t utilization = sum(messages);
+  uint64_t window_ms = window_ms_.load(std::memory_order_relaxed);
 
   madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
-      "Bandwidth: %d messages "
-      "for %" PRIu64 " bytes over %lld window (%" PRIu64 " B/s)\n",
-      messages_.size(), utilization_, (long long)window_,
-      get_bytes_per_second());
+      "Bandwidth: %" PRIu64 " messages "
+      "for %" PRIu64 " bytes over %" PRIu64 "ms window (%" PRIu64 " B/s)\n",
+      messages, utilization, window_ms, utilization * 1000 / window_ms);
 }
 
 size_t madara::transport::BandwidthMonitor::get_number_of_messages(void)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  uint64_t messages;
 
-  update_utilization();
+  sum(messages);
 
-  return messages_.size();
+  return (size_t)messages;
 }
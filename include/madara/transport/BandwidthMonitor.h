@@ -1,5 +1,3 @@
-
-
 #ifndef _MADARA_BANDWIDTH_MONITOR_H
 #define _MADARA_BANDWIDTH_MONITOR_H
 
@@ -11,10 +9,9 @@
  * to monitor bandwidth utilization of a transport
  **/
 
-#include <deque>
+#include <atomic>
 #include <time.h>
 
-#include "madara/LockType.h"
 #include "madara/utility/StdInt.h"
 #include "madara/MadaraExport.h"
 
@@ -22,14 +19,19 @@ namespace madara
 {
 namespace transport
 {
-typedef std::pair<time_t, uint64_t> BandwidthRecord;
-typedef std::deque<BandwidthRecord> BandwidthMessages;
-
 /**
  * @class BandwidthMonitor
  * @brief Provides monitoring capability of a transport's bandwidth
+ *
+ * Utilization is tracked in a fixed ring of time buckets with millisecond
+ * timestamps. The window is divided evenly across the ring, so a 10s window
+ * has 40ms resolution and windows of 256ms or less have 1ms resolution.
+ * Adding a message and querying utilization only use atomic operations,
+ * so many send and receive threads may share a monitor without a lock.
+ * A message racing with the recycling of a bucket may go uncounted, which
+ * is acceptable for rate estimation. Changing the window clears the
+ * monitor and should not race with add calls.
  **/
-
 class MADARA_EXPORT BandwidthMonitor
 {
 public:
@@ -70,9 +72,9 @@ public:
   void add(time_t timestamp, uint64_t size);
 
   /**
-   * Checks send and receive bandwidth against send and receive limits
-   * @param  limit  if -1, does not check. If positive, checks
-   *                against current usage
+   * Checks bandwidth usage against a limit
+   * @param  limit  bytes per second. If 0 or less, does not check.
+   * @return true if bytes per second over the window exceed the limit
    **/
   bool is_bandwidth_violated(int64_t limit);
 
@@ -82,6 +84,12 @@ public:
    **/
   void set_window(time_t window_in_secs);
 
+  /**
+   * Sets the window in milliseconds to measure bandwidth
+   * @param   window_in_ms   Time window to measure bandwidth usage
+   **/
+  void set_window_ms(uint64_t window_in_ms);
+
   /**
    * Queries the monitor for the current bandwidth utilization
    * @return   current bandwidth utilization in bytes
@@ -108,36 +116,69 @@ public:
 
   /**
    * Returns the number of messages in the past window
-   * @return  the number of types that have filters
+   * @return  the number of messages in the past window
    **/
   size_t get_number_of_messages(void);
 
+  /// the number of buckets the window is divided into
+  static const size_t NUM_BUCKETS = 256;
+
 protected:
   /**
-   * Updates utilization for most public functions
-   * @return   current time
+   * A bucket of messages added within the same bucket period
+   **/
+  struct Bucket
+  {
+    /// bucket period + 1 that bytes and messages belong to (0 is empty)
+    std::atomic<uint64_t> period = {0};
+
+    /// bytes added during the period
+    std::atomic<uint64_t> bytes = {0};
+
+    /// messages added during the period
+    std::atomic<uint64_t> messages = {0};
+  };
+
+  /**
+   * Returns the current wall clock time in milliseconds
+   * @return   milliseconds since the epoch
+   **/
+  static uint64_t now_ms(void);
+
+  /**
+   * Adds a message to the bucket for the given time
+   * @param   timestamp_ms   time of the message in milliseconds
+   * @param   size           the size of the message
    **/
-  time_t update_utilization(void);
+  void record(uint64_t timestamp_ms, uint64_t size);
 
   /**
-   * Mutex for supporting multithreaded monitor calls
+   * Sums the buckets within the window ending now
+   * @param   messages   set to the number of messages within the window
+   * @return  bytes within the window
    **/
-  mutable MADARA_LOCK_TYPE mutex_;
+  uint64_t sum(uint64_t& messages) const;
 
   /**
-   * Map of timestamps to messages
+   * Copies the buckets and window of another monitor
+   * @param  rhs   the monitor to copy
    **/
-  BandwidthMessages messages_;
+  void copy(const BandwidthMonitor& rhs);
 
   /**
-   * Utilization
+   * Ring of time buckets
    **/
-  uint64_t utilization_;
+  Bucket buckets_[NUM_BUCKETS];
 
   /**
    * Time window for useful messages to bandwidth calculations
    **/
-  time_t window_;
+  std::atomic<uint64_t> window_ms_;
+
+  /**
+   * Milliseconds covered by each bucket
+   **/
+  std::atomic<uint64_t> bucket_ms_;
 };
 }
 }
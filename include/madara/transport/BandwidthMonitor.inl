@@ -2,37 +2,78 @@
 #ifndef _BANDWIDTH_MONITOR_INL_
 #define _BANDWIDTH_MONITOR_INL_
 
+#include <chrono>
+
 #include "BandwidthMonitor.h"
 #include "madara/utility/Utility.h"
 
-inline time_t madara::transport::BandwidthMonitor::update_utilization(void)
+inline uint64_t madara::transport::BandwidthMonitor::now_ms(void)
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  // wall clock, so add (timestamp, size) can use time (NULL) values
+  return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
 
-  time_t cur_time = time(NULL);
-  time_t earliest_time = cur_time - window_;
+inline void madara::transport::BandwidthMonitor::record(
+    uint64_t timestamp_ms, uint64_t size)
+{
+  uint64_t period =
+      timestamp_ms / bucket_ms_.load(std::memory_order_relaxed) + 1;
+  Bucket& bucket = buckets_[period % NUM_BUCKETS];
 
-  BandwidthMessages::iterator begin = messages_.begin();
-  BandwidthMessages::iterator end = begin;
+  uint64_t current = bucket.period.load(std::memory_order_acquire);
 
-  for (end = begin; end != messages_.end(); ++end)
+  if (current != period)
   {
-    /**
-     * if we have an old message, remove it from utilization and schedule
-     * a deletion
-     **/
-    if (end->first < earliest_time)
+    // the bucket already holds a newer period, so this message has expired
+    if (current > period)
+      return;
+
+    // recycle the stale bucket. Only the thread that wins the exchange
+    // resets the totals; losers add to whatever period won.
+    if (bucket.period.compare_exchange_strong(
+            current, period, std::memory_order_acq_rel))
     {
-      utilization_ -= end->second;
+      bucket.bytes.store(size, std::memory_order_release);
+      bucket.messages.store(1, std::memory_order_release);
+      return;
     }
-    else
-      break;
+
+    if (current != period)
+      return;
   }
 
-  if (end != begin)
-    messages_.erase(begin, end);
+  bucket.bytes.fetch_add(size, std::memory_order_acq_rel);
+  bucket.messages.fetch_add(1, std::memory_order_acq_rel);
+}
+
+inline uint64_t madara::transport::BandwidthMonitor::sum(
+    uint64_t& messages) const
+{
+  uint64_t bucket_ms = bucket_ms_.load(std::memory_order_relaxed);
+  uint64_t window_ms = window_ms_.load(std::memory_order_relaxed);
+  uint64_t current = now_ms() / bucket_ms + 1;
+  uint64_t periods = (window_ms + bucket_ms - 1) / bucket_ms;
+
+  if (periods > NUM_BUCKETS)
+    periods = NUM_BUCKETS;
+
+  uint64_t bytes = 0;
+  messages = 0;
+
+  for (size_t i = 0; i < NUM_BUCKETS; ++i)
+  {
+    uint64_t period = buckets_[i].period.load(std::memory_order_acquire);
+
+    if (period != 0 && period <= current && period + periods > current)
+    {
+      bytes += buckets_[i].bytes.load(std::memory_order_acquire);
+      messages += buckets_[i].messages.load(std::memory_order_acquire);
+    }
+  }
 
-  return cur_time;
+  return bytes;
 }
 
 #endif  // _BANDWIDTH_MONITOR_INL_
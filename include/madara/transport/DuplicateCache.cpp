@@ -0,0 +1,92 @@
+#include "DuplicateCache.h"
+
+namespace madara
+{
+namespace transport
+{
+namespace
+{
+/**
+ * Combines a value into a hash and scrambles the bits with the
+ * splitmix64 finalizer
+ **/
+inline uint64_t mix(uint64_t hash, uint64_t value)
+{
+  hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return hash;
+}
+}
+
+uint64_t DuplicateCache::fingerprint(const char* originator, uint64_t clock,
+    uint64_t timestamp, uint64_t part)
+{
+  // FNV-1a over the originator
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char* c = originator; c && *c; ++c)
+  {
+    hash ^= (unsigned char)*c;
+    hash *= 0x100000001b3ULL;
+  }
+
+  hash = mix(hash, clock);
+  hash = mix(hash, timestamp);
+  return mix(hash, part);
+}
+
+void DuplicateCache::expire(uint64_t now, uint64_t window, size_t capacity)
+{
+  while (order_.size() > 0 &&
+         (order_.size() > capacity || order_.front().first + window < now))
+  {
+    seen_.erase(order_.front().second);
+    order_.pop_front();
+  }
+}
+
+bool DuplicateCache::insert(
+    uint64_t fingerprint, uint64_t now, uint64_t window, size_t capacity)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  expire(now, window, capacity);
+
+  if (seen_.find(fingerprint) != seen_.end())
+  {
+    ++duplicates_;
+    return false;
+  }
+
+  seen_.insert(fingerprint);
+  order_.push_back(std::make_pair(now, fingerprint));
+
+  // make room for the newest fingerprint
+  expire(now, window, capacity);
+
+  return true;
+}
+
+size_t DuplicateCache::size(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return seen_.size();
+}
+
+uint64_t DuplicateCache::get_duplicates(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return duplicates_;
+}
+
+void DuplicateCache::clear(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  seen_.clear();
+  order_.clear();
+}
+}
+}
@@ -0,0 +1,113 @@
+#ifndef _MADARA_TRANSPORT_DUPLICATE_CACHE_H_
+#define _MADARA_TRANSPORT_DUPLICATE_CACHE_H_
+
+/**
+ * @file DuplicateCache.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the DuplicateCache class, which remembers recently
+ * received messages so copies can be dropped before they are decoded
+ **/
+
+#include <deque>
+#include <unordered_set>
+#include <utility>
+
+#include "madara/LockType.h"
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class DuplicateCache
+ * @brief A time-bounded set of recently received message fingerprints
+ *
+ * In a rebroadcasting mesh, every participant hears each message once
+ * from the originator and again from each neighbor that relays it. The
+ * header of a relayed message is the original header with a lower ttl,
+ * so the originator, clock, timestamp and fragment number identify the
+ * message on every path. Receivers insert a 64 bit fingerprint of these
+ * fields right after reading the header and drop the message if it was
+ * already seen, before decoding, filtering or relaying it again.
+ *
+ * Fingerprints are forgotten after a time window, or oldest first when
+ * the cache is full. The cache is owned by the receiving transport's
+ * settings and is never copied with them.
+ **/
+class MADARA_EXPORT DuplicateCache
+{
+public:
+  /**
+   * Constructor
+   **/
+  DuplicateCache() = default;
+
+  DuplicateCache(const DuplicateCache&) = delete;
+  DuplicateCache& operator=(const DuplicateCache&) = delete;
+
+  /**
+   * Computes the fingerprint of a message
+   * @param  originator   the originator in the message header
+   * @param  clock        the clock in the message header
+   * @param  timestamp    the send time in the message header
+   * @param  part         the fragment number, or any value that
+   *                      distinguishes messages with the same header
+   * @return the fingerprint
+   **/
+  static uint64_t fingerprint(const char* originator, uint64_t clock,
+      uint64_t timestamp, uint64_t part);
+
+  /**
+   * Records a fingerprint
+   * @param  fingerprint  the fingerprint of a received message
+   * @param  now          the current time in nanoseconds
+   * @param  window       nanoseconds to remember fingerprints
+   * @param  capacity     the most fingerprints to remember
+   * @return true if the fingerprint was not seen within the window
+   **/
+  bool insert(uint64_t fingerprint, uint64_t now, uint64_t window,
+      size_t capacity);
+
+  /**
+   * Returns the number of remembered fingerprints
+   * @return  the size of the cache
+   **/
+  size_t size(void) const;
+
+  /**
+   * Returns the number of duplicates detected
+   * @return  the duplicates detected since the cache was created
+   **/
+  uint64_t get_duplicates(void) const;
+
+  /**
+   * Forgets all fingerprints
+   **/
+  void clear(void);
+
+private:
+  /**
+   * Forgets fingerprints older than the window or beyond the capacity.
+   * Requires the lock.
+   **/
+  void expire(uint64_t now, uint64_t window, size_t capacity);
+
+  /// Guards all members
+  mutable MADARA_LOCK_TYPE mutex_;
+
+  /// Remembered fingerprints
+  std::unordered_set<uint64_t> seen_;
+
+  /// Times fingerprints were first seen, oldest first
+  std::deque<std::pair<uint64_t, uint64_t>> order_;
+
+  /// Duplicates detected
+  uint64_t duplicates_ = 0;
+};
+}
+}
+
+#endif  // _MADARA_TRANSPORT_DUPLICATE_CACHE_H_
@@ -2,6 +2,9 @@
 #include "madara/utility/Utility.h"
 #include "madara/logger/GlobalLogger.h"
 
+#include <algorithm>
+#include <vector>
+
 const uint64_t max_stride(150000000);
 
 /**
@@ -90,7 +93,8 @@ madara::transport::PacketScheduler::PacketScheduler(
   : settings_(settings),
     sent_messages_(0),
     dropped_messages_(0),
-    consecutive_drops_(0)
+    consecutive_drops_(0),
+    virtual_time_(0)
 {
 }
 
@@ -98,7 +102,8 @@ madara::transport::PacketScheduler::PacketScheduler(const PacketScheduler& rhs)
   : settings_(rhs.settings_),
     sent_messages_(rhs.sent_messages_),
     dropped_messages_(rhs.dropped_messages_),
-    consecutive_drops_(rhs.consecutive_drops_)
+    consecutive_drops_(rhs.consecutive_drops_),
+    virtual_time_(0)
 {
 }
 
@@ -217,6 +222,10 @@ void madara::transport::PacketScheduler::clear(void)
   consecutive_drops_ = 0;
   while (!queue_.empty())
     queue_.pop();
+
+  deferred_.clear();
+  passes_.clear();
+  virtual_time_ = 0;
 }
 
 void madara::transport::PacketScheduler::reset(void)
@@ -269,3 +278,146 @@ uint64_t madara::transport::PacketScheduler::get_sent(void)
   MADARA_GUARD_TYPE guard(mutex_);
   return sent_messages_;
 }
+
+namespace
+{
+/**
+ * <b>INTERNAL USE</b>: Records of a send priority class, oldest first
+ **/
+struct PriorityClass
+{
+  /**
+   * the share of bandwidth for the class
+   **/
+  double tickets = 1;
+
+  /**
+   * the next record in records to schedule
+   **/
+  size_t next = 0;
+
+  /**
+   * the records of the class, sorted by toi
+   **/
+  std::vector<madara::knowledge::KnowledgeMap::iterator> records;
+};
+}
+
+size_t madara::transport::PacketScheduler::schedule(
+    knowledge::KnowledgeMap& updates, uint64_t max_bytes)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (!settings_)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_EMERGENCY,
+        "PacketScheduler::schedule: ERROR: Invalid settings class\n");
+
+    return 0;
+  }
+
+  // newer updates replace deferred records with the same key
+  for (auto& update : updates)
+  {
+    deferred_[update.first] = std::move(update.second);
+  }
+
+  updates.clear();
+
+  std::map<std::string, PriorityClass> classes;
+
+  for (auto i = deferred_.begin(); i != deferred_.end(); ++i)
+  {
+    classes[settings_->get_send_priority_class(i->first)].records.push_back(i);
+  }
+
+  for (auto i = passes_.begin(); i != passes_.end();)
+  {
+    if (classes.find(i->first) == classes.end())
+      i = passes_.erase(i);
+    else
+      ++i;
+  }
+
+  for (auto& priority : classes)
+  {
+    priority.second.tickets = settings_->get_send_priority(priority.first);
+
+    std::stable_sort(priority.second.records.begin(),
+        priority.second.records.end(),
+        [](const knowledge::KnowledgeMap::iterator& lhs,
+            const knowledge::KnowledgeMap::iterator& rhs) {
+          return lhs->second.toi() < rhs->second.toi();
+        });
+
+    // classes that were idle start at the current virtual time
+    auto pass = passes_.find(priority.first);
+    if (pass == passes_.end() || pass->second < virtual_time_)
+    {
+      passes_[priority.first] = virtual_time_;
+    }
+  }
+
+  uint64_t used = 0;
+
+  while (!classes.empty())
+  {
+    // the class with the lowest pass sends next, and ties go to the
+    // class with more tickets
+    auto current = classes.begin();
+    for (auto i = classes.begin(); i != classes.end(); ++i)
+    {
+      double pass = passes_[i->first];
+      double best = passes_[current->first];
+
+      if (pass < best ||
+          (pass == best && i->second.tickets > current->second.tickets))
+      {
+        current = i;
+      }
+    }
+
+    PriorityClass& priority = current->second;
+    auto record = priority.records[priority.next];
+    uint64_t size = (uint64_t)record->second.get_encoded_size(record->first);
+
+    // a class whose next record does not fit is done for this packet,
+    // but smaller records from other classes may still fit
+    if (updates.size() > 0 && used + size > max_bytes)
+    {
+      classes.erase(current);
+      continue;
+    }
+
+    used += size;
+
+    double& pass = passes_[current->first];
+    virtual_time_ = pass;
+    pass += (double)size / priority.tickets;
+
+    updates.emplace(record->first, std::move(record->second));
+    deferred_.erase(record);
+
+    if (++priority.next == priority.records.size())
+    {
+      passes_.erase(current->first);
+      classes.erase(current);
+    }
+  }
+
+  if (deferred_.size() > 0)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "PacketScheduler::schedule: %d records in %d bytes scheduled,"
+        " %d records deferred\n",
+        (int)updates.size(), (int)used, (int)deferred_.size());
+  }
+
+  return deferred_.size();
+}
+
+size_t madara::transport::PacketScheduler::get_deferred(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return deferred_.size();
+}
@@ -8,17 +8,20 @@
  * @author James Edmondson <jedmondson@gmail.com>
  *
  * This file contains the PacketScheduler class, which is intended
- * to enforce user-requested packet drop rates
+ * to enforce user-requested packet drop rates and send priorities
  **/
 
 #include <deque>
+#include <map>
 #include <queue>
+#include <string>
 #include <time.h>
 
 #include "madara/LockType.h"
 #include "madara/utility/StdInt.h"
 #include "madara/MadaraExport.h"
 #include "madara/transport/QoSTransportSettings.h"
+#include "madara/knowledge/KnowledgeRecord.h"
 
 class StrideTask;
 
@@ -28,7 +31,8 @@ namespace transport
 {
 /**
  * @class PacketScheduler
- * @brief Provides scheduler for dropping packets
+ * @brief Provides scheduler for dropping packets and for packing
+ *        records by send priority
  **/
 
 class MADARA_EXPORT PacketScheduler
@@ -82,6 +86,28 @@ public:
    **/
   uint64_t get_sent(void);
 
+  /**
+   * Chooses the records to send in the next packet, according to the
+   * send priorities in the settings. Each priority class is a stride
+   * scheduled task whose pass advances by the bytes it sends divided
+   * by its tickets, so under saturation classes share the packet in
+   * proportion to their tickets. Records that do not fit are deferred
+   * and merged with the updates of the next call, where newer updates
+   * replace deferred records with the same key.
+   * @param   updates     the records to send. Replaced with the records
+   *                      chosen for the packet.
+   * @param   max_bytes   the bytes available for encoded records. At
+   *                      least one record is always chosen.
+   * @return  the number of deferred records
+   **/
+  size_t schedule(knowledge::KnowledgeMap& updates, uint64_t max_bytes);
+
+  /**
+   * Returns the number of records deferred by schedule
+   * @return  the number of records waiting for a later packet
+   **/
+  size_t get_deferred(void) const;
+
   /**
    * Clears the packet scheduler
    **/
@@ -131,6 +157,22 @@ protected:
    * queue used by stride scheduling algorithm
    **/
   std::priority_queue<StrideTask, std::vector<StrideTask> > queue_;
+
+  /**
+   * records waiting for a later packet
+   **/
+  knowledge::KnowledgeMap deferred_;
+
+  /**
+   * pass of each priority class with deferred records
+   **/
+  std::map<std::string, double> passes_;
+
+  /**
+   * pass of the last scheduled record. Classes that become active
+   * start here, so idle time does not build up credit.
+   **/
+  double virtual_time_;
 };
 }
 }
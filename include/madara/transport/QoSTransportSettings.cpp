@@ -18,8 +18,12 @@ madara::transport::QoSTransportSettings::QoSTransportSettings()
     packet_drop_burst_(1),
     max_send_bandwidth_(-1),
     max_total_bandwidth_(-1),
+    send_pacing_rate_(-1),
+    send_pacing_burst_(-1),
+    send_pacing_max_delay_(-1),
     deadline_(-1)
 {
+  seed_rebroadcast();
 }
 
 madara::transport::QoSTransportSettings::QoSTransportSettings(
@@ -38,8 +42,17 @@ madara::transport::QoSTransportSettings::QoSTransportSettings(
     packet_drop_burst_(settings.packet_drop_burst_),
     max_send_bandwidth_(settings.max_send_bandwidth_),
     max_total_bandwidth_(settings.max_total_bandwidth_),
-    deadline_(settings.deadline_)
+    send_pacing_rate_(settings.send_pacing_rate_),
+    send_pacing_burst_(settings.send_pacing_burst_),
+    send_pacing_max_delay_(settings.send_pacing_max_delay_),
+    send_priorities_(settings.send_priorities_),
+    deadline_(settings.deadline_),
+    duplicate_window_(settings.duplicate_window_),
+    duplicate_capacity_(settings.duplicate_capacity_),
+    rebroadcast_probability_(settings.rebroadcast_probability_),
+    rebroadcast_seed_(settings.rebroadcast_seed_)
 {
+  seed_rebroadcast();
 }
 
 madara::transport::QoSTransportSettings::QoSTransportSettings(
@@ -52,6 +65,9 @@ madara::transport::QoSTransportSettings::QoSTransportSettings(
     packet_drop_rate_(0.0),
     max_send_bandwidth_(-1),
     max_total_bandwidth_(-1),
+    send_pacing_rate_(-1),
+    send_pacing_burst_(-1),
+    send_pacing_max_delay_(-1),
     deadline_(-1)
 {
   const QoSTransportSettings* rhs =
@@ -71,13 +87,23 @@ madara::transport::QoSTransportSettings::QoSTransportSettings(
     packet_drop_burst_ = rhs->packet_drop_burst_;
     max_send_bandwidth_ = rhs->max_send_bandwidth_;
     max_total_bandwidth_ = rhs->max_total_bandwidth_;
+    send_pacing_rate_ = rhs->send_pacing_rate_;
+    send_pacing_burst_ = rhs->send_pacing_burst_;
+    send_pacing_max_delay_ = rhs->send_pacing_max_delay_;
+    send_priorities_ = rhs->send_priorities_;
     deadline_ = rhs->deadline_;
+    duplicate_window_ = rhs->duplicate_window_;
+    duplicate_capacity_ = rhs->duplicate_capacity_;
+    rebroadcast_probability_ = rhs->rebroadcast_probability_;
+    rebroadcast_seed_ = rhs->rebroadcast_seed_;
   }
   else
   {
     TransportSettings* lhs = dynamic_cast<TransportSettings*>(this);
     *lhs = settings;
   }
+
+  seed_rebroadcast();
 }
 
 madara::transport::QoSTransportSettings::~QoSTransportSettings()
@@ -108,7 +134,16 @@ void madara::transport::QoSTransportSettings::operator=(
     packet_drop_burst_ = rhs.packet_drop_burst_;
     max_send_bandwidth_ = rhs.max_send_bandwidth_;
     max_total_bandwidth_ = rhs.max_total_bandwidth_;
+    send_pacing_rate_ = rhs.send_pacing_rate_;
+    send_pacing_burst_ = rhs.send_pacing_burst_;
+    send_pacing_max_delay_ = rhs.send_pacing_max_delay_;
+    send_priorities_ = rhs.send_priorities_;
     deadline_ = rhs.deadline_;
+    duplicate_window_ = rhs.duplicate_window_;
+    duplicate_capacity_ = rhs.duplicate_capacity_;
+    rebroadcast_probability_ = rhs.rebroadcast_probability_;
+    rebroadcast_seed_ = rhs.rebroadcast_seed_;
+    seed_rebroadcast();
   }
 }
 
@@ -129,7 +164,16 @@ void madara::transport::QoSTransportSettings::operator=(
     packet_drop_burst_ = 1;
     max_send_bandwidth_ = -1;
     max_total_bandwidth_ = -1;
+    send_pacing_rate_ = -1;
+    send_pacing_burst_ = -1;
+    send_pacing_max_delay_ = -1;
+    send_priorities_.clear();
     deadline_ = -1;
+    duplicate_window_ = 5;
+    duplicate_capacity_ = 10000;
+    rebroadcast_probability_ = 1;
+    rebroadcast_seed_ = 0;
+    seed_rebroadcast();
 
     TransportSettings* lhs_base = (TransportSettings*)this;
     TransportSettings* rhs_base = (TransportSettings*)&rhs;
@@ -250,12 +294,24 @@ void madara::transport::QoSTransportSettings::add_send_filter(
   send_filters_.add(functor);
 }
 
+void madara::transport::QoSTransportSettings::add_send_filter(
+    filters::BatchFilter* functor)
+{
+  send_filters_.add(functor);
+}
+
 void madara::transport::QoSTransportSettings::add_receive_filter(
     filters::AggregateFilter* functor)
 {
   receive_filters_.add(functor);
 }
 
+void madara::transport::QoSTransportSettings::add_receive_filter(
+    filters::BatchFilter* functor)
+{
+  receive_filters_.add(functor);
+}
+
 void madara::transport::QoSTransportSettings::add_filter(
     filters::BufferFilter* functor)
 {
@@ -308,6 +364,12 @@ void madara::transport::QoSTransportSettings::add_rebroadcast_filter(
   rebroadcast_filters_.add(functor);
 }
 
+void madara::transport::QoSTransportSettings::add_rebroadcast_filter(
+    filters::BatchFilter* functor)
+{
+  rebroadcast_filters_.add(functor);
+}
+
 #ifdef _MADARA_JAVA_
 
 void madara::transport::QoSTransportSettings::add_receive_filter(
@@ -409,6 +471,11 @@ void madara::transport::QoSTransportSettings::clear_send_aggregate_filters()
   send_filters_.clear_aggregate_filters();
 }
 
+void madara::transport::QoSTransportSettings::clear_send_batch_filters()
+{
+  send_filters_.clear_batch_filters();
+}
+
 void madara::transport::QoSTransportSettings::clear_receive_filters(
     uint32_t types)
 {
@@ -420,6 +487,11 @@ void madara::transport::QoSTransportSettings::clear_receive_aggregate_filters()
   receive_filters_.clear_aggregate_filters();
 }
 
+void madara::transport::QoSTransportSettings::clear_receive_batch_filters()
+{
+  receive_filters_.clear_batch_filters();
+}
+
 void madara::transport::QoSTransportSettings::clear_rebroadcast_filters(
     uint32_t types)
 {
@@ -437,6 +509,11 @@ void madara::transport::QoSTransportSettings::
   rebroadcast_filters_.clear_aggregate_filters();
 }
 
+void madara::transport::QoSTransportSettings::clear_rebroadcast_batch_filters()
+{
+  rebroadcast_filters_.clear_batch_filters();
+}
+
 madara::knowledge::KnowledgeRecord
 madara::transport::QoSTransportSettings::filter_send(
     const madara::knowledge::KnowledgeRecord& input, const std::string& name,
@@ -452,6 +529,13 @@ void madara::transport::QoSTransportSettings::filter_send(
   send_filters_.filter(records, transport_context);
 }
 
+void madara::transport::QoSTransportSettings::filter_send_batch(
+    filters::RecordBatch& records,
+    transport::TransportContext& transport_context) const
+{
+  send_filters_.filter_batch(records, transport_context);
+}
+
 int madara::transport::QoSTransportSettings::filter_encode(
     char* source, int size, int max_size) const
 {
@@ -658,6 +742,13 @@ void madara::transport::QoSTransportSettings::filter_receive(
   receive_filters_.filter(records, transport_context);
 }
 
+void madara::transport::QoSTransportSettings::filter_receive_batch(
+    filters::RecordBatch& records,
+    transport::TransportContext& transport_context) const
+{
+  receive_filters_.filter_batch(records, transport_context);
+}
+
 madara::knowledge::KnowledgeRecord
 madara::transport::QoSTransportSettings::filter_rebroadcast(
     const madara::knowledge::KnowledgeRecord& input, const std::string& name,
@@ -673,6 +764,13 @@ void madara::transport::QoSTransportSettings::filter_rebroadcast(
   rebroadcast_filters_.filter(records, transport_context);
 }
 
+void madara::transport::QoSTransportSettings::filter_rebroadcast_batch(
+    filters::RecordBatch& records,
+    transport::TransportContext& transport_context) const
+{
+  rebroadcast_filters_.filter_batch(records, transport_context);
+}
+
 void madara::transport::QoSTransportSettings::print_num_filters_send(void) const
 {
   send_filters_.print_num_filters();
@@ -704,6 +802,12 @@ madara::transport::QoSTransportSettings::get_number_of_send_aggregate_filters(
   return send_filters_.get_number_of_aggregate_filters();
 }
 
+size_t madara::transport::QoSTransportSettings::
+    get_number_of_send_batch_filters(void) const
+{
+  return send_filters_.get_number_of_batch_filters();
+}
+
 size_t madara::transport::QoSTransportSettings::
     get_number_of_rebroadcast_filtered_types(void) const
 {
@@ -716,6 +820,12 @@ size_t madara::transport::QoSTransportSettings::
   return rebroadcast_filters_.get_number_of_aggregate_filters();
 }
 
+size_t madara::transport::QoSTransportSettings::
+    get_number_of_rebroadcast_batch_filters(void) const
+{
+  return rebroadcast_filters_.get_number_of_batch_filters();
+}
+
 size_t
 madara::transport::QoSTransportSettings::get_number_of_receive_filtered_types(
     void) const
@@ -729,6 +839,12 @@ size_t madara::transport::QoSTransportSettings::
   return receive_filters_.get_number_of_aggregate_filters();
 }
 
+size_t madara::transport::QoSTransportSettings::
+    get_number_of_receive_batch_filters(void) const
+{
+  return receive_filters_.get_number_of_batch_filters();
+}
+
 size_t madara::transport::QoSTransportSettings::get_number_of_buffer_filters(
     void) const
 {
@@ -782,6 +898,93 @@ int64_t madara::transport::QoSTransportSettings::get_total_bandwidth_limit(
   return max_total_bandwidth_;
 }
 
+void madara::transport::QoSTransportSettings::set_send_pacing_rate(
+    int64_t bandwidth)
+{
+  send_pacing_rate_ = bandwidth;
+}
+
+int64_t madara::transport::QoSTransportSettings::get_send_pacing_rate(
+    void) const
+{
+  return send_pacing_rate_;
+}
+
+void madara::transport::QoSTransportSettings::set_send_pacing_burst(
+    int64_t burst)
+{
+  send_pacing_burst_ = burst;
+}
+
+int64_t madara::transport::QoSTransportSettings::get_send_pacing_burst(
+    void) const
+{
+  return send_pacing_burst_;
+}
+
+void madara::transport::QoSTransportSettings::set_send_pacing_max_delay(
+    double max_delay)
+{
+  send_pacing_max_delay_ = max_delay;
+}
+
+double madara::transport::QoSTransportSettings::get_send_pacing_max_delay(
+    void) const
+{
+  return send_pacing_max_delay_;
+}
+
+void madara::transport::QoSTransportSettings::set_send_priority(
+    const std::string& prefix, double tickets)
+{
+  if(tickets > 0)
+  {
+    send_priorities_[prefix] = tickets;
+  }
+  else
+  {
+    send_priorities_.erase(prefix);
+  }
+}
+
+double madara::transport::QoSTransportSettings::get_send_priority(
+    const std::string& key) const
+{
+  std::string prefix = get_send_priority_class(key);
+
+  auto found = send_priorities_.find(prefix);
+
+  return found != send_priorities_.end() ? found->second : 1;
+}
+
+std::string madara::transport::QoSTransportSettings::get_send_priority_class(
+    const std::string& key) const
+{
+  std::string result;
+
+  for(auto& priority : send_priorities_)
+  {
+    if(priority.first.size() > result.size() &&
+        utility::begins_with(key, priority.first))
+    {
+      result = priority.first;
+    }
+  }
+
+  return result;
+}
+
+size_t madara::transport::QoSTransportSettings::get_number_of_send_priorities(
+    void) const
+{
+  return send_priorities_.size();
+}
+
+void madara::transport::QoSTransportSettings::clear_send_priorities(void)
+{
+  send_priorities_.clear();
+}
+
 void madara::transport::QoSTransportSettings::set_deadline(double deadline)
 {
   deadline_ = deadline;
@@ -792,6 +995,110 @@ double madara::transport::QoSTransportSettings::get_deadline(void) const
   return deadline_;
 }
 
+void madara::transport::QoSTransportSettings::set_duplicate_window(
+    double seconds)
+{
+  duplicate_window_ = seconds;
+}
+
+double madara::transport::QoSTransportSettings::get_duplicate_window(
+    void) const
+{
+  return duplicate_window_;
+}
+
+void madara::transport::QoSTransportSettings::set_duplicate_capacity(
+    size_t capacity)
+{
+  duplicate_capacity_ = capacity;
+}
+
+size_t madara::transport::QoSTransportSettings::get_duplicate_capacity(
+    void) const
+{
+  return duplicate_capacity_;
+}
+
+bool madara::transport::QoSTransportSettings::is_duplicate(
+    const char* originator, uint64_t clock, uint64_t timestamp,
+    uint64_t part) const
+{
+  if(duplicate_window_ <= 0 || duplicate_capacity_ == 0)
+  {
+    return false;
+  }
+
+  return !duplicate_cache_.insert(
+      DuplicateCache::fingerprint(originator, clock, timestamp, part),
+      (uint64_t)utility::get_time(), (uint64_t)(duplicate_window_ * 1e9),
+      duplicate_capacity_);
+}
+
+uint64_t madara::transport::QoSTransportSettings::get_duplicates(void) const
+{
+  return duplicate_cache_.get_duplicates();
+}
+
+void madara::transport::QoSTransportSettings::set_rebroadcast_probability(
+    double probability)
+{
+  rebroadcast_probability_ = probability;
+}
+
+double madara::transport::QoSTransportSettings::get_rebroadcast_probability(
+    void) const
+{
+  return rebroadcast_probability_;
+}
+
+void madara::transport::QoSTransportSettings::set_rebroadcast_seed(
+    uint64_t seed)
+{
+  rebroadcast_seed_ = seed;
+  seed_rebroadcast();
+}
+
+uint64_t madara::transport::QoSTransportSettings::get_rebroadcast_seed(
+    void) const
+{
+  return rebroadcast_seed_;
+}
+
+void madara::transport::QoSTransportSettings::set_rebroadcast_stream(
+    const std::string& id)
+{
+  seed_rebroadcast(DuplicateCache::fingerprint(id.c_str(), 0, 0, 0));
+}
+
+bool madara::transport::QoSTransportSettings::draw_rebroadcast(void) const
+{
+  if(rebroadcast_probability_ >= 1)
+  {
+    return true;
+  }
+
+  MADARA_GUARD_TYPE guard(rebroadcast_mutex_);
+
+  return std::uniform_real_distribution<double>(0.0, 1.0)(
+             rebroadcast_random_) < rebroadcast_probability_;
+}
+
+void madara::transport::QoSTransportSettings::seed_rebroadcast(
+    uint64_t stream)
+{
+  MADARA_GUARD_TYPE guard(rebroadcast_mutex_);
+
+  if(rebroadcast_seed_ != 0)
+  {
+    rebroadcast_random_.seed(rebroadcast_seed_ ^ stream);
+  }
+  else
+  {
+    std::random_device device;
+    rebroadcast_random_.seed(((uint64_t)device() << 32) | device());
+  }
+}
+
 void madara::transport::QoSTransportSettings::load(
     const std::string& filename, const std::string& prefix)
 {
@@ -834,8 +1141,39 @@ void madara::transport::QoSTransportSettings::load(
       (int64_t)knowledge.get(prefix + ".max_send_bandwidth").to_integer();
   max_total_bandwidth_ =
       (int64_t)knowledge.get(prefix + ".max_total_bandwidth").to_integer();
+  send_pacing_rate_ =
+      (int64_t)knowledge.get(prefix + ".send_pacing_rate").to_integer();
+  send_pacing_burst_ =
+      (int64_t)knowledge.get(prefix + ".send_pacing_burst").to_integer();
+  send_pacing_max_delay_ =
+      knowledge.get(prefix + ".send_pacing_max_delay").to_double();
+
+  containers::Map send_priorities(prefix + ".send_priorities", knowledge);
+
+  std::vector<std::string> priority_keys;
+  send_priorities.keys(priority_keys);
+
+  send_priorities_.clear();
+  for(size_t i = 0; i < priority_keys.size(); ++i)
+  {
+    set_send_priority(
+        priority_keys[i], send_priorities[priority_keys[i]].to_double());
+  }
 
   deadline_ = knowledge.get(prefix + ".deadline").to_double();
+
+  if(knowledge.exists(prefix + ".duplicate_window"))
+  {
+    duplicate_window_ =
+        knowledge.get(prefix + ".duplicate_window").to_double();
+    duplicate_capacity_ =
+        (size_t)knowledge.get(prefix + ".duplicate_capacity").to_integer();
+    rebroadcast_probability_ =
+        knowledge.get(prefix + ".rebroadcast_probability").to_double();
+    rebroadcast_seed_ =
+        (uint64_t)knowledge.get(prefix + ".rebroadcast_seed").to_integer();
+    seed_rebroadcast();
+  }
 }
 
 void madara::transport::QoSTransportSettings::load_text(
@@ -880,8 +1218,39 @@ void madara::transport::QoSTransportSettings::load_text(
       (int64_t)knowledge.get(prefix + ".max_send_bandwidth").to_integer();
   max_total_bandwidth_ =
       (int64_t)knowledge.get(prefix + ".max_total_bandwidth").to_integer();
+  send_pacing_rate_ =
+      (int64_t)knowledge.get(prefix + ".send_pacing_rate").to_integer();
+  send_pacing_burst_ =
+      (int64_t)knowledge.get(prefix + ".send_pacing_burst").to_integer();
+  send_pacing_max_delay_ =
+      knowledge.get(prefix + ".send_pacing_max_delay").to_double();
+
+  containers::Map send_priorities(prefix + ".send_priorities", knowledge);
+
+  std::vector<std::string> priority_keys;
+  send_priorities.keys(priority_keys);
+
+  send_priorities_.clear();
+  for(size_t i = 0; i < priority_keys.size(); ++i)
+  {
+    set_send_priority(
+        priority_keys[i], send_priorities[priority_keys[i]].to_double());
+  }
 
   deadline_ = knowledge.get(prefix + ".deadline").to_double();
+
+  if(knowledge.exists(prefix + ".duplicate_window"))
+  {
+    duplicate_window_ =
+        knowledge.get(prefix + ".duplicate_window").to_double();
+    duplicate_capacity_ =
+        (size_t)knowledge.get(prefix + ".duplicate_capacity").to_integer();
+    rebroadcast_probability_ =
+        knowledge.get(prefix + ".rebroadcast_probability").to_double();
+    rebroadcast_seed_ =
+        (uint64_t)knowledge.get(prefix + ".rebroadcast_seed").to_integer();
+    seed_rebroadcast();
+  }
 }
 
 void madara::transport::QoSTransportSettings::save(
@@ -919,7 +1288,23 @@ void madara::transport::QoSTransportSettings::save(
 
   knowledge.set(prefix + ".max_send_bandwidth", Integer(max_send_bandwidth_));
   knowledge.set(prefix + ".max_total_bandwidth", Integer(max_total_bandwidth_));
+  knowledge.set(prefix + ".send_pacing_rate", Integer(send_pacing_rate_));
+  knowledge.set(prefix + ".send_pacing_burst", Integer(send_pacing_burst_));
+  knowledge.set(prefix + ".send_pacing_max_delay", send_pacing_max_delay_);
+
+  containers::Map send_priorities(prefix + ".send_priorities", knowledge);
+
+  for(auto& priority : send_priorities_)
+  {
+    send_priorities.set(priority.first, priority.second);
+  }
+
   knowledge.set(prefix + ".deadline", deadline_);
+  knowledge.set(prefix + ".duplicate_window", duplicate_window_);
+  knowledge.set(
+      prefix + ".duplicate_capacity", Integer(duplicate_capacity_));
+  knowledge.set(prefix + ".rebroadcast_probability", rebroadcast_probability_);
+  knowledge.set(prefix + ".rebroadcast_seed", Integer(rebroadcast_seed_));
 
   knowledge.save_context(filename);
 }
@@ -959,7 +1344,23 @@ void madara::transport::QoSTransportSettings::save_text(
 
   knowledge.set(prefix + ".max_send_bandwidth", Integer(max_send_bandwidth_));
   knowledge.set(prefix + ".max_total_bandwidth", Integer(max_total_bandwidth_));
+  knowledge.set(prefix + ".send_pacing_rate", Integer(send_pacing_rate_));
+  knowledge.set(prefix + ".send_pacing_burst", Integer(send_pacing_burst_));
+  knowledge.set(prefix + ".send_pacing_max_delay", send_pacing_max_delay_);
+
+  containers::Map send_priorities(prefix + ".send_priorities", knowledge);
+
+  for(auto& priority : send_priorities_)
+  {
+    send_priorities.set(priority.first, priority.second);
+  }
+
   knowledge.set(prefix + ".deadline", deadline_);
+  knowledge.set(prefix + ".duplicate_window", duplicate_window_);
+  knowledge.set(
+      prefix + ".duplicate_capacity", Integer(duplicate_capacity_));
+  knowledge.set(prefix + ".rebroadcast_probability", rebroadcast_probability_);
+  knowledge.set(prefix + ".rebroadcast_seed", Integer(rebroadcast_seed_));
 
   knowledge.save_as_karl(filename);
 }
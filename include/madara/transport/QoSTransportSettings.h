@@ -9,16 +9,19 @@
  * settings container for quality of service parameters for transport classes
  **/
 
+#include <random>
 #include <string>
 
 #include "madara/transport/TransportSettings.h"
 #include "madara/transport/TransportContext.h"
+#include "madara/transport/DuplicateCache.h"
 #include "madara/knowledge/ThreadSafeContext.h"
 #include "madara/utility/StdInt.h"
 #include "madara/MadaraExport.h"
 #include "madara/filters/AggregateFilter.h"
 #include "madara/filters/RecordFilter.h"
 #include "madara/filters/BufferFilter.h"
+#include "madara/filters/BatchFilter.h"
 #include "madara/knowledge/KnowledgeRecordFilters.h"
 
 #ifdef _MADARA_JAVA_
@@ -113,6 +116,15 @@ public:
    **/
   void add_send_filter(filters::AggregateFilter* filter);
 
+  /**
+   * Adds a batch filter that will be applied before sending, after
+   * individual record filters and before aggregate filters. The filter
+   * is called once per message with every record in the message.
+   * @param   filter     an instance of a batch record filter that
+   *                     will be managed by the underlying infrastructure
+   **/
+  void add_send_filter(filters::BatchFilter* filter);
+
   /**
    * Adds a buffer filter to the chain
    * @param   filter     an instance of a buffer filter
@@ -154,6 +166,15 @@ public:
    **/
   void add_receive_filter(filters::AggregateFilter* filter);
 
+  /**
+   * Adds a batch filter that will be applied after receiving, after
+   * individual record filters and before aggregate filters. The filter
+   * is called once per message with every record in the message.
+   * @param   filter     an instance of a batch record filter that
+   *                     will be managed by the underlying infrastructure
+   **/
+  void add_receive_filter(filters::BatchFilter* filter);
+
   /**
    * Adds a filter that will be applied to certain types after receiving
    * and before rebroadcasting (if TTL > 0)
@@ -190,6 +211,15 @@ public:
    **/
   void add_rebroadcast_filter(filters::AggregateFilter* filter);
 
+  /**
+   * Adds a batch filter that will be applied before rebroadcasting,
+   * after individual record filters and before aggregate filters. The filter
+   * is called once per message with every record in the message.
+   * @param   filter     an instance of a batch record filter that
+   *                     will be managed by the underlying infrastructure
+   **/
+  void add_rebroadcast_filter(filters::BatchFilter* filter);
+
 #ifdef _MADARA_JAVA_
 
   /**
@@ -329,6 +359,11 @@ public:
    **/
   void clear_send_aggregate_filters(void);
 
+  /**
+   * Clears the list of send time batch filters
+   **/
+  void clear_send_batch_filters(void);
+
   /**
    * Clears the list of filters for the specified types
    * @param   types   the types to clear the filters of
@@ -345,6 +380,11 @@ public:
    **/
   void clear_receive_aggregate_filters(void);
 
+  /**
+   * Clears the list of receive time batch filters
+   **/
+  void clear_receive_batch_filters(void);
+
   /**
    * Clears the list of filters for the specified types
    * @param   types   the types to clear the filters of
@@ -356,6 +396,11 @@ public:
    **/
   void clear_rebroadcast_aggregate_filters(void);
 
+  /**
+   * Clears the list of rebroadcast time batch filters
+   **/
+  void clear_rebroadcast_batch_filters(void);
+
   /**
    * Filters an input according to send's filter chain
    * @param   name    variable name of input ("" for unnamed)
@@ -375,6 +420,14 @@ public:
   void filter_send(knowledge::KnowledgeMap& records,
       const transport::TransportContext& transport_context) const;
 
+  /**
+   * Filters a batch of records with the send batch filter chain
+   * @param  records             the batch of records
+   * @param  transport_context   the context of the transport
+   **/
+  void filter_send_batch(filters::RecordBatch& records,
+      transport::TransportContext& transport_context) const;
+
   /**
    * Filters an input according to the receive filter chain
    * @param   name    variable name of input ("" for unnamed)
@@ -394,6 +447,14 @@ public:
   void filter_receive(knowledge::KnowledgeMap& records,
       const transport::TransportContext& transport_context) const;
 
+  /**
+   * Filters a batch of records with the receive batch filter chain
+   * @param  records             the batch of records
+   * @param  transport_context   the context of the transport
+   **/
+  void filter_receive_batch(filters::RecordBatch& records,
+      transport::TransportContext& transport_context) const;
+
   /**
    * Filters an input according to the rebroadcast filter chain
    * @param   name    variable name of input ("" for unnamed)
@@ -413,6 +474,14 @@ public:
   void filter_rebroadcast(knowledge::KnowledgeMap& records,
       const transport::TransportContext& transport_context) const;
 
+  /**
+   * Filters a batch of records with the rebroadcast batch filter chain
+   * @param  records             the batch of records
+   * @param  transport_context   the context of the transport
+   **/
+  void filter_rebroadcast_batch(filters::RecordBatch& records,
+      transport::TransportContext& transport_context) const;
+
   /**
    * Calls encode on the the buffer filter chain
    * @param   source           the source and destination buffer
@@ -476,6 +545,12 @@ public:
    **/
   size_t get_number_of_send_aggregate_filters(void) const;
 
+  /**
+   * Returns the number of batch filters applied before sending
+   * @return  the number of batch filters
+   **/
+  size_t get_number_of_send_batch_filters(void) const;
+
   /**
    * Returns the number of aggregate filters applied before
    * rebroadcasting
@@ -483,6 +558,12 @@ public:
    **/
   size_t get_number_of_rebroadcast_aggregate_filters(void) const;
 
+  /**
+   * Returns the number of batch filters applied before rebroadcasting
+   * @return  the number of batch filters
+   **/
+  size_t get_number_of_rebroadcast_batch_filters(void) const;
+
   /**
    * Returns the number of types that are filtered before rebroadcast
    * @return  the number of types that have filters
@@ -495,6 +576,12 @@ public:
    **/
   size_t get_number_of_receive_aggregate_filters(void) const;
 
+  /**
+   * Returns the number of batch filters applied after receiving
+   * @return  the number of batch filters
+   **/
+  size_t get_number_of_receive_batch_filters(void) const;
+
   /**
    * Returns the number of types that are filtered after received
    * @return  the number of types that have filters
@@ -613,6 +700,88 @@ public:
    **/
   int64_t get_total_bandwidth_limit(void) const;
 
+  /**
+   * Sets a pacing rate for sending on this transport. When pacing is
+   * enabled, sends that would exceed the rate are delayed until they
+   * conform instead of being dropped by the send bandwidth limit.
+   * @param   bandwidth  pacing rate in bytes per second. 0 or less
+   *                     disables pacing.
+   **/
+  void set_send_pacing_rate(int64_t bandwidth);
+
+  /**
+   * Returns the pacing rate for sending on this transport
+   * @return the pacing rate in bytes per second (0 or less if disabled)
+   **/
+  int64_t get_send_pacing_rate(void) const;
+
+  /**
+   * Sets the number of bytes that may be sent back-to-back at full speed
+   * after the transport has been idle.
+   * @param   burst   burst size in bytes. 0 or less uses queue_length.
+   **/
+  void set_send_pacing_burst(int64_t burst);
+
+  /**
+   * Returns the pacing burst size
+   * @return the burst size in bytes (0 or less means queue_length)
+   **/
+  int64_t get_send_pacing_burst(void) const;
+
+  /**
+   * Sets the longest a send may be delayed by pacing. Sends that would
+   * wait longer are dropped.
+   * @param   max_delay   maximum delay in seconds. 0 or less means sends
+   *                      are never dropped by pacing.
+   **/
+  void set_send_pacing_max_delay(double max_delay);
+
+  /**
+   * Returns the longest a send may be delayed by pacing
+   * @return the maximum delay in seconds (0 or less means no limit)
+   **/
+  double get_send_pacing_max_delay(void) const;
+
+  /**
+   * Sets the send priority of records whose keys start with a prefix.
+   * Once any priority is set, each send is limited to a single
+   * max_fragment_size packet. Records are packed by stride scheduling,
+   * so each priority class gets a share of the packet proportional to
+   * its tickets, and records that do not fit are deferred to later
+   * sends. Keys that match no prefix have 1 ticket.
+   * @param   prefix   the key prefix. The longest matching prefix wins.
+   * @param   tickets  the share of bandwidth for the class. 0 or less
+   *                   removes the prefix.
+   **/
+  void set_send_priority(const std::string& prefix, double tickets);
+
+  /**
+   * Returns the send priority of a key
+   * @param   key      the key of a record to send
+   * @return  the tickets of the longest matching prefix, or 1 if no
+   *          prefix matches
+   **/
+  double get_send_priority(const std::string& key) const;
+
+  /**
+   * Returns the prefix of the priority class of a key
+   * @param   key      the key of a record to send
+   * @return  the longest matching prefix, or an empty string if no
+   *          prefix matches
+   **/
+  std::string get_send_priority_class(const std::string& key) const;
+
+  /**
+   * Returns the number of prefixes with send priorities
+   * @return  the number of priority classes, excluding the default
+   **/
+  size_t get_number_of_send_priorities(void) const;
+
+  /**
+   * Removes all send priorities, which disables priority scheduling
+   **/
+  void clear_send_priorities(void);
+
   /**
    * Sets the packet deadline in seconds. Note that most transports only
    * enforce deadline in seconds. However, future transports may allow
@@ -628,6 +797,95 @@ public:
    **/
   double get_deadline(void) const;
 
+  /**
+   * Sets how long received messages are remembered. Copies of a message
+   * received within the window, e.g., from other rebroadcasters, are
+   * dropped right after the header is read. Default is 5 seconds.
+   * @param   seconds   the window in seconds. 0 or less disables
+   *                    duplicate detection.
+   **/
+  void set_duplicate_window(double seconds);
+
+  /**
+   * Returns how long received messages are remembered
+   * @return  the window in seconds. 0 or less is disabled.
+   **/
+  double get_duplicate_window(void) const;
+
+  /**
+   * Sets the most received messages remembered. The oldest are forgotten
+   * first. Default is 10000.
+   * @param   capacity   the most messages to remember
+   **/
+  void set_duplicate_capacity(size_t capacity);
+
+  /**
+   * Returns the most received messages remembered
+   * @return  the capacity of the duplicate cache
+   **/
+  size_t get_duplicate_capacity(void) const;
+
+  /**
+   * Checks if a received message was already received within the
+   * duplicate window, and remembers it
+   * @param   originator   the originator in the message header
+   * @param   clock        the clock in the message header
+   * @param   timestamp    the send time in the message header
+   * @param   part         the fragment number, or 0 for whole messages
+   * @return  true if the message is a duplicate
+   **/
+  bool is_duplicate(const char* originator, uint64_t clock,
+      uint64_t timestamp, uint64_t part) const;
+
+  /**
+   * Returns the number of duplicate messages dropped
+   * @return  the duplicates detected
+   **/
+  uint64_t get_duplicates(void) const;
+
+  /**
+   * Sets the probability of rebroadcasting a received message, for
+   * gossip-style flooding of dense networks. Each participant relays
+   * each message at most once, with this probability. Default is 1.
+   * @param   probability   probability of rebroadcasting (0 to 1)
+   **/
+  void set_rebroadcast_probability(double probability);
+
+  /**
+   * Returns the probability of rebroadcasting a received message
+   * @return  the probability of rebroadcasting (0 to 1)
+   **/
+  double get_rebroadcast_probability(void) const;
+
+  /**
+   * Seeds the draws that decide whether to rebroadcast, so runs that use
+   * a rebroadcast probability can be reproduced, e.g., on a loopback
+   * network. Each transport mixes its id into the seed. The default, 0,
+   * seeds each copy of the settings from a random device.
+   * @param   seed   the seed, or 0 for a random seed
+   **/
+  void set_rebroadcast_seed(uint64_t seed);
+
+  /**
+   * Returns the seed of the draws that decide whether to rebroadcast
+   * @return  the seed, or 0 if seeded randomly
+   **/
+  uint64_t get_rebroadcast_seed(void) const;
+
+  /**
+   * Reseeds rebroadcast draws from the seed mixed with a transport id, so
+   * transports that share settings and a seed still draw independently.
+   * Transports call this with their own id when they are created.
+   * @param   id     the id of the transport using these settings
+   **/
+  void set_rebroadcast_stream(const std::string& id);
+
+  /**
+   * Decides whether to rebroadcast a received message
+   * @return  true with the rebroadcast probability
+   **/
+  bool draw_rebroadcast(void) const;
+
   /**
    * Loads the settings from a binary file
    * @param  filename    the file to load from
@@ -737,10 +995,72 @@ private:
    **/
   int64_t max_total_bandwidth_;
 
+  /**
+   * Pacing rate for sends in bytes per second
+   **/
+  int64_t send_pacing_rate_;
+
+  /**
+   * Pacing burst size in bytes
+   **/
+  int64_t send_pacing_burst_;
+
+  /**
+   * Maximum delay in seconds a paced send may wait before being dropped
+   **/
+  double send_pacing_max_delay_;
+
+  /**
+   * Send priority tickets by key prefix
+   **/
+  std::map<std::string, double> send_priorities_;
+
   /**
    * Deadline for packets at which packets drop
    **/
   double deadline_;
+
+  /**
+   * Seconds to remember received messages
+   **/
+  double duplicate_window_ = 5;
+
+  /**
+   * Most received messages to remember
+   **/
+  size_t duplicate_capacity_ = 10000;
+
+  /**
+   * Probability of rebroadcasting a received message
+   **/
+  double rebroadcast_probability_ = 1;
+
+  /**
+   * Seed for rebroadcast draws, or 0 for a random seed
+   **/
+  uint64_t rebroadcast_seed_ = 0;
+
+  /**
+   * Generator for rebroadcast draws. Reseeded, not copied, with the
+   * settings.
+   **/
+  mutable std::mt19937_64 rebroadcast_random_;
+
+  /**
+   * Guards rebroadcast_random_ for transports with many read threads
+   **/
+  mutable MADARA_LOCK_TYPE rebroadcast_mutex_;
+
+  /**
+   * Recently received messages. Never copied with the settings.
+   **/
+  mutable DuplicateCache duplicate_cache_;
+
+  /**
+   * Seeds rebroadcast_random_ from rebroadcast_seed_
+   * @param   stream  mixed into the seed, or 0 for none
+   **/
+  void seed_rebroadcast(uint64_t stream = 0);
 };
 }  // end Transport namespace
 }  // end Madara namespace
@@ -0,0 +1,108 @@
+#include "TokenBucket.h"
+
+#include <chrono>
+#include <thread>
+
+madara::transport::TokenBucket::TokenBucket(int64_t rate, int64_t burst)
+  : rate_(rate), burst_(burst), drained_at_(0)
+{
+}
+
+madara::transport::TokenBucket::TokenBucket(const TokenBucket& rhs)
+  : rate_(rhs.rate_.load()),
+    burst_(rhs.burst_.load()),
+    drained_at_(rhs.drained_at_.load())
+{
+}
+
+void madara::transport::TokenBucket::operator=(const TokenBucket& rhs)
+{
+  if (this != &rhs)
+  {
+    rate_.store(rhs.rate_.load());
+    burst_.store(rhs.burst_.load());
+    drained_at_.store(rhs.drained_at_.load());
+  }
+}
+
+void madara::transport::TokenBucket::set_rate(int64_t rate, int64_t burst)
+{
+  rate_.store(rate);
+  burst_.store(burst > 0 ? burst : 0);
+  reset();
+}
+
+int64_t madara::transport::TokenBucket::get_rate(void) const
+{
+  return rate_.load();
+}
+
+int64_t madara::transport::TokenBucket::get_burst(void) const
+{
+  return burst_.load();
+}
+
+bool madara::transport::TokenBucket::is_enabled(void) const
+{
+  return rate_.load(std::memory_order_relaxed) > 0;
+}
+
+void madara::transport::TokenBucket::reset(void)
+{
+  drained_at_.store(0);
+}
+
+int64_t madara::transport::TokenBucket::now_ns(void)
+{
+  return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t madara::transport::TokenBucket::reserve(
+    uint64_t bytes, int64_t max_delay_ns)
+{
+  int64_t rate = rate_.load(std::memory_order_relaxed);
+
+  if (rate <= 0)
+    return 0;
+
+  // convert bytes to the time the bucket needs to drain them
+  int64_t cost = (int64_t)(bytes * 1000000000.0 / rate);
+  int64_t tolerance =
+      (int64_t)(burst_.load(std::memory_order_relaxed) * 1000000000.0 / rate);
+
+  int64_t now = now_ns();
+  int64_t drained_at = drained_at_.load(std::memory_order_acquire);
+
+  for (;;)
+  {
+    // an idle bucket drains to empty, it does not bank extra tokens
+    int64_t next = (drained_at > now ? drained_at : now) + cost;
+    int64_t delay = next - tolerance - now;
+
+    if (delay < 0)
+      delay = 0;
+
+    if (max_delay_ns >= 0 && delay > max_delay_ns)
+      return -1;
+
+    if (drained_at_.compare_exchange_weak(
+            drained_at, next, std::memory_order_acq_rel))
+      return delay;
+  }
+}
+
+bool madara::transport::TokenBucket::acquire(uint64_t bytes, double max_delay)
+{
+  int64_t delay =
+      reserve(bytes, max_delay > 0 ? (int64_t)(max_delay * 1000000000) : -1);
+
+  if (delay < 0)
+    return false;
+
+  if (delay > 0)
+    std::this_thread::sleep_for(std::chrono::nanoseconds(delay));
+
+  return true;
+}
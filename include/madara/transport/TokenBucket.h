@@ -0,0 +1,126 @@
+#ifndef _MADARA_TRANSPORT_TOKEN_BUCKET_H_
+#define _MADARA_TRANSPORT_TOKEN_BUCKET_H_
+
+/**
+ * @file TokenBucket.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the TokenBucket class, which paces sends to a
+ * configured byte rate
+ **/
+
+#include <atomic>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class TokenBucket
+ * @brief Lock-free token bucket for pacing bytes to a rate
+ *
+ * The bucket refills at the configured rate up to a burst size. Callers
+ * reserve bytes and are told how long to wait before the bytes conform
+ * to the rate. Reservations are made with a single compare-and-swap on
+ * the time the bucket is next empty, so concurrent senders are queued in
+ * the order they reserve without taking a lock.
+ **/
+class MADARA_EXPORT TokenBucket
+{
+public:
+  /**
+   * Constructor
+   * @param  rate    bytes per second. 0 or less disables pacing.
+   * @param  burst   bytes that may be sent back-to-back after idling
+   **/
+  TokenBucket(int64_t rate = -1, int64_t burst = 0);
+
+  /**
+   * Copy constructor
+   * @param  rhs   the value to be copied into this class
+   **/
+  TokenBucket(const TokenBucket& rhs);
+
+  /**
+   * Assignment operator
+   * @param  rhs   the value to be copied into this class
+   **/
+  void operator=(const TokenBucket& rhs);
+
+  /**
+   * Sets the rate and burst size and refills the bucket
+   * @param  rate    bytes per second. 0 or less disables pacing.
+   * @param  burst   bytes that may be sent back-to-back after idling
+   **/
+  void set_rate(int64_t rate, int64_t burst);
+
+  /**
+   * Returns the pacing rate
+   * @return  bytes per second, or 0 or less if disabled
+   **/
+  int64_t get_rate(void) const;
+
+  /**
+   * Returns the burst size
+   * @return  bytes that may be sent back-to-back after idling
+   **/
+  int64_t get_burst(void) const;
+
+  /**
+   * Checks if pacing is enabled
+   * @return  true if a positive rate has been set
+   **/
+  bool is_enabled(void) const;
+
+  /**
+   * Reserves bytes from the bucket without waiting
+   * @param  bytes          the number of bytes to send
+   * @param  max_delay_ns   the longest acceptable wait in nanoseconds.
+   *                        Negative means no limit.
+   * @return nanoseconds to wait before sending, or -1 if the wait would
+   *         exceed max_delay_ns, in which case nothing is reserved
+   **/
+  int64_t reserve(uint64_t bytes, int64_t max_delay_ns = -1);
+
+  /**
+   * Reserves bytes from the bucket and sleeps until they may be sent
+   * @param  bytes       the number of bytes to send
+   * @param  max_delay   the longest acceptable wait in seconds. 0 or less
+   *                     means no limit.
+   * @return true if the bytes may be sent, false if they should be dropped
+   **/
+  bool acquire(uint64_t bytes, double max_delay = -1);
+
+  /**
+   * Refills the bucket to its burst size
+   **/
+  void reset(void);
+
+protected:
+  /**
+   * Returns a monotonic time in nanoseconds
+   **/
+  static int64_t now_ns(void);
+
+  /**
+   * Bytes per second
+   **/
+  std::atomic<int64_t> rate_;
+
+  /**
+   * Maximum bytes in the bucket
+   **/
+  std::atomic<int64_t> burst_;
+
+  /**
+   * Time at which all reserved bytes will have drained from the bucket
+   **/
+  std::atomic<int64_t> drained_at_;
+};
+}
+}
+
+#endif  // _MADARA_TRANSPORT_TOKEN_BUCKET_H_
@@ -10,6 +10,108 @@ namespace madara
 {
 namespace transport
 {
+namespace
+{
+/**
+ * Packs updates into as few packets of capacity bytes as possible,
+ * largest first. Fragments are identified by originator and clock, so
+ * updates larger than the capacity share one packet, which is the only
+ * fragmented message of the send.
+ **/
+void pack_updates(const knowledge::KnowledgeMap& updates, uint64_t capacity,
+    std::vector<knowledge::KnowledgeMap>& packets)
+{
+  typedef std::pair<uint64_t, knowledge::KnowledgeMap::const_iterator>
+      SizedUpdate;
+
+  std::vector<SizedUpdate> sizes;
+  sizes.reserve(updates.size());
+
+  for(auto i = updates.begin(); i != updates.end(); ++i)
+  {
+    sizes.push_back(
+        SizedUpdate((uint64_t)i->second.get_encoded_size(i->first), i));
+  }
+
+  std::stable_sort(sizes.begin(), sizes.end(),
+      [](const SizedUpdate& lhs, const SizedUpdate& rhs) {
+        return lhs.first > rhs.first;
+      });
+
+  std::vector<uint64_t> used;
+
+  for(auto& update : sizes)
+  {
+    // sorted largest first, so oversized updates fill the first packet
+    if(update.first > capacity)
+    {
+      if(packets.size() == 0)
+      {
+        packets.push_back(knowledge::KnowledgeMap());
+        used.push_back(0);
+      }
+
+      packets[0].emplace(update.second->first, update.second->second);
+      used[0] += update.first;
+      continue;
+    }
+
+    // first fit
+    size_t packet = 0;
+    while(packet < used.size() && used[packet] + update.first > capacity)
+    {
+      ++packet;
+    }
+
+    if(packet == used.size())
+    {
+      packets.push_back(knowledge::KnowledgeMap());
+      used.push_back(0);
+    }
+
+    packets[packet].emplace(update.second->first, update.second->second);
+    used[packet] += update.first;
+  }
+}
+
+/**
+ * Erases the records that batch filters dropped with clear_value
+ **/
+void erase_missing(knowledge::KnowledgeMap& records)
+{
+  for(auto i = records.begin(); i != records.end();)
+  {
+    if(i->second.exists())
+    {
+      ++i;
+    }
+    else
+    {
+      i = records.erase(i);
+    }
+  }
+}
+
+/**
+ * Checks if a message was already received, e.g., from another
+ * rebroadcaster. Relays keep the original header, apart from the ttl,
+ * and senders give each message a unique timestamp.
+ **/
+bool is_duplicate(const QoSTransportSettings& settings,
+    const MessageHeader* header, bool is_fragment)
+{
+  uint64_t part = 0;
+
+  if(is_fragment)
+  {
+    part = (uint64_t)((const FragmentMessageHeader*)header)->update_number + 1;
+  }
+
+  return settings.is_duplicate(
+      header->originator, header->clock, header->timestamp, part);
+}
+}
+
 Base::Base(const std::string& id, TransportSettings& new_settings,
     knowledge::ThreadSafeContext& context)
   : is_valid_(false),
@@ -24,6 +126,7 @@ Base::Base(const std::string& id, TransportSettings& new_settings,
 #endif  // _MADARA_NO_KARL_
 {
   settings_.attach(&context_);
+  settings_.set_rebroadcast_stream(id_);
   packet_scheduler_.attach(&settings_);
 }
 
@@ -56,6 +159,19 @@ int Base::setup(void)
   if(settings_.queue_length > 0)
     buffer_ = new char[settings_.queue_length];
 
+  // setup the send pacer, which defaults to bursting a full send buffer
+  send_pacer_.set_rate(settings_.get_send_pacing_rate(),
+      settings_.get_send_pacing_burst() > 0 ? settings_.get_send_pacing_burst()
+                                            : settings_.queue_length);
+
+  if(send_pacer_.is_enabled())
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "transport::Base::setup"
+        " pacing sends to %lld B/s with %lld byte bursts\n",
+        (long long)send_pacer_.get_rate(), (long long)send_pacer_.get_burst());
+  }
+
   // if read domains has not been set, then set to write domain
   if(settings_.num_read_domains() == 0)
   {
@@ -246,6 +362,16 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     return -1;
   }
 
+  if(!is_reduced && is_duplicate(settings, header, is_fragment))
+  {
+    madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " Message from %s was already received. Dropping duplicate.\n",
+        print_prefix, header->originator);
+
+    return -7;
+  }
+
   if(!is_reduced)
   {
     // reject the message if it is us as the originator (no update necessary)
@@ -417,6 +543,18 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
           return 0;
         }
 
+        // the whole message may also arrive unfragmented or from a relay
+        if(!is_reduced && is_duplicate(settings, header, false))
+        {
+          madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+              "%s:"
+              " Defragged message from %s was already received."
+              " Dropping duplicate.\n",
+              print_prefix, header->originator);
+
+          return -7;
+        }
+
         madara_logger_log(context.get_logger(),
             logger::LOG_MAJOR, "%s:"
             " past fragment header create.\n",
@@ -517,6 +655,15 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         " Dropping packet from rebroadcast list...\n",
         print_prefix);
   }
+  else if(!settings.draw_rebroadcast())
+  {
+    dropped = true;
+    madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " Rebroadcast probability suppressed this relay."
+        " Dropping packet from rebroadcast list...\n",
+        print_prefix);
+  }
 
   madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
       "%s:"
@@ -540,6 +687,10 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     }
   };
 
+  // batch filters see all surviving records of the message at once
+  const bool batch_receive = settings.get_number_of_receive_batch_filters() > 0;
+  filters::RecordBatch batch;
+
   // iterate over the updates
   for(uint32_t i = 0; i < header->updates; ++i)
   {
@@ -574,7 +725,14 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
             " Filter results for %s were %s\n",
             print_prefix, key.c_str(), record.to_string().c_str());
 
-        add_record(key, record);
+        if(batch_receive)
+        {
+          batch[key] = record;
+        }
+        else
+        {
+          add_record(key, record);
+        }
       }
       else
       {
@@ -586,6 +744,24 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     }
   }
 
+  if(batch_receive && batch.size() > 0)
+  {
+    madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " Applying batch receive filters to %d records.\n",
+        print_prefix, (int)batch.size());
+
+    settings.filter_receive_batch(batch, transport_context);
+
+    for(auto& e : batch)
+    {
+      if(e.second.exists())
+      {
+        add_record(e.first, std::move(e.second));
+      }
+    }
+  }
+
   const knowledge::KnowledgeMap& additionals = transport_context.get_records();
 
   if(additionals.size() > 0)
@@ -725,6 +901,20 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
       }
     }
 
+    // batch filters work on the rebroadcast records in place
+    if(settings.get_number_of_rebroadcast_batch_filters() > 0 &&
+        rebroadcast_records.size() > 0)
+    {
+      madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+          "%s:"
+          " Applying batch rebroadcast filters to %d records.\n",
+          print_prefix, (int)rebroadcast_records.size());
+
+      settings.filter_rebroadcast_batch(rebroadcast_records, transport_context);
+
+      erase_missing(rebroadcast_records);
+    }
+
     const knowledge::KnowledgeMap& additionals =
         transport_context.get_records();
 
@@ -858,8 +1048,201 @@ int prep_rebroadcast(knowledge::ThreadSafeContext& context, char* buffer,
   return result;
 }
 
-long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
+long Base::encode_message(const knowledge::KnowledgeMap& updates,
+    uint32_t quality, char* buffer, int64_t buffer_size,
     const char* print_prefix)
+{
+  int64_t buffer_remaining = buffer_size;
+  bool reduced = false;
+
+  // set the header to the beginning of the buffer
+  MessageHeader* header = 0;
+
+  if(settings_.send_reduced_message_header)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Preparing message with reduced message header.\n",
+        print_prefix);
+
+    header = new ReducedMessageHeader();
+    reduced = true;
+  }
+  else
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Preparing message with normal message header.\n",
+        print_prefix);
+
+    header = new MessageHeader();
+  }
+
+  // get the clock
+  header->clock = context_.get_clock();
+
+  if(!reduced)
+  {
+    // copy the domain from settings
+    strncpy(header->domain, this->settings_.write_domain.c_str(),
+        sizeof(header->domain) - 1);
+
+    // get the quality of the key
+    header->quality = quality;
+
+    // copy the message originator (our id)
+    strncpy(header->originator, id_.c_str(), sizeof(header->originator) - 1);
+
+    // send data is generally an assign type. However, MessageHeader is
+    // flexible enough to support both, and this will simply our read thread
+    // handling
+    header->type = MULTIASSIGN;
+
+    // receivers tell messages apart by originator, clock and timestamp
+    if(header->timestamp <= last_timestamp_sent_)
+    {
+      header->timestamp = last_timestamp_sent_ + 1;
+    }
+    last_timestamp_sent_ = header->timestamp;
+  }
+
+  // set the time-to-live
+  header->ttl = settings_.get_rebroadcast_ttl();
+
+  header->updates = uint32_t(updates.size());
+
+  // compute size of this header
+  header->size = header->encoded_size();
+
+  // keep track of the maximum buffer size for encoding
+  int max_buffer_size = (int)buffer_remaining;
+
+  // set the update to the end of the header
+  char* update = header->write(buffer, buffer_remaining);
+  uint64_t* message_size = (uint64_t*)buffer;
+  uint32_t* message_updates = (uint32_t*)(buffer + 116);
+
+  // Message header format
+  // [size|id|domain|originator|type|updates|quality|clock|list of updates]
+
+  /**
+   * size = buffer[0] (unsigned 64 bit)
+   * transport id = buffer[8] (8 byte)
+   * domain = buffer[16] (32 byte domain name)
+   * originator = buffer[48] (64 byte originator host:port)
+   * type = buffer[112] (unsigned 32 bit type of message--usually MULTIASSIGN)
+   * updates = buffer[116] (unsigned 32 bit number of updates)
+   * quality = buffer[120] (unsigned 32 bit quality of message)
+   * clock = buffer[124] (unsigned 64 bit clock for this message)
+   * ttl = buffer[132] (the new knowledge starts here)
+   * knowledge = buffer[133] (the new knowledge starts here)
+   **/
+
+  // zero out the memory
+  // memset(buffer, 0, MAX_PACKET_SIZE);
+
+  // Message update format
+  // [key|value]
+
+  int j = 0;
+  uint32_t actual_updates = 0;
+  for(knowledge::KnowledgeMap::const_iterator i = updates.begin();
+       i != updates.end(); ++i)
+  {
+    const auto& key = i->first;
+    const auto& rec = i->second;
+    const auto do_write = [&](const knowledge::KnowledgeRecord& rec) {
+      if(!rec.exists())
+      {
+        madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+            "%s:"
+            " update[%d] => value is empty\n",
+            print_prefix, j, key.c_str());
+        return;
+      }
+
+      update = rec.write(update, key, buffer_remaining);
+
+      if(buffer_remaining > 0)
+      {
+        madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+            "%s:"
+            " update[%d] => encoding %s of type %" PRId32 " and size %" PRIu32
+            " @%" PRIu64 "\n",
+            print_prefix, j, key.c_str(), rec.type(), rec.size(), rec.toi());
+        ++actual_updates;
+        ++j;
+      }
+      else
+      {
+        madara_logger_log(context_.get_logger(), logger::LOG_EMERGENCY,
+            "%s:"
+            " unable to encode update[%d] => %s of type %" PRId32
+            " and size %" PRIu32 "\n",
+            print_prefix, j, key.c_str(), rec.type(), rec.size());
+      }
+    };
+
+    if(!settings_.send_history || !rec.has_history())
+    {
+      do_write(rec);
+    }
+    else
+    {
+      auto buf = rec.share_circular_buffer();
+      auto end = buf->end();
+      auto cur = buf->begin();
+
+      if(last_toi_sent_ > 0)
+      {
+        cur = std::upper_bound(cur, end, last_toi_sent_,
+            [](uint64_t lhs, const knowledge::KnowledgeRecord& rhs) {
+              return lhs < rhs.toi();
+            });
+      }
+      for(; cur != end; ++cur)
+      {
+        do_write(*cur);
+      }
+    }
+  }
+
+  long size(0);
+
+  if(buffer_remaining > 0)
+  {
+    size = (long)(buffer_size - buffer_remaining);
+    header->size = size;
+    *message_size = utility::endian_swap((uint64_t)size);
+    header->updates = actual_updates;
+    *message_updates = utility::endian_swap(actual_updates);
+  }
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " calling encode filters\n",
+      print_prefix);
+
+  // buffer is ready encoding
+  size = (long)settings_.filter_encode(buffer, (int)size, max_buffer_size);
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+      "%s:"
+      " header info before encode: %s\n",
+      print_prefix, header->to_string().c_str());
+
+  delete header;
+
+  return size;
+}
+
+bool Base::has_deferred_updates(void) const
+{
+  return packet_scheduler_.get_deferred() > 0;
+}
+
+long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
+    const char* print_prefix, MessageSpans* messages)
 {
   // check to see if we are shutting down
   long ret = this->check_transport();
@@ -881,7 +1264,6 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
   // get the maximum quality from the updates
   uint32_t quality = knowledge::max_quality(orig_updates);
   uint64_t latest_toi = 0;
-  bool reduced = false;
 
   knowledge::KnowledgeMap filtered_updates;
 
@@ -897,7 +1279,9 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
 
   bool dropped = false;
 
-  if(send_monitor_.is_bandwidth_violated(settings_.get_send_bandwidth_limit()))
+  // a paced transport delays sends instead of dropping them
+  if(!send_pacer_.is_enabled() &&
+      send_monitor_.is_bandwidth_violated(settings_.get_send_bandwidth_limit()))
   {
     dropped = true;
     madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
@@ -1031,6 +1415,22 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     return 0;
   }
 
+  // apply the batch filters, which see all surviving records at once
+  if(settings_.get_number_of_send_batch_filters() > 0 &&
+      filtered_updates.size() > 0)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Applying %d batch send filters to %d updates...\n",
+        print_prefix, (int)settings_.get_number_of_send_batch_filters(),
+        (int)filtered_updates.size());
+
+    // the filters work on the update map in place
+    settings_.filter_send_batch(filtered_updates, transport_context);
+
+    erase_missing(filtered_updates);
+  }
+
   madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
       "%s:"
       " Applying %d aggregate update send filters to %d updates...\n",
@@ -1051,6 +1451,26 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
         print_prefix);
   }
 
+  // with send priorities, fill a single packet by priority and defer
+  // the records that do not fit
+  if(settings_.get_number_of_send_priorities() > 0)
+  {
+    // the full header is never smaller than the reduced header
+    uint64_t header_size = MessageHeader::static_encoded_size();
+    uint64_t max_bytes = settings_.max_fragment_size > header_size
+                             ? settings_.max_fragment_size - header_size
+                             : 0;
+
+    size_t deferred = packet_scheduler_.schedule(filtered_updates, max_bytes);
+
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Send priorities scheduled %d updates and deferred %d...\n",
+        print_prefix, (int)filtered_updates.size(), (int)deferred);
+
+    quality = knowledge::max_quality(filtered_updates);
+  }
+
   packet_scheduler_.print_status(logger::LOG_DETAILED, print_prefix);
 
   madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
@@ -1070,7 +1490,6 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
 
   // allocate a buffer to send
   char* buffer = buffer_.get_ptr();
-  int64_t buffer_remaining = settings_.queue_length;
 
   if(buffer == 0)
   {
@@ -1082,161 +1501,53 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     return -3;
   }
 
-  // set the header to the beginning of the buffer
-  MessageHeader* header = 0;
-
-  if(settings_.send_reduced_message_header)
-  {
-    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
-        "%s:"
-        " Preparing message with reduced message header.\n",
-        print_prefix);
-
-    header = new ReducedMessageHeader();
-    reduced = true;
-  }
-  else
-  {
-    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
-        "%s:"
-        " Preparing message with normal message header.\n",
-        print_prefix);
-
-    header = new MessageHeader();
-  }
-
-  // get the clock
-  header->clock = context_.get_clock();
+  long size(0);
 
-  if(!reduced)
+  if(messages && settings_.pack_messages)
   {
-    // copy the domain from settings
-    strncpy(header->domain, this->settings_.write_domain.c_str(),
-        sizeof(header->domain) - 1);
-
-    // get the quality of the key
-    header->quality = quality;
-
-    // copy the message originator (our id)
-    strncpy(header->originator, id_.c_str(), sizeof(header->originator) - 1);
+    // the full header is never smaller than the reduced header
+    uint64_t header_size = MessageHeader::static_encoded_size();
+    uint64_t capacity = settings_.max_fragment_size > header_size
+                            ? settings_.max_fragment_size - header_size
+                            : 0;
 
-    // send data is generally an assign type. However, MessageHeader is
-    // flexible enough to support both, and this will simply our read thread
-    // handling
-    header->type = MULTIASSIGN;
-  }
-
-  // set the time-to-live
-  header->ttl = settings_.get_rebroadcast_ttl();
-
-  header->updates = uint32_t(filtered_updates.size());
+    std::vector<knowledge::KnowledgeMap> packets;
+    pack_updates(filtered_updates, capacity, packets);
 
-  // compute size of this header
-  header->size = header->encoded_size();
-
-  // keep track of the maximum buffer size for encoding
-  int max_buffer_size = (int)buffer_remaining;
-
-  // set the update to the end of the header
-  char* update = header->write(buffer, buffer_remaining);
-  uint64_t* message_size = (uint64_t*)buffer;
-  uint32_t* message_updates = (uint32_t*)(buffer + 116);
-
-  // Message header format
-  // [size|id|domain|originator|type|updates|quality|clock|list of updates]
-
-  /**
-   * size = buffer[0] (unsigned 64 bit)
-   * transport id = buffer[8] (8 byte)
-   * domain = buffer[16] (32 byte domain name)
-   * originator = buffer[48] (64 byte originator host:port)
-   * type = buffer[112] (unsigned 32 bit type of message--usually MULTIASSIGN)
-   * updates = buffer[116] (unsigned 32 bit number of updates)
-   * quality = buffer[120] (unsigned 32 bit quality of message)
-   * clock = buffer[124] (unsigned 64 bit clock for this message)
-   * ttl = buffer[132] (the new knowledge starts here)
-   * knowledge = buffer[133] (the new knowledge starts here)
-   **/
-
-  // zero out the memory
-  // memset(buffer, 0, MAX_PACKET_SIZE);
-
-  // Message update format
-  // [key|value]
+    // packets of small updates go out before large, fragmented ones
+    for(auto packet = packets.rbegin(); packet != packets.rend(); ++packet)
+    {
+      long packet_size = encode_message(*packet,
+          knowledge::max_quality(*packet), buffer + size,
+          (int64_t)settings_.queue_length - size, print_prefix);
 
-  int j = 0;
-  uint32_t actual_updates = 0;
-  for(knowledge::KnowledgeMap::const_iterator i = filtered_updates.begin();
-       i != filtered_updates.end(); ++i)
-  {
-    const auto& key = i->first;
-    const auto& rec = i->second;
-    const auto do_write = [&](const knowledge::KnowledgeRecord& rec) {
-      if(!rec.exists())
+      if(packet_size <= 0)
       {
-        madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
             "%s:"
-            " update[%d] => value is empty\n",
-            print_prefix, j, key.c_str());
-        return;
-      }
-
-      update = rec.write(update, key, buffer_remaining);
+            " Send buffer is full. Dropping %d of %d packets...\n",
+            print_prefix, (int)(packets.rend() - packet), (int)packets.size());
 
-      if(buffer_remaining > 0)
-      {
-        madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
-            "%s:"
-            " update[%d] => encoding %s of type %" PRId32 " and size %" PRIu32
-            " @%" PRIu64 "\n",
-            print_prefix, j, key.c_str(), rec.type(), rec.size(), rec.toi());
-        ++actual_updates;
-        ++j;
+        break;
       }
-      else
-      {
-        madara_logger_log(context_.get_logger(), logger::LOG_EMERGENCY,
-            "%s:"
-            " unable to encode update[%d] => %s of type %" PRId32
-            " and size %" PRIu32 "\n",
-            print_prefix, j, key.c_str(), rec.type(), rec.size());
-      }
-    };
 
-    if(!settings_.send_history || !rec.has_history())
-    {
-      do_write(rec);
+      messages->push_back(std::make_pair((size_t)size, (size_t)packet_size));
+      size += packet_size;
     }
-    else
-    {
-      auto buf = rec.share_circular_buffer();
-      auto end = buf->end();
-      auto cur = buf->begin();
 
-      if(last_toi_sent_ > 0)
-      {
-        cur = std::upper_bound(cur, end, last_toi_sent_,
-            [](uint64_t lhs, const knowledge::KnowledgeRecord& rhs) {
-              return lhs < rhs.toi();
-            });
-      }
-      for(; cur != end; ++cur)
-      {
-        do_write(*cur);
-      }
-    }
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Packed %d updates into %d messages\n",
+        print_prefix, (int)filtered_updates.size(), (int)messages->size());
   }
-
-  long size(0);
-
-  if(buffer_remaining > 0)
+  else
   {
-    size = (long)(settings_.queue_length - buffer_remaining);
-    header->size = size;
-    *message_size = utility::endian_swap((uint64_t)size);
-    header->updates = actual_updates;
-    *message_updates = utility::endian_swap(actual_updates);
+    size = encode_message(filtered_updates, quality, buffer,
+        settings_.queue_length, print_prefix);
+  }
 
+  if(size > 0)
+  {
     // before we send to others, we first execute rules
     if(settings_.on_data_received_logic.length() != 0)
     {
@@ -1265,21 +1576,21 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     }
   }
 
-  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
-      "%s:"
-      " calling encode filters\n",
-      print_prefix);
-
-  // buffer is ready encoding
-  size = (long)settings_.filter_encode(
-      buffer_.get_ptr(), (int)size, max_buffer_size);
-
-  madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
-      "%s:"
-      " header info before encode: %s\n",
-      print_prefix, header->to_string().c_str());
+  // wait for the pacer to allow the message, or drop it if the wait is
+  // longer than the user allows
+  if(size > 0 && send_pacer_.is_enabled())
+  {
+    if(!send_pacer_.acquire(
+            (uint64_t)size, settings_.get_send_pacing_max_delay()))
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "%s:"
+          " Send pacer would delay packet beyond %f s. Dropping packet...\n",
+          print_prefix, settings_.get_send_pacing_max_delay());
 
-  delete header;
+      return 0;
+    }
+  }
 
   last_toi_sent_ = latest_toi;
 
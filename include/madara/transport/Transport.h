@@ -25,6 +25,7 @@
 #include "ReducedMessageHeader.h"
 #include "madara/transport/BandwidthMonitor.h"
 #include "madara/transport/PacketScheduler.h"
+#include "madara/transport/TokenBucket.h"
 
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/knowledge/ThreadSafeContext.h"
@@ -50,6 +51,11 @@ public:
    **/
   typedef std::vector<std::string> HostsVector;
 
+  /**
+   * Offsets and sizes of the messages prepped in the send buffer
+   **/
+  typedef std::vector<std::pair<size_t, size_t>> MessageSpans;
+
   /**
    * Constructor
    * @param   id                unique identifier (generally host:port)
@@ -90,14 +96,19 @@ public:
    * @param  orig_updates     updates before send filtering is applied
    * @param  print_prefix     prefix to include before every log message,
    *                          e.g., "MyTransport::svc"
+   * @param  messages         if not null and settings.pack_messages is
+   *                          true, updates are packed into independent
+   *                          messages of at most max_fragment_size bytes,
+   *                          and the span of each in the send buffer is
+   *                          added here. Otherwise, one message is made.
    * @return       -1   Transport is shutting down<br />
    *               -2   Transport is invalid<br />
    *               -3   Unable to allocate send buffer<br />
    *                0   No message to send
-   *               > 0  size of buffered message
+   *               > 0  size of buffered message(s)
    **/
   long prep_send(const knowledge::KnowledgeMap& orig_updates,
-      const char* print_prefix);
+      const char* print_prefix, MessageSpans* messages = 0);
 
   /**
    * Sends a list of updates to the domain. This function must be
@@ -111,6 +122,14 @@ public:
    **/
   virtual long send_data(const knowledge::KnowledgeMap&) = 0;
 
+  /**
+   * Checks if send priorities have deferred records to a later send.
+   * Deferred records go out with the next send_data call, even if it
+   * has no updates.
+   * @return  true if records are waiting to be sent
+   **/
+  bool has_deferred_updates(void) const;
+
   /**
    * Invalidates a transport to indicate it is shutting down
    **/
@@ -122,6 +141,19 @@ public:
   virtual void close(void);
 
 protected:
+  /**
+   * Encodes updates into a single message and applies the encode filters
+   * @param  updates          the updates to encode
+   * @param  quality          the quality for the message header
+   * @param  buffer           the buffer to encode into
+   * @param  buffer_size      the bytes available in buffer
+   * @param  print_prefix     prefix to include before every log message
+   * @return the size of the message, or 0 or less if it did not fit
+   **/
+  long encode_message(const knowledge::KnowledgeMap& updates,
+      uint32_t quality, char* buffer, int64_t buffer_size,
+      const char* print_prefix);
+
   volatile bool is_valid_;
   volatile bool shutting_down_;
   HostsVector hosts;
@@ -149,11 +181,17 @@ protected:
   /// scheduler for dropping packets to simulate network issues
   PacketScheduler packet_scheduler_;
 
+  /// pacer for delaying sends to the send pacing rate
+  TokenBucket send_pacer_;
+
   /// buffer for sending
   madara::utility::ScopedArray<char> buffer_;
 
   /// Latest TOI the previous send operation included
   uint64_t last_toi_sent_ = 0;
+
+  /// Timestamp of the previous message, so each message has its own
+  uint64_t last_timestamp_sent_ = 0;
 };
 
 /**
@@ -185,6 +223,8 @@ protected:
  *               -3   Rejected: Untrusted Peer<br />
  *               -4   Rejected: Untrusted Originator<br />
  *               -5   Rejected: Wrong domain<br />
+ *               -6   Rejected: Deadline violation<br />
+ *               -7   Rejected: Duplicate of a recent message<br />
  *               >=   Number of accepted updates
  **/
 int MADARA_EXPORT process_received_update(const char* buffer,
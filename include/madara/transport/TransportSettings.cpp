@@ -70,6 +70,7 @@ madara::transport::TransportSettings::TransportSettings(
     delay_launch(settings.delay_launch),
     never_exit(settings.never_exit),
     send_reduced_message_header(settings.send_reduced_message_header),
+    pack_messages(settings.pack_messages),
     slack_time(settings.slack_time),
     read_thread_hertz(settings.read_thread_hertz),
     max_send_hertz(settings.max_send_hertz),
@@ -105,6 +106,7 @@ void madara::transport::TransportSettings::operator=(
   never_exit = settings.never_exit;
 
   send_reduced_message_header = settings.send_reduced_message_header;
+  pack_messages = settings.pack_messages;
   slack_time = settings.slack_time;
   read_thread_hertz = settings.read_thread_hertz;
   max_send_hertz = settings.max_send_hertz;
@@ -161,6 +163,7 @@ void madara::transport::TransportSettings::load(
 
   send_reduced_message_header =
       knowledge.get(prefix + ".send_reduced_message_header").is_true();
+  pack_messages = knowledge.get(prefix + ".pack_messages").is_true();
   slack_time = knowledge.get(prefix + ".slack_time").to_double();
   read_thread_hertz = knowledge.get(prefix + ".read_thread_hertz").to_double();
   max_send_hertz = knowledge.get(prefix + ".max_send_hertz").to_double();
@@ -214,6 +217,7 @@ void madara::transport::TransportSettings::load_text(
 
   send_reduced_message_header =
       knowledge.get(prefix + ".send_reduced_message_header").is_true();
+  pack_messages = knowledge.get(prefix + ".pack_messages").is_true();
   slack_time = knowledge.get(prefix + ".slack_time").to_double();
   read_thread_hertz = knowledge.get(prefix + ".read_thread_hertz").to_double();
   max_send_hertz = knowledge.get(prefix + ".max_send_hertz").to_double();
@@ -269,6 +273,7 @@ void madara::transport::TransportSettings::save(
 
   knowledge.set(prefix + ".send_reduced_message_header",
       Integer(send_reduced_message_header));
+  knowledge.set(prefix + ".pack_messages", Integer(pack_messages));
   knowledge.set(prefix + ".slack_time", slack_time);
   knowledge.set(prefix + ".read_thread_hertz", read_thread_hertz);
   knowledge.set(prefix + ".max_send_hertz", max_send_hertz);
@@ -321,6 +326,7 @@ void madara::transport::TransportSettings::save_text(
 
   knowledge.set(prefix + ".send_reduced_message_header",
       Integer(send_reduced_message_header));
+  knowledge.set(prefix + ".pack_messages", Integer(pack_messages));
   knowledge.set(prefix + ".slack_time", slack_time);
   knowledge.set(prefix + ".read_thread_hertz", read_thread_hertz);
   knowledge.set(prefix + ".max_send_hertz", max_send_hertz);
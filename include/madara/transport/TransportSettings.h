@@ -259,6 +259,14 @@ public:
   /// Send a reduced message header (clock, size, updates, KaRL id)
   bool send_reduced_message_header = false;
 
+  /**
+   * If true, transports that support it pack updates into independent
+   * messages of at most max_fragment_size bytes, so losing a packet only
+   * loses the updates in it. Small updates share packets, and updates
+   * too large for a packet are sent and fragmented on their own.
+   **/
+  bool pack_messages = false;
+
   /// Map of fragments received by originator
   mutable OriginatorFragmentMap fragment_map;
 
@@ -0,0 +1,298 @@
+#include "madara/transport/loopback/LoopbackNetwork.h"
+#include "madara/transport/loopback/LoopbackTransport.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace madara
+{
+namespace transport
+{
+LoopbackNetwork::LoopbackNetwork(const NetworkEmulatorSettings& settings)
+  : settings_(settings), random_(settings.seed)
+{
+}
+
+LoopbackNetwork::~LoopbackNetwork() {}
+
+void LoopbackNetwork::set_settings(const NetworkEmulatorSettings& settings)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  settings_ = settings;
+  random_.seed(settings.seed);
+  bursts_.clear();
+}
+
+NetworkEmulatorSettings LoopbackNetwork::get_settings(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return settings_;
+}
+
+void LoopbackNetwork::attach(LoopbackTransport* transport)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  if (std::find(transports_.begin(), transports_.end(), transport) ==
+      transports_.end())
+  {
+    transports_.push_back(transport);
+  }
+}
+
+void LoopbackNetwork::detach(LoopbackTransport* transport)
+{
+  MADARA_GUARD_TYPE delivery_guard(delivery_mutex_);
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  transports_.erase(
+      std::remove(transports_.begin(), transports_.end(), transport),
+      transports_.end());
+
+  busy_until_.erase(transport);
+
+  for (auto i = bursts_.begin(); i != bursts_.end();)
+  {
+    if (i->first.first == transport || i->first.second == transport)
+      i = bursts_.erase(i);
+    else
+      ++i;
+  }
+
+  // drop the datagrams on their way to the transport
+  std::vector<Datagram> remaining;
+  remaining.reserve(queue_.size());
+
+  while (!queue_.empty())
+  {
+    if (queue_.top().target != transport)
+    {
+      remaining.push_back(queue_.top());
+    }
+
+    queue_.pop();
+  }
+
+  for (auto& datagram : remaining)
+  {
+    queue_.push(std::move(datagram));
+  }
+}
+
+void LoopbackNetwork::send(
+    const LoopbackTransport* sender, const char* buffer, size_t size)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  auto payload = std::make_shared<const std::string>(buffer, size);
+
+  // a sender transmits one datagram at a time
+  double departure = now_;
+  if (settings_.bandwidth > 0)
+  {
+    double& busy = busy_until_[sender];
+    departure = std::max(now_, busy) + (double)size / settings_.bandwidth;
+    busy = departure;
+  }
+
+  std::uniform_real_distribution<double> chance(0, 1);
+
+  for (auto transport : transports_)
+  {
+    if (transport == sender)
+    {
+      continue;
+    }
+
+    ++sent_;
+
+    if (settings_.mtu > 0 && size > settings_.mtu)
+    {
+      ++lost_;
+      continue;
+    }
+
+    uint32_t& burst = bursts_[std::make_pair(
+        sender, static_cast<const LoopbackTransport*>(transport))];
+
+    if (burst > 0)
+    {
+      --burst;
+      ++lost_;
+      continue;
+    }
+
+    if (settings_.loss_rate > 0 && chance(random_) < settings_.loss_rate)
+    {
+      burst = settings_.loss_burst > 1 ? settings_.loss_burst - 1 : 0;
+      ++lost_;
+      continue;
+    }
+
+    Datagram datagram;
+    datagram.arrival = departure + sample_latency();
+    datagram.sent = now_;
+    datagram.sequence = sequence_++;
+    datagram.target = transport;
+    datagram.sender = sender->get_id();
+    datagram.payload = payload;
+
+    if (settings_.reorder_rate > 0 &&
+        chance(random_) < settings_.reorder_rate)
+    {
+      datagram.arrival += settings_.reorder_delay;
+    }
+
+    queue_.push(std::move(datagram));
+  }
+}
+
+double LoopbackNetwork::sample_latency(void)
+{
+  double latency = settings_.latency;
+
+  if (settings_.latency_distribution == LATENCY_UNIFORM &&
+      settings_.jitter > 0)
+  {
+    std::uniform_real_distribution<double> distribution(
+        settings_.latency - settings_.jitter,
+        settings_.latency + settings_.jitter);
+    latency = distribution(random_);
+  }
+  else if (settings_.latency_distribution == LATENCY_NORMAL &&
+           settings_.jitter > 0)
+  {
+    std::normal_distribution<double> distribution(
+        settings_.latency, settings_.jitter);
+    latency = distribution(random_);
+  }
+  else if (settings_.latency_distribution == LATENCY_EXPONENTIAL &&
+           settings_.latency > 0)
+  {
+    std::exponential_distribution<double> distribution(
+        1 / settings_.latency);
+    latency = distribution(random_);
+  }
+
+  return latency > 0 ? latency : 0;
+}
+
+bool LoopbackNetwork::deliver_next(double until)
+{
+  Datagram datagram;
+
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    if (queue_.empty() || queue_.top().arrival > until)
+    {
+      return false;
+    }
+
+    datagram = queue_.top();
+    queue_.pop();
+
+    now_ = std::max(now_, datagram.arrival);
+
+    ++delivered_;
+    bytes_delivered_ += datagram.payload->size();
+    total_latency_ += datagram.arrival - datagram.sent;
+  }
+
+  // the receiver may rebroadcast, which sends on this network
+  datagram.target->receive(
+      datagram.payload->data(), datagram.payload->size(), datagram.sender);
+
+  return true;
+}
+
+size_t LoopbackNetwork::advance(double seconds)
+{
+  MADARA_GUARD_TYPE delivery_guard(delivery_mutex_);
+
+  double until;
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+    until = now_ + seconds;
+  }
+
+  size_t delivered = 0;
+  while (deliver_next(until))
+  {
+    ++delivered;
+  }
+
+  MADARA_GUARD_TYPE guard(mutex_);
+  now_ = std::max(now_, until);
+
+  return delivered;
+}
+
+size_t LoopbackNetwork::flush(void)
+{
+  MADARA_GUARD_TYPE delivery_guard(delivery_mutex_);
+
+  size_t delivered = 0;
+  while (deliver_next(std::numeric_limits<double>::infinity()))
+  {
+    ++delivered;
+  }
+
+  return delivered;
+}
+
+double LoopbackNetwork::get_time(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return now_;
+}
+
+size_t LoopbackNetwork::get_in_flight(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return queue_.size();
+}
+
+uint64_t LoopbackNetwork::get_sent(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return sent_;
+}
+
+uint64_t LoopbackNetwork::get_delivered(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return delivered_;
+}
+
+uint64_t LoopbackNetwork::get_lost(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return lost_;
+}
+
+uint64_t LoopbackNetwork::get_bytes_delivered(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return bytes_delivered_;
+}
+
+double LoopbackNetwork::get_total_latency(void) const
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+  return total_latency_;
+}
+
+void LoopbackNetwork::reset_stats(void)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  sent_ = 0;
+  delivered_ = 0;
+  lost_ = 0;
+  bytes_delivered_ = 0;
+  total_latency_ = 0;
+}
+}
+}
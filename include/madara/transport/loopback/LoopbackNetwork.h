@@ -0,0 +1,325 @@
+#ifndef _MADARA_LOOPBACK_NETWORK_H_
+#define _MADARA_LOOPBACK_NETWORK_H_
+
+/**
+ * @file LoopbackNetwork.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the LoopbackNetwork class, which connects loopback
+ * transports in one process through an emulated network
+ **/
+
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "madara/LockType.h"
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace transport
+{
+class LoopbackTransport;
+
+/**
+ * Distributions for the latency of an emulated link
+ **/
+enum LatencyDistributions
+{
+  LATENCY_CONSTANT = 0,
+  LATENCY_UNIFORM = 1,
+  LATENCY_NORMAL = 2,
+  LATENCY_EXPONENTIAL = 3
+};
+
+/**
+ * @class NetworkEmulatorSettings
+ * @brief Conditions applied to datagrams in a LoopbackNetwork
+ **/
+struct MADARA_EXPORT NetworkEmulatorSettings
+{
+  /**
+   * Mean one-way latency in seconds
+   **/
+  double latency = 0;
+
+  /**
+   * Spread of the latency in seconds. For LATENCY_UNIFORM, latencies are
+   * within latency +/- jitter. For LATENCY_NORMAL, jitter is the standard
+   * deviation. Unused by the other distributions.
+   **/
+  double jitter = 0;
+
+  /**
+   * Latency distribution. See LatencyDistributions for options.
+   **/
+  int latency_distribution = LATENCY_CONSTANT;
+
+  /**
+   * Probability that a datagram on a link starts a loss burst
+   **/
+  double loss_rate = 0;
+
+  /**
+   * Number of consecutive datagrams lost on a link in each loss burst
+   **/
+  uint32_t loss_burst = 1;
+
+  /**
+   * Probability that a datagram is held back, so later datagrams
+   * arrive first
+   **/
+  double reorder_rate = 0;
+
+  /**
+   * Extra latency in seconds of a datagram that is held back
+   **/
+  double reorder_delay = 0.01;
+
+  /**
+   * Bandwidth of each sender in bytes per second. Datagrams from a
+   * sender are serialized at this rate. 0 or less is unlimited.
+   **/
+  int64_t bandwidth = 0;
+
+  /**
+   * Largest datagram in bytes. Larger datagrams are dropped. 0 is
+   * unlimited.
+   **/
+  uint32_t mtu = 0;
+
+  /**
+   * Seed of the random generator, so runs can be reproduced
+   **/
+  uint64_t seed = 0;
+};
+
+/**
+ * @class LoopbackNetwork
+ * @brief An emulated network between LoopbackTransports in one process
+ *
+ * Datagrams sent by a transport are delivered to every other attached
+ * transport, as with multicast. Each datagram is subjected to the
+ * conditions in the NetworkEmulatorSettings and queued for delivery at
+ * a time in the network's virtual clock.
+ *
+ * The network does not run on its own. Call advance or flush to deliver
+ * queued datagrams in the caller's thread. With the same settings, seed
+ * and sequence of sends, every run delivers the same datagrams at the
+ * same virtual times, so benchmarks are reproducible.
+ **/
+class MADARA_EXPORT LoopbackNetwork
+{
+public:
+  /**
+   * Constructor
+   * @param  settings   conditions of the emulated network
+   **/
+  LoopbackNetwork(
+      const NetworkEmulatorSettings& settings = NetworkEmulatorSettings());
+
+  /**
+   * Destructor
+   **/
+  ~LoopbackNetwork();
+
+  /**
+   * Changes the network conditions and reseeds the random generator
+   * @param  settings   conditions of the emulated network
+   **/
+  void set_settings(const NetworkEmulatorSettings& settings);
+
+  /**
+   * Returns the network conditions
+   * @return  conditions of the emulated network
+   **/
+  NetworkEmulatorSettings get_settings(void) const;
+
+  /**
+   * Connects a transport to the network. Called by LoopbackTransport.
+   * @param  transport   the transport to connect
+   **/
+  void attach(LoopbackTransport* transport);
+
+  /**
+   * Disconnects a transport and drops datagrams queued for it. Called by
+   * LoopbackTransport.
+   * @param  transport   the transport to disconnect
+   **/
+  void detach(LoopbackTransport* transport);
+
+  /**
+   * Sends a datagram from a transport to all other transports
+   * @param  sender   the sending transport
+   * @param  buffer   the datagram
+   * @param  size     the size of the datagram in bytes
+   **/
+  void send(const LoopbackTransport* sender, const char* buffer, size_t size);
+
+  /**
+   * Moves the virtual clock forward, delivering datagrams that arrive
+   * in that time
+   * @param  seconds   how far to move the clock
+   * @return  the number of datagrams delivered
+   **/
+  size_t advance(double seconds);
+
+  /**
+   * Delivers all queued datagrams, including rebroadcasts they cause,
+   * moving the virtual clock to the last arrival
+   * @return  the number of datagrams delivered
+   **/
+  size_t flush(void);
+
+  /**
+   * Returns the virtual clock
+   * @return  seconds since the network was created
+   **/
+  double get_time(void) const;
+
+  /**
+   * Returns the number of queued datagrams
+   * @return  datagrams waiting for delivery
+   **/
+  size_t get_in_flight(void) const;
+
+  /**
+   * Returns the number of datagrams sent, counting each receiver
+   * @return  datagrams sent to receivers
+   **/
+  uint64_t get_sent(void) const;
+
+  /**
+   * Returns the number of datagrams delivered
+   * @return  datagrams delivered to receivers
+   **/
+  uint64_t get_delivered(void) const;
+
+  /**
+   * Returns the number of datagrams lost, including datagrams larger
+   * than the MTU
+   * @return  datagrams lost
+   **/
+  uint64_t get_lost(void) const;
+
+  /**
+   * Returns the bytes delivered
+   * @return  bytes delivered to receivers
+   **/
+  uint64_t get_bytes_delivered(void) const;
+
+  /**
+   * Returns the total latency of delivered datagrams, including
+   * serialization delays, so the mean is this over get_delivered
+   * @return  the total latency in seconds
+   **/
+  double get_total_latency(void) const;
+
+  /**
+   * Resets the statistics
+   **/
+  void reset_stats(void);
+
+private:
+  /**
+   * A datagram on its way to a receiver
+   **/
+  struct Datagram
+  {
+    /// virtual time of arrival
+    double arrival;
+
+    /// virtual time it was sent
+    double sent;
+
+    /// order of sending, to break ties in arrival
+    uint64_t sequence;
+
+    /// the receiver
+    LoopbackTransport* target;
+
+    /// the id of the sender
+    std::string sender;
+
+    /// the contents, shared by all receivers
+    std::shared_ptr<const std::string> payload;
+
+    /**
+     * Orders datagrams by arrival, then by sending order
+     **/
+    bool operator>(const Datagram& rhs) const
+    {
+      return arrival > rhs.arrival ||
+             (arrival == rhs.arrival && sequence > rhs.sequence);
+    }
+  };
+
+  /**
+   * Returns a latency sample. Requires the lock.
+   **/
+  double sample_latency(void);
+
+  /**
+   * Delivers the next datagram if it arrives by a time
+   * @return  true if a datagram was delivered
+   **/
+  bool deliver_next(double until);
+
+  /// Guards all members
+  mutable MADARA_LOCK_TYPE mutex_;
+
+  /// Serializes deliveries, so detached transports are never used
+  MADARA_LOCK_TYPE delivery_mutex_;
+
+  /// Network conditions
+  NetworkEmulatorSettings settings_;
+
+  /// Source of all randomness
+  std::mt19937_64 random_;
+
+  /// Connected transports
+  std::vector<LoopbackTransport*> transports_;
+
+  /// Time each sender finishes sending its queued datagrams
+  std::map<const LoopbackTransport*, double> busy_until_;
+
+  /// Datagrams left to lose in the current burst of each link
+  std::map<std::pair<const LoopbackTransport*, const LoopbackTransport*>,
+      uint32_t>
+      bursts_;
+
+  /// Datagrams waiting for delivery
+  std::priority_queue<Datagram, std::vector<Datagram>,
+      std::greater<Datagram>>
+      queue_;
+
+  /// Virtual clock in seconds
+  double now_ = 0;
+
+  /// Datagrams queued so far
+  uint64_t sequence_ = 0;
+
+  /// Datagrams sent, counting each receiver
+  uint64_t sent_ = 0;
+
+  /// Datagrams delivered
+  uint64_t delivered_ = 0;
+
+  /// Datagrams lost
+  uint64_t lost_ = 0;
+
+  /// Bytes delivered
+  uint64_t bytes_delivered_ = 0;
+
+  /// Total latency of delivered datagrams in seconds
+  double total_latency_ = 0;
+};
+}
+}
+
+#endif  // _MADARA_LOOPBACK_NETWORK_H_
@@ -0,0 +1,230 @@
+#include "madara/transport/loopback/LoopbackTransport.h"
+#include "madara/transport/Fragmentation.h"
+#include "madara/utility/Utility.h"
+#include "madara/logger/GlobalLogger.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace madara
+{
+namespace transport
+{
+LoopbackTransport::LoopbackTransport(const std::string& id,
+    knowledge::ThreadSafeContext& context, TransportSettings& config,
+    std::shared_ptr<LoopbackNetwork> network, bool launch_transport)
+  : Base(id, config, context), network_(std::move(network))
+{
+  if (launch_transport)
+    setup();
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+  LoopbackTransport::close();
+}
+
+int LoopbackTransport::setup(void)
+{
+  // call base setup method to initialize certain common variables
+  if (Base::setup() < 0)
+  {
+    return -1;
+  }
+
+  if (!network_)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_ERROR,
+        "LoopbackTransport::setup:"
+        " no network was provided\n");
+
+    return -1;
+  }
+
+  if (settings_.queue_length > 0)
+  {
+    receive_buffer_ = new char[settings_.queue_length];
+    rebroadcast_buffer_ = new char[settings_.queue_length];
+  }
+
+#ifndef _MADARA_NO_KARL_
+  if (settings_.on_data_received_logic.length() != 0)
+  {
+    on_data_received_rules_ =
+        context_.compile(settings_.on_data_received_logic);
+  }
+#endif  // _MADARA_NO_KARL_
+
+  if (!settings_.no_receiving || !settings_.no_sending)
+  {
+    network_->attach(this);
+    attached_ = true;
+  }
+
+  return this->validate_transport();
+}
+
+void LoopbackTransport::close(void)
+{
+  this->invalidate_transport();
+
+  if (attached_)
+  {
+    network_->detach(this);
+    attached_ = false;
+  }
+}
+
+const std::string& LoopbackTransport::get_id(void) const
+{
+  return id_;
+}
+
+std::shared_ptr<LoopbackNetwork> LoopbackTransport::get_network(void) const
+{
+  return network_;
+}
+
+long LoopbackTransport::send_message(
+    const char* buffer, size_t size, uint64_t clock)
+{
+  static const char print_prefix[] = "LoopbackTransport::send_message";
+
+  long bytes_sent = 0;
+
+  if (size > settings_.max_fragment_size)
+  {
+    FragmentMap map;
+
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " fragmenting %d byte message (%d bytes is max fragment size)\n",
+        print_prefix, (int)size, (int)settings_.max_fragment_size);
+
+    frag(buffer, size, id_.c_str(), settings_.write_domain.c_str(), clock,
+        utility::get_time(), 0, 0, settings_.max_fragment_size, map);
+
+    for (FragmentMap::iterator i = map.begin(); i != map.end(); ++i)
+    {
+      size_t fragment_size =
+          (size_t)MessageHeader::get_size(i->second.get());
+
+      network_->send(this, i->second.get(), fragment_size);
+      bytes_sent += (long)fragment_size;
+    }
+
+    delete_fragments(map);
+  }
+  else
+  {
+    network_->send(this, buffer, size);
+    bytes_sent = (long)size;
+  }
+
+  send_monitor_.add((uint32_t)bytes_sent);
+
+  return bytes_sent;
+}
+
+long LoopbackTransport::send_data(const knowledge::KnowledgeMap& updates)
+{
+  long result(0);
+  const char* print_prefix = "LoopbackTransport::send_data";
+
+  if (attached_ && !settings_.no_sending &&
+      (updates.size() != 0 || has_deferred_updates()))
+  {
+    MessageSpans messages;
+    result = prep_send(updates, print_prefix, &messages);
+
+    if (result > 0)
+    {
+      uint64_t clock = updates.size() != 0 ? updates.begin()->second.clock
+                                           : context_.get_clock();
+
+      if (messages.size() == 0)
+      {
+        messages.push_back(std::make_pair((size_t)0, (size_t)result));
+      }
+
+      result = 0;
+      for (const auto& message : messages)
+      {
+        result += send_message(
+            buffer_.get_ptr() + message.first, message.second, clock);
+      }
+    }
+  }
+
+  return result;
+}
+
+void LoopbackTransport::rebroadcast(const char* print_prefix,
+    MessageHeader* header, const knowledge::KnowledgeMap& records)
+{
+  int64_t buffer_remaining = (int64_t)settings_.queue_length;
+  char* buffer = rebroadcast_buffer_.get_ptr();
+
+  if (!settings_.no_sending && records.size() > 0)
+  {
+    int result = prep_rebroadcast(context_, buffer, buffer_remaining,
+        settings_, print_prefix, header, records, packet_scheduler_);
+
+    if (result > 0)
+    {
+      send_message(buffer, (size_t)result, records.begin()->second.clock);
+    }
+  }
+}
+
+void LoopbackTransport::receive(
+    const char* buffer, size_t size, const std::string& sender)
+{
+  static const char print_prefix[] = "LoopbackTransport::receive";
+
+  if (settings_.no_receiving || shutting_down_)
+  {
+    return;
+  }
+
+  if (size > settings_.queue_length)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " %d byte datagram from %s is larger than the queue length."
+        " Dropping it.\n",
+        print_prefix, (int)size, sender.c_str());
+
+    return;
+  }
+
+  // defragmentation writes whole messages over the receive buffer
+  char* received = receive_buffer_.get_ptr();
+  memcpy(received, buffer, size);
+
+  MessageHeader* header = 0;
+  knowledge::KnowledgeMap rebroadcast_records;
+
+  process_received_update(received, (uint32_t)size, id_, context_,
+      settings_, send_monitor_, receive_monitor_, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received_rules_,
+#endif  // _MADARA_NO_KARL_
+      print_prefix, sender.c_str(), header);
+
+  if (header)
+  {
+    if (header->ttl > 0 && rebroadcast_records.size() > 0 &&
+        settings_.get_participant_ttl() > 0)
+    {
+      --header->ttl;
+      header->ttl = std::min(settings_.get_participant_ttl(), header->ttl);
+
+      rebroadcast(print_prefix, header, rebroadcast_records);
+    }
+
+    delete header;
+  }
+}
+}
+}
@@ -0,0 +1,140 @@
+#ifndef _MADARA_LOOPBACK_TRANSPORT_H_
+#define _MADARA_LOOPBACK_TRANSPORT_H_
+
+/**
+ * @file LoopbackTransport.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the LoopbackTransport class, which connects
+ * knowledge bases in one process through a LoopbackNetwork
+ **/
+
+#include <memory>
+#include <string>
+
+#include "madara/MadaraExport.h"
+#include "madara/transport/Transport.h"
+#include "madara/transport/loopback/LoopbackNetwork.h"
+#include "madara/knowledge/CompiledExpression.h"
+#include "madara/utility/ScopedArray.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class LoopbackTransport
+ * @brief In-process transport for knowledge. Messages are exchanged
+ *        through a LoopbackNetwork, which emulates latency, loss,
+ *        reordering, bandwidth and MTU. This transport supports:<br />
+ *        1) the reduced message header<br />
+ *        2) the normal message header<br />
+ *        3) domain differentiation<br />
+ *        4) on data received logic<br />
+ *        5) fragmentation and packed messages<br />
+ *        6) rebroadcasting<br />
+ *        7) send, receive and rebroadcast filters<br />
+ *
+ * Create one transport per knowledge base on a shared network and
+ * attach it with KnowledgeBase::attach_transport. Received messages are
+ * processed in the thread that calls LoopbackNetwork::advance or flush.
+ **/
+class MADARA_EXPORT LoopbackTransport : public Base
+{
+public:
+  /**
+   * Constructor
+   * @param   id                unique identifier of this participant
+   * @param   context           the knowledge record context
+   * @param   config            transport settings
+   * @param   network           the network to connect to
+   * @param   launch_transport  whether or not to launch this transport
+   **/
+  LoopbackTransport(const std::string& id,
+      knowledge::ThreadSafeContext& context, TransportSettings& config,
+      std::shared_ptr<LoopbackNetwork> network, bool launch_transport = true);
+
+  /**
+   * Destructor
+   **/
+  virtual ~LoopbackTransport();
+
+  /**
+   * Connects to the network and prepares the receive buffers
+   * @return  0 on success, -1 on failure
+   **/
+  int setup(void) override;
+
+  /**
+   * Sends a list of knowledge updates to listeners
+   * @param   updates listing of all updates that must be sent
+   * @return  result of write operation or -1 if we are shutting down
+   **/
+  long send_data(const knowledge::KnowledgeMap& updates) override;
+
+  /**
+   * Disconnects from the network
+   **/
+  void close(void) override;
+
+  /**
+   * Processes a datagram from the network. Called by LoopbackNetwork.
+   * @param   buffer   the datagram
+   * @param   size     the size of the datagram in bytes
+   * @param   sender   the id of the sending transport
+   **/
+  void receive(const char* buffer, size_t size, const std::string& sender);
+
+  /**
+   * Returns the unique identifier of this participant
+   * @return  the id
+   **/
+  const std::string& get_id(void) const;
+
+  /**
+   * Returns the network this transport is connected to
+   * @return  the network
+   **/
+  std::shared_ptr<LoopbackNetwork> get_network(void) const;
+
+protected:
+  /**
+   * Sends a message, fragmenting it if it is larger than
+   * max_fragment_size
+   * @param   buffer   the message
+   * @param   size     the size of the message
+   * @param   clock    the clock used to key fragments
+   * @return  bytes sent
+   **/
+  long send_message(const char* buffer, size_t size, uint64_t clock);
+
+  /**
+   * Resends received records to other participants
+   * @param   print_prefix   prefix for log messages
+   * @param   header         the header of the received message
+   * @param   records        the records to rebroadcast
+   **/
+  void rebroadcast(const char* print_prefix, MessageHeader* header,
+      const knowledge::KnowledgeMap& records);
+
+  /// the network datagrams are sent on
+  std::shared_ptr<LoopbackNetwork> network_;
+
+  /// true if attached to the network
+  bool attached_ = false;
+
+#ifndef _MADARA_NO_KARL_
+  /// data received rules, evaluated after each received message
+  knowledge::CompiledExpression on_data_received_rules_;
+#endif  // _MADARA_NO_KARL_
+
+  /// buffer for received datagrams, which defragmentation overwrites
+  utility::ScopedArray<char> receive_buffer_;
+
+  /// buffer for rebroadcasts
+  utility::ScopedArray<char> rebroadcast_buffer_;
+};
+}
+}
+
+#endif  // _MADARA_LOOPBACK_TRANSPORT_H_
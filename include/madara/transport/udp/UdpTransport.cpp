@@ -265,14 +265,31 @@ long UdpTransport::send_data(
   long result(0);
   const char* print_prefix = "UdpTransport::send_data";
 
-  if(!settings_.no_sending && orig_updates.size() != 0)
+  if(!settings_.no_sending &&
+      (orig_updates.size() != 0 || has_deferred_updates()))
   {
-    result = prep_send(orig_updates, print_prefix);
+    MessageSpans messages;
+    result = prep_send(orig_updates, print_prefix, &messages);
 
     if(addresses_.size() > 0 && result > 0)
     {
-      result = send_message(
-          buffer_.get_ptr(), result, orig_updates.begin()->second.clock);
+      uint64_t clock = orig_updates.size() != 0 ?
+        orig_updates.begin()->second.clock : context_.get_clock();
+
+      if(messages.size() > 0)
+      {
+        // packed messages are sent, and lost, independently
+        result = 0;
+        for(const auto& message : messages)
+        {
+          result += send_message(
+            buffer_.get_ptr() + message.first, message.second, clock);
+        }
+      }
+      else
+      {
+        result = send_message(buffer_.get_ptr(), result, clock);
+      }
     }
   }
 
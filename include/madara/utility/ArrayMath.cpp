@@ -0,0 +1,341 @@
+#include "ArrayMath.h"
+
+#include <math.h>
+#include <functional>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define MADARA_ARRAY_MATH_X86
+#define MADARA_ARRAY_MATH_TARGET __attribute__((target("avx2")))
+#define MADARA_ARRAY_MATH_INLINE inline __attribute__((always_inline))
+#else
+#define MADARA_ARRAY_MATH_INLINE inline
+#endif
+
+namespace madara
+{
+namespace utility
+{
+namespace
+{
+/**
+ * Independent partial results kept by reductions. Separate lanes break
+ * the dependency between iterations so the compiler can fill two AVX2
+ * registers per step, and keep the association order the same whichever
+ * instruction set runs the loop.
+ **/
+const size_t LANES = 8;
+
+/**
+ * Combines the lanes of a reduction pairwise
+ **/
+template<typename T, typename Op>
+MADARA_ARRAY_MATH_INLINE T reduce_lanes(const T (&partial)[LANES], Op op)
+{
+  return op(op(op(partial[0], partial[1]), op(partial[2], partial[3])),
+      op(op(partial[4], partial[5]), op(partial[6], partial[7])));
+}
+
+/**
+ * The kernels are plain loops, and reductions keep fixed-width lane
+ * arrays, which compilers vectorize for whatever target the function they
+ * are inlined into is compiled for. run() inlines each kernel once for
+ * the default target and once for AVX2.
+ **/
+struct Transform
+{
+  template<typename T, typename Op>
+  MADARA_ARRAY_MATH_INLINE void operator()(
+      const T* lhs, const T* rhs, T* out, size_t size, Op op) const
+  {
+    for (size_t i = 0; i < size; ++i)
+      out[i] = op(lhs[i], rhs[i]);
+  }
+
+  template<typename T, typename Op>
+  MADARA_ARRAY_MATH_INLINE void operator()(
+      const T* lhs, T rhs, T* out, size_t size, Op op) const
+  {
+    for (size_t i = 0; i < size; ++i)
+      out[i] = op(lhs[i], rhs);
+  }
+
+  template<typename T, typename Op>
+  MADARA_ARRAY_MATH_INLINE void operator()(
+      T lhs, const T* rhs, T* out, size_t size, Op op) const
+  {
+    for (size_t i = 0; i < size; ++i)
+      out[i] = op(lhs, rhs[i]);
+  }
+};
+
+struct Sum
+{
+  template<typename T>
+  MADARA_ARRAY_MATH_INLINE T operator()(const T* values, size_t size) const
+  {
+    T partial[LANES] = {};
+    size_t i = 0;
+
+    for (; i + LANES <= size; i += LANES)
+      for (size_t lane = 0; lane < LANES; ++lane)
+        partial[lane] += values[i + lane];
+
+    T total = reduce_lanes(partial, std::plus<T>());
+
+    for (; i < size; ++i)
+      total += values[i];
+
+    return total;
+  }
+};
+
+struct Dot
+{
+  template<typename T>
+  MADARA_ARRAY_MATH_INLINE T operator()(
+      const T* lhs, const T* rhs, size_t size) const
+  {
+    T partial[LANES] = {};
+    size_t i = 0;
+
+    for (; i + LANES <= size; i += LANES)
+      for (size_t lane = 0; lane < LANES; ++lane)
+        partial[lane] += lhs[i + lane] * rhs[i + lane];
+
+    T total = reduce_lanes(partial, std::plus<T>());
+
+    for (; i < size; ++i)
+      total += lhs[i] * rhs[i];
+
+    return total;
+  }
+};
+
+struct Min
+{
+  template<typename T>
+  MADARA_ARRAY_MATH_INLINE static T select(T lhs, T rhs)
+  {
+    return rhs < lhs ? rhs : lhs;
+  }
+
+  template<typename T>
+  MADARA_ARRAY_MATH_INLINE T operator()(const T* values, size_t size) const
+  {
+    T partial[LANES];
+    for (size_t lane = 0; lane < LANES; ++lane)
+      partial[lane] = values[0];
+
+    size_t i = 0;
+
+    for (; i + LANES <= size; i += LANES)
+      for (size_t lane = 0; lane < LANES; ++lane)
+        partial[lane] = select(partial[lane], values[i + lane]);
+
+    T result = reduce_lanes(partial, select<T>);
+
+    for (; i < size; ++i)
+      result = select(result, values[i]);
+
+    return result;
+  }
+};
+
+struct Max
+{
+  template<typename T>
+  MADARA_ARRAY_MATH_INLINE static T select(T lhs, T rhs)
+  {
+    return lhs < rhs ? rhs : lhs;
+  }
+
+  template<typename T>
+  MADARA_ARRAY_MATH_INLINE T operator()(const T* values, size_t size) const
+  {
+    T partial[LANES];
+    for (size_t lane = 0; lane < LANES; ++lane)
+      partial[lane] = values[0];
+
+    size_t i = 0;
+
+    for (; i + LANES <= size; i += LANES)
+      for (size_t lane = 0; lane < LANES; ++lane)
+        partial[lane] = select(partial[lane], values[i + lane]);
+
+    T result = reduce_lanes(partial, select<T>);
+
+    for (; i < size; ++i)
+      result = select(result, values[i]);
+
+    return result;
+  }
+};
+
+struct Axpy
+{
+  template<typename T>
+  MADARA_ARRAY_MATH_INLINE void operator()(
+      T a, const T* x, const T* y, T* out, size_t size) const
+  {
+    for (size_t i = 0; i < size; ++i)
+      out[i] = a * x[i] + y[i];
+  }
+};
+
+#ifdef MADARA_ARRAY_MATH_X86
+template<typename Kernel, typename... Args>
+MADARA_ARRAY_MATH_TARGET auto run_avx2(Kernel kernel, Args... args)
+    -> decltype(kernel(args...))
+{
+  return kernel(args...);
+}
+
+bool detect_avx2(void)
+{
+  return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/**
+ * Runs a kernel compiled for the best instruction set this processor
+ * supports
+ **/
+template<typename Kernel, typename... Args>
+inline auto run(Kernel kernel, Args... args) -> decltype(kernel(args...))
+{
+#ifdef MADARA_ARRAY_MATH_X86
+  if (array_math_is_accelerated())
+  {
+    return run_avx2(kernel, args...);
+  }
+#endif
+
+  return kernel(args...);
+}
+
+template<typename L, typename R, typename T>
+inline void apply(ArrayOp op, L lhs, R rhs, T* out, size_t size)
+{
+  switch (op)
+  {
+    case ARRAY_ADD:
+      run(Transform(), lhs, rhs, out, size, std::plus<T>());
+      break;
+    case ARRAY_SUBTRACT:
+      run(Transform(), lhs, rhs, out, size, std::minus<T>());
+      break;
+    case ARRAY_MULTIPLY:
+      run(Transform(), lhs, rhs, out, size, std::multiplies<T>());
+      break;
+    case ARRAY_DIVIDE:
+      run(Transform(), lhs, rhs, out, size, std::divides<T>());
+      break;
+  }
+}
+}
+
+bool array_math_is_accelerated(void)
+{
+#ifdef MADARA_ARRAY_MATH_X86
+  static const bool accelerated = detect_avx2();
+  return accelerated;
+#else
+  return false;
+#endif
+}
+
+void array_apply(ArrayOp op, const int64_t* lhs, const int64_t* rhs,
+    int64_t* out, size_t size)
+{
+  apply(op, lhs, rhs, out, size);
+}
+
+void array_apply(
+    ArrayOp op, const int64_t* lhs, int64_t rhs, int64_t* out, size_t size)
+{
+  apply(op, lhs, rhs, out, size);
+}
+
+void array_apply(
+    ArrayOp op, int64_t lhs, const int64_t* rhs, int64_t* out, size_t size)
+{
+  apply(op, lhs, rhs, out, size);
+}
+
+void array_apply(ArrayOp op, const double* lhs, const double* rhs,
+    double* out, size_t size)
+{
+  apply(op, lhs, rhs, out, size);
+}
+
+void array_apply(
+    ArrayOp op, const double* lhs, double rhs, double* out, size_t size)
+{
+  apply(op, lhs, rhs, out, size);
+}
+
+void array_apply(
+    ArrayOp op, double lhs, const double* rhs, double* out, size_t size)
+{
+  apply(op, lhs, rhs, out, size);
+}
+
+int64_t array_sum(const int64_t* values, size_t size)
+{
+  return run(Sum(), values, size);
+}
+
+double array_sum(const double* values, size_t size)
+{
+  return run(Sum(), values, size);
+}
+
+int64_t array_dot(const int64_t* lhs, const int64_t* rhs, size_t size)
+{
+  return run(Dot(), lhs, rhs, size);
+}
+
+double array_dot(const double* lhs, const double* rhs, size_t size)
+{
+  return run(Dot(), lhs, rhs, size);
+}
+
+int64_t array_min(const int64_t* values, size_t size)
+{
+  return run(Min(), values, size);
+}
+
+double array_min(const double* values, size_t size)
+{
+  return run(Min(), values, size);
+}
+
+int64_t array_max(const int64_t* values, size_t size)
+{
+  return run(Max(), values, size);
+}
+
+double array_max(const double* values, size_t size)
+{
+  return run(Max(), values, size);
+}
+
+double array_norm(const double* values, size_t size)
+{
+  return sqrt(run(Dot(), values, values, size));
+}
+
+void array_axpy(int64_t a, const int64_t* x, const int64_t* y, int64_t* out,
+    size_t size)
+{
+  run(Axpy(), a, x, y, out, size);
+}
+
+void array_axpy(
+    double a, const double* x, const double* y, double* out, size_t size)
+{
+  run(Axpy(), a, x, y, out, size);
+}
+}
+}
@@ -0,0 +1,165 @@
+#ifndef _MADARA_UTILITY_ARRAY_MATH_H_
+#define _MADARA_UTILITY_ARRAY_MATH_H_
+
+/**
+ * @file ArrayMath.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains vectorized element-wise arithmetic and reductions
+ * over integer and double arrays, which back array arithmetic in
+ * KnowledgeRecord and the KaRL array system calls
+ **/
+
+#include <stddef.h>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * Element-wise operations supported by array_apply
+ **/
+enum ArrayOp
+{
+  ARRAY_ADD,
+  ARRAY_SUBTRACT,
+  ARRAY_MULTIPLY,
+  ARRAY_DIVIDE
+};
+
+/**
+ * Computes out[i] = lhs[i] op rhs[i]. Uses AVX2 when the processor
+ * supports it, and the compiler's default vector instructions otherwise.
+ * Integer division by zero is undefined, so callers must check divisors.
+ * @param  op     the operation
+ * @param  lhs    the left operands
+ * @param  rhs    the right operands
+ * @param  out    the results, which may alias lhs or rhs
+ * @param  size   the number of elements
+ **/
+MADARA_EXPORT void array_apply(ArrayOp op, const int64_t* lhs,
+    const int64_t* rhs, int64_t* out, size_t size);
+
+/**
+ * Computes out[i] = lhs[i] op rhs
+ **/
+MADARA_EXPORT void array_apply(
+    ArrayOp op, const int64_t* lhs, int64_t rhs, int64_t* out, size_t size);
+
+/**
+ * Computes out[i] = lhs op rhs[i]
+ **/
+MADARA_EXPORT void array_apply(
+    ArrayOp op, int64_t lhs, const int64_t* rhs, int64_t* out, size_t size);
+
+/**
+ * Computes out[i] = lhs[i] op rhs[i]
+ **/
+MADARA_EXPORT void array_apply(ArrayOp op, const double* lhs,
+    const double* rhs, double* out, size_t size);
+
+/**
+ * Computes out[i] = lhs[i] op rhs
+ **/
+MADARA_EXPORT void array_apply(
+    ArrayOp op, const double* lhs, double rhs, double* out, size_t size);
+
+/**
+ * Computes out[i] = lhs op rhs[i]
+ **/
+MADARA_EXPORT void array_apply(
+    ArrayOp op, double lhs, const double* rhs, double* out, size_t size);
+
+/**
+ * Sums an array
+ * @param  values  the array
+ * @param  size    the number of elements
+ * @return the sum, or 0 if the array is empty
+ **/
+MADARA_EXPORT int64_t array_sum(const int64_t* values, size_t size);
+
+/**
+ * Sums an array. Partial sums are kept in several lanes, so the result
+ * may differ in the last bits from a sequential sum.
+ **/
+MADARA_EXPORT double array_sum(const double* values, size_t size);
+
+/**
+ * Computes the dot product of two arrays
+ * @param  lhs     the first array
+ * @param  rhs     the second array
+ * @param  size    the number of elements
+ * @return the sum of lhs[i] * rhs[i], or 0 if the arrays are empty
+ **/
+MADARA_EXPORT int64_t array_dot(
+    const int64_t* lhs, const int64_t* rhs, size_t size);
+
+/**
+ * Computes the dot product of two arrays
+ **/
+MADARA_EXPORT double array_dot(
+    const double* lhs, const double* rhs, size_t size);
+
+/**
+ * Finds the smallest element of an array
+ * @param  values  the array
+ * @param  size    the number of elements. Must be at least 1.
+ * @return the smallest element
+ **/
+MADARA_EXPORT int64_t array_min(const int64_t* values, size_t size);
+
+/**
+ * Finds the smallest element of an array
+ **/
+MADARA_EXPORT double array_min(const double* values, size_t size);
+
+/**
+ * Finds the largest element of an array
+ * @param  values  the array
+ * @param  size    the number of elements. Must be at least 1.
+ * @return the largest element
+ **/
+MADARA_EXPORT int64_t array_max(const int64_t* values, size_t size);
+
+/**
+ * Finds the largest element of an array
+ **/
+MADARA_EXPORT double array_max(const double* values, size_t size);
+
+/**
+ * Computes the Euclidean norm of an array
+ * @param  values  the array
+ * @param  size    the number of elements
+ * @return the square root of the sum of squares
+ **/
+MADARA_EXPORT double array_norm(const double* values, size_t size);
+
+/**
+ * Computes out[i] = a * x[i] + y[i]
+ * @param  a       the scale of x
+ * @param  x       the scaled array
+ * @param  y       the added array
+ * @param  out     the results, which may alias x or y
+ * @param  size    the number of elements
+ **/
+MADARA_EXPORT void array_axpy(int64_t a, const int64_t* x, const int64_t* y,
+    int64_t* out, size_t size);
+
+/**
+ * Computes out[i] = a * x[i] + y[i]
+ **/
+MADARA_EXPORT void array_axpy(
+    double a, const double* x, const double* y, double* out, size_t size);
+
+/**
+ * Checks if the array functions use AVX2 on this processor
+ * @return true if AVX2 kernels are used
+ **/
+MADARA_EXPORT bool array_math_is_accelerated(void);
+}
+}
+
+#endif  // _MADARA_UTILITY_ARRAY_MATH_H_
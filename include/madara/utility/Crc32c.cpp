@@ -0,0 +1,200 @@
+#include "Crc32c.h"
+
+#include <string.h>
+#include <fstream>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define MADARA_CRC32C_X86
+#define MADARA_CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <nmmintrin.h>
+#define MADARA_CRC32C_X86
+#define MADARA_CRC32C_TARGET
+#endif
+
+namespace madara
+{
+namespace utility
+{
+namespace
+{
+/**
+ * Slicing-by-8 lookup tables for the reflected Castagnoli polynomial
+ **/
+struct Crc32cTables
+{
+  uint32_t table[8][256];
+
+  Crc32cTables()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit)
+      {
+        crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+      }
+      table[0][i] = crc;
+    }
+
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      for (int slice = 1; slice < 8; ++slice)
+      {
+        uint32_t prev = table[slice - 1][i];
+        table[slice][i] = (prev >> 8) ^ table[0][prev & 0xff];
+      }
+    }
+  }
+};
+
+const Crc32cTables& get_tables(void)
+{
+  static const Crc32cTables tables;
+  return tables;
+}
+
+uint32_t crc32c_table(uint32_t crc, const unsigned char* buf, size_t size)
+{
+  const uint32_t(&t)[8][256] = get_tables().table;
+
+  while (size >= 8)
+  {
+    uint32_t low, high;
+    memcpy(&low, buf, 4);
+    memcpy(&high, buf + 4, 4);
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    low = __builtin_bswap32(low);
+    high = __builtin_bswap32(high);
+#endif
+
+    low ^= crc;
+    crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^
+          t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^ t[3][high & 0xff] ^
+          t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^
+          t[0][high >> 24];
+
+    buf += 8;
+    size -= 8;
+  }
+
+  while (size > 0)
+  {
+    crc = (crc >> 8) ^ t[0][(crc ^ *buf) & 0xff];
+    ++buf;
+    --size;
+  }
+
+  return crc;
+}
+
+#ifdef MADARA_CRC32C_X86
+MADARA_CRC32C_TARGET
+uint32_t crc32c_sse42(uint32_t crc, const unsigned char* buf, size_t size)
+{
+  // align to 8 bytes so the wide loads don't straddle cache lines
+  while (size > 0 && ((uintptr_t)buf & 7) != 0)
+  {
+    crc = _mm_crc32_u8(crc, *buf);
+    ++buf;
+    --size;
+  }
+
+#if defined(__x86_64__) || defined(_M_X64)
+  uint64_t crc64 = crc;
+  while (size >= 8)
+  {
+    uint64_t value;
+    memcpy(&value, buf, 8);
+    crc64 = _mm_crc32_u64(crc64, value);
+    buf += 8;
+    size -= 8;
+  }
+  crc = (uint32_t)crc64;
+#endif
+
+  while (size >= 4)
+  {
+    uint32_t value;
+    memcpy(&value, buf, 4);
+    crc = _mm_crc32_u32(crc, value);
+    buf += 4;
+    size -= 4;
+  }
+
+  while (size > 0)
+  {
+    crc = _mm_crc32_u8(crc, *buf);
+    ++buf;
+    --size;
+  }
+
+  return crc;
+}
+
+bool detect_sse42(void)
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 20)) != 0;
+#else
+  return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#endif  // MADARA_CRC32C_X86
+}
+
+bool crc32c_is_accelerated(void)
+{
+#ifdef MADARA_CRC32C_X86
+  static const bool accelerated = detect_sse42();
+  return accelerated;
+#else
+  return false;
+#endif
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc)
+{
+#ifdef MADARA_CRC32C_X86
+  if (crc32c_is_accelerated())
+  {
+    return ~crc32c_sse42(~crc, (const unsigned char*)data, size);
+  }
+#endif
+
+  return ~crc32c_table(~crc, (const unsigned char*)data, size);
+}
+
+uint32_t crc32c_portable(const void* data, size_t size, uint32_t crc)
+{
+  return ~crc32c_table(~crc, (const unsigned char*)data, size);
+}
+
+uint32_t file_crc32c(const std::string& filename, size_t max_block)
+{
+  uint32_t crc = 0;
+
+  std::ifstream input(filename, std::ios::in | std::ios::binary);
+  std::vector<char> block(max_block > 0 ? max_block : 1);
+
+  while (input)
+  {
+    input.read(block.data(), block.size());
+    std::size_t bytes_read = input.gcount();
+    if (bytes_read > 0)
+    {
+      crc = crc32c(block.data(), bytes_read, crc);
+    }
+  }
+
+  return crc;
+}
+}
+}
@@ -0,0 +1,62 @@
+#ifndef _MADARA_UTILITY_CRC32C_H_
+#define _MADARA_UTILITY_CRC32C_H_
+
+/**
+ * @file Crc32c.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains CRC-32C (Castagnoli) checksum functions, which are
+ * used to verify file fragments
+ **/
+
+#include <string>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * Computes or extends a CRC-32C (Castagnoli) checksum. Uses the SSE4.2
+ * crc32 instruction when the processor supports it, and a portable
+ * slicing-by-8 table implementation otherwise. Both produce the same
+ * result.
+ * @param  data   the bytes to checksum
+ * @param  size   the number of bytes
+ * @param  crc    the checksum of any preceding bytes, to checksum data
+ *                that arrives in pieces. 0 for a new checksum.
+ * @return the checksum of all bytes so far
+ **/
+MADARA_EXPORT uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/**
+ * Computes a CRC-32C checksum with the portable table implementation,
+ * regardless of processor support. Mainly useful for testing.
+ * @param  data   the bytes to checksum
+ * @param  size   the number of bytes
+ * @param  crc    the checksum of any preceding bytes
+ * @return the checksum of all bytes so far
+ **/
+MADARA_EXPORT uint32_t crc32c_portable(
+    const void* data, size_t size, uint32_t crc = 0);
+
+/**
+ * Checks if crc32c uses a hardware instruction on this processor
+ * @return true if the checksum is hardware accelerated
+ **/
+MADARA_EXPORT bool crc32c_is_accelerated(void);
+
+/**
+ * Computes the CRC-32C checksum of a file
+ * @param  filename   path and name of the file to open
+ * @param  max_block  maximum block size to read at a time
+ * @return the checksum of the file contents, or 0 if the file cannot be read
+ **/
+MADARA_EXPORT uint32_t file_crc32c(
+    const std::string& filename, size_t max_block = 1000000);
+}
+}
+
+#endif  // _MADARA_UTILITY_CRC32C_H_
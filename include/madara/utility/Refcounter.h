@@ -2,6 +2,8 @@
 #ifndef _MADARA_UTILITY_REFCOUNTER_H_
 #define _MADARA_UTILITY_REFCOUNTER_H_
 
+#include <atomic>
+
 namespace madara
 {
 namespace utility
@@ -15,7 +17,9 @@ namespace utility
  *        instances,
  *
  *        This class can be used to automate the implementation of the
- *        Bridge pattern in C++.
+ *        Bridge pattern in C++. The count is atomic, so separate
+ *        Refcounters that share an instance may be copied and destroyed
+ *        from different threads.
  */
 template<typename T>
 class Refcounter
@@ -85,7 +89,7 @@ private:
     T* t_;
 
     /// Current value of the reference count.
-    int refcount_;
+    std::atomic<int> refcount_;
   };
 
   /// Pointer to the @a Shim.
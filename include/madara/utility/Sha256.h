@@ -0,0 +1,50 @@
+#ifndef _MADARA_UTILITY_SHA256_H_
+#define _MADARA_UTILITY_SHA256_H_
+
+/**
+ * @file Sha256.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a SHA-256 digest, which is used to address binary
+ * content by its value
+ **/
+
+#include <string>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * Size of a SHA-256 digest in bytes
+ **/
+const size_t SHA256_DIGEST_SIZE = 32;
+
+/**
+ * Computes the SHA-256 digest of a buffer
+ * @param  data   the bytes to digest
+ * @param  size   the number of bytes
+ * @return the 32 byte digest as a binary string
+ **/
+MADARA_EXPORT std::string sha256(const void* data, size_t size);
+
+/**
+ * Converts a binary digest into lowercase hexadecimal
+ * @param  digest   the binary digest
+ * @return the digest in hexadecimal
+ **/
+MADARA_EXPORT std::string digest_to_hex(const std::string& digest);
+
+/**
+ * Converts hexadecimal into a binary digest
+ * @param  hex   the digest in hexadecimal
+ * @return the binary digest, or an empty string if hex is malformed
+ **/
+MADARA_EXPORT std::string hex_to_digest(const std::string& hex);
+}
+}
+
+#endif  // _MADARA_UTILITY_SHA256_H_
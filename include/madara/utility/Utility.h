@@ -2,6 +2,7 @@
 #define _MADARA_UTILITY_H_
 
 #include <vector>
+#include <map>
 #include <string>
 #include <cmath>
 #include <limits.h>
@@ -255,6 +256,39 @@ MADARA_EXPORT std::vector<int64_t> get_file_missing_fragments(
     const std::string& filename, uint32_t crc, size_t expected_size,
     int max_fragments = -1, size_t fragment_size = 60000);
 
+/**
+ * Returns the name of the manifest that lists verified fragments of a file
+ * being built from fragments: filename.crc.manifest
+ * @param   filename          name of the file being built
+ * @param   crc               crc for completed file
+ * @return  the name of the manifest file
+ **/
+MADARA_EXPORT std::string get_fragment_manifest_name(
+    const std::string& filename, uint32_t crc);
+
+/**
+ * Reads the manifest of fragments that have been verified and saved for
+ * a file being built from fragments
+ * @param   filename          name of the file being built
+ * @param   crc               crc for completed file
+ * @return  map of fragment index to the CRC-32C checksum of the fragment
+ **/
+MADARA_EXPORT std::map<int64_t, uint32_t> read_fragment_manifest(
+    const std::string& filename, uint32_t crc);
+
+/**
+ * Records a verified fragment in the manifest of a file being built from
+ * fragments. The fragment should be saved before it is recorded. Every
+ * call appends a line, so callers should skip fragments that are already
+ * recorded with the same checksum.
+ * @param   filename          name of the file being built
+ * @param   crc               crc for completed file
+ * @param   index             the index of the fragment
+ * @param   checksum          the CRC-32C checksum of the fragment
+ **/
+MADARA_EXPORT void append_fragment_manifest(const std::string& filename,
+    uint32_t crc, int64_t index, uint32_t checksum);
+
 /**
  * Expands environment variables referenced in the string. The environment
  * variables must be specified as $(var) and not $var.
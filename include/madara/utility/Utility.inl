@@ -508,6 +508,8 @@ inline bool file_from_fragments(const std::string& filename, uint32_t crc,
         {
           remove(frag_file.c_str());
         }
+
+        remove(get_fragment_manifest_name(filename, crc).c_str());
       }
 
       return true;
@@ -635,6 +637,43 @@ inline std::vector<int64_t> get_file_missing_fragments(
   return result;
 }
 
+inline std::string get_fragment_manifest_name(
+    const std::string& filename, uint32_t crc)
+{
+  return filename + "." + std::to_string((unsigned long)crc) + ".manifest";
+}
+
+inline std::map<int64_t, uint32_t> read_fragment_manifest(
+    const std::string& filename, uint32_t crc)
+{
+  std::map<int64_t, uint32_t> result;
+  std::ifstream input(get_fragment_manifest_name(filename, crc));
+
+  // each line is a fragment index and checksum. A line cut short by a
+  // crash either fails to parse or has a checksum that won't verify, so
+  // at worst that fragment is requested again.
+  int64_t index;
+  uint32_t checksum;
+  while (input >> index >> checksum)
+  {
+    result[index] = checksum;
+  }
+
+  return result;
+}
+
+inline void append_fragment_manifest(const std::string& filename,
+    uint32_t crc, int64_t index, uint32_t checksum)
+{
+  std::ofstream output(get_fragment_manifest_name(filename, crc),
+      std::ios::out | std::ios::app);
+
+  if (output)
+  {
+    output << index << " " << checksum << "\n";
+  }
+}
+
 inline bool begins_with(const std::string& input, const std::string& prefix)
 {
   bool result = false;
@@ -2,8 +2,11 @@
 #include "madara/knowledge/rcw/Transaction.h"
 #include "madara/utility/Utility.h"
 #include <stdio.h>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "test.h"
@@ -11,8 +14,189 @@
 using namespace madara::knowledge;
 using namespace madara::knowledge::rcw;
 
+void test_incremental_pull(void)
+{
+  KnowledgeBase kb;
+  Transaction tx(kb);
+
+  int x = 1;
+  std::string s;
+
+  kb.set("s", "foo");
+  tx.add_init("x", x);
+  tx.build("s", s).ro().add();
+
+  VariableReference ref = kb.get_ref("x");
+  uint64_t version = ref.get_record_unsafe()->version();
+  test(version != 0);
+
+  kb.set(ref, KnowledgeRecord::Integer(5));
+  test(ref.get_record_unsafe()->version() > version);
+
+  tx.pull();
+  test_eq(x, 5);
+  test_eq(s, "foo");
+
+  // nothing changed on either side, so the pull leaves values alone
+  tx.pull();
+  test_eq(x, 5);
+  test_eq(s, "foo");
+
+  // local changes that were never pushed are still overwritten
+  x = 7;
+  s = "bar";
+  tx.pull();
+  test_eq(x, 5);
+  test_eq(s, "foo");
+
+  version = ref.get_record_unsafe()->version();
+  kb.clear(std::string("x"));
+  test(ref.get_record_unsafe()->version() > version);
+
+  tx.pull();
+  test_eq(x, 0);
+}
+
+void bench_pull(void)
+{
+  typedef std::chrono::steady_clock clock;
+
+  const size_t num_vars = 1000;
+  const size_t iterations = 200;
+
+  KnowledgeBase kb;
+  Transaction tx(kb);
+
+  std::vector<std::string> values(num_vars);
+  std::vector<VariableReference> refs(num_vars);
+
+  for (size_t i = 0; i < num_vars; ++i)
+  {
+    std::string name = "var." + std::to_string(i);
+    values[i] = std::string(64, 'a' + i % 26);
+    tx.add_init(name.c_str(), values[i]);
+    refs[i] = kb.get_ref(name);
+  }
+
+  std::string update(64, 'z');
+
+  for (size_t percent : {1, 100})
+  {
+    size_t changes = num_vars * percent / 100;
+    double total_ns = 0;
+
+    for (size_t j = 0; j < iterations; ++j)
+    {
+      for (size_t i = 0; i < changes; ++i)
+      {
+        update[0] = 'a' + j % 26;
+        kb.set(refs[(i * 100 / percent + j) % num_vars], update);
+      }
+
+      auto start = clock::now();
+      tx.pull();
+      total_ns +=
+          std::chrono::duration<double, std::nano>(clock::now() - start)
+              .count();
+    }
+
+    std::cerr << "pull of " << num_vars << " vars with " << percent
+              << "% changed: " << total_ns / iterations / 1000 << " us\n";
+  }
+
+  bool matches = true;
+  for (size_t i = 0; i < num_vars; ++i)
+  {
+    if (values[i] != kb.get(refs[i]).to_string())
+      matches = false;
+  }
+  test(matches, "tracked values match knowledge base after pulls");
+}
+
+void test_optimistic(void)
+{
+  KnowledgeBase kb;
+  Transaction tx(kb);
+
+  int x = 1, y = 0;
+  tx.add_init("x", x);
+  tx.add_init("y", y);
+
+  // another writer modifies x between our pull and push
+  tx.pull();
+  y = x + 1;
+  kb.set("x", KnowledgeRecord::Integer(10));
+
+  test(!tx.try_push());
+  test_eq(kb.get("y").to_integer(), 0);
+  test_eq(tx.get_conflicts(), (uint64_t)1);
+
+  tx.pull();
+  y = x + 1;
+  test(tx.try_push());
+  test_eq(kb.get("y").to_integer(), 11);
+  test_eq(tx.get_commits(), (uint64_t)1);
+
+  // a conflict on the first attempt makes transact recompute
+  bool interfere = true;
+  test(tx.transact([&]() {
+    y = x * 2;
+    if (interfere)
+    {
+      interfere = false;
+      kb.set("x", KnowledgeRecord::Integer(20));
+    }
+  }));
+  test_eq(kb.get("y").to_integer(), 40);
+  test_eq(tx.get_retries(), (uint64_t)1);
+
+  // no lost updates when threads increment the same variable
+  const int num_threads = 4;
+  const int increments = 500;
+  uint64_t commits = 0;
+  std::vector<std::thread> threads;
+  std::vector<uint64_t> thread_commits(num_threads, 0);
+
+  kb.set("count", KnowledgeRecord::Integer(0));
+
+  for (int i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&kb, &thread_commits, i]() {
+      Transaction local(kb);
+      local.set_max_attempts(1000);
+
+      int count = 0;
+      local.add("count", count);
+
+      for (int j = 0; j < increments; ++j)
+      {
+        local.transact([&count]() { ++count; });
+      }
+      thread_commits[i] = local.get_commits();
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (uint64_t cur : thread_commits)
+  {
+    commits += cur;
+  }
+
+  test_eq(commits, (uint64_t)(num_threads * increments));
+  test_eq(kb.get("count").to_integer(),
+      (KnowledgeRecord::Integer)(num_threads * increments));
+}
+
 int main(int, char**)
 {
+  test_incremental_pull();
+  test_optimistic();
+  bench_pull();
+
   KnowledgeBase kb;
   Transaction tx(kb);
 
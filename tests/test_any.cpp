@@ -273,6 +273,68 @@ void test_record()
   }
 }
 
+void test_lazy_record()
+{
+  std::vector<char> buf(4096);
+
+  KnowledgeRecord k0(tags::any<std::vector<std::string>>{}, {"a", "b", "c"});
+  int64_t remaining = buf.size();
+  const char* end = k0.write(buf.data(), "k0", remaining);
+  size_t size = end - buf.data();
+
+  std::string key;
+  KnowledgeRecord k1;
+  remaining = size;
+  k1.read(buf.data(), key, remaining);
+  TEST_EQ(k1.is_any_decoded(), false);
+
+  // forwarding an untouched record reuses the received bytes
+  std::vector<char> buf2(4096);
+  remaining = buf2.size();
+  KnowledgeRecord k2(k1);
+  end = k2.write(buf2.data(), "k0", remaining);
+  TEST_EQ((size_t)(end - buf2.data()), size);
+  TEST_EQ(memcmp(buf.data(), buf2.data(), size), 0);
+  TEST_EQ(k1.is_any_decoded(), false);
+  TEST_EQ((size_t)k2.get_encoded_size("k0"), size);
+
+  // first typed access decodes once for all copies
+  TEST_EQ(k2.get_any_cref<std::vector<std::string>>()[1], "b");
+  TEST_EQ(k1.is_any_decoded(), true);
+  TEST_EQ(k1.share_any().get(), k2.share_any().get());
+
+  k2.set_any(std::string("modified"));
+  remaining = buf2.size();
+  k2.write(buf2.data(), "k0", remaining);
+  KnowledgeRecord k3;
+  remaining = buf2.size();
+  k3.read(buf2.data(), key, remaining);
+  TEST_EQ(k3.get_any_cref<std::string>(), "modified");
+  TEST_EQ(k1.get_any_cref<std::vector<std::string>>()[2], "c");
+
+  // checking truth does not decode
+  KnowledgeRecord k4;
+  remaining = size;
+  k4.read(buf.data(), key, remaining);
+  TEST_EQ(k4.is_true(), true);
+  TEST_EQ(k4.is_any_decoded(), false);
+
+  // received bytes without a value are false, like an empty local Any
+  KnowledgeRecord blank("");
+  remaining = buf.size();
+  blank.write(buf.data(), remaining);
+  uint32_t any_type =
+      utility::endian_swap((uint32_t)KnowledgeRecord::ANY);
+  memcpy(buf.data(), &any_type, sizeof(any_type));
+
+  KnowledgeRecord k5;
+  remaining = buf.size();
+  k5.read(buf.data(), remaining);
+  TEST_EQ(k5.is_any_type(), true);
+  TEST_EQ(k5.is_true(), false);
+  TEST_EQ(KnowledgeRecord(Any()).is_true(), false);
+}
+
 void test_kb(KnowledgeBase& kb)
 {
   kb.set("hello_str", "world");
@@ -599,6 +661,41 @@ void test_capn()
   TEST_EQ(ajr.get("x").as<double>(), 1.25);
   TEST_EQ(ajr.get("y").as<double>(), 2.5);
   TEST_EQ(ajr.get("z").as<double>(), 4.75);
+
+  // shared buffers are read in place, without copying the message
+  Any ap(type<RegCapnObject>{}, "PointSchema", buffer);
+  std::vector<char> tagged;
+  ap.tagged_serialize(tagged);
+
+  size_t prefix =
+      tagged.size() - ap.get_capnp_buffer().size() * sizeof(capnp::word);
+  size_t pad = (sizeof(capnp::word) - prefix % sizeof(capnp::word)) %
+               sizeof(capnp::word);
+  std::shared_ptr<char> storage(
+      new char[tagged.size() + pad], std::default_delete<char[]>());
+  memcpy(storage.get() + pad, tagged.data(), tagged.size());
+  std::shared_ptr<const char> bytes(storage, storage.get() + pad);
+
+  Any view;
+  view.tagged_unserialize(bytes, tagged.size());
+  TEST_EQ((const void*)view.get_capnp_buffer().begin(),
+      (const void*)(bytes.get() + prefix));
+  TEST_EQ(view.reader().get("y").as<double>(), 8);
+
+  // received records keep their bytes aligned for in place reads
+  KnowledgeRecord sent(std::move(ap));
+  std::vector<char> wire(4096);
+  int64_t remaining = wire.size();
+  const char* end = sent.write(wire.data(), "point", remaining);
+
+  std::string key;
+  KnowledgeRecord received;
+  remaining = end - wire.data();
+  received.read(wire.data(), key, remaining);
+  TEST_EQ((size_t)received.get_any_cref().get_capnp_buffer().begin() %
+              sizeof(capnp::word),
+      0UL);
+  TEST_EQ(received.get_any_cref().reader().get("z").as<double>(), 12);
 }
 
 void test_geo()
@@ -808,6 +905,7 @@ int main(int, char**)
 
   test_any();
   test_record();
+  test_lazy_record();
 
   {
     KnowledgeBase kb;
@@ -1,10 +1,14 @@
 
 #include "madara/transport/BandwidthMonitor.h"
+#include "madara/transport/TokenBucket.h"
 #include "madara/utility/Utility.h"
 
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
+#include <chrono>
 
 #include "madara/logger/GlobalLogger.h"
 
@@ -15,6 +19,148 @@ int madara_fails = 0;
 // command line arguments
 int parse_args(int argc, char* argv[]);
 
+void test_subsecond_window(void)
+{
+  madara::transport::BandwidthMonitor monitor;
+
+  std::cerr << "Setting window to 200ms and adding 10 100 byte messages...\n";
+
+  monitor.set_window_ms(200);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    monitor.add(100);
+  }
+
+  monitor.print_utilization();
+  if (monitor.get_utilization() == 1000 &&
+      monitor.get_number_of_messages() == 10 &&
+      monitor.get_bytes_per_second() == 5000 &&
+      monitor.is_bandwidth_violated(4000) &&
+      !monitor.is_bandwidth_violated(6000) &&
+      !monitor.is_bandwidth_violated(-1))
+    std::cerr << "Bandwidth check results in SUCCESS\n\n";
+  else
+  {
+    std::cerr << "Bandwidth check results in FAIL\n\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "Sleeping for 300ms...\n";
+  madara::utility::sleep(0.3);
+
+  monitor.print_utilization();
+  if (monitor.get_utilization() == 0)
+    std::cerr << "Bandwidth check results in SUCCESS\n\n";
+  else
+  {
+    std::cerr << "Bandwidth check results in FAIL\n\n";
+    ++madara_fails;
+  }
+}
+
+void test_concurrent_adds(void)
+{
+  typedef std::chrono::steady_clock clock;
+
+  const int num_threads = 4;
+  const int num_messages = 100000;
+
+  madara::transport::BandwidthMonitor monitor;
+
+  std::cerr << "Adding " << num_messages << " 10 byte messages from "
+            << num_threads << " threads...\n";
+
+  auto start = clock::now();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back([&monitor, num_messages]() {
+      for (int i = 0; i < num_messages; ++i)
+      {
+        monitor.add(10);
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  double secs = std::chrono::duration<double>(clock::now() - start).count();
+
+  std::cerr << "  " << (num_threads * num_messages) / secs
+            << " adds/s across threads\n";
+
+  // adds racing a bucket rollover may be lost, so allow a small shortfall
+  uint64_t expected = (uint64_t)num_threads * num_messages * 10;
+  uint64_t actual = monitor.get_utilization();
+
+  monitor.print_utilization();
+  if (actual <= expected && actual >= expected - expected / 100)
+    std::cerr << "Bandwidth check results in SUCCESS\n\n";
+  else
+  {
+    std::cerr << "Bandwidth check results in FAIL\n\n";
+    ++madara_fails;
+  }
+}
+
+void test_token_bucket(void)
+{
+  typedef std::chrono::steady_clock clock;
+
+  std::cerr << "Pacing 20 1000 byte messages at 100000 B/s with a "
+               "1000 byte burst...\n";
+
+  madara::transport::TokenBucket pacer(100000, 1000);
+
+  auto start = clock::now();
+
+  bool all_sent = true;
+  for (int i = 0; i < 20; ++i)
+  {
+    all_sent = pacer.acquire(1000) && all_sent;
+  }
+
+  double secs = std::chrono::duration<double>(clock::now() - start).count();
+
+  std::cerr << "  took " << secs << "s (ideal 0.19s)\n";
+
+  if (all_sent && secs >= 0.17 && secs < 1.0)
+    std::cerr << "Pacing check results in SUCCESS\n\n";
+  else
+  {
+    std::cerr << "Pacing check results in FAIL\n\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "Reserving past a 5ms maximum delay...\n";
+
+  // the bucket is now in debt, so a 10000 byte message needs ~100ms
+  if (pacer.reserve(10000, 5000000) == -1 && pacer.reserve(10) >= 0)
+    std::cerr << "Pacing check results in SUCCESS\n\n";
+  else
+  {
+    std::cerr << "Pacing check results in FAIL\n\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "Checking disabled pacer never delays...\n";
+
+  madara::transport::TokenBucket disabled;
+
+  if (!disabled.is_enabled() && disabled.reserve(1000000000) == 0)
+    std::cerr << "Pacing check results in SUCCESS\n\n";
+  else
+  {
+    std::cerr << "Pacing check results in FAIL\n\n";
+    ++madara_fails;
+  }
+}
+
 int main(int argc, char* argv[])
 {
   parse_args(argc, argv);
@@ -92,6 +238,10 @@ int main(int argc, char* argv[])
     ++madara_fails;
   }
 
+  test_subsecond_window();
+  test_concurrent_adds();
+  test_token_bucket();
+
   if (madara_fails > 0)
   {
     std::cerr << "OVERALL: FAIL. " << madara_fails << " tests failed.\n";
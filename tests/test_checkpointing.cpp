@@ -1199,6 +1199,236 @@ void test_streaming()
   }
 }
 
+void test_parallel_playback(void)
+{
+  std::cerr << "\n*********** TESTING PARALLEL PLAYBACK *************.\n";
+
+  knowledge::CheckpointSettings settings;
+  settings.filename = "parallel_playback_test.kb";
+  settings.reset_checkpoint = true;
+
+  knowledge::EvalSettings track_changes;
+  track_changes.track_local_changes = true;
+
+  knowledge::KnowledgeBase saver;
+  remove(settings.filename.c_str());
+
+  const int num_states = 200;
+  const int num_agents = 50;
+
+  std::cerr << "Saving " << num_states << " checkpoints of " << num_agents
+            << " agents\n";
+
+  for (int state = 0; state < num_states; ++state)
+  {
+    for (int agent = 0; agent < num_agents; ++agent)
+    {
+      std::string prefix = "agent." + std::to_string(agent);
+      saver.set(prefix + ".state",
+          (knowledge::KnowledgeRecord::Integer)state, track_changes);
+      saver.set(prefix + ".pos",
+          std::vector<double>{agent * 1.0, state * 1.0, 3.5}, track_changes);
+      saver.set(prefix + ".status",
+          "agent " + std::to_string(agent) + " at state " +
+              std::to_string(state),
+          track_changes);
+    }
+
+    saver.save_checkpoint(settings);
+  }
+
+  typedef std::chrono::steady_clock clock;
+
+  std::vector<std::string> sequential;
+
+  auto start = clock::now();
+  {
+    knowledge::CheckpointReader reader(settings);
+    for (;;)
+    {
+      auto next = reader.next();
+      if (next.first == "")
+      {
+        break;
+      }
+      sequential.push_back(next.first + "=" + next.second.to_string());
+    }
+  }
+  double sequential_secs =
+      std::chrono::duration<double>(clock::now() - start).count();
+
+  std::vector<std::string> parallel;
+
+  start = clock::now();
+  knowledge::ParallelCheckpointReader parallel_reader(settings, 4);
+  uint64_t delivered = parallel_reader.read_all(
+      [&](const std::string& key, knowledge::KnowledgeRecord& record) {
+        parallel.push_back(key + "=" + record.to_string());
+      });
+  double parallel_secs =
+      std::chrono::duration<double>(clock::now() - start).count();
+
+  double megabytes = parallel_reader.get_total_read() / 1000000.0;
+
+  std::cerr << "Sequential read: " << sequential.size() << " records, "
+            << megabytes / sequential_secs << " MB/s\n";
+  std::cerr << "Parallel read (4 threads): " << delivered << " records, "
+            << megabytes / parallel_secs << " MB/s\n";
+
+  std::cerr << "Parallel read matches sequential order: ";
+
+  if (delivered == parallel.size() && parallel == sequential &&
+      sequential.size() == (size_t)(num_states * num_agents * 3))
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    ++madara_fails;
+    std::cerr << "FAIL. " << parallel.size() << " parallel vs "
+              << sequential.size() << " sequential records\n";
+  }
+
+  std::cerr << "Parallel read with prefix and state range: ";
+
+  settings.prefixes.push_back("agent.7.");
+  settings.initial_state = 10;
+  settings.last_state = 19;
+
+  std::vector<std::string> filtered;
+  knowledge::ParallelCheckpointReader(settings, 2).read_all(
+      [&](const std::string& key, knowledge::KnowledgeRecord& record) {
+        filtered.push_back(key + "=" + record.to_string());
+      });
+
+  if (filtered.size() == 30 &&
+      filtered[2] == "agent.7.status=agent 7 at state 10" &&
+      filtered.back() == "agent.7.status=agent 7 at state 19")
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    ++madara_fails;
+    std::cerr << "FAIL. " << filtered.size() << " records\n";
+    for (const auto& cur : filtered)
+    {
+      std::cerr << "  " << cur << "\n";
+    }
+  }
+
+  settings.prefixes.clear();
+  settings.initial_state = 0;
+  settings.last_state = (uint64_t)-1;
+
+  std::cerr << "CheckpointPlayer::play_all into a context: ";
+
+  knowledge::KnowledgeBase loader;
+  knowledge::CheckpointPlayer player(loader.get_context(), settings);
+  uint64_t applied = player.play_all();
+
+  if (applied == sequential.size() &&
+      loader.get("agent.49.state").to_integer() == num_states - 1 &&
+      loader.get("agent.3.status").to_string() == "agent 3 at state 199")
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    ++madara_fails;
+    std::cerr << "FAIL. Knowledge was:\n";
+    loader.print();
+  }
+}
+
+void test_parallel_save(void)
+{
+  std::cerr << "\n*********** TESTING PARALLEL SAVE *************.\n";
+
+  knowledge::KnowledgeBase saver;
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    std::string prefix = "agent." + std::to_string(i);
+    saver.set(prefix + ".id", (knowledge::KnowledgeRecord::Integer)i);
+    saver.set(prefix + ".pos", std::vector<double>{i * 1.0, 2.0, 3.0});
+    saver.set(prefix + ".name", "agent number " + std::to_string(i));
+  }
+
+  std::string expected;
+  saver.to_string(expected);
+
+  typedef std::chrono::steady_clock clock;
+
+  knowledge::CheckpointSettings settings;
+  settings.filename = "parallel_save_test.kb";
+  settings.buffer_size = 100000;
+
+  auto start = clock::now();
+  int64_t sequential_size = saver.save_context("sequential_save_test.kb");
+  double sequential_secs =
+      std::chrono::duration<double>(clock::now() - start).count();
+
+  settings.save_threads = 4;
+
+  start = clock::now();
+  int64_t parallel_size = saver.save_context(settings);
+  double parallel_secs =
+      std::chrono::duration<double>(clock::now() - start).count();
+
+  std::cerr << "Single state save: " << sequential_size << " bytes in "
+            << sequential_secs << "s\n";
+  std::cerr << "Parallel save (4 threads, 100KB states): " << parallel_size
+            << " bytes in " << parallel_secs << "s\n";
+
+  std::cerr << "Loading parallel save: ";
+
+  knowledge::KnowledgeBase loader;
+  settings.save_threads = 0;
+  loader.load_context(settings);
+
+  std::string actual;
+  loader.to_string(actual);
+
+  if (parallel_size > 0 && actual == expected &&
+      settings.states > 1)
+  {
+    std::cerr << "SUCCESS (" << settings.states << " states)\n";
+  }
+  else
+  {
+    ++madara_fails;
+    std::cerr << "FAIL. " << settings.states << " states, "
+              << actual.size() << " vs " << expected.size() << " chars\n";
+  }
+
+#ifdef _USE_LZ4_
+  std::cerr << "Loading parallel save with lz4: ";
+
+  filters::LZ4BufferFilter lz4;
+  settings.filename = "parallel_save_test.kb.lz4";
+  settings.buffer_filters.push_back(&lz4);
+  settings.save_threads = 4;
+  saver.save_context(settings);
+
+  knowledge::KnowledgeBase lz4_loader;
+  lz4_loader.load_context(settings);
+
+  actual.clear();
+  lz4_loader.to_string(actual);
+
+  if (actual == expected)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    ++madara_fails;
+    std::cerr << "FAIL\n";
+  }
+#endif
+}
+
 int main(int argc, char* argv[])
 {
   handle_arguments(argc, argv);
@@ -1273,6 +1503,10 @@ int main(int argc, char* argv[])
 
   test_diff_filter_chains();
 
+  test_parallel_playback();
+
+  test_parallel_save();
+
   logger::global_logger->set_level(log_level);
   test_streaming();
 
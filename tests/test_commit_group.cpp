@@ -0,0 +1,212 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iostream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/CommitGroup.h"
+#include "madara/exceptions/ContextException.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace containers = knowledge::containers;
+namespace utility = madara::utility;
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+void test_commit(void)
+{
+  std::cerr << "Testing commit of staged containers...\n";
+
+  knowledge::KnowledgeBase kb;
+
+  containers::IntegerStaged count("count", kb);
+  containers::DoubleStaged speed("speed", kb);
+  containers::StringStaged status("status", kb);
+  containers::NativeDoubleVectorStaged position("position", kb);
+  containers::NativeIntegerVectorStaged ids("ids", kb);
+
+  containers::CommitGroup group(kb);
+  group.add(count);
+  group.add(speed);
+  group.add(status);
+  group.add(position);
+  group.add(ids);
+
+  TEST_EQ(group.size(), (size_t)5);
+
+  count = 3;
+  speed = 1.5;
+  status = "moving";
+  position.set({1.0, 2.0, 3.0});
+  ids.set({4, 5});
+
+  // nothing is written until the group commits
+  TEST_EQ(kb.get("count").exists(), false);
+
+  TEST_EQ(group.commit(), (size_t)5);
+
+  TEST_EQ(kb.get("count").to_integer(), (Integer)3);
+  TEST_EQ(kb.get("speed").to_double(), 1.5);
+  TEST_EQ(kb.get("status").to_string(), std::string("moving"));
+  TEST_EQ(kb.get("position").size(), (uint32_t)3);
+  TEST_EQ(kb.get("position").retrieve_index(2).to_double(), 3.0);
+  TEST_EQ(kb.get("ids").size(), (uint32_t)2);
+  TEST_EQ(kb.get("ids").retrieve_index(1).to_integer(), (Integer)5);
+
+  // committed values are marked to send
+  TEST_EQ(kb.get_context().get_modifieds().size(), (size_t)5);
+
+  kb.get_context().reset_modified();
+
+  std::cerr << "Testing that unchanged containers are skipped...\n";
+
+  TEST_EQ(group.commit(), (size_t)0);
+  TEST_EQ(kb.get_context().get_modifieds().size(), (size_t)0);
+
+  speed = 2.5;
+
+  TEST_EQ(group.commit(), (size_t)1);
+  TEST_EQ(kb.get("speed").to_double(), 2.5);
+  TEST_EQ(kb.get_context().get_modifieds().size(), (size_t)1);
+
+  std::cerr << "Testing read of staged containers...\n";
+
+  kb.set("count", (Integer)10);
+  kb.set("status", "stopped");
+
+  group.read();
+
+  TEST_EQ(*count, (Integer)10);
+  TEST_EQ(*status, std::string("stopped"));
+
+  // values that were just read are not written back
+  TEST_EQ(group.commit(), (size_t)0);
+
+  group.clear();
+
+  TEST_EQ(group.size(), (size_t)0);
+}
+
+void test_contexts(void)
+{
+  std::cerr << "Testing containers of other knowledge bases...\n";
+
+  knowledge::KnowledgeBase kb;
+  knowledge::KnowledgeBase other;
+
+  containers::IntegerStaged local("local", kb);
+  containers::IntegerStaged remote("remote", other);
+  containers::DoubleStaged unnamed;
+
+  containers::CommitGroup group(kb);
+
+  group.add(local);
+
+  EXPECT_EXCEPTION(madara::exceptions::ContextException, group.add(remote););
+  EXPECT_EXCEPTION(madara::exceptions::ContextException, group.add(unnamed););
+
+  // rejected containers are not added
+  TEST_EQ(group.size(), (size_t)1);
+
+  local = 1;
+  remote = 2;
+
+  TEST_EQ(group.commit(), (size_t)1);
+  TEST_EQ(other.get("remote").exists(), false);
+}
+
+void test_signals(void)
+{
+  std::cerr << "Testing that waiters are signalled once per commit...\n";
+
+  knowledge::KnowledgeBase kb;
+  knowledge::ThreadSafeContext& context = kb.get_context();
+
+  containers::IntegerStaged first("first", kb);
+  containers::IntegerStaged second("second", kb);
+  containers::IntegerStaged third("third", kb);
+
+  containers::CommitGroup group(kb);
+  group.add(first);
+  group.add(second);
+  group.add(third);
+
+  // a waiter counts wakeups until done is set. Each wait starts while the
+  // context is locked, so a writer can only lock it once the waiter sleeps.
+  std::atomic<int> waits(0);
+  int wakeups = 0;
+  Integer sum_at_first_wakeup = 0;
+
+  std::thread waiter([&]() {
+    context.lock();
+
+    while (context.get("done").is_false())
+    {
+      ++waits;
+
+      // releases the lock while waiting and returns without it
+      context.wait_for_change(true);
+      context.lock();
+
+      ++wakeups;
+
+      if (wakeups == 1)
+      {
+        sum_at_first_wakeup = context.get("first").to_integer() +
+                              context.get("second").to_integer() +
+                              context.get("third").to_integer();
+      }
+    }
+
+    context.unlock();
+  });
+
+  while (waits.load() < 1)
+    utility::sleep(0.001);
+
+  first = 1;
+  second = 2;
+  third = 3;
+
+  TEST_EQ(group.commit(), (size_t)3);
+
+  while (waits.load() < 2)
+    utility::sleep(0.001);
+
+  // an unchanged commit writes nothing and does not wake the waiter
+  TEST_EQ(group.commit(), (size_t)0);
+
+  utility::sleep(0.1);
+
+  TEST_EQ(waits.load(), 2);
+
+  kb.set("done", (Integer)1);
+
+  waiter.join();
+
+  TEST_EQ(wakeups, 2);
+  TEST_EQ(sum_at_first_wakeup, (Integer)6);
+}
+
+int main(int, char**)
+{
+  test_commit();
+  test_contexts();
+  test_signals();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,394 @@
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <iostream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/ExpressionBatch.h"
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/expression/AccessVisitor.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+#include "madara/utility/ArrayMath.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace expression = madara::expression;
+namespace utility = madara::utility;
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+// number of rule sets in the benchmark
+const int rule_sets = 32;
+
+// threads used by batches
+const size_t threads = 4;
+
+/// Describes the records of a knowledge base and the records queued to send
+std::string describe(knowledge::KnowledgeBase& kb)
+{
+  std::string result;
+
+  for (const auto& entry : kb.to_map(""))
+  {
+    result += entry.first + "=" + std::to_string(entry.second.type()) + ":" +
+              entry.second.to_string() + " ";
+  }
+
+  // deferred marks must leave the same records queued to send
+  result += "| modified:";
+
+  for (const auto& entry : kb.get_context().get_modifieds())
+  {
+    result += std::string(" ") + entry.first;
+  }
+
+  return result;
+}
+
+/// Joins a set of names with spaces
+std::string join(const std::set<std::string>& names)
+{
+  std::string result;
+
+  for (const std::string& name : names)
+  {
+    result += (result.empty() ? "" : " ") + name;
+  }
+
+  return result;
+}
+
+/// Joins groups of expression indices, separating groups with a bar
+std::string join(const std::vector<std::vector<size_t>>& groups)
+{
+  std::string result;
+
+  for (const std::vector<size_t>& group : groups)
+  {
+    result += result.empty() ? "" : " |";
+
+    for (size_t index : group)
+    {
+      result += " " + std::to_string(index);
+    }
+  }
+
+  return result;
+}
+
+expression::VariableAccess analyze(
+    knowledge::KnowledgeBase& kb, const std::string& logic)
+{
+  knowledge::CompiledExpression compiled = kb.compile(logic);
+
+  return expression::AccessVisitor().analyze(compiled.get_root());
+}
+
+/// Checks the variables found in expressions
+void test_access(void)
+{
+  knowledge::KnowledgeBase kb;
+
+  expression::VariableAccess access =
+      analyze(kb, "a = b + c; ++d; e += f; g[h] = 1; i[j] > 2; k++");
+
+  // reads and writes are found in every kind of node
+  TEST_EQ(join(access.reads), "b c d e f h i j k");
+  TEST_EQ(join(access.writes), "a d e g k");
+  TEST_EQ(access.unbounded, false);
+
+  access = analyze(kb, ".i [0 -> 10) (sum += .i)");
+
+  // for loops include their loop variable and body
+  TEST_EQ(join(access.reads), ".i sum");
+  TEST_EQ(join(access.writes), ".i sum");
+  TEST_EQ(access.unbounded, false);
+
+  access = analyze(kb, "x => (y = #sqrt (z))");
+
+  // branches not taken and pure system calls are included
+  TEST_EQ(join(access.reads), "x z");
+  TEST_EQ(join(access.writes), "y");
+  TEST_EQ(access.unbounded, false);
+
+  // expanded names and side effects make access unbounded
+  TEST_EQ((bool)analyze(kb, "agent{.id}.state = 1").unbounded, true);
+  TEST_EQ((bool)analyze(kb, "#print ('hello')").unbounded, true);
+  TEST_EQ((bool)analyze(kb, "#clear_var (a)").unbounded, true);
+
+  expression::VariableAccess writer = analyze(kb, "a = 1");
+  expression::VariableAccess reader = analyze(kb, "b = a");
+  expression::VariableAccess other = analyze(kb, "c = d");
+
+  // only writes conflict with other accesses
+  TEST_EQ(writer.conflicts(reader), true);
+  TEST_EQ(reader.conflicts(writer), true);
+  TEST_EQ(writer.conflicts(other), false);
+  TEST_EQ(reader.conflicts(other), false);
+  TEST_EQ(analyze(kb, "e = d").conflicts(other), false);
+}
+
+/// Checks how expressions are grouped
+void test_groups(void)
+{
+  knowledge::KnowledgeBase kb;
+  knowledge::ExpressionBatch batch(kb, threads);
+
+  batch.add("a = b + 1");
+  batch.add("c = d * 2");
+  batch.add("e = a + c");
+  batch.add("f = 3");
+  batch.add("#print ('{f}\n')");
+  batch.add("g = 4");
+
+  // expressions run after the last group they conflict with
+  TEST_EQ(join(batch.get_groups()), " 0 1 3 | 2 | 4 | 5");
+}
+
+/// Compares batches against evaluating expressions in order
+void test_equivalence(void)
+{
+  knowledge::KnowledgeBase parallel;
+  knowledge::KnowledgeBase serial;
+  knowledge::ExpressionBatch batch(parallel, threads);
+
+  std::vector<std::string> logics;
+
+  for (int i = 0; i < 16; ++i)
+  {
+    std::string agent = "agent." + std::to_string(i);
+    std::string loop = ".i" + std::to_string(i);
+
+    logics.push_back(agent + ".ticks += 1; " + loop + " [0 -> 50) (" +
+                     agent + ".sum += " + loop + " * " + agent + ".ticks); " +
+                     agent + ".ok = " + agent + ".sum > 100");
+  }
+
+  // dependent logic that must see the rule sets' results
+  logics.push_back("total = 0; .j [0 -> 16) (total += .j)");
+  logics.push_back("agent.0.ticks > 2 => (done = 1)");
+  logics.push_back("agent.1.sum = agent.1.sum / 2");
+  logics.push_back("names = 'tick ' + agent.2.ticks");
+
+  std::vector<knowledge::CompiledExpression> compiled;
+
+  for (const std::string& logic : logics)
+  {
+    batch.add(parallel.compile(logic));
+    compiled.push_back(serial.compile(logic));
+  }
+
+  // batches return what sequential evaluation returns
+  int mismatches = 0;
+
+  for (int tick = 0; tick < 5; ++tick)
+  {
+    std::vector<knowledge::KnowledgeRecord> results = batch.evaluate();
+
+    for (size_t i = 0; i < compiled.size(); ++i)
+    {
+      knowledge::KnowledgeRecord expected = serial.evaluate(compiled[i]);
+
+      if (results[i].to_string() != expected.to_string())
+      {
+        ++mismatches;
+      }
+    }
+  }
+
+  TEST_EQ(mismatches, 0);
+
+  // independent rule sets share a group
+  TEST_GT(batch.get_groups().size(), (size_t)1);
+  TEST_GE(batch.get_groups()[0].size(), (size_t)16);
+
+  // batches leave the records and modifieds of sequential evaluation
+  TEST_EQ(describe(parallel), describe(serial));
+}
+
+/// Checks that expressions reading the same arrays can share them
+void test_shared_reads(void)
+{
+  knowledge::KnowledgeBase kb;
+  knowledge::ExpressionBatch batch(kb, threads);
+
+  kb.set("weights", std::vector<double>{1.0, 2.0, 3.0, 4.0});
+  kb.set("counts", std::vector<Integer>{1, 2, 3, 4});
+
+  // #sum and #dot share the arrays of the records they read
+  for (int i = 0; i < 16; ++i)
+  {
+    batch.add("result." + std::to_string(i) +
+              " = #sum (weights) + #dot (counts, counts) + " +
+              std::to_string(i));
+  }
+
+  for (int tick = 0; tick < 10; ++tick)
+  {
+    batch.evaluate();
+  }
+
+  TEST_EQ(batch.get_groups().size(), (size_t)1);
+  TEST_EQ(kb.get("result.0").to_double(), 40.0);
+  TEST_EQ(kb.get("result.15").to_double(), 55.0);
+
+  // shared records can still be written between batches
+  kb.set_index("weights", 0, 11.0);
+  batch.evaluate();
+
+  TEST_EQ(kb.get("result.0").to_double(), 50.0);
+
+  // like batch workers, readers share a record while the caller holds
+  // the context, and each share marks the record as shared
+  std::vector<double> sums(threads);
+  {
+    knowledge::ContextGuard guard(kb);
+    const knowledge::KnowledgeRecord& weights =
+        *kb.get_context().get_record("weights");
+
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < threads; ++i)
+    {
+      readers.emplace_back([&weights, &sums, i]() {
+        for (int j = 0; j < 1000; ++j)
+        {
+          auto values = weights.share_doubles();
+          sums[i] = utility::array_sum(values->data(), values->size());
+        }
+      });
+    }
+
+    for (auto& reader : readers)
+    {
+      reader.join();
+    }
+  }
+
+  TEST_EQ(sums[0], 20.0);
+  TEST_EQ(sums[threads - 1], 20.0);
+
+  // a shared array is copied before the next write
+  auto held = kb.get_context().share_doubles("weights");
+  kb.set_index("weights", 1, 12.0);
+
+  TEST_EQ((*held)[1], 2.0);
+  TEST_EQ(kb.get("weights").retrieve_index(1).to_double(), 12.0);
+}
+
+/// Checks that a failing expression stops the batch
+void test_errors(void)
+{
+  knowledge::KnowledgeBase kb;
+  knowledge::ExpressionBatch batch(kb, threads);
+
+  batch.add("a = 1");
+  batch.add("b = unset + 1");
+  batch.add("c = 1");
+  batch.add("d = a + b");
+
+  knowledge::EvalSettings settings;
+  settings.exception_on_unitialized = true;
+
+  bool thrown = false;
+
+  try
+  {
+    batch.evaluate(settings);
+  }
+  catch (const std::exception&)
+  {
+    thrown = true;
+  }
+
+  // exceptions are rethrown and later groups are skipped
+  TEST_EQ(thrown, true);
+  TEST_EQ(kb.get("a").to_integer(), 1);
+  TEST_EQ(kb.get("c").to_integer(), 1);
+  TEST_EQ(kb.exists("d"), false);
+
+  kb.set("unset", Integer(1));
+
+  std::vector<knowledge::KnowledgeRecord> results = batch.evaluate(settings);
+
+  // batches evaluate again after an exception
+  TEST_EQ(results.size(), (size_t)4);
+  TEST_EQ(results[3].to_integer(), 3);
+}
+
+/// Compares evaluating independent rule sets serially and in a batch
+void benchmark_batch(void)
+{
+  std::cerr << "Benchmarking batches against sequential evaluation...\n";
+
+  knowledge::KnowledgeBase parallel;
+  knowledge::KnowledgeBase serial;
+  knowledge::ExpressionBatch batch(parallel, threads);
+  std::vector<knowledge::CompiledExpression> compiled;
+
+  for (int i = 0; i < rule_sets; ++i)
+  {
+    std::string agent = "agent." + std::to_string(i);
+    std::string loop = ".i" + std::to_string(i);
+    std::string logic = loop + " [0 -> 2000) (" + agent + ".sum += " + loop +
+                        " * 2 + " + agent + ".bias); " + agent +
+                        ".ready = " + agent + ".sum > 1000";
+
+    batch.add(parallel.compile(logic));
+    compiled.push_back(serial.compile(logic));
+  }
+
+  utility::Timer<std::chrono::steady_clock> timer;
+
+  timer.start();
+
+  for (int tick = 0; tick < 10; ++tick)
+  {
+    for (knowledge::CompiledExpression& expression : compiled)
+    {
+      serial.evaluate(expression);
+    }
+  }
+
+  timer.stop();
+  uint64_t serial_ns = timer.duration_ns();
+
+  timer.start();
+
+  for (int tick = 0; tick < 10; ++tick)
+  {
+    batch.evaluate();
+  }
+
+  timer.stop();
+  uint64_t batch_ns = timer.duration_ns();
+
+  TEST_EQ(describe(parallel), describe(serial));
+
+  std::cerr << "  " << rule_sets << " rule sets x 10 ticks: serial "
+            << serial_ns / 1000 << " us, batch of " << threads << " threads "
+            << batch_ns / 1000 << " us\n";
+}
+
+int main(int, char**)
+{
+  test_access();
+  test_groups();
+  test_equivalence();
+  test_shared_reads();
+  test_errors();
+  benchmark_batch();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <chrono>
 
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/knowledge/KnowledgeRecordFilters.h"
@@ -10,7 +11,10 @@
 #include "madara/filters/PrefixIntConvert.h"
 #include "madara/filters/FragmentsToFilesFilter.h"
 #include "madara/filters/VariableMapFilter.h"
+#include "madara/filters/BatchFilter.h"
+#include "madara/filters/ContentDedupFilter.h"
 #include "madara/utility/Utility.h"
+#include "madara/utility/Sha256.h"
 #include "madara/knowledge/FileFragmenter.h"
 #include "madara/knowledge/FileRequester.h"
 
@@ -447,6 +451,411 @@ void test_variable_map_filter(void)
   }
 }
 
+/**
+ * Per-record filter that decrements integers and leaves others alone
+ **/
+class DecrementRecordFilter : public filters::RecordFilter
+{
+public:
+  KnowledgeRecord filter(knowledge::FunctionArguments& args,
+      knowledge::Variables&) override
+  {
+    if (args[0].type() == KnowledgeRecord::INTEGER)
+    {
+      return KnowledgeRecord(args[0].to_integer() - 1);
+    }
+
+    return args[0];
+  }
+};
+
+/**
+ * Batch filter that decrements integers, drops strings and adds a
+ * record with the number of records it saw
+ **/
+class DecrementBatchFilter : public filters::BatchFilter
+{
+public:
+  void filter(filters::RecordBatch& records, transport::TransportContext&,
+      knowledge::Variables&) override
+  {
+    size_t seen = records.size();
+
+    for (auto& record : records)
+    {
+      if (record.second.type() == KnowledgeRecord::INTEGER)
+      {
+        record.second = KnowledgeRecord(record.second.to_integer() - 1);
+      }
+      else if (record.second.type() == KnowledgeRecord::STRING)
+      {
+        record.second.clear_value();
+      }
+    }
+
+    records["batch.seen"] = KnowledgeRecord(KnowledgeRecord::Integer(seen));
+  }
+};
+
+/**
+ * Batch filter that only decrements integers, for the benchmark
+ **/
+class DecrementOnlyBatchFilter : public filters::BatchFilter
+{
+public:
+  void filter(filters::RecordBatch& records, transport::TransportContext&,
+      knowledge::Variables&) override
+  {
+    for (auto& record : records)
+    {
+      if (record.second.type() == KnowledgeRecord::INTEGER)
+      {
+        record.second = KnowledgeRecord(record.second.to_integer() - 1);
+      }
+    }
+  }
+};
+
+void test_batch_filter(void)
+{
+  madara::knowledge::KnowledgeBase kb;
+  knowledge::KnowledgeRecordFilters filters;
+  filters.attach(&kb.get_context());
+
+  DecrementBatchFilter decrement;
+  filters.add(&decrement);
+  filters.add(&decrement);
+
+  filters::RecordBatch batch;
+  batch["agent.0.x"] = KnowledgeRecord(KnowledgeRecord::Integer(5));
+  batch["agent.0.name"] = KnowledgeRecord("agent0");
+  batch["agent.0.y"] = KnowledgeRecord(2.5);
+
+  transport::TransportContext context;
+
+  std::cerr << "Testing batch filter chain: ";
+
+  filters.filter_batch(batch, context);
+
+  // first pass saw 3 records and added batch.seen=3, which the second pass
+  // decremented before overwriting it with the 4 records it saw
+  if (filters.get_number_of_batch_filters() == 2 && batch.size() == 4 &&
+      batch["agent.0.x"] == KnowledgeRecord::Integer(3) &&
+      !batch["agent.0.name"].exists() && batch["agent.0.y"] == 2.5 &&
+      batch["batch.seen"] == KnowledgeRecord::Integer(4))
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    for (auto& record : batch)
+    {
+      std::cerr << "  " << record.first << "=" << record.second << "\n";
+    }
+    ++madara_fails;
+  }
+
+  std::cerr << "Testing batch filter clear: ";
+
+  filters.clear_batch_filters();
+
+  if (filters.get_number_of_batch_filters() == 0)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+}
+
+void test_content_dedup_filter(void)
+{
+  std::cerr << "Testing content-addressed deduplication...\n";
+
+  std::string directory = "test_filters_content";
+
+  auto sender_store = std::make_shared<knowledge::ContentStore>();
+  auto receiver_store = std::make_shared<knowledge::ContentStore>();
+  receiver_store->set_directory(directory);
+
+  knowledge::KnowledgeBase sender, receiver;
+  sender.set_content_store(sender_store);
+  receiver.set_content_store(receiver_store);
+
+  std::vector<unsigned char> tile(5000);
+  for (size_t i = 0; i < tile.size(); ++i)
+  {
+    tile[i] = (unsigned char)(i * 7);
+  }
+
+  sender.set_file("tiles.a", tile.data(), tile.size());
+  sender.set_file("tiles.b", tile.data(), tile.size());
+
+  std::cerr << "  Sharing identical payloads in a knowledge base... ";
+
+  if (sender_store->size() == 1 && sender_store->get_duplicates() == 1 &&
+      sender.get("tiles.a").share_binary() ==
+          sender.get("tiles.b").share_binary())
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+
+  filters::ContentDedupFilter sender_filter(sender_store);
+  filters::ContentDedupFilter receiver_filter(receiver_store);
+
+  knowledge::Variables sender_vars(&sender.get_context());
+  knowledge::Variables receiver_vars(&receiver.get_context());
+
+  uint64_t now = utility::get_time();
+
+  transport::TransportContext sender_sending(
+      transport::TransportContext::SENDING_OPERATION, 0, 0, now, now, "",
+      "sender");
+  transport::TransportContext sender_receiving(
+      transport::TransportContext::RECEIVING_OPERATION, 0, 0, now, now, "",
+      "receiver");
+  transport::TransportContext receiver_sending(
+      transport::TransportContext::SENDING_OPERATION, 0, 0, now, now, "",
+      "receiver");
+  transport::TransportContext receiver_receiving(
+      transport::TransportContext::RECEIVING_OPERATION, 0, 0, now, now, "",
+      "sender");
+
+  // with no known peers, the payload goes out in full
+  knowledge::KnowledgeMap records;
+  records["tiles.a"] = sender.get("tiles.a");
+  sender_filter.filter(records, sender_sending, sender_vars);
+
+  std::cerr << "  Sending full payloads to unknown peers... ";
+
+  if (records.count("tiles.a") == 1 && records.count("madara.content.have"))
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+
+  receiver_filter.filter(records, receiver_receiving, receiver_vars);
+
+  // the receiver advertises the tile with its next message
+  records.clear();
+  records["receiver.status"] = KnowledgeRecord::Integer(1);
+  receiver_filter.filter(records, receiver_sending, receiver_vars);
+  sender_filter.filter(records, sender_receiving, sender_vars);
+
+  records.clear();
+  records["tiles.c"] = sender.get("tiles.a");
+  records["tiles.c"].clock = 5;
+  records["tiles.d"] = sender.get("tiles.a");
+  records["tiles.d"].clock = 2;
+  records["tiles.d"].quality = 3;
+  sender_filter.filter(records, sender_sending, sender_vars);
+
+  std::cerr << "  Sending references to peers with the content... ";
+
+  if (records.count("tiles.c") == 0 && records.count("tiles.d") == 0 &&
+      records.count("madara.content.refs") == 1 &&
+      sender_filter.get_references_sent() == 2 &&
+      sender_filter.get_bytes_saved() == tile.size() * 2)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+
+  receiver_filter.filter(records, receiver_receiving, receiver_vars);
+
+  std::cerr << "  Restoring referenced payloads on receipt... ";
+
+  auto restored = records["tiles.c"].share_binary();
+
+  if (records.count("madara.content.refs") == 0 && restored &&
+      *restored == tile && records["tiles.c"].clock == 5 &&
+      records["tiles.c"].quality == 0 && records["tiles.d"].clock == 2 &&
+      records["tiles.d"].quality == 3 &&
+      restored == receiver_store->get(receiver_store->digest(restored)) &&
+      receiver_filter.get_unresolved() == 0)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "  Loading persisted content in a new session... ";
+
+  knowledge::ContentStore next_session;
+  next_session.set_directory(directory);
+
+  std::string digest = utility::sha256(tile.data(), tile.size());
+  auto loaded = next_session.get(digest);
+
+  if (next_session.has(digest) && next_session.digests().size() == 1 &&
+      loaded && *loaded == tile)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+
+  remove((directory + "/" + utility::digest_to_hex(digest)).c_str());
+  remove(directory.c_str());
+
+  std::cerr << "  Reading newly interned content with cursors... ";
+
+  knowledge::ContentStore store(1);
+  size_t first = store.open_cursor();
+  size_t second = store.open_cursor();
+
+  auto payload = [](unsigned char value) {
+    return knowledge::ContentStore::Payload(
+        std::make_shared<std::vector<unsigned char>>(4, value));
+  };
+
+  knowledge::ContentStore::Payload a = payload(1), b = payload(2),
+                                   c = payload(3);
+  store.intern(a);
+  store.intern(b);
+
+  bool cursors_ok = store.digests_since(first).size() == 2;
+
+  store.intern(c);
+
+  cursors_ok = cursors_ok && store.digests_since(first).size() == 1 &&
+               store.digests_since(second).size() == 3 &&
+               store.digests_since(second).empty();
+
+  store.intern(a = payload(4));
+  store.clear();
+
+  cursors_ok = cursors_ok && store.digests_since(first).empty();
+
+  store.close_cursor(second);
+  store.intern(b = payload(5));
+
+  cursors_ok = cursors_ok && store.digests_since(first).size() == 1 &&
+               store.digests_since(second).empty();
+
+  if (cursors_ok)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+}
+
+void test_batch_filter_overhead(void)
+{
+  typedef std::chrono::steady_clock clock;
+
+  const size_t num_records = 5000;
+  const size_t num_filters = 3;
+  const size_t iterations = 20;
+
+  madara::knowledge::KnowledgeBase kb;
+  knowledge::KnowledgeRecordFilters record_filters;
+  knowledge::KnowledgeRecordFilters batch_filters;
+  record_filters.attach(&kb.get_context());
+  batch_filters.attach(&kb.get_context());
+
+  DecrementRecordFilter record_filter;
+  DecrementOnlyBatchFilter batch_filter;
+
+  for (size_t i = 0; i < num_filters; ++i)
+  {
+    record_filters.add(KnowledgeRecord::INTEGER, &record_filter);
+    batch_filters.add(&batch_filter);
+  }
+
+  std::vector<std::pair<std::string, KnowledgeRecord>> records;
+  records.reserve(num_records);
+
+  filters::RecordBatch records_map;
+
+  for (size_t i = 0; i < num_records; ++i)
+  {
+    records.emplace_back("agent." + std::to_string(i) + ".x",
+        KnowledgeRecord(KnowledgeRecord::Integer(i + num_filters)));
+    records_map.insert(records.back());
+  }
+
+  transport::TransportContext context;
+
+  // per-record filtering, as done by the existing send/receive chains
+  std::vector<KnowledgeRecord> results(num_records);
+  auto start = clock::now();
+  for (size_t j = 0; j < iterations; ++j)
+  {
+    for (size_t i = 0; i < num_records; ++i)
+    {
+      results[i] =
+          record_filters.filter(records[i].second, records[i].first, context);
+    }
+  }
+  double record_ns =
+      std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+  // one call per batch
+  filters::RecordBatch batch;
+  start = clock::now();
+  for (size_t j = 0; j < iterations; ++j)
+  {
+    batch = records_map;
+    batch_filters.filter_batch(batch, context);
+  }
+  double batch_ns =
+      std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+  double per_record = record_ns / (num_records * iterations);
+  double per_batch = batch_ns / (num_records * iterations);
+
+  std::cerr << "Per-record chain (" << num_filters << " filters): "
+            << per_record << " ns/record\n";
+  std::cerr << "Batch chain (" << num_filters << " filters): " << per_batch
+            << " ns/record\n";
+
+  std::cerr << "Testing batch and per-record results match: ";
+
+  bool match = batch.size() == num_records;
+  for (size_t i = 0; match && i < num_records; ++i)
+  {
+    match = batch[records[i].first] == KnowledgeRecord::Integer(i) &&
+            results[i] == KnowledgeRecord::Integer(i);
+  }
+
+  if (match)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+}
+
 int main(int, char**)
 {
   test_dynamic_predicate_filter();
@@ -456,6 +865,9 @@ int main(int, char**)
   test_print_filter_compile();
   test_variable_map_filter();
   test_fragments_to_files_filter();
+  test_batch_filter();
+  test_batch_filter_overhead();
+  test_content_dedup_filter();
 
   madara::knowledge::KnowledgeRecordFilters filters;
 
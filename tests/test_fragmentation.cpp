@@ -1,6 +1,9 @@
 
 #include "madara/transport/Fragmentation.h"
 #include "madara/transport/MessageHeader.h"
+#include "madara/transport/Transport.h"
+#include "madara/transport/PacketScheduler.h"
+#include "madara/knowledge/KnowledgeBase.h"
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/utility/Utility.h"
 #include <stdio.h>
@@ -565,6 +568,193 @@ void test_ssl(void)
 #endif // end if SSL
 }
 
+/**
+ * Transport that keeps the datagrams it would send, fragmenting
+ * messages larger than max_fragment_size as UdpTransport does
+ **/
+class CaptureTransport : public transport::Base
+{
+public:
+  CaptureTransport(const std::string& id,
+      transport::TransportSettings& settings,
+      madara::knowledge::ThreadSafeContext& context)
+    : transport::Base(id, settings, context)
+  {
+    setup();
+  }
+
+  long send_data(const madara::knowledge::KnowledgeMap& updates) override
+  {
+    MessageSpans messages;
+    long result = prep_send(updates, "CaptureTransport::send_data", &messages);
+
+    if (result > 0 && messages.size() == 0)
+    {
+      messages.push_back(std::make_pair((size_t)0, (size_t)result));
+    }
+
+    for (auto& message : messages)
+    {
+      const char* buffer = buffer_.get_ptr() + message.first;
+
+      if (message.second > settings_.max_fragment_size)
+      {
+        transport::FragmentMap map;
+
+        transport::frag(buffer, message.second, id_.c_str(),
+            settings_.write_domain.c_str(), context_.get_clock(),
+            utility::get_time(), 0, 0, settings_.max_fragment_size, map);
+
+        for (auto& fragment : map)
+        {
+          datagrams.push_back(std::string(fragment.second.get(),
+              (size_t)transport::MessageHeader::get_size(
+                  fragment.second.get())));
+        }
+
+        transport::delete_fragments(map);
+      }
+      else
+      {
+        datagrams.push_back(std::string(buffer, message.second));
+      }
+    }
+
+    return result;
+  }
+
+  std::vector<std::string> datagrams;
+};
+
+/**
+ * Delivers datagrams to a receiver, dropping them at a loss rate
+ * @return  the number of small.* updates the receiver got
+ **/
+size_t deliver(const std::vector<std::string>& datagrams, double loss,
+    madara::knowledge::KnowledgeBase& receiver)
+{
+  transport::QoSTransportSettings settings;
+  settings.add_read_domain(settings.write_domain);
+
+  transport::QoSTransportSettings drops;
+  drops.update_drop_rate(loss, transport::PACKET_DROP_DETERMINISTIC);
+
+  transport::PacketScheduler scheduler(&drops);
+  transport::BandwidthMonitor send_monitor, receive_monitor;
+#ifndef _MADARA_NO_KARL_
+  madara::knowledge::CompiledExpression on_data_received;
+#endif
+
+  // defragmented messages are copied over the receive buffer
+  std::vector<char> buffer(settings.queue_length);
+
+  for (auto& datagram : datagrams)
+  {
+    if (!scheduler.add())
+    {
+      continue;
+    }
+
+    memcpy(buffer.data(), datagram.c_str(), datagram.size());
+
+    madara::knowledge::KnowledgeMap rebroadcast_records;
+    transport::MessageHeader* header = 0;
+
+    transport::process_received_update(buffer.data(),
+        (uint32_t)datagram.size(), "receiver", receiver.get_context(),
+        settings, send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+        on_data_received,
+#endif
+        "test_packed_messages", "sender", header);
+
+    delete header;
+  }
+
+  return receiver.to_map("small.").size();
+}
+
+void test_packed_messages(void)
+{
+  std::cerr << "Testing packed messages under loss...\n";
+
+  madara::knowledge::KnowledgeMap updates;
+  updates["big"].set_value(std::string(100000, 'x'));
+  updates["huge"].set_value(std::string(50000, 'y'));
+
+  for (int i = 0; i < 100; ++i)
+  {
+    updates["small." + std::to_string(i)].set_value(
+        madara::knowledge::KnowledgeRecord::Integer(i + 1));
+  }
+
+  madara::knowledge::KnowledgeBase sender;
+  transport::QoSTransportSettings settings;
+  settings.max_fragment_size = 1000;
+
+  CaptureTransport whole("sender", settings, sender.get_context());
+  whole.send_data(updates);
+
+  settings.pack_messages = true;
+
+  CaptureTransport packed("sender", settings, sender.get_context());
+  packed.send_data(updates);
+
+  // fragments carry their own header on top of max_fragment_size
+  size_t largest = settings.max_fragment_size +
+                   transport::FragmentMessageHeader::static_encoded_size();
+
+  bool fits = true;
+  for (auto& datagram : packed.datagrams)
+  {
+    fits = fits && datagram.size() <= largest;
+  }
+
+  if (fits && packed.datagrams.size() > whole.datagrams.size())
+  {
+    std::cerr << "  SUCCESS: " << packed.datagrams.size()
+              << " datagrams fit in " << largest << " bytes\n";
+  }
+  else
+  {
+    std::cerr << "  FAIL: " << packed.datagrams.size()
+              << " packed datagrams, of which some were too large\n";
+    ++madara_fails;
+  }
+
+  madara::knowledge::KnowledgeBase lossless;
+  size_t delivered = deliver(packed.datagrams, 0, lossless);
+
+  if (delivered == 100 && lossless.get("big").to_string().size() == 100000 &&
+      lossless.get("huge").to_string().size() == 50000)
+  {
+    std::cerr << "  SUCCESS: packed messages decode without loss\n";
+  }
+  else
+  {
+    std::cerr << "  FAIL: only " << delivered << " of 100 updates decoded\n";
+    ++madara_fails;
+  }
+
+  madara::knowledge::KnowledgeBase whole_receiver, packed_receiver;
+  size_t whole_delivered = deliver(whole.datagrams, .2, whole_receiver);
+  size_t packed_delivered = deliver(packed.datagrams, .2, packed_receiver);
+
+  std::cerr << "  With 20% datagram loss, " << whole_delivered
+            << " updates were delivered in one message and "
+            << packed_delivered << " in packed messages\n";
+
+  if (packed_delivered >= 60 && packed_delivered > whole_delivered)
+  {
+    std::cerr << "  SUCCESS: packing delivers more updates under loss\n";
+  }
+  else
+  {
+    std::cerr << "  FAIL: packing did not deliver more updates\n";
+    ++madara_fails;
+  }
+}
+
 int main(int argc, char* argv[])
 {
   handle_arguments(argc, argv);
@@ -572,6 +762,7 @@ int main(int argc, char* argv[])
   test_frag();
   test_add_frag();
   test_records_frag();
+  test_packed_messages();
   test_ssl();
 
   if (madara_fails > 0)
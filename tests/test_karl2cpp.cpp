@@ -0,0 +1,225 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+// generated by karl2cpp from tests/karl2cpp/*.karl before this test builds
+#include "karl2cpp/basic_reasoning.h"
+
+namespace knowledge = madara::knowledge;
+namespace utility = madara::utility;
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+// number of evaluations in the benchmark
+const int evaluations = 100000;
+
+/// Describes a record's type and value, so results can be compared
+std::string describe(const knowledge::KnowledgeRecord& record)
+{
+  return std::to_string(record.type()) + ":" + record.to_string();
+}
+
+/// Describes every record in a knowledge base
+std::string describe(knowledge::KnowledgeBase& kb)
+{
+  std::string result;
+
+  for (const auto& entry : kb.to_map(""))
+  {
+    result += entry.first + "=" + describe(entry.second) + " ";
+  }
+
+  return result;
+}
+
+knowledge::KnowledgeRecord call(const knowledge::GeneratedFunction& function,
+    knowledge::KnowledgeBase& kb)
+{
+  knowledge::FunctionArguments args;
+  knowledge::Variables vars(&kb.get_context());
+
+  return function.function(args, vars);
+}
+
+/// Compares every generated function against interpreting its source
+void test_equivalence(void)
+{
+  for (size_t i = 0; i < basic_reasoning::num_functions; ++i)
+  {
+    const knowledge::GeneratedFunction& function =
+        basic_reasoning::functions[i];
+
+    knowledge::KnowledgeBase interpreted;
+    knowledge::KnowledgeBase generated;
+
+    // evaluate twice so logic sees the state its first evaluation left
+    knowledge::KnowledgeRecord expected1 = interpreted.evaluate(function.source);
+    knowledge::KnowledgeRecord expected2 = interpreted.evaluate(function.source);
+    knowledge::KnowledgeRecord result1 = call(function, generated);
+    knowledge::KnowledgeRecord result2 = call(function, generated);
+
+    log("INFO    : comparing %s\n", function.name);
+
+    // results and variables match the interpreter's
+    TEST_EQ(describe(result1), describe(expected1));
+    TEST_EQ(describe(result2), describe(expected2));
+    TEST_EQ(describe(generated), describe(interpreted));
+
+    // erasing records makes the generated function resolve them again
+    interpreted.clear();
+    generated.clear();
+
+    expected1 = interpreted.evaluate(function.source);
+    result1 = call(function, generated);
+
+    TEST_EQ(describe(result1), describe(expected1));
+    TEST_EQ(describe(generated), describe(interpreted));
+  }
+}
+
+/// Checks which corpus files were generated and which are interpreted
+void test_fallback(void)
+{
+  // only logic with variable expansion and arrays is interpreted
+  for (size_t i = 0; i < basic_reasoning::num_functions; ++i)
+  {
+    const knowledge::GeneratedFunction& function =
+        basic_reasoning::functions[i];
+
+    log("INFO    : checking %s\n", function.name);
+    TEST_EQ(function.interpreted, std::string(function.name) == "expansion");
+  }
+
+  // the function table ends with a null entry
+  TEST_EQ(
+      basic_reasoning::functions[basic_reasoning::num_functions].name ==
+          nullptr,
+      true);
+}
+
+/// Calls generated functions through a knowledge base
+void test_define_functions(void)
+{
+  knowledge::KnowledgeBase kb;
+  knowledge::KnowledgeBase interpreted;
+
+  basic_reasoning::define_functions(kb);
+
+  kb.set("S0", Integer(1));
+  kb.set("S1", Integer(1));
+  kb.set("S2", Integer(0));
+  interpreted.set("S0", Integer(1));
+  interpreted.set("S1", Integer(1));
+  interpreted.set("S2", Integer(0));
+
+  std::string dijkstra;
+
+  for (size_t i = 0; i < basic_reasoning::num_functions; ++i)
+  {
+    if (std::string(basic_reasoning::functions[i].name) == "dijkstra")
+    {
+      dijkstra = basic_reasoning::functions[i].source;
+    }
+  }
+
+  for (int i = 0; i < 6; ++i)
+  {
+    kb.evaluate("dijkstra ()");
+    interpreted.evaluate(dijkstra);
+  }
+
+  // define_functions makes generated logic callable from KaRL
+  TEST_EQ(describe(kb.get("S0")), describe(interpreted.get("S0")));
+  TEST_EQ(describe(kb.get("S1")), describe(interpreted.get("S1")));
+  TEST_EQ(describe(kb.get("S2")), describe(interpreted.get("S2")));
+
+  knowledge::KnowledgeBase other;
+  knowledge::KnowledgeBase other_interpreted;
+  basic_reasoning::define_functions(other);
+
+  other.set("S0", Integer(2));
+  other_interpreted.set("S0", Integer(2));
+  other.evaluate("dijkstra ()");
+  other_interpreted.evaluate(dijkstra);
+
+  // one generated function serves several knowledge bases
+  TEST_EQ(describe(other), describe(other_interpreted));
+  TEST_EQ(describe(kb.get("S0")), describe(interpreted.get("S0")));
+}
+
+/// Compares interpreting a compiled expression against generated code
+void benchmark_generated(void)
+{
+  std::cerr << "Benchmarking generated functions against the interpreter...\n";
+
+  for (size_t i = 0; i < basic_reasoning::num_functions; ++i)
+  {
+    const knowledge::GeneratedFunction& function =
+        basic_reasoning::functions[i];
+
+    if (function.interpreted)
+    {
+      continue;
+    }
+
+    knowledge::KnowledgeBase interpreted;
+    knowledge::KnowledgeBase generated;
+    knowledge::CompiledExpression compiled =
+        interpreted.compile(function.source);
+
+    utility::Timer<std::chrono::steady_clock> timer;
+
+    timer.start();
+
+    for (int j = 0; j < evaluations; ++j)
+    {
+      interpreted.evaluate(compiled);
+    }
+
+    timer.stop();
+    uint64_t interpreted_ns = timer.duration_ns();
+
+    knowledge::FunctionArguments args;
+    knowledge::Variables vars(&generated.get_context());
+
+    timer.start();
+
+    for (int j = 0; j < evaluations; ++j)
+    {
+      function.function(args, vars);
+    }
+
+    timer.stop();
+    uint64_t generated_ns = timer.duration_ns();
+
+    std::cerr << "  " << function.name << ": interpreted "
+              << interpreted_ns / evaluations << " ns, generated "
+              << generated_ns / evaluations << " ns per evaluation\n";
+  }
+}
+
+int main(int, char**)
+{
+  test_equivalence();
+  test_fallback();
+  test_define_functions();
+  benchmark_generated();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -52,6 +52,48 @@ void test_expansion(madara::knowledge::KnowledgeBase& knowledge)
   assert(
       knowledge.get("var3") == (madara::knowledge::KnowledgeRecord::Integer)2);
 
+  // nested expansions use the value of the fully expanded inner key
+  knowledge.evaluate(".idx = 1; .name1 = 2; val2 = 7");
+  result = knowledge.evaluate("val{.name{.idx}}");
+  assert(result == (madara::knowledge::KnowledgeRecord::Integer)7);
+
+  // compiled expansions must follow changes to the inserted values
+  madara::knowledge::CompiledExpression loop =
+      knowledge.compile("agent{.i}.x = .i * 10; agent{.i}.x");
+
+  for (madara::knowledge::KnowledgeRecord::Integer i = 0; i < 40; ++i)
+  {
+    knowledge.set(".i", i);
+    result = knowledge.evaluate(loop);
+    assert(result == i * 10);
+  }
+  assert(knowledge.get("agent39.x") ==
+         (madara::knowledge::KnowledgeRecord::Integer)390);
+
+  // reading an unset expanded key should not create it
+  knowledge.set(".i", (madara::knowledge::KnowledgeRecord::Integer)100);
+  result = knowledge.evaluate("agent{.i}.y");
+  assert(!result.exists());
+  assert(!knowledge.exists("agent100.y"));
+
+  // cached references must not outlive deleted variables
+  madara::knowledge::CompiledExpression read =
+      knowledge.compile("agent{.i}.x");
+  knowledge.set(".i", (madara::knowledge::KnowledgeRecord::Integer)5);
+  assert(knowledge.evaluate(read) ==
+         (madara::knowledge::KnowledgeRecord::Integer)50);
+  knowledge.get_context().delete_variable("agent5.x");
+  assert(!knowledge.evaluate(read).exists());
+  knowledge.set("agent5.x", (madara::knowledge::KnowledgeRecord::Integer)51);
+  assert(knowledge.evaluate(read) ==
+         (madara::knowledge::KnowledgeRecord::Integer)51);
+
+  // array values are inserted with the same delimiter as operator<<
+  knowledge.evaluate(".arr = [1, 2]");
+  knowledge.set("key1, 2", (madara::knowledge::KnowledgeRecord::Integer)3);
+  result = knowledge.evaluate("key{.arr}");
+  assert(result == (madara::knowledge::KnowledgeRecord::Integer)3);
+
 #else
   std::cout << "This test is disabled due to karl feature being disabled.\n";
 #endif  // _MADARA_NO_KARL_
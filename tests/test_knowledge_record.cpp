@@ -1,15 +1,46 @@
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/knowledge/KnowledgeBase.h"
 #include "madara/knowledge/Any.h"
+#include "madara/utility/Timer.h"
 #include "test.h"
 
 #include <vector>
 #include <memory>
 #include <iostream>
 #include <limits>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cmath>
 
 using namespace madara::knowledge;
 
+// counts every heap allocation made by this process so that hot paths
+// can be checked for allocation-free behavior
+static std::atomic<uint64_t> heap_allocations(0);
+
+void* operator new(std::size_t size)
+{
+  ++heap_allocations;
+
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+
+  if (!ptr)
+    throw std::bad_alloc();
+
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
 void check_basic_types_records()
 {
   // constuct an integer record and test operators
@@ -278,10 +309,219 @@ void check_file_records()
   buffer = nullptr;
 }
 
+void check_scalar_allocations()
+{
+  const uint64_t iterations = 1000000;
+
+  KnowledgeRecord int_record(1);
+  KnowledgeRecord int_rhs(3);
+  KnowledgeRecord dbl_record(1.5);
+  KnowledgeRecord dbl_rhs(2.5);
+  KnowledgeRecord::Integer matches = 0;
+
+  madara::utility::Timer<std::chrono::steady_clock> timer;
+
+  uint64_t allocations = heap_allocations;
+  timer.start();
+
+  for (uint64_t i = 0; i < iterations; ++i)
+  {
+    KnowledgeRecord sum = int_record + int_rhs;
+    KnowledgeRecord product = sum * int_rhs;
+    product -= int_record;
+    product /= int_rhs;
+    product %= int_rhs;
+    ++int_record;
+
+    KnowledgeRecord mixed = dbl_record * int_rhs;
+    mixed += dbl_rhs;
+    mixed /= int_rhs;
+    --dbl_record;
+    ++dbl_record;
+
+    if (product < sum && mixed >= dbl_record && !(sum == mixed) &&
+        int_record > dbl_rhs && int_record <= sum)
+    {
+      ++matches;
+    }
+  }
+
+  timer.stop();
+  allocations = heap_allocations - allocations;
+
+  std::cerr << "Scalar arithmetic: " << iterations << " iterations in "
+            << timer.duration_ns() << " ns ("
+            << timer.duration_ns() / iterations << " ns/iteration), "
+            << allocations << " heap allocations\n";
+
+  TEST_EQ(allocations, (uint64_t)0);
+  TEST_EQ(matches > 0, true);
+  TEST_EQ(int_record, KnowledgeRecord::Integer(iterations + 1));
+  TEST_EQ(dbl_record, 1.5);
+
+  // integer and double interactions must keep the old type semantics
+  TEST_EQ((KnowledgeRecord(7) + KnowledgeRecord(2)).type(),
+      (uint32_t)KnowledgeRecord::INTEGER);
+  TEST_EQ((KnowledgeRecord(7) + KnowledgeRecord(2.0)).type(),
+      (uint32_t)KnowledgeRecord::DOUBLE);
+  TEST_EQ((KnowledgeRecord(7.0) - KnowledgeRecord(2)).type(),
+      (uint32_t)KnowledgeRecord::DOUBLE);
+  TEST_EQ(KnowledgeRecord(7) / KnowledgeRecord(2), 3);
+  TEST_EQ(KnowledgeRecord(7) / KnowledgeRecord(2.0), 3.5);
+  TEST_EQ(std::isnan((KnowledgeRecord(7) / KnowledgeRecord(0)).to_double()),
+      true);
+  TEST_EQ(std::isnan((KnowledgeRecord(7) % KnowledgeRecord(0)).to_double()),
+      true);
+  TEST_EQ(KnowledgeRecord(1234567.8).to_integer(), 1234567);
+  TEST_EQ(KnowledgeRecord(-5).to_double(), -5.0);
+}
+
+void check_short_strings()
+{
+  KnowledgeRecord status("ready");
+  KnowledgeRecord long_status(
+      std::string("this status message is too long to be stored inline"));
+
+  // short strings are copied inline without allocating or sharing
+  uint64_t allocations = heap_allocations;
+  KnowledgeRecord status_copy(status);
+  KnowledgeRecord status_assigned;
+  status_assigned = status_copy;
+  KnowledgeRecord status_moved(std::move(status_copy));
+  allocations = heap_allocations - allocations;
+
+  TEST_EQ(allocations, (uint64_t)0);
+  TEST_EQ(status_assigned.to_string(), std::string("ready"));
+  TEST_EQ(status_moved.to_string(), std::string("ready"));
+  TEST_EQ(status_moved.size(), (uint32_t)6);
+  TEST_EQ(status_moved == status, true);
+  TEST_EQ(status_moved.share_string()->compare("ready"), 0);
+
+  // long strings are still shared between copies
+  KnowledgeRecord long_copy(long_status);
+  TEST_EQ(long_copy.share_string() == long_status.share_string(), true);
+
+  // boundaries of the inline storage
+  std::string max_short(KnowledgeRecord::SHORT_STRING_MAX, 'x');
+  KnowledgeRecord max_record(max_short);
+  TEST_EQ(max_record.to_string(), max_short);
+  TEST_EQ(max_record.size(), (uint32_t)max_short.size() + 1);
+  KnowledgeRecord over_record(max_short + "y");
+  TEST_EQ(over_record.to_string(), max_short + "y");
+
+  // resizing moves strings between inline and shared storage
+  max_record.resize(KnowledgeRecord::SHORT_STRING_MAX + 10);
+  TEST_EQ(max_record.to_string().size(),
+      (size_t)KnowledgeRecord::SHORT_STRING_MAX + 10);
+  over_record.resize(3);
+  TEST_EQ(over_record.to_string(), std::string("xxx"));
+
+  // string subtypes survive inline storage
+  KnowledgeRecord xml;
+  xml.set_xml("<a/>");
+  TEST_EQ(xml.type(), (uint32_t)KnowledgeRecord::XML);
+  KnowledgeRecord xml_copy(xml);
+  TEST_EQ(xml_copy.type(), (uint32_t)KnowledgeRecord::XML);
+  TEST_EQ(xml_copy.to_string(), std::string("<a/>"));
+
+  // the wire format is the same for inline and shared strings
+  char buffer[512];
+  const char* records[] = {"", "ready", "this one is long enough to share"};
+  for (const char* value : records)
+  {
+    KnowledgeRecord original(value);
+    int64_t remaining = sizeof(buffer);
+    original.write(buffer, "status", remaining);
+
+    KnowledgeRecord decoded;
+    std::string key;
+    int64_t to_read = sizeof(buffer) - remaining;
+    decoded.read(buffer, key, to_read);
+
+    TEST_EQ(key, std::string("status"));
+    TEST_EQ(to_read, (int64_t)0);
+    TEST_EQ(decoded.to_string(), std::string(value));
+    TEST_EQ(decoded.type(), (uint32_t)KnowledgeRecord::STRING);
+  }
+}
+
+void check_array_arithmetic()
+{
+  std::vector<KnowledgeRecord::Integer> ints{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  std::vector<double> doubles{0.5, 1.5, 2.5};
+
+  // element-wise arithmetic between arrays
+  KnowledgeRecord lhs(ints);
+  KnowledgeRecord rhs(ints);
+  TEST_EQ((lhs + rhs).to_string(),
+      std::string("2, 4, 6, 8, 10, 12, 14, 16, 18, 20"));
+  TEST_EQ((lhs - rhs).to_string(), std::string("0, 0, 0, 0, 0, 0, 0, 0, 0, 0"));
+  TEST_EQ((lhs * rhs).to_string(),
+      std::string("1, 4, 9, 16, 25, 36, 49, 64, 81, 100"));
+  TEST_EQ((lhs / rhs).to_string(), std::string("1, 1, 1, 1, 1, 1, 1, 1, 1, 1"));
+
+  // copies sharing the array are not changed by in-place arithmetic
+  TEST_EQ(lhs.to_string(), std::string("1, 2, 3, 4, 5, 6, 7, 8, 9, 10"));
+  KnowledgeRecord copy(lhs);
+  lhs += KnowledgeRecord(1);
+  TEST_EQ(lhs.to_string(), std::string("2, 3, 4, 5, 6, 7, 8, 9, 10, 11"));
+  TEST_EQ(copy.to_string(), std::string("1, 2, 3, 4, 5, 6, 7, 8, 9, 10"));
+
+  // scalars broadcast from either side
+  TEST_EQ((KnowledgeRecord(10) - copy).to_string(),
+      std::string("9, 8, 7, 6, 5, 4, 3, 2, 1, 0"));
+  TEST_EQ((copy * KnowledgeRecord(2)).type(),
+      (uint32_t)KnowledgeRecord::INTEGER_ARRAY);
+
+  // mixing in doubles produces doubles, up to the shorter array
+  KnowledgeRecord mixed = copy + KnowledgeRecord(doubles);
+  TEST_EQ(mixed.type(), (uint32_t)KnowledgeRecord::DOUBLE_ARRAY);
+  TEST_EQ(mixed.size(), (uint32_t)3);
+  TEST_EQ(mixed.retrieve_index(2).to_double(), 5.5);
+  TEST_EQ((copy * KnowledgeRecord(0.5)).retrieve_index(9).to_double(), 5.0);
+
+  // integer division by zero falls back to doubles
+  KnowledgeRecord divided = copy / KnowledgeRecord(0);
+  TEST_EQ(divided.type(), (uint32_t)KnowledgeRecord::DOUBLE_ARRAY);
+  TEST_EQ(std::isinf(divided.retrieve_index(0).to_double()), true);
+
+#ifndef _MADARA_NO_KARL_
+  KnowledgeBase kb;
+  kb.set("x", ints);
+  kb.set("y", doubles);
+
+  TEST_EQ(kb.evaluate("x + x").to_string(),
+      std::string("2, 4, 6, 8, 10, 12, 14, 16, 18, 20"));
+  TEST_EQ(
+      kb.evaluate("x -= 1; x[0]").to_integer(), (KnowledgeRecord::Integer)0);
+  kb.set("x", ints);
+
+  TEST_EQ(kb.evaluate("#sum (x)").to_integer(), (KnowledgeRecord::Integer)55);
+  TEST_EQ(kb.evaluate("#sum (x)").type(), (uint32_t)KnowledgeRecord::INTEGER);
+  TEST_EQ(kb.evaluate("#sum (y)").to_double(), 4.5);
+  TEST_EQ(kb.evaluate("#dot (x, x)").to_integer(),
+      (KnowledgeRecord::Integer)385);
+  TEST_EQ(kb.evaluate("#dot (x, y)").to_double(), 11.0);
+  TEST_EQ(kb.evaluate("#min (x, y)").to_double(), 0.5);
+  TEST_EQ(kb.evaluate("#max (x, y, 12)").to_integer(),
+      (KnowledgeRecord::Integer)12);
+  TEST_EQ(kb.evaluate("#norm ([3, 4])").to_double(), 5.0);
+  TEST_EQ(kb.evaluate("#axpy (2, x, x)").to_string(),
+      std::string("3, 6, 9, 12, 15, 18, 21, 24, 27, 30"));
+  TEST_EQ(kb.evaluate("#axpy (2, y, y)").retrieve_index(2).to_double(), 7.5);
+#endif
+}
+
 int main()
 {
   check_basic_types_records();
 
+  check_scalar_allocations();
+
+  check_short_strings();
+
+  check_array_arithmetic();
+
   check_non_basic_types_records();
 
   check_file_records();
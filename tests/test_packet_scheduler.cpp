@@ -468,12 +468,182 @@ void test_deterministic(void)
   }
 }
 
+void test_send_priorities(void)
+{
+  madara::transport::QoSTransportSettings settings;
+
+  madara::transport::PacketScheduler scheduler(&settings);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "*******************TESTING SEND PRIORITIES********************\n");
+
+  settings.set_send_priority("cmd.", 100);
+  settings.set_send_priority("cmd.low.", 2);
+  settings.set_send_priority("a.", 3);
+  settings.set_send_priority("b.", 1);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "  Longest prefix decides the priority class: ");
+
+  if (settings.get_send_priority("cmd.stop") == 100 &&
+      settings.get_send_priority("cmd.low.stop") == 2 &&
+      settings.get_send_priority("telemetry.0") == 1 &&
+      settings.get_send_priority_class("cmd.low.stop") == "cmd.low." &&
+      settings.get_send_priority_class("telemetry.0") == "")
+  {
+    madara_logger_ptr_log(
+        logger::global_logger.get(), logger::LOG_ALWAYS, "SUCCESS\n");
+  }
+  else
+  {
+    madara_logger_ptr_log(
+        logger::global_logger.get(), logger::LOG_ALWAYS, "FAIL\n");
+    ++madara_fails;
+  }
+
+  std::string payload(1000, 'x');
+  madara::knowledge::KnowledgeMap updates;
+
+  for (int i = 0; i < 20; ++i)
+  {
+    updates["telemetry." + std::to_string(i)].set_value(payload);
+  }
+
+  updates["cmd.stop"].set_value(madara::knowledge::KnowledgeRecord::Integer(1));
+
+  size_t deferred = scheduler.schedule(updates, 4000);
+
+  uint64_t bytes = 0;
+  size_t telemetry = 0;
+  for (auto& update : updates)
+  {
+    bytes += (uint64_t)update.second.get_encoded_size(update.first);
+    telemetry += update.first != "cmd.stop";
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "  Commands are packed first, the rest is deferred: ");
+
+  if (updates.count("cmd.stop") == 1 && bytes <= 4000 &&
+      updates.size() + deferred == 21 && deferred > 0 &&
+      scheduler.get_deferred() == deferred)
+  {
+    madara_logger_ptr_log(
+        logger::global_logger.get(), logger::LOG_ALWAYS, "SUCCESS\n");
+  }
+  else
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "FAIL (%d sent in %d bytes, %d deferred)\n", (int)updates.size(),
+        (int)bytes, (int)deferred);
+    ++madara_fails;
+  }
+
+  // a new command goes ahead of deferred telemetry, and newer values
+  // replace deferred ones
+  updates.clear();
+  updates["cmd.go"].set_value(madara::knowledge::KnowledgeRecord::Integer(1));
+  updates["telemetry.19"].set_value(std::string("latest"));
+
+  scheduler.schedule(updates, 4000);
+
+  bool command_first = updates.count("cmd.go") == 1;
+  telemetry += updates.size() - 1;
+  std::string latest;
+
+  for (int packets = 0; packets < 100 && scheduler.get_deferred() > 0;
+       ++packets)
+  {
+    if (updates.count("telemetry.19"))
+    {
+      latest = updates["telemetry.19"].to_string();
+    }
+
+    updates.clear();
+    scheduler.schedule(updates, 4000);
+    telemetry += updates.size();
+  }
+
+  if (updates.count("telemetry.19"))
+  {
+    latest = updates["telemetry.19"].to_string();
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "  Deferred records are all sent, newest values win: ");
+
+  if (command_first && scheduler.get_deferred() == 0 &&
+      telemetry == 20 && latest == "latest")
+  {
+    madara_logger_ptr_log(
+        logger::global_logger.get(), logger::LOG_ALWAYS, "SUCCESS\n");
+  }
+  else
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "FAIL (%d telemetry, latest=%s)\n", (int)telemetry, latest.c_str());
+    ++madara_fails;
+  }
+
+  // saturated classes share packets in proportion to their tickets
+  std::string sample(100, 'y');
+  updates.clear();
+
+  for (int i = 0; i < 200; ++i)
+  {
+    updates["a." + std::to_string(i)].set_value(sample);
+    updates["b." + std::to_string(i)].set_value(sample);
+  }
+
+  size_t a_sent = 0, b_sent = 0;
+
+  for (int packets = 0; packets < 10; ++packets)
+  {
+    scheduler.schedule(updates, 1400);
+
+    for (auto& update : updates)
+    {
+      if (update.first[0] == 'a')
+        ++a_sent;
+      else
+        ++b_sent;
+    }
+
+    updates.clear();
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "  Tickets of 3:1 sent %d:%d records: ", (int)a_sent, (int)b_sent);
+
+  if (b_sent > 0 && a_sent >= b_sent * 5 / 2 && a_sent <= b_sent * 7 / 2)
+  {
+    madara_logger_ptr_log(
+        logger::global_logger.get(), logger::LOG_ALWAYS, "SUCCESS\n");
+  }
+  else
+  {
+    madara_logger_ptr_log(
+        logger::global_logger.get(), logger::LOG_ALWAYS, "FAIL\n");
+    ++madara_fails;
+  }
+
+  scheduler.clear();
+
+  if (scheduler.get_deferred() != 0)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "  Clear did not drop deferred records: FAIL\n");
+    ++madara_fails;
+  }
+}
+
 int main(int argc, char* argv[])
 {
   parse_args(argc, argv);
 
   test_probablistic();
   test_deterministic();
+  test_send_priorities();
 
   if (madara_fails > 0)
   {
@@ -11,6 +11,7 @@
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
 #include "madara/knowledge/containers/Integer.h"
 #include "madara/knowledge/containers/IntegerStaged.h"
+#include "madara/knowledge/containers/CommitGroup.h"
 #include "madara/logger/GlobalLogger.h"
 #include "madara/utility/Utility.h"
 #include "madara/utility/Timer.h"
@@ -57,6 +58,10 @@ uint64_t test_staged_container_assignment(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
 uint64_t test_staged_container_increment(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+uint64_t test_staged_individual_commit(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+uint64_t test_staged_group_commit(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
 
 uint64_t test_compiled_sr(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
@@ -99,6 +104,19 @@ uint64_t test_get_expand_ref(
 uint64_t test_variables_inc_var_ref(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
 
+uint64_t test_looped_array_sum(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+uint64_t test_array_sum(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+uint64_t test_looped_array_dot(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+uint64_t test_array_dot(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+uint64_t test_looped_array_add(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+uint64_t test_array_add(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+
 uint64_t test_stl_inc_atomic(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
 uint64_t test_stl_inc_recursive(
@@ -300,7 +318,7 @@ int main(int argc, char* argv[])
     exit(-1);
   }
 
-  const int num_test_types = 36;
+  const int num_test_types = 44;
 
   // make everything all pretty and for-loopy
   uint64_t results[num_test_types];
@@ -333,6 +351,14 @@ int main(int argc, char* argv[])
       "KaRL container: Increments        ",
       "KaRL staged container: Assignment ",
       "KaRL staged container: Increments ",
+      "KaRL staged: Individual Commits   ",
+      "KaRL staged: Group Commit         ",
+      "KaRL: Looped Array Sum            ",
+      "KaRL: #sum System Call            ",
+      "KaRL: Looped Dot Product          ",
+      "KaRL: #dot System Call            ",
+      "KaRL: Looped Array Addition       ",
+      "KaRL: Array Addition Operator     ",
       "C++: Optimized Assignments        ",
       "C++: Optimized Increments         ",
       "C++: Optimized Ternary Increments ",
@@ -373,6 +399,14 @@ int main(int argc, char* argv[])
     ContainerIncrement,
     StagedContainerAssignment,
     StagedContainerIncrement,
+    StagedIndividualCommit,
+    StagedGroupCommit,
+    LoopedArraySum,
+    ArraySum,
+    LoopedArrayDot,
+    ArrayDot,
+    LoopedArrayAdd,
+    ArrayAdd,
     OptimizedAssignment,
     OptimizedReinforcement,
     OptimizedInference,
@@ -420,6 +454,15 @@ int main(int argc, char* argv[])
   test_functions[ContainerIncrement] = test_container_increment;
   test_functions[StagedContainerAssignment] = test_staged_container_assignment;
   test_functions[StagedContainerIncrement] = test_staged_container_increment;
+  test_functions[StagedIndividualCommit] = test_staged_individual_commit;
+  test_functions[StagedGroupCommit] = test_staged_group_commit;
+
+  test_functions[LoopedArraySum] = test_looped_array_sum;
+  test_functions[ArraySum] = test_array_sum;
+  test_functions[LoopedArrayDot] = test_looped_array_dot;
+  test_functions[ArrayDot] = test_array_dot;
+  test_functions[LoopedArrayAdd] = test_looped_array_add;
+  test_functions[ArrayAdd] = test_array_add;
 
   test_functions[OptimizedAssignment] = test_optimal_assignment;
   test_functions[OptimizedReinforcement] = test_optimal_reinforcement;
@@ -724,6 +767,103 @@ uint64_t test_staged_container_increment(
   return measured;
 }
 
+/// number of staged values committed by a control loop
+const uint32_t num_staged = 300;
+
+/// Creates the staged values of a control loop
+void create_staged(madara::knowledge::KnowledgeBase& knowledge,
+    std::vector<madara::knowledge::containers::IntegerStaged>& staged)
+{
+  staged.reserve(num_staged);
+
+  for (uint32_t i = 0; i < num_staged; ++i)
+  {
+    staged.emplace_back("staged." + std::to_string(i), knowledge);
+  }
+}
+
+/// Tests committing staged containers one at a time
+uint64_t test_staged_individual_commit(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  knowledge.clear();
+
+  std::vector<madara::knowledge::containers::IntegerStaged> staged;
+  create_staged(knowledge, staged);
+
+  uint32_t rounds = iterations / num_staged > 0 ? iterations / num_staged : 1;
+
+  // keep track of time
+  uint64_t measured(0);
+  madara::utility::Timer<Clock> timer;
+
+  timer.start();
+
+  for (uint32_t i = 0; i < rounds; ++i)
+  {
+    for (auto& value : staged)
+    {
+      value = i;
+    }
+
+    for (auto& value : staged)
+    {
+      value.write();
+    }
+  }
+
+  timer.stop();
+  measured = timer.duration_ns();
+
+  print(measured, knowledge.get("staged.0"), rounds * num_staged,
+      "Staged individual commits: ");
+
+  return measured;
+}
+
+/// Tests committing staged containers with a commit group
+uint64_t test_staged_group_commit(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  knowledge.clear();
+
+  std::vector<madara::knowledge::containers::IntegerStaged> staged;
+  create_staged(knowledge, staged);
+
+  madara::knowledge::containers::CommitGroup group(knowledge);
+
+  for (auto& value : staged)
+  {
+    group.add(value);
+  }
+
+  uint32_t rounds = iterations / num_staged > 0 ? iterations / num_staged : 1;
+
+  // keep track of time
+  uint64_t measured(0);
+  madara::utility::Timer<Clock> timer;
+
+  timer.start();
+
+  for (uint32_t i = 0; i < rounds; ++i)
+  {
+    for (auto& value : staged)
+    {
+      value = i;
+    }
+
+    group.commit();
+  }
+
+  timer.stop();
+  measured = timer.duration_ns();
+
+  print(measured, knowledge.get("staged.0"), rounds * num_staged,
+      "Staged group commit: ");
+
+  return measured;
+}
+
 uint64_t test_compiled_sr(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
 {
@@ -1829,6 +1969,106 @@ uint64_t test_volatile_assignment(
   return measured;
 }
 
+/**
+ * Times one evaluation of logic over arrays of iterations elements, .x
+ * holding 0, 1, 2, ... and .y holding 2s, of type T
+ **/
+template<typename T>
+uint64_t time_array_logic(madara::knowledge::KnowledgeBase& knowledge,
+    uint32_t iterations, const std::string& logic, const std::string& result,
+    const std::string& type)
+{
+  knowledge.clear();
+
+#ifndef _MADARA_NO_KARL_
+  // keep track of time
+  uint64_t measured(0);
+  madara::utility::Timer<Clock> timer;
+
+  std::vector<T> x(iterations), y(iterations, T(2));
+
+  for (uint32_t i = 0; i < iterations; ++i)
+  {
+    x[i] = T(i);
+  }
+
+  knowledge.set(".iterations", iterations);
+  knowledge.set(".x", x);
+  knowledge.set(".y", y);
+  knowledge.set(".z", std::vector<T>(iterations));
+
+  madara::knowledge::CompiledExpression ce;
+
+  ce = knowledge.compile(logic);
+
+  timer.start();
+
+  knowledge.evaluate(ce, madara::knowledge::EvalSettings(false, false, false));
+
+  timer.stop();
+  measured = timer.duration_ns();
+
+  print(measured, knowledge.get(result), iterations, type);
+
+  return measured;
+#else
+  return 0;
+#endif
+}
+
+/// Tests summing an integer array element by element in a KaRL loop
+uint64_t test_looped_array_sum(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  return time_array_logic<madara::knowledge::KnowledgeRecord::Integer>(
+      knowledge, iterations, ".i[0->.iterations) (.sum += .x[.i])", ".sum",
+      "Looped Array Sum: ");
+}
+
+/// Tests summing an integer array with #sum
+uint64_t test_array_sum(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  return time_array_logic<madara::knowledge::KnowledgeRecord::Integer>(
+      knowledge, iterations, ".sum = #sum (.x)", ".sum", "Array Sum: ");
+}
+
+/// Tests a double dot product computed in a KaRL loop
+uint64_t test_looped_array_dot(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  return time_array_logic<double>(knowledge, iterations,
+      ".i[0->.iterations) (.dot += .x[.i] * .y[.i])", ".dot",
+      "Looped Dot Product: ");
+}
+
+/// Tests a double dot product computed with #dot
+uint64_t test_array_dot(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  return time_array_logic<double>(
+      knowledge, iterations, ".dot = #dot (.x, .y)", ".dot", "Dot Product: ");
+}
+
+/// Tests adding double arrays element by element in a KaRL loop
+uint64_t test_looped_array_add(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  return time_array_logic<double>(knowledge, iterations,
+      ".i[0->.iterations) (.z[.i] = .x[.i] + .y[.i]);"
+      ".last = .z[.iterations - 1]",
+      ".last", "Looped Array Addition: ");
+}
+
+/// Tests adding double arrays with the array + operator
+uint64_t test_array_add(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  return time_array_logic<double>(knowledge, iterations,
+      ".z = .x + .y; .last = .z[.iterations - 1]", ".last",
+      "Array Addition: ");
+}
+
 // handle command line arguments
 void handle_arguments(int argc, char* argv[])
 {
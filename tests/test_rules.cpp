@@ -0,0 +1,218 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/RuleEngine.h"
+#include "madara/knowledge/ContextGuard.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace utility = madara::utility;
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+// number of agents in the benchmark
+const int agents = 1000;
+
+#ifndef _MADARA_NO_KARL_
+
+/// Tests that rules run only when matching keys change
+void test_patterns(void)
+{
+  std::cerr << "Testing rule key patterns...\n";
+
+  knowledge::KnowledgeBase kb;
+  knowledge::RuleEngine rules(kb);
+
+  rules.add("battery", {"agent.*.battery"}, "++battery_runs");
+  rules.add("swarm", {"swarm.*"}, "++swarm_runs");
+
+  kb.set("agent.0.battery", Integer(50));
+  rules.wait_idle();
+
+  kb.set("agent.0.position", Integer(3));
+  kb.set("agents", Integer(1));
+  kb.set("swarm.size", Integer(1));
+  rules.wait_idle();
+
+  // each rule runs once for one matching change
+  TEST_EQ(kb.get("battery_runs").to_integer(), 1);
+  TEST_EQ(kb.get("swarm_runs").to_integer(), 1);
+
+  knowledge::RuleStats stats = rules.get_stats("battery");
+  TEST_EQ(stats.triggers, (uint64_t)1);
+  TEST_EQ(stats.executions, (uint64_t)1);
+  TEST_EQ(stats.errors, (uint64_t)0);
+
+  // removing a rule succeeds only once
+  TEST_EQ(rules.remove("swarm"), true);
+  TEST_EQ(rules.remove("swarm"), false);
+
+  kb.set("swarm.size", Integer(2));
+  rules.wait_idle();
+
+  // removed rules no longer run
+  TEST_EQ(kb.get("swarm_runs").to_integer(), 1);
+  TEST_EQ(rules.rules().size(), (size_t)1);
+  TEST_EQ(std::string(rules.rules()[0]), "battery");
+}
+
+/// Tests that rules propagate results to other rules
+void test_propagation(void)
+{
+  std::cerr << "Testing propagation between rules...\n";
+
+  knowledge::KnowledgeBase kb;
+  kb.set("agent.0.battery", Integer(80));
+  kb.set("agent.1.battery", Integer(60));
+  kb.set("agent.2.battery", Integer(70));
+
+  knowledge::RuleEngine rules(kb);
+
+  rules.add("min_battery", {"agent.*.battery"},
+      "swarm.min_battery = #min (agent.0.battery, agent.1.battery, "
+      "agent.2.battery)");
+  rules.add("low_battery", {"swarm.min_battery"},
+      "swarm.low = swarm.min_battery < 50");
+
+  kb.set("agent.1.battery", Integer(40));
+  rules.wait_idle();
+
+  // low_battery runs after min_battery is recomputed
+  TEST_EQ(kb.get("swarm.min_battery").to_integer(), 40);
+  TEST_EQ(kb.get("swarm.low").to_integer(), 1);
+
+  kb.set("agent.1.battery", Integer(90));
+  rules.wait_idle();
+
+  TEST_EQ(kb.get("swarm.min_battery").to_integer(), 70);
+  TEST_EQ(kb.get("swarm.low").to_integer(), 0);
+
+  // rules may write variables matching their own patterns
+  rules.add("clamp", {"agent.*.battery"},
+      "agent.0.battery > 100 => agent.0.battery = 100");
+
+  kb.set("agent.0.battery", Integer(120));
+  rules.wait_idle();
+
+  // changes a rule makes to its inputs do not schedule it again
+  TEST_EQ(kb.get("agent.0.battery").to_integer(), 100);
+  TEST_EQ((uint64_t)rules.get_stats("clamp").executions, (uint64_t)1);
+}
+
+/// Tests that bursts of changes are coalesced into one execution
+void test_coalescing(void)
+{
+  std::cerr << "Testing coalesced scheduling...\n";
+
+  knowledge::KnowledgeBase kb;
+  knowledge::RuleEngine rules(kb);
+
+  rules.add("sum", {"value.*"}, "++sum_runs");
+
+  {
+    // holding the lock keeps the worker from running the rule
+    knowledge::ContextGuard guard(kb);
+
+    for (int i = 0; i < 100; ++i)
+    {
+      kb.set("value." + std::to_string(i), Integer(i));
+    }
+  }
+
+  rules.wait_idle();
+
+  knowledge::RuleStats stats = rules.get_stats("sum");
+
+  // each trigger either runs or is coalesced, and a burst of changes runs
+  // the rule at most twice
+  TEST_EQ(stats.triggers, (uint64_t)100);
+  TEST_EQ(stats.executions + stats.coalesced, (uint64_t)100);
+  TEST_LE(stats.executions, (uint64_t)2);
+}
+
+/// Compares periodic re-evaluation of all logic against rules
+void benchmark_rules(void)
+{
+  std::cerr << "Benchmarking rules against periodic evaluation...\n";
+
+  knowledge::KnowledgeBase kb;
+
+  for (int i = 0; i < agents; ++i)
+  {
+    kb.set("agent." + std::to_string(i) + ".battery", Integer(100));
+    kb.set("agent." + std::to_string(i) + ".position", Integer(0));
+  }
+
+  std::string logic = "swarm.min_battery = 100;"
+                      ".i[0->" +
+                      std::to_string(agents) +
+                      ") (agent.{.i}.battery < swarm.min_battery => "
+                      "swarm.min_battery = agent.{.i}.battery)";
+
+  knowledge::CompiledExpression ce = kb.compile(logic);
+
+  // periodic: re-evaluate after every update, whatever changed
+  utility::Timer<std::chrono::steady_clock> timer;
+  timer.start();
+
+  for (int i = 0; i < agents; ++i)
+  {
+    kb.set("agent." + std::to_string(i) + ".position", Integer(i));
+    kb.evaluate(ce);
+  }
+
+  timer.stop();
+  uint64_t periodic = timer.duration_ns();
+
+  // reactive: only battery changes schedule the rule
+  knowledge::RuleEngine rules(kb);
+  rules.add("min_battery", {"agent.*.battery"}, ce);
+
+  timer.start();
+
+  for (int i = 0; i < agents; ++i)
+  {
+    kb.set("agent." + std::to_string(i) + ".position", Integer(i + 1));
+  }
+
+  kb.set("agent.0.battery", Integer(10));
+  rules.wait_idle();
+
+  timer.stop();
+  uint64_t reactive = timer.duration_ns();
+
+  TEST_EQ(kb.get("swarm.min_battery").to_integer(), 10);
+
+  std::cerr << "  periodic: " << periodic << " ns, rules: " << reactive
+            << " ns, executions: "
+            << rules.get_stats("min_battery").executions << "\n";
+}
+
+#endif  // _MADARA_NO_KARL_
+
+int main(int, char**)
+{
+#ifndef _MADARA_NO_KARL_
+  test_patterns();
+  test_propagation();
+  test_coalescing();
+  benchmark_rules();
+#endif  // _MADARA_NO_KARL_
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,245 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/KnowledgeSnapshot.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace utility = madara::utility;
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+// number of records in the benchmark
+const int records = 100000;
+
+/// Tests that snapshots do not change with the context
+void test_snapshots(void)
+{
+  std::cerr << "Testing snapshots...\n";
+
+  knowledge::KnowledgeBase kb;
+  kb.set("agent.0.battery", Integer(50));
+  kb.set("agent.1.battery", Integer(60));
+  kb.set("positions", std::vector<double>{1.0, 2.0, 3.0});
+
+  knowledge::KnowledgeSnapshot::Ptr first = kb.snapshot();
+
+  kb.set("agent.0.battery", Integer(40));
+  kb.set_index("positions", 1, 5.0);
+  kb.set("agent.2.battery", Integer(70));
+
+  knowledge::KnowledgeSnapshot::Ptr second = kb.snapshot();
+
+  // the first snapshot keeps old values and does not see later records
+  TEST_EQ(first->get("agent.0.battery").to_integer(), 50);
+  TEST_EQ(first->get("positions").retrieve_index(1).to_double(), 2.0);
+  TEST_EQ(first->exists("agent.2.battery"), false);
+
+  // the second snapshot sees changed and unchanged records
+  TEST_EQ(second->get("agent.0.battery").to_integer(), 40);
+  TEST_EQ(second->get("agent.1.battery").to_integer(), 60);
+  TEST_EQ(second->get("agent.2.battery").to_integer(), 70);
+  TEST_EQ(second->get("positions").retrieve_index(1).to_double(), 5.0);
+
+  // the second snapshot is layered over the first
+  TEST_GE(second->depth(), (size_t)1);
+  TEST_LE(second->depth(), (size_t)2);
+
+  // an unchanged context returns its previous snapshot
+  TEST_EQ(kb.snapshot(), second);
+
+  // to_map copies records from every layer
+  TEST_EQ(second->to_map("agent.").size(), (size_t)3);
+
+  // earlier snapshots keep deleted records
+  kb.get_context().delete_variable("agent.1.battery");
+  TEST_EQ(kb.snapshot()->exists("agent.1.battery"), false);
+  TEST_EQ(second->exists("agent.1.battery"), true);
+}
+
+/// Tests that layers stay shallow as many snapshots are taken
+void test_layers(void)
+{
+  std::cerr << "Testing snapshot layering...\n";
+
+  knowledge::KnowledgeBase kb;
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    kb.set("var." + std::to_string(i), Integer(i));
+  }
+
+  knowledge::KnowledgeSnapshot::Ptr snapshot = kb.snapshot();
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    kb.set("var." + std::to_string(i), Integer(-i));
+    snapshot = kb.snapshot();
+  }
+
+  // layers are merged as they accumulate
+  TEST_LE(snapshot->depth(), (size_t)12);
+
+  int changed = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    if (snapshot->get("var." + std::to_string(i)).to_integer() == -i)
+    {
+      ++changed;
+    }
+  }
+
+  // the final snapshot sees every change
+  TEST_EQ(changed, 1000);
+}
+
+/// Tests that forks and their parents do not see each other's writes
+void test_forks(void)
+{
+  std::cerr << "Testing forks...\n";
+
+  knowledge::KnowledgeBase kb;
+  kb.set("agent.0.battery", Integer(50));
+  kb.set("agent.1.battery", Integer(60));
+  kb.set("agent.2.battery", Integer(70));
+  kb.set("name", "parent");
+
+  knowledge::KnowledgeBase fork = kb.fork();
+
+  // the fork sees the parent's records
+  TEST_EQ(fork.get("agent.0.battery").to_integer(), 50);
+  TEST_EQ(fork.get("name").to_string(), "parent");
+
+  fork.set("agent.0.battery", Integer(10));
+  fork.set("name", "fork");
+  fork.set("plan", Integer(1));
+
+  // the parent does not see the fork's writes
+  TEST_EQ(kb.get("agent.0.battery").to_integer(), 50);
+  TEST_EQ(kb.get("name").to_string(), "parent");
+  TEST_EQ(kb.exists("plan"), false);
+
+  // the fork does not see the parent's later writes
+  kb.set("agent.1.battery", Integer(30));
+  TEST_EQ(fork.get("agent.1.battery").to_integer(), 60);
+
+  // deleting from the fork leaves the parent's record
+  fork.get_context().delete_variable("agent.1.battery");
+  TEST_EQ(fork.exists("agent.1.battery"), false);
+  TEST_EQ(kb.exists("agent.1.battery"), true);
+
+  // agent.2.battery was never read, so it is only in the fork's snapshot
+  TEST_EQ(fork.get_context().delete_variable("agent.2.battery"), true);
+  TEST_EQ(fork.exists("agent.2.battery"), false);
+  TEST_EQ(fork.get_context().delete_variable("agent.2.battery"), false);
+
+  knowledge::KnowledgeBase partial;
+  knowledge::CopySet copy_set;
+  copy_set["agent.2.battery"] = true;
+  copy_set["name"] = true;
+  partial.copy(fork, copy_set, false);
+
+  // copying a copy set from a fork skips deleted records
+  TEST_EQ(partial.get("name").to_string(), "fork");
+  TEST_EQ(partial.exists("agent.2.battery"), false);
+  TEST_EQ(partial.exists("agent.0.battery"), false);
+
+  // to_map on the fork sees copied and uncopied records
+  TEST_EQ(fork.to_map("agent.").size(), (size_t)1);
+
+  // a deleted record can be set again in the fork
+  fork.set("agent.2.battery", Integer(5));
+  TEST_EQ(fork.get("agent.2.battery").to_integer(), 5);
+  TEST_EQ(kb.get("agent.2.battery").to_integer(), 70);
+
+#ifndef _MADARA_NO_KARL_
+  fork.evaluate("agent.0.battery += 5");
+  // KaRL logic evaluated in the fork changes only the fork
+  TEST_EQ(fork.get("agent.0.battery").to_integer(), 15);
+  TEST_EQ(kb.get("agent.0.battery").to_integer(), 50);
+#endif  // _MADARA_NO_KARL_
+
+  knowledge::KnowledgeBase nested = fork.fork();
+  nested.set("plan", Integer(2));
+
+  // forks of forks are isolated from their parents
+  TEST_EQ(nested.get("name").to_string(), "fork");
+  TEST_EQ(fork.get("plan").to_integer(), 1);
+}
+
+/// Compares a full copy against a fork when a few records change
+void benchmark_forks(void)
+{
+  std::cerr << "Benchmarking forks against full copies...\n";
+
+  knowledge::KnowledgeBase kb;
+
+  for (int i = 0; i < records; ++i)
+  {
+    kb.set("agent." + std::to_string(i) + ".battery", Integer(100));
+  }
+
+  // make the parent's snapshot current so both branches start equal
+  kb.snapshot();
+
+  utility::Timer<std::chrono::steady_clock> timer;
+
+  timer.start();
+
+  knowledge::KnowledgeBase copy;
+  knowledge::CopySet copy_set;
+  copy.copy(kb, copy_set, false);
+  copy.set("agent.0.battery", Integer(10));
+  copy.set("agent.1.battery", Integer(10));
+
+  timer.stop();
+  uint64_t copy_ns = timer.duration_ns();
+
+  timer.start();
+
+  knowledge::KnowledgeBase fork = kb.fork();
+  fork.set("agent.0.battery", Integer(10));
+  fork.set("agent.1.battery", Integer(10));
+
+  timer.stop();
+  uint64_t fork_ns = timer.duration_ns();
+
+  TEST_EQ(fork.get("agent.0.battery").to_integer(), 10);
+  TEST_EQ(kb.get("agent.0.battery").to_integer(), 100);
+
+  kb.set("agent.2.battery", Integer(10));
+
+  timer.start();
+  kb.snapshot();
+  timer.stop();
+  uint64_t snapshot_ns = timer.duration_ns();
+
+  std::cerr << "  " << records << " records: copy " << copy_ns
+            << " ns, fork " << fork_ns << " ns, snapshot after one change "
+            << snapshot_ns << " ns\n";
+}
+
+int main(int, char**)
+{
+  test_snapshots();
+  test_layers();
+  test_forks();
+  benchmark_forks();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
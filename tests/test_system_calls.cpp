@@ -14,10 +14,100 @@ typedef knowledge::KnowledgeRecord KnowledgeRecord;
 int madara_fails = 0;
 
 // command line arguments
+/// Tests the bounded compiled expression cache and #eval call sites
+void test_expression_cache(void)
+{
+#ifndef _MADARA_NO_KARL_
+  std::cerr << "Testing the compiled expression cache...\n";
+
+  knowledge::KnowledgeBase kb;
+  kb.set_expression_cache_capacity(3);
+
+  kb.evaluate("x = 1");
+  kb.evaluate("x = 2");
+  kb.evaluate("x = 3");
+  kb.evaluate("x = 1");
+
+  madara::expression::ExpressionCacheStats stats =
+      kb.get_expression_cache_stats();
+
+  if (stats.misses != 3 || stats.hits != 1 || stats.size != 3 ||
+      stats.capacity != 3)
+  {
+    std::cerr << "FAIL: expected 3 misses and 1 hit, got " << stats.misses
+              << " misses and " << stats.hits << " hits.\n";
+    ++madara_fails;
+  }
+
+  // x = 2 is now the least recently used
+  kb.evaluate("x = 4");
+  kb.evaluate("x = 1");
+  kb.evaluate("x = 2");
+
+  stats = kb.get_expression_cache_stats();
+
+  if (stats.misses != 5 || stats.hits != 2 || stats.evictions != 2 ||
+      stats.size != 3)
+  {
+    std::cerr << "FAIL: expected 5 misses, 2 hits and 2 evictions, got "
+              << stats.misses << ", " << stats.hits << " and "
+              << stats.evictions << ".\n";
+    ++madara_fails;
+  }
+
+  // evicted expressions can still be evaluated
+  knowledge::CompiledExpression ce = kb.compile("y = 5");
+  kb.set_expression_cache_capacity(0);
+  kb.evaluate(ce);
+
+  stats = kb.get_expression_cache_stats();
+
+  if (stats.size != 0 || kb.get("y").to_integer() != 5)
+  {
+    std::cerr << "FAIL: evicted expression did not evaluate.\n";
+    ++madara_fails;
+  }
+
+  // #eval compiles its argument only when the argument changes
+  kb.set_expression_cache_capacity(100);
+  kb.set("logic", "z += 1");
+
+  ce = kb.compile("#eval(logic)");
+
+  stats = kb.get_expression_cache_stats();
+  uint64_t misses = stats.misses;
+  uint64_t hits = stats.hits;
+
+  kb.evaluate(ce);
+  kb.evaluate(ce);
+  kb.evaluate(ce);
+
+  kb.set("logic", "z += 10");
+  kb.evaluate(ce);
+
+  stats = kb.get_expression_cache_stats();
+
+  if (kb.get("z").to_integer() != 13 || stats.misses != misses + 2 ||
+      stats.hits != hits)
+  {
+    std::cerr << "FAIL: #eval gave z=" << kb.get("z").to_integer()
+              << " with " << stats.misses - misses << " compiles and "
+              << stats.hits - hits << " cache lookups.\n";
+    ++madara_fails;
+  }
+  else
+  {
+    std::cerr << "SUCCESS: expression cache is bounded and #eval reuses "
+                 "its compiled argument.\n";
+  }
+#endif
+}
+
 int parse_args(int argc, char* argv[]);
 
 // test functions
 void test_system_calls(madara::knowledge::KnowledgeBase& knowledge);
+void test_expression_cache(void);
 
 int main(int argc, char* argv[])
 {
@@ -29,6 +119,7 @@ int main(int argc, char* argv[])
   madara::knowledge::KnowledgeBase knowledge;
 
   test_system_calls(knowledge);
+  test_expression_cache();
 
   knowledge.print();
 
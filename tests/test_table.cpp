@@ -0,0 +1,321 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/Table.h"
+#include "madara/knowledge/containers/FlexMap.h"
+#include "madara/exceptions/NameException.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace containers = knowledge::containers;
+namespace utility = madara::utility;
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+// number of agents in the benchmark
+const int agents = 1000;
+
+containers::Table::Columns agent_columns(void)
+{
+  return {{"id", containers::Table::INTEGER},
+      {"x", containers::Table::DOUBLE}, {"y", containers::Table::DOUBLE}};
+}
+
+/// Joins the names of the records queued to send with spaces
+std::string modified_names(knowledge::KnowledgeBase& kb)
+{
+  std::string result;
+
+  for (const auto& modified : kb.get_context().get_modifieds())
+  {
+    result += (result.empty() ? "" : " ") + std::string(modified.first);
+  }
+
+  return result;
+}
+
+/// Joins numbers with spaces
+template<typename T>
+std::string join(const std::vector<T>& values)
+{
+  std::ostringstream result;
+
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    result << (i == 0 ? "" : " ") << values[i];
+  }
+
+  return result.str();
+}
+
+/// Checks that columns are stored as native arrays
+void test_columns(void)
+{
+  knowledge::KnowledgeBase kb;
+  containers::Table table("swarm", kb, agent_columns(), 4);
+
+  // each column is one native array record
+  TEST_EQ(table.size(), (size_t)4);
+  TEST_EQ(kb.get("swarm.id").type(),
+      (uint32_t)knowledge::KnowledgeRecord::INTEGER_ARRAY);
+  TEST_EQ(kb.get("swarm.x").type(),
+      (uint32_t)knowledge::KnowledgeRecord::DOUBLE_ARRAY);
+  TEST_EQ(kb.get("swarm.x").size(), (uint32_t)4);
+
+  // columns are found by name
+  TEST_EQ(table.column("id"), (size_t)0);
+  TEST_EQ(table.column("y"), (size_t)2);
+  EXPECT_EXCEPTION(
+      madara::exceptions::NameException, table.column("z"););
+
+  // tables refer to existing columns without resizing them
+  containers::Table existing("swarm", kb, agent_columns());
+  TEST_EQ(existing.size(), (size_t)4);
+  TEST_EQ(existing.exists(), true);
+}
+
+/// Checks row and cell access
+void test_rows(void)
+{
+  knowledge::KnowledgeBase kb;
+  containers::Table table("swarm", kb, agent_columns(), 2);
+
+  size_t x = table.column("x");
+
+  table.set(0, 0, Integer(7));
+  table.set(0, x, 1.5);
+  table.set(1, 0, 2.9);
+
+  // cells keep the type of their column
+  TEST_EQ(table.to_integer(0, 0), 7);
+  TEST_EQ(table.to_double(0, x), 1.5);
+  TEST_EQ(table.to_integer(1, 0), 2);
+  TEST_EQ(kb.get("swarm.id").type(),
+      (uint32_t)knowledge::KnowledgeRecord::INTEGER_ARRAY);
+
+  // cells outside the table are not set
+  TEST_EQ(table.set(2, x, 1.0), -1);
+  TEST_EQ(table.set(0, 3, 1.0), -1);
+  TEST_EQ(table.to_double(5, x), 0.0);
+
+  knowledge::KnowledgeVector row;
+  row.push_back(knowledge::KnowledgeRecord(Integer(3)));
+  row.push_back(knowledge::KnowledgeRecord(4.5));
+  row.push_back(knowledge::KnowledgeRecord(5.5));
+
+  TEST_EQ(table.set_row(1, row), 0);
+
+  knowledge::KnowledgeVector read = table.get_row(1);
+
+  TEST_EQ(read.size(), (size_t)3);
+  TEST_EQ(read[0].to_integer(), 3);
+  TEST_EQ(read[1].to_double(), 4.5);
+  TEST_EQ(read[2].to_double(), 5.5);
+
+  // push_back appends a row
+  TEST_EQ(table.push_back(row), (size_t)2);
+  TEST_EQ(table.size(), (size_t)3);
+  TEST_EQ(table.to_double(2, 2), 5.5);
+
+  // whole columns are set if their size matches
+  TEST_EQ(table.set_column(x, std::vector<double>({1, 2, 3})), 0);
+  TEST_EQ(join(table.to_doubles(x)), "1 2 3");
+  TEST_EQ(table.set_column(x, std::vector<double>({1, 2})), -1);
+
+  // resize changes every column
+  table.resize(1);
+  TEST_EQ(table.size(), (size_t)1);
+  TEST_EQ(kb.get("swarm.y").size(), (uint32_t)1);
+  TEST_EQ(table.get_row(1).empty(), true);
+}
+
+/// Checks dirty rows and which records are sent
+void test_dirty(void)
+{
+  knowledge::KnowledgeBase kb;
+  containers::Table table("swarm", kb, agent_columns(), 8);
+
+  // new rows are dirty
+  TEST_EQ(table.get_dirty_rows().size(), (size_t)8);
+
+  table.clear_dirty();
+  kb.get_context().reset_modified();
+
+  size_t x = table.column("x");
+
+  table.set(5, x, 1.0);
+  table.set(2, x, 2.0);
+  table.set(5, x, 3.0);
+
+  // written rows are dirty
+  TEST_EQ(join(table.get_dirty_rows()), "2 5");
+  TEST_EQ(table.is_dirty(5), true);
+  TEST_EQ(table.is_dirty(3), false);
+
+  // only changed columns are marked for sending
+  TEST_EQ(modified_names(kb), "swarm.x");
+
+  // publishing writes the dirty rows and clears them
+  TEST_EQ(table.publish_dirty(), (size_t)2);
+  TEST_EQ(join(kb.get("swarm.dirty").to_integers()), "2 5");
+  TEST_EQ(table.get_dirty_rows().empty(), true);
+
+  // dirty rows are sent with the changed columns
+  TEST_EQ(modified_names(kb), "swarm.dirty swarm.x");
+
+  // publishing without dirty rows sends nothing
+  kb.get_context().reset_modified();
+  TEST_EQ(table.publish_dirty(), (size_t)0);
+  TEST_EQ(modified_names(kb), "");
+
+  // modify resends every column
+  table.modify();
+  TEST_EQ(modified_names(kb), "swarm.id swarm.x swarm.y");
+}
+
+/// Checks column scans
+void test_scans(void)
+{
+  knowledge::KnowledgeBase kb;
+  containers::Table table("swarm", kb, agent_columns(), 5);
+
+  size_t id = table.column("id");
+  size_t x = table.column("x");
+  size_t y = table.column("y");
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    table.set(i, id, Integer(i + 1));
+    table.set(i, x, i * 0.5);
+    table.set(i, y, 2.0);
+  }
+
+  // columns are summed, searched and averaged
+  TEST_EQ(table.sum(id).type(), (uint32_t)knowledge::KnowledgeRecord::INTEGER);
+  TEST_EQ(table.sum(id).to_integer(), 15);
+  TEST_EQ(table.sum(x).to_double(), 5.0);
+  TEST_EQ(table.min(id).to_integer(), 1);
+  TEST_EQ(table.max(x).to_double(), 2.0);
+  TEST_EQ(table.mean(id), 3.0);
+
+  // dot products of integer, double and mixed columns
+  TEST_EQ(table.dot(id, id).to_integer(), 55);
+  TEST_EQ(table.dot(x, y).to_double(), 10.0);
+  TEST_EQ(table.dot(id, y).to_double(), 30.0);
+
+  // select finds the rows within a range
+  TEST_EQ(join(table.select(x, 0.5, 1.5)), "1 2 3");
+  TEST_EQ(table.select(id, 6, 10).empty(), true);
+
+  // shared columns are not changed by later writes
+  auto shared = table.share_doubles(x);
+  table.set(0, x, 100.0);
+
+  TEST_EQ((bool)shared, true);
+  TEST_EQ((*shared)[0], 0.0);
+  TEST_EQ(table.to_double(0, x), 100.0);
+  TEST_EQ((bool)table.share_integers(x), false);
+
+  // scans of empty tables
+  containers::Table empty("none", kb, agent_columns(), 0);
+
+  TEST_EQ(empty.min(x).exists(), false);
+  TEST_EQ(empty.mean(x), 0.0);
+  TEST_EQ(empty.sum(id).to_integer(), 0);
+}
+
+/// Compares a table against the FlexMap layout of agent.{i}.{column}
+void benchmark_flexmap(void)
+{
+  std::cerr << "Benchmarking a table against a FlexMap of " << agents
+            << " agents...\n";
+
+  knowledge::KnowledgeBase flex_kb;
+  knowledge::KnowledgeBase table_kb;
+  containers::FlexMap map("agent", flex_kb);
+  containers::Table table("agent", table_kb, agent_columns(), agents);
+
+  size_t x = table.column("x");
+  utility::Timer<std::chrono::steady_clock> timer;
+
+  timer.start();
+
+  for (int i = 0; i < agents; ++i)
+  {
+    map[i]["x"] = i * 0.25;
+  }
+
+  timer.stop();
+  uint64_t flex_write_ns = timer.duration_ns();
+
+  timer.start();
+
+  for (int i = 0; i < agents; ++i)
+  {
+    table.set(i, x, i * 0.25);
+  }
+
+  timer.stop();
+  uint64_t table_write_ns = timer.duration_ns();
+
+  timer.start();
+
+  double flex_sum = 0;
+  size_t flex_selected = 0;
+
+  for (int i = 0; i < agents; ++i)
+  {
+    double value = map[i]["x"].to_double();
+    flex_sum += value;
+
+    if (value >= 10 && value <= 20)
+    {
+      ++flex_selected;
+    }
+  }
+
+  timer.stop();
+  uint64_t flex_scan_ns = timer.duration_ns();
+
+  timer.start();
+
+  double table_sum = table.sum(x).to_double();
+  size_t table_selected = table.select(x, 10, 20).size();
+
+  timer.stop();
+  uint64_t table_scan_ns = timer.duration_ns();
+
+  TEST_EQ(flex_sum, table_sum);
+  TEST_EQ(flex_selected, table_selected);
+
+  std::cerr << "  write x of every agent: FlexMap " << flex_write_ns / 1000
+            << " us, Table " << table_write_ns / 1000 << " us\n";
+  std::cerr << "  sum and select x: FlexMap " << flex_scan_ns / 1000
+            << " us, Table " << table_scan_ns / 1000 << " us\n";
+}
+
+int main(int, char**)
+{
+  test_columns();
+  test_rows();
+  test_dirty();
+  test_scans();
+  benchmark_flexmap();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -11,12 +11,18 @@
 #include <chrono>
 
 #include "madara/utility/Utility.h"
+#include "madara/utility/Crc32c.h"
 
 #include "madara/utility/Timer.h"
 #include "madara/knowledge/FileFragmenter.h"
+#include "madara/knowledge/FileRequester.h"
+#include "madara/knowledge/FileStreamer.h"
+#include "madara/filters/FragmentsToFilesFilter.h"
 #include "madara/utility/NamedVectorCombinator.h"
 
 namespace knowledge = madara::knowledge;
+namespace filters = madara::filters;
+namespace transport = madara::transport;
 namespace utility = madara::utility;
 namespace sc = std::chrono;
 
@@ -566,6 +572,209 @@ void test_file_crc(void)
   }
 }
 
+void test_crc32c(void)
+{
+  std::cerr << "Testing crc32c (accelerated="
+            << utility::crc32c_is_accelerated() << ")...";
+
+  // the standard check value for CRC-32C
+  const char* check = "123456789";
+
+  std::vector<unsigned char> buffer(100003);
+  for(size_t i = 0; i < buffer.size(); ++i)
+  {
+    buffer[i] = (unsigned char)(i * 2654435761u >> 24);
+  }
+
+  bool matches = utility::crc32c(check, 9) == 0xE3069283 &&
+                 utility::crc32c_portable(check, 9) == 0xE3069283;
+
+  // unaligned starts, odd lengths, and checksums built up in pieces
+  for(size_t offset = 0; offset < 9; ++offset)
+  {
+    size_t size = buffer.size() - offset;
+    uint32_t whole = utility::crc32c(buffer.data() + offset, size);
+    uint32_t first = utility::crc32c(buffer.data() + offset, size / 3);
+    uint32_t pieces = utility::crc32c(
+        buffer.data() + offset + size / 3, size - size / 3, first);
+
+    if(whole != pieces ||
+        whole != utility::crc32c_portable(buffer.data() + offset, size))
+    {
+      matches = false;
+    }
+  }
+
+  if(matches)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+}
+
+void test_resumable_transfer(void)
+{
+  std::cerr << "Testing resumable file transfer...\n";
+
+  std::string source = utility::expand_envs(
+      "$(MADARA_ROOT)/tests/images/manaus_hotel_450x750.jpg");
+  std::string directory = "test_utility_transfer";
+  std::string target = directory + "/manaus.jpg";
+
+  knowledge::KnowledgeBase sender;
+  knowledge::FileStreamer streamer("files.manaus.jpg", source, sender);
+
+  size_t num_fragments = (streamer.get_size() + 59999) / 60000;
+
+  knowledge::KnowledgeBase receiver;
+  filters::FragmentsToFilesFilter filter;
+  filter.set_dir_mapping("files", directory);
+  transport::TransportContext context;
+  knowledge::Variables vars(&receiver.get_context());
+
+  // sends a fragment through the filter, optionally corrupting it
+  auto send = [&](size_t index, bool corrupt) {
+    streamer.load(index);
+
+    std::string name = std::to_string(index);
+    knowledge::KnowledgeMap records;
+    records["files.manaus.jpg.crc"] = sender.get("files.manaus.jpg.crc");
+    records["files.manaus.jpg.size"] = sender.get("files.manaus.jpg.size");
+    records["files.manaus.jpg.checksums." + name] =
+        sender.get("files.manaus.jpg.checksums." + name);
+
+    knowledge::KnowledgeRecord contents =
+        sender.get("files.manaus.jpg.contents." + name);
+
+    if(corrupt)
+    {
+      size_t size;
+      unsigned char* bytes = contents.to_unmanaged_buffer(size);
+      bytes[size / 2] ^= 0xff;
+      contents.set_file(bytes, size);
+      delete[] bytes;
+    }
+
+    records["files.manaus.jpg.contents." + name] = contents;
+    filter.filter(records, context, vars);
+
+    streamer.clear_fragments();
+  };
+
+  receiver.set("files.manaus.jpg.crc",
+      (knowledge::KnowledgeRecord::Integer)streamer.get_crc());
+  receiver.set("files.manaus.jpg.size",
+      (knowledge::KnowledgeRecord::Integer)streamer.get_size());
+
+  // lose fragment 1 and corrupt fragment 2 in transit
+  for(size_t i = 0; i < num_fragments; ++i)
+  {
+    if(i != 1)
+    {
+      send(i, i == 2);
+    }
+  }
+
+  std::cerr << "  Requesting lost and corrupt fragments... ";
+
+  std::vector<int64_t> request;
+  {
+    knowledge::FileRequester requester(
+        "files.manaus.jpg", "sync", target, receiver);
+    request = requester.build_fragment_request();
+  }
+
+  if(num_fragments == 4 && request == std::vector<int64_t>({1, 2}))
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL. Requested " << request.size() << " fragments\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "  Resuming after a saved fragment is damaged... ";
+
+  {
+    std::fstream damage(target + ".0." +
+                            std::to_string((unsigned long)streamer.get_crc()) +
+                            ".frag",
+        std::ios::in | std::ios::out | std::ios::binary);
+    damage.seekp(100);
+    damage.put('X');
+  }
+
+  knowledge::FileRequester requester(
+      "files.manaus.jpg", "sync", target, receiver);
+  request = requester.build_fragment_request();
+
+  if(request == std::vector<int64_t>({0, 1, 2}))
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL. Requested " << request.size() << " fragments\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "  Completing transfer with requested fragments... ";
+
+  for(auto index : request)
+  {
+    send((size_t)index, false);
+  }
+
+  request = requester.build_fragment_request();
+
+  if(request.empty() && requester.get_percent_complete() == 100 &&
+      utility::file_crc(target) == streamer.get_crc())
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL. " << requester.get_percent_complete()
+              << "% complete\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "  Receiving fragments again... ";
+
+  send(0, false);
+  send(num_fragments - 1, false);
+
+  std::ifstream manifest(
+      utility::get_fragment_manifest_name(target, streamer.get_crc()));
+  std::string line;
+  size_t lines = 0;
+
+  while(std::getline(manifest, line))
+  {
+    ++lines;
+  }
+
+  if(lines == num_fragments)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL. Manifest has " << lines << " lines\n";
+    ++madara_fails;
+  }
+
+  manifest.close();
+  requester.clear_fragments();
+  remove(target.c_str());
+  boost::filesystem::remove_all(directory);
+}
+
 void test_file_fragmenter(void)
 {
   std::cerr << "Testing FileFragmenter...\n";
@@ -896,6 +1105,8 @@ int main(int argc, char** argv)
   test_sleep();
   test_file_fragmenter();
   test_file_crc();
+  test_crc32c();
+  test_resumable_transfer();
   test_named_vector_combinator();
 
   if(madara_fails > 0)
@@ -0,0 +1,438 @@
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <memory>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/loopback/LoopbackTransport.h"
+#include "madara/filters/BatchFilter.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+#include "../test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+
+// number of updates in the throughput benchmark
+const int updates = 10000;
+
+/**
+ * A group of knowledge bases connected by a loopback network
+ **/
+struct Cluster
+{
+  Cluster(size_t size, const transport::NetworkEmulatorSettings& conditions,
+      transport::QoSTransportSettings settings =
+          transport::QoSTransportSettings())
+    : network(std::make_shared<transport::LoopbackNetwork>(conditions)),
+      kbs(size)
+  {
+    for (size_t i = 0; i < size; ++i)
+    {
+      kbs[i].attach_transport(new transport::LoopbackTransport(
+          "agent" + std::to_string(i), kbs[i].get_context(), settings,
+          network));
+    }
+  }
+
+  std::shared_ptr<transport::LoopbackNetwork> network;
+  std::vector<knowledge::KnowledgeBase> kbs;
+};
+
+void test_latency(void)
+{
+  std::cerr << "Testing delivery and latency...\n";
+
+  transport::NetworkEmulatorSettings conditions;
+  conditions.latency = 0.05;
+
+  Cluster cluster(3, conditions);
+
+  cluster.kbs[0].set("x", knowledge::KnowledgeRecord::Integer(5));
+  cluster.kbs[0].send_modifieds();
+
+  cluster.network->advance(0.04);
+
+  // nothing arrives before the latency
+  TEST_EQ(cluster.kbs[1].exists("x"), false);
+  TEST_EQ(cluster.kbs[2].exists("x"), false);
+
+  cluster.network->advance(0.02);
+
+  TEST_EQ(cluster.kbs[1].get("x").to_integer(), 5);
+  TEST_EQ(cluster.kbs[2].get("x").to_integer(), 5);
+
+  // two datagrams delivered with 50ms latency each
+  TEST_EQ(cluster.network->get_delivered(), (uint64_t)2);
+  TEST_GT(cluster.network->get_total_latency(), 0.099);
+  TEST_LT(cluster.network->get_total_latency(), 0.101);
+}
+
+void test_fragments_and_mtu(void)
+{
+  std::cerr << "Testing fragmentation and MTU...\n";
+
+  transport::QoSTransportSettings settings;
+  settings.max_fragment_size = 8000;
+
+  transport::NetworkEmulatorSettings conditions;
+  conditions.mtu = 9000;
+
+  Cluster cluster(2, conditions, settings);
+
+  cluster.kbs[0].set("image", std::string(100000, 'x'));
+  cluster.kbs[0].send_modifieds();
+  cluster.network->flush();
+
+  // fragments within the MTU are reassembled
+  TEST_EQ(cluster.kbs[1].get("image").to_string().size(), (size_t)100000);
+  TEST_EQ(cluster.network->get_lost(), (uint64_t)0);
+
+  // fragments carry a header on top of max_fragment_size
+  conditions.mtu = 8000;
+  cluster.network->set_settings(conditions);
+
+  cluster.kbs[0].set("image", std::string(100000, 'y'));
+  cluster.kbs[0].send_modifieds();
+  cluster.network->flush();
+
+  // datagrams larger than the MTU are dropped
+  TEST_EQ((char)cluster.kbs[1].get("image").to_string()[0], 'x');
+  TEST_GT(cluster.network->get_lost(), (uint64_t)0);
+}
+
+void test_bandwidth(void)
+{
+  std::cerr << "Testing bandwidth cap...\n";
+
+  transport::NetworkEmulatorSettings conditions;
+  conditions.bandwidth = 100000;
+
+  Cluster cluster(2, conditions);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    cluster.kbs[0].set("payload", std::string(10000, (char)('a' + i)));
+    cluster.kbs[0].send_modifieds();
+  }
+
+  cluster.network->flush();
+
+  // 100KB at 100KB/s takes at least a second to leave the sender
+  TEST_GE(cluster.network->get_time(), 1.0);
+  TEST_LT(cluster.network->get_time(), 1.1);
+
+  // the last message is delivered
+  TEST_EQ((char)cluster.kbs[1].get("payload").to_string()[0], 'j');
+}
+
+/**
+ * Sends numbered updates from the first agent through lossy conditions
+ * @return  a summary of what each agent received and the network stats
+ **/
+std::string run_lossy(uint64_t seed)
+{
+  transport::NetworkEmulatorSettings conditions;
+  conditions.latency = 0.02;
+  conditions.jitter = 0.01;
+  conditions.latency_distribution = transport::LATENCY_NORMAL;
+  conditions.loss_rate = 0.1;
+  conditions.loss_burst = 3;
+  conditions.reorder_rate = 0.1;
+  conditions.seed = seed;
+
+  Cluster cluster(3, conditions);
+
+  for (int i = 0; i < 200; ++i)
+  {
+    cluster.kbs[0].set("counter", knowledge::KnowledgeRecord::Integer(i));
+    cluster.kbs[0].set("sample." + std::to_string(i),
+        knowledge::KnowledgeRecord::Integer(i));
+    cluster.kbs[0].send_modifieds();
+    cluster.network->advance(0.005);
+  }
+
+  cluster.network->flush();
+
+  std::stringstream summary;
+  for (size_t i = 1; i < cluster.kbs.size(); ++i)
+  {
+    summary << cluster.kbs[i].to_map("sample.").size() << ",";
+  }
+
+  summary << cluster.network->get_delivered() << ","
+          << cluster.network->get_lost() << ","
+          << cluster.network->get_total_latency();
+
+  return summary.str();
+}
+
+void test_reproducible(void)
+{
+  std::cerr << "Testing reproducibility...\n";
+
+  std::string first = run_lossy(42);
+  std::string second = run_lossy(42);
+  std::string other = run_lossy(7);
+
+  TEST_EQ(first, second);
+  TEST_NE(first, other);
+}
+
+void test_rebroadcast(void)
+{
+  std::cerr << "Testing rebroadcast...\n";
+
+  transport::NetworkEmulatorSettings conditions;
+  conditions.latency = 0.01;
+
+  Cluster direct(3, conditions);
+
+  direct.kbs[0].set("x", knowledge::KnowledgeRecord::Integer(1));
+  direct.kbs[0].send_modifieds();
+  direct.network->flush();
+
+  // receivers pass the update on once
+  transport::QoSTransportSettings settings;
+  settings.set_rebroadcast_ttl(2);
+  settings.enable_participant_ttl(2);
+
+  Cluster relayed(3, conditions, settings);
+
+  relayed.kbs[0].set("x", knowledge::KnowledgeRecord::Integer(1));
+  relayed.kbs[0].send_modifieds();
+  relayed.network->flush();
+
+  // receivers rebroadcast the update
+  TEST_GT(relayed.network->get_delivered(), direct.network->get_delivered());
+  TEST_EQ(relayed.kbs[2].get("x").to_integer(), 1);
+}
+
+/**
+ * Floods one update through a full mesh of rebroadcasters
+ * @return  the datagrams delivered
+ **/
+uint64_t flood(const transport::QoSTransportSettings& settings)
+{
+  transport::NetworkEmulatorSettings conditions;
+  conditions.latency = 0.01;
+  conditions.jitter = 0.005;
+  conditions.latency_distribution = transport::LATENCY_UNIFORM;
+  conditions.seed = 3;
+
+  Cluster mesh(5, conditions, settings);
+
+  mesh.kbs[0].set("x", knowledge::KnowledgeRecord::Integer(1));
+  mesh.kbs[0].send_modifieds();
+  mesh.network->flush();
+
+  for (size_t i = 1; i < mesh.kbs.size(); ++i)
+  {
+    if (mesh.kbs[i].get("x") != knowledge::KnowledgeRecord::Integer(1))
+    {
+      return 0;
+    }
+  }
+
+  return mesh.network->get_delivered();
+}
+
+void test_duplicate_suppression(void)
+{
+  std::cerr << "Testing duplicate suppression...\n";
+
+  transport::QoSTransportSettings settings;
+  settings.set_rebroadcast_ttl(3);
+  settings.enable_participant_ttl(3);
+  settings.set_duplicate_window(0);
+
+  uint64_t flooded = flood(settings);
+
+  settings.set_duplicate_window(5);
+
+  uint64_t suppressed = flood(settings);
+
+  // duplicate suppression reduces relays and still reaches everyone
+  TEST_GT(suppressed, (uint64_t)0);
+  TEST_GT(flooded, suppressed);
+
+  // a rebroadcast probability of 0 stops relays
+  settings.set_rebroadcast_probability(0);
+  TEST_EQ(flood(settings), (uint64_t)4);
+
+  settings.set_rebroadcast_probability(0.5);
+  settings.set_rebroadcast_seed(11);
+
+  // a rebroadcast seed makes probabilistic relays reproducible
+  uint64_t first = flood(settings);
+  TEST_GT(first, (uint64_t)4);
+  TEST_EQ(flood(settings), first);
+}
+
+/**
+ * Batch send filter that decrements integers, drops strings and adds
+ * the number of records it saw
+ **/
+class SendBatchFilter : public madara::filters::BatchFilter
+{
+public:
+  void filter(madara::filters::RecordBatch& records,
+      transport::TransportContext&, knowledge::Variables&) override
+  {
+    knowledge::KnowledgeRecord::Integer seen =
+        (knowledge::KnowledgeRecord::Integer)records.size();
+
+    for (auto& record : records)
+    {
+      if (record.second.type() == knowledge::KnowledgeRecord::INTEGER)
+      {
+        record.second =
+            knowledge::KnowledgeRecord(record.second.to_integer() - 1);
+      }
+      else if (record.second.type() == knowledge::KnowledgeRecord::STRING)
+      {
+        record.second.clear_value();
+      }
+    }
+
+    records["batch.sent"] = knowledge::KnowledgeRecord(seen);
+  }
+};
+
+/**
+ * Batch receive filter that counts the records it saw and erases
+ * records with a .local suffix
+ **/
+class ReceiveBatchFilter : public madara::filters::BatchFilter
+{
+public:
+  void filter(madara::filters::RecordBatch& records,
+      transport::TransportContext&, knowledge::Variables&) override
+  {
+    received += records.size();
+
+    for (auto i = records.begin(); i != records.end();)
+    {
+      if (madara::utility::ends_with(i->first, ".local"))
+      {
+        i = records.erase(i);
+      }
+      else
+      {
+        ++i;
+      }
+    }
+  }
+
+  size_t received = 0;
+};
+
+void test_batch_filters(void)
+{
+  std::cerr << "Testing batch filters...\n";
+
+  SendBatchFilter send_filter;
+  ReceiveBatchFilter receive_filter;
+
+  transport::QoSTransportSettings settings;
+  settings.add_send_filter(&send_filter);
+  settings.add_receive_filter(&receive_filter);
+
+  transport::NetworkEmulatorSettings conditions;
+  conditions.latency = 0.01;
+
+  Cluster cluster(2, conditions, settings);
+
+  cluster.kbs[0].set("x", knowledge::KnowledgeRecord::Integer(5));
+  cluster.kbs[0].set("y", 2.5);
+  cluster.kbs[0].set("name", "agent0");
+  cluster.kbs[0].set("x.local", knowledge::KnowledgeRecord::Integer(7));
+  cluster.kbs[0].send_modifieds();
+  cluster.network->flush();
+
+  // the send filter changed and dropped records before encoding
+  TEST_EQ(cluster.kbs[1].get("x").to_integer(), 4);
+  TEST_EQ(cluster.kbs[1].get("y").to_double(), 2.5);
+  TEST_EQ(cluster.kbs[1].exists("name"), false);
+  TEST_EQ(cluster.kbs[1].get("batch.sent").to_integer(), 4);
+
+  // the receive filter saw every record that was sent in one batch
+  TEST_EQ(receive_filter.received, (size_t)4);
+  TEST_EQ(cluster.kbs[1].exists("x.local"), false);
+
+  // the sender's own records are unchanged
+  TEST_EQ(cluster.kbs[0].get("x").to_integer(), 5);
+  TEST_EQ(cluster.kbs[0].get("name").to_string(), std::string("agent0"));
+}
+
+void benchmark_throughput(void)
+{
+  std::cerr << "Benchmarking throughput...\n";
+
+  transport::NetworkEmulatorSettings conditions;
+  conditions.latency = 0.001;
+  conditions.loss_rate = 0.01;
+  conditions.seed = 1;
+
+  Cluster cluster(3, conditions);
+
+  int64_t start = madara::utility::get_time();
+
+  for (int i = 0; i < updates; ++i)
+  {
+    cluster.kbs[0].set("value", knowledge::KnowledgeRecord::Integer(i));
+    cluster.kbs[0].send_modifieds();
+
+    if (i % 100 == 0)
+    {
+      cluster.network->advance(0.001);
+    }
+  }
+
+  cluster.network->flush();
+
+  double seconds = (madara::utility::get_time() - start) / 1000000000.0;
+  uint64_t delivered = cluster.network->get_delivered();
+
+  std::cerr << "  " << updates << " updates to 2 peers in " << seconds
+            << "s: " << (seconds > 0 ? updates / seconds : 0)
+            << " updates/s, " << delivered << " datagrams delivered, "
+            << cluster.network->get_lost() << " lost, mean latency "
+            << (delivered > 0 ?
+                       cluster.network->get_total_latency() / delivered :
+                       0)
+            << "s\n";
+
+  // the last update reaches a peer unless the network lost it
+  TEST_EQ(cluster.kbs[1].get("value").to_integer() == updates - 1 ||
+              cluster.kbs[2].get("value").to_integer() == updates - 1 ||
+              cluster.network->get_lost() > 0,
+      true);
+}
+
+int main(int, char**)
+{
+  test_latency();
+  test_fragments_and_mtu();
+  test_bandwidth();
+  test_reproducible();
+  test_rebroadcast();
+  test_duplicate_suppression();
+  test_batch_filters();
+  benchmark_throughput();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
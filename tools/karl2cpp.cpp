@@ -0,0 +1,310 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/expression/CppGenerator.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+namespace knowledge = madara::knowledge;
+namespace expression = madara::expression;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+/// a piece of logic to generate a function from
+struct Logic
+{
+  std::string name;
+  std::string source;
+};
+
+std::vector<Logic> logics;
+std::string output("karl_logic");
+std::string namespace_name("karl");
+bool strict(false);
+
+// converts a file name into a C++ identifier
+std::string function_name(const std::string& filename)
+{
+  std::string name = utility::extract_filename(filename);
+
+  size_t dot = name.find('.');
+  if (dot != std::string::npos)
+  {
+    name.resize(dot);
+  }
+
+  for (char& c : name)
+  {
+    if (!isalnum(static_cast<unsigned char>(c)))
+    {
+      c = '_';
+    }
+  }
+
+  if (name.size() == 0 || isdigit(static_cast<unsigned char>(name[0])))
+  {
+    name = "_" + name;
+  }
+
+  return name;
+}
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-i" || arg1 == "--input")
+    {
+      if (i + 1 < argc)
+      {
+        Logic logic;
+        logic.name = function_name(argv[i + 1]);
+        logic.source = utility::file_to_string(argv[i + 1]);
+        logics.push_back(logic);
+      }
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+
+        logger::global_logger->set_level(level);
+      }
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--namespace")
+    {
+      if (i + 1 < argc)
+      {
+        namespace_name = argv[i + 1];
+      }
+      ++i;
+    }
+    else if (arg1 == "-o" || arg1 == "--output")
+    {
+      if (i + 1 < argc)
+      {
+        output = argv[i + 1];
+      }
+      ++i;
+    }
+    else if (arg1 == "-s" || arg1 == "--strict")
+    {
+      strict = true;
+    }
+    else if (arg1 == "-x" || arg1 == "--expression")
+    {
+      if (i + 2 < argc)
+      {
+        Logic logic;
+        logic.name = argv[i + 1];
+        logic.source = argv[i + 2];
+        logics.push_back(logic);
+      }
+      i += 2;
+    }
+    else
+    {
+      std::cerr
+          << "\nProgram summary for " << argv[0]
+          << " [options]:\n\n"
+             "Generates C++ functions from KaRL logic. Each function can be\n"
+             "defined in a knowledge base with define_function and gives the\n"
+             "same results as interpreting the logic, without parsing it or\n"
+             "walking an expression tree.\n"
+             "\noptions:\n"
+             "  [-i|--input file]        KaRL file to generate a function\n"
+             "                           from, named after the file\n"
+             "  [-l|--level level]       the logger level (0+, higher is\n"
+             "                           higher detail)\n"
+             "  [-n|--namespace name]    namespace of the generated code.\n"
+             "                           Default is karl.\n"
+             "  [-o|--output path]       path of the generated files, without\n"
+             "                           extension. Writes path.h and\n"
+             "                           path.cpp. Default is karl_logic.\n"
+             "  [-s|--strict]            fail if logic uses constructs that\n"
+             "                           cannot be generated, instead of\n"
+             "                           interpreting that logic at runtime\n"
+             "  [-x|--expression name logic] KaRL logic to generate a\n"
+             "                           function from\n"
+             "\n";
+      exit(0);
+    }
+  }
+}
+
+bool write_header(void)
+{
+  std::string filename(output + ".h");
+  std::ofstream header(filename.c_str());
+
+  if (!header.is_open())
+  {
+    std::cerr << "ERROR: Unable to open " << filename << " for writing\n";
+    return false;
+  }
+
+  std::string guard = "_" + function_name(output) + "_H_";
+  utility::upper(guard);
+
+  header << "#ifndef " << guard << "\n";
+  header << "#define " << guard << "\n\n";
+  header << "/**\n";
+  header << " * @file " << utility::extract_filename(filename) << "\n";
+  header << " *\n";
+  header << " * Generated by karl2cpp. Do not edit.\n";
+  header << " **/\n\n";
+  header << "#include \"madara/knowledge/KnowledgeBase.h\"\n";
+  header << "#include \"madara/knowledge/GeneratedLogic.h\"\n\n";
+  header << "namespace " << namespace_name << "\n{\n";
+
+  for (const Logic& logic : logics)
+  {
+    header << "madara::knowledge::KnowledgeRecord " << logic.name << "(\n";
+    header << "    madara::knowledge::FunctionArguments& args,\n";
+    header << "    madara::knowledge::Variables& vars);\n\n";
+  }
+
+  header << "/// the generated functions, in the order they were given\n";
+  header << "extern const madara::knowledge::GeneratedFunction "
+            "functions[];\n\n";
+  header << "/// the number of generated functions\n";
+  header << "extern const size_t num_functions;\n\n";
+  header << "/**\n";
+  header << " * Defines every generated function in a knowledge base\n";
+  header << " * @param  kb   the knowledge base\n";
+  header << " **/\n";
+  header << "void define_functions(madara::knowledge::KnowledgeBase& kb);\n";
+  header << "}\n\n";
+  header << "#endif  // " << guard << "\n";
+
+  return true;
+}
+
+bool write_source(void)
+{
+  std::string filename(output + ".cpp");
+  std::ofstream source(filename.c_str());
+
+  if (!source.is_open())
+  {
+    std::cerr << "ERROR: Unable to open " << filename << " for writing\n";
+    return false;
+  }
+
+  source << "// Generated by karl2cpp. Do not edit.\n\n";
+  source << "#include <cmath>\n";
+  source << "#include <limits>\n\n";
+  source << "#include \"" << utility::extract_filename(output) << ".h\"\n";
+  source << "#include \"madara/knowledge/ContextGuard.h\"\n";
+  source << "#include \"madara/knowledge/Variables.h\"\n\n";
+  source << "namespace " << namespace_name << "\n{\n";
+
+  knowledge::KnowledgeBase kb;
+  expression::CppGenerator generator;
+  std::vector<bool> interpreted;
+
+  for (const Logic& logic : logics)
+  {
+    knowledge::CompiledExpression compiled = kb.compile(logic.source);
+
+    try
+    {
+      source << generator.generate(compiled.get_root(), logic.name,
+          logic.source);
+      interpreted.push_back(false);
+    }
+    catch (const madara::exceptions::KarlException& e)
+    {
+      if (strict)
+      {
+        std::cerr << "ERROR: " << logic.name << ": " << e.what() << "\n";
+        return false;
+      }
+
+      std::cerr << "WARNING: " << logic.name << " will be interpreted: "
+                << e.what() << "\n";
+
+      source << "madara::knowledge::KnowledgeRecord " << logic.name << "(\n";
+      source << "    madara::knowledge::FunctionArguments&, "
+                "madara::knowledge::Variables& vars)\n";
+      source << "{\n";
+      source << "  // " << e.what() << "\n";
+      source << "  return vars.evaluate("
+             << expression::CppGenerator::quote(logic.source) << ");\n";
+      source << "}\n";
+
+      interpreted.push_back(true);
+    }
+
+    source << "\n";
+  }
+
+  source << "const madara::knowledge::GeneratedFunction functions[] = {\n";
+
+  for (size_t i = 0; i < logics.size(); ++i)
+  {
+    source << "  {" << expression::CppGenerator::quote(logics[i].name) << ", "
+           << expression::CppGenerator::quote(logics[i].source) << ", "
+           << logics[i].name << ", "
+           << (interpreted[i] ? "true" : "false") << "},\n";
+  }
+
+  // an empty array is ill-formed, so always end with a null entry
+  source << "  {nullptr, nullptr, nullptr, false}\n";
+  source << "};\n\n";
+  source << "const size_t num_functions = " << logics.size() << ";\n\n";
+  source << "void define_functions(madara::knowledge::KnowledgeBase& kb)\n";
+  source << "{\n";
+  source << "  for (size_t i = 0; i < num_functions; ++i)\n";
+  source << "  {\n";
+  source << "    kb.define_function(functions[i].name, "
+            "functions[i].function);\n";
+  source << "  }\n";
+  source << "}\n";
+  source << "}\n";
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  // handle all user arguments
+  handle_arguments(argc, argv);
+
+  if (logics.size() == 0)
+  {
+    std::cerr << "ERROR: No logic given. Use -i or -x, or -h for help.\n";
+    return 1;
+  }
+
+  try
+  {
+    if (!write_header() || !write_source())
+    {
+      return 1;
+    }
+  }
+  catch (const madara::exceptions::KarlException& e)
+  {
+    std::cerr << "ERROR: " << e.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
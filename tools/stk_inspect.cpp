@@ -1115,7 +1115,19 @@ void iterate_stk(
 
     VariableStats& variable = variables[cur.first];
 
-    uint64_t size = cur.second.size();
+    uint64_t size = 0;
+
+    if(cur.second.is_any_type())
+    {
+      // count encoded bytes, since asking an Any for its element count
+      // would decode it. An empty record encodes only the header.
+      size = cur.second.get_encoded_size() -
+        knowledge::KnowledgeRecord().get_encoded_size();
+    }
+    else
+    {
+      size = cur.second.size();
+    }
 
     if(cur.second.is_integer_type())
     {